@@ -138,6 +138,7 @@ FGAIBase::FGAIBase(object_type ot, bool enableHot) :
     _refID( _newAIModelID() ),
     _otype(ot),
     _initialized(false),
+    _kinematicsDone(false),
     _modeldata(0),
     _fx(0)
 {
@@ -316,6 +317,20 @@ void FGAIBase::update(double dt) {
     updateInterior();
 }
 
+void FGAIBase::preUpdate(double dt)
+{
+    updateKinematics(dt);
+    _kinematicsDone = true;
+}
+
+void FGAIBase::runKinematics(double dt)
+{
+    if (_kinematicsDone)
+        _kinematicsDone = false;
+    else
+        updateKinematics(dt);
+}
+
 void FGAIBase::updateInterior()
 {
     if(!_modeldata || !_modeldata->hasInteriorPath())
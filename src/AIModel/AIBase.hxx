@@ -64,6 +64,19 @@ public:
     virtual void unbind();
     virtual void reinit() {}
 
+    /**
+     * True if updateKinematics() only depends on the state of this object,
+     * so the manager may run it for several objects concurrently.
+     */
+    virtual bool hasIndependentKinematics() const { return false; }
+
+    /**
+     * Run the kinematic part of this frame's update ahead of update().
+     * Called by FGAIManager, possibly from a worker thread, and only for
+     * objects with independent kinematics.
+     */
+    void preUpdate(double dt);
+
     void updateLOD();
     void updateInterior();
     void setManager(FGAIManager* mgr, SGPropertyNode* p);
@@ -222,6 +235,16 @@ protected:
     double _impact_roll;
     double _impact_speed;
 
+    /**
+     * The part of the update which only touches members of this object:
+     * no property tree, scene graph or other AI objects. Subclasses
+     * overriding it call runKinematics() from update().
+     */
+    virtual void updateKinematics(double dt) {}
+
+    /// run updateKinematics(), unless preUpdate() already did for this frame
+    void runKinematics(double dt);
+
     void Transform();
     void CalculateMach();
     double UpdateRadar(FGAIManager* manager);
@@ -235,6 +258,7 @@ private:
     int _refID;
     object_type _otype;
     bool _initialized;
+    bool _kinematicsDone;
     osg::ref_ptr<osg::PagedLOD> _model;
     osg::ref_ptr<osg::PagedLOD> _interior;
 
@@ -36,10 +36,19 @@
 #include <Viewer/view.hxx>
 
 #include <Scenery/scenery.hxx>
+#include <Scenery/ElevationService.hxx>
 
 #include "AIEscort.hxx"
 
 using std::string;
+using flightgear::ElevationService;
+
+static ElevationService::CallerId elevationCaller()
+{
+    static ElevationService::CallerId id =
+        ElevationService::instance()->registerCaller("ai-escort", 10.0);
+    return id;
+}
 
 FGAIEscort::FGAIEscort() :
 FGAIShip(otEscort),
@@ -192,7 +201,8 @@ bool FGAIEscort::getGroundElev(SGGeod inpos) {
     double height_m ;
 
     const simgear::BVHMaterial* mat = 0;
-    if (globals->get_scenery()->get_elevation_m(SGGeod::fromGeodM(inpos, 3000), height_m, &mat, 0)){
+    if (ElevationService::instance()->getElevation(elevationCaller(),
+            SGGeod::fromGeodM(inpos, 3000), height_m, &mat)){
         const SGMaterial* material = dynamic_cast<const SGMaterial*>(mat);
         _ht_agl_ft = inpos.getElevationFt() - height_m * SG_METER_TO_FEET;
 
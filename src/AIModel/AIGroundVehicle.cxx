@@ -26,12 +26,23 @@
 
 #include <Viewer/view.hxx>
 #include <Scenery/scenery.hxx>
+#include <Scenery/ElevationService.hxx>
 #include <Airports/dynamics.hxx>
 #include <Main/globals.hxx>
 
 #include "AIGroundVehicle.hxx"
 
 using std::string;
+using flightgear::ElevationService;
+
+// the pitch comes from the difference between the front and rear
+// elevations, so these need to be precise
+static ElevationService::CallerId elevationCaller()
+{
+    static ElevationService::CallerId id =
+        ElevationService::instance()->registerCaller("ai-ground-vehicle", 1.0);
+    return id;
+}
 
 FGAIGroundVehicle::FGAIGroundVehicle() :
 FGAIShip(otGroundVehicle),
@@ -239,17 +250,16 @@ bool FGAIGroundVehicle::getPitch() {
         double elev_rear = 0;
         //double max_alt = 10000;
 
-        if (globals->get_scenery()->get_elevation_m(SGGeod::fromGeodM(geodFront, 3000),
-            elev_front, NULL, 0)){
-                front_elev_m = elev_front + _z_offset_m;
-        } else
+        ElevationService::QueryList contacts;
+        contacts.push_back(ElevationService::Query(SGGeod::fromGeodM(geodFront, 3000)));
+        contacts.push_back(ElevationService::Query(SGGeod::fromGeodM(geodRear, 3000)));
+        if (ElevationService::instance()->getElevations(elevationCaller(), contacts) < 2)
             return false;
 
-        if (globals->get_scenery()->get_elevation_m(SGGeod::fromGeodM(geodRear, 3000),
-            elev_rear, NULL, 0)){
-                rear_elev_m = elev_rear;
-        } else
-            return false;
+        elev_front = contacts[0].elevation;
+        front_elev_m = elev_front + _z_offset_m;
+        elev_rear = contacts[1].elevation;
+        rear_elev_m = elev_rear;
 
         if (vel >= 0){
             double diff = front_elev_m - rear_elev_m;
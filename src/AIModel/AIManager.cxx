@@ -19,6 +19,7 @@
 // Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 #include <cstring>
+#include <cmath>
 #include <algorithm>
 
 #include <simgear/sg_inlines.h>
@@ -27,6 +28,8 @@
 #include <simgear/structure/exception.hxx>
 #include <simgear/structure/commands.hxx>
 #include <simgear/structure/SGBinding.hxx>
+#include <simgear/threads/SGThread.hxx>
+#include <simgear/threads/SGGuard.hxx>
 
 #include <boost/mem_fn.hpp>
 #include <boost/foreach.hpp>
@@ -106,7 +109,143 @@ private:
 
 ///////////////////////////////////////////////////////////////////////////////
 
+namespace {
+
+// Below this number of objects the parallel update is not worth the
+// thread synchronisation.
+const unsigned PARALLEL_MIN_OBJECTS = 32;
+
+} // anonymous namespace
+
+///////////////////////////////////////////////////////////////////////////////
+
+/// Threads running FGAIBase::preUpdate. Each run splits the objects into
+/// one contiguous slice per thread, the calling thread takes the first
+/// slice itself and then waits for the others.
+class FGAIManager::UpdateWorkers
+{
+public:
+    UpdateWorkers(unsigned count) :
+        _generation(0),
+        _pending(0),
+        _exit(false),
+        _objects(NULL),
+        _dt(0.0)
+    {
+        for (unsigned i = 0; i < count; ++i) {
+            Worker* w = new Worker(this, i + 1);
+            _threads.push_back(w);
+            w->start();
+        }
+    }
+
+    ~UpdateWorkers()
+    {
+        {
+            SGGuard<SGMutex> g(_lock);
+            _exit = true;
+            _start.broadcast();
+        }
+
+        BOOST_FOREACH(Worker* w, _threads) {
+            w->join();
+            delete w;
+        }
+    }
+
+    unsigned size() const
+    { return _threads.size(); }
+
+    void run(const std::vector<FGAIBase*>& objects, double dt)
+    {
+        {
+            SGGuard<SGMutex> g(_lock);
+            _objects = &objects;
+            _dt = dt;
+            _pending = _threads.size();
+            ++_generation;
+            _start.broadcast();
+        }
+
+        runSlice(0);
+
+        SGGuard<SGMutex> g(_lock);
+        while (_pending > 0) {
+            _done.wait(_lock);
+        }
+        _objects = NULL;
+    }
+private:
+    class Worker : public SGThread
+    {
+    public:
+        Worker(UpdateWorkers* owner, unsigned slice) :
+            _owner(owner),
+            _slice(slice)
+        {
+        }
+
+        virtual void run()
+        {
+            unsigned generation = 0;
+            for (;;) {
+                {
+                    SGGuard<SGMutex> g(_owner->_lock);
+                    while (!_owner->_exit && (_owner->_generation == generation)) {
+                        _owner->_start.wait(_owner->_lock);
+                    }
+
+                    if (_owner->_exit) {
+                        return;
+                    }
+                    generation = _owner->_generation;
+                }
+
+                _owner->runSlice(_slice);
+
+                SGGuard<SGMutex> g(_owner->_lock);
+                if (--_owner->_pending == 0) {
+                    _owner->_done.signal();
+                }
+            }
+        }
+    private:
+        UpdateWorkers* _owner;
+        unsigned _slice;
+    };
+
+    void runSlice(unsigned slice)
+    {
+        const std::vector<FGAIBase*>& objects(*_objects);
+        unsigned count = _threads.size() + 1;
+        size_t begin = (objects.size() * slice) / count;
+        size_t end = (objects.size() * (slice + 1)) / count;
+        for (size_t i = begin; i < end; ++i) {
+            try {
+                objects[i]->preUpdate(_dt);
+            } catch (sg_exception& e) {
+                SG_LOG(SG_AI, SG_WARN, "caught exception updating AI model:" << objects[i]->_getName()<< ", which will be killed."
+                       "\n\tError:" << e.getFormattedMessage());
+                objects[i]->setDie(true);
+            }
+        }
+    }
+
+    SGMutex _lock;
+    SGWaitCondition _start, _done;
+    unsigned _generation;
+    unsigned _pending;
+    bool _exit;
+    const std::vector<FGAIBase*>* _objects;
+    double _dt;
+    std::vector<Worker*> _threads;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
 FGAIManager::FGAIManager() :
+    _index(new FGAIGridIndex),
+    _snapshotFrame(0),
     cb_ai_bare(SGPropertyChangeCallback<FGAIManager>(this,&FGAIManager::updateLOD,
                fgGetNode("/sim/rendering/static-lod/ai-bare", true))),
     cb_ai_detailed(SGPropertyChangeCallback<FGAIManager>(this,&FGAIManager::updateLOD,
@@ -133,6 +272,12 @@ FGAIManager::init() {
     user_altitude_agl_node  = fgGetNode("/position/altitude-agl-ft", true);
     user_speed_node     = fgGetNode("/velocities/uBody-fps", true);
     
+    _parallelUpdate = fgGetNode("/sim/ai/parallel-update", true);
+    _updateThreads = fgGetNode("/sim/ai/update-threads", true);
+    if (!_updateThreads->hasValue()) {
+        _updateThreads->setIntValue(2);
+    }
+
     globals->get_commands()->addCommand("load-scenario", this, &FGAIManager::loadScenarioCommand);
     globals->get_commands()->addCommand("unload-scenario", this, &FGAIManager::unloadScenarioCommand);
     _environmentVisiblity = fgGetNode("/environment/visibility-m");
@@ -186,6 +331,13 @@ FGAIManager::shutdown()
     }
     
     ai_list.clear();
+    _index->clear();
+    {
+        SGGuard<SGMutex> g(_snapshotLock);
+        _trafficSnapshot.clear();
+        _spareSnapshot.clear();
+    }
+    _workers.reset();
     _environmentVisiblity.clear();
     
     globals->get_commands()->removeCommand("load-scenario");
@@ -240,11 +392,25 @@ FGAIManager::update(double dt) {
     }
   
     ai_list.erase(ai_list.begin(), firstAlive);
+    _positions.clear();
+    BOOST_FOREACH(FGAIBase* ai, ai_list) {
+        _positions.push_back(ai->getCartPos());
+    }
+    _index->rebuild(_positions);
+
+    if (_parallelUpdate->getBoolValue()) {
+        updateKinematics(dt);
+    } else {
+        _workers.reset();
+    }
   
     // every remaining item is alive. update them in turn, but guard for
     // exceptions, so a single misbehaving AI object doesn't bring down the
     // entire subsystem.
-    BOOST_FOREACH(FGAIBase* base, ai_list) {
+    // Objects may be attached while we are updating (from Nasal), so
+    // don't hold on to iterators here.
+    for (size_t i = 0; i < ai_list.size(); ++i) {
+        FGAIBase* base = ai_list[i];
         try {
             if (base->isa(FGAIBase::otThermal)) {
                 processThermal(dt, (FGAIThermal*)base);
@@ -259,6 +425,70 @@ FGAIManager::update(double dt) {
     } // of live AI objects iteration
 
     thermal_lift_node->setDoubleValue( strength );  // for thermals
+    publishTrafficSnapshot();
+}
+
+void
+FGAIManager::publishTrafficSnapshot()
+{
+    // reuse the previous buffer, unless a reader still holds on to it.
+    // The spare is not published, so no reader can pick it up meanwhile.
+    FGAITrafficSnapshotPtr next;
+    {
+        SGGuard<SGMutex> g(_snapshotLock);
+        next = _spareSnapshot;
+        _spareSnapshot.clear();
+    }
+    if (!next || (next.getNumRefs() > 1)) {
+        next = new FGAITrafficSnapshot;
+    }
+
+    next->rebuild(ai_list, ++_snapshotFrame);
+
+    SGGuard<SGMutex> g(_snapshotLock);
+    _spareSnapshot = _trafficSnapshot;
+    _trafficSnapshot = next;
+}
+
+FGAITrafficSnapshotPtr
+FGAIManager::getTrafficSnapshot() const
+{
+    FGAITrafficSnapshotPtr snapshot;
+    {
+        SGGuard<SGMutex> g(_snapshotLock);
+        snapshot = _trafficSnapshot;
+    }
+
+    if (!snapshot) {
+        // nothing published yet
+        return FGAITrafficSnapshotPtr(new FGAITrafficSnapshot);
+    }
+
+    return snapshot;
+}
+
+// run the kinematic part of the updates on the worker threads, for the
+// objects which support it. Their update() then skips that part.
+void
+FGAIManager::updateKinematics(double dt)
+{
+    _parallelObjects.clear();
+    BOOST_FOREACH(FGAIBase* base, ai_list) {
+        if (base->hasIndependentKinematics()) {
+            _parallelObjects.push_back(base);
+        }
+    }
+
+    if (_parallelObjects.size() < PARALLEL_MIN_OBJECTS) {
+        return;
+    }
+
+    unsigned threads = std::max(_updateThreads->getIntValue(), 1);
+    if (!_workers.get() || (_workers->size() != threads)) {
+        _workers.reset(new UpdateWorkers(threads));
+    }
+
+    _workers->run(_parallelObjects, dt);
 }
 
 /** update LOD settings of all AI/MP models */
@@ -307,6 +537,23 @@ bool FGAIManager::isVisible(const SGGeod& pos) const
   return ( dist(globals->get_view_position_cart(), SGVec3d::fromGeod(pos)) ) <= visibility_meters;
 }
 
+void
+FGAIManager::findObjectsInRange(const SGVec3d& cart, double rangeM,
+                                std::vector<FGAIBase*>& result) const
+{
+    std::vector<unsigned> candidates;
+    _index->query(cart, rangeM, ai_list.size(), candidates);
+
+    result.clear();
+    double rangeSqr = rangeM * rangeM;
+    BOOST_FOREACH(unsigned i, candidates) {
+        FGAIBase* ai = ai_list[i];
+        if (distSqr(cart, ai->getCartPos()) <= rangeSqr) {
+            result.push_back(ai);
+        }
+    }
+}
+
 int
 FGAIManager::getNumAiObjects() const
 {
@@ -559,33 +806,36 @@ const FGAIBase *
 FGAIManager::calcCollision(double alt, double lat, double lon, double fuse_range)
 {
     // we specify tgt extent (ft) according to the AIObject type
-    double tgt_ht[]     = {0,  50, 100, 250, 0, 100, 0, 0,  50,  50, 20, 100,  50};
-    double tgt_length[] = {0, 100, 200, 750, 0,  50, 0, 0, 200, 100, 40, 200, 100};
-    ai_list_iterator ai_list_itr = ai_list.begin();
-    ai_list_iterator end = ai_list.end();
+    static const double tgt_ht[]     = {0,  50, 100, 250, 0, 100, 0, 0,  50,  50, 20, 100,  50};
+    static const double tgt_length[] = {0, 100, 200, 750, 0,  50, 0, 0, 200, 100, 40, 200, 100};
+    const double max_length = 750;
 
     SGGeod pos(SGGeod::fromDegFt(lon, lat, alt));
     SGVec3d cartPos(SGVec3d::fromGeod(pos));
-    
-    while (ai_list_itr != end) {
-        double tgt_alt = (*ai_list_itr)->_getAltitude();
-        int type       = (*ai_list_itr)->getType();
-        tgt_ht[type] += fuse_range;
 
-        if (fabs(tgt_alt - alt) > tgt_ht[type] || type == FGAIBase::otBallistic
+    // only look at the objects which might be within the largest extent,
+    // in the order they were attached, as a linear scan would
+    double max_range_m = (max_length + fuse_range) * SG_FEET_TO_METER;
+    _index->query(cartPos, max_range_m, ai_list.size(), _queryResult);
+
+    BOOST_FOREACH(unsigned index, _queryResult) {
+        FGAIBase* ai = ai_list[index];
+        double tgt_alt = ai->_getAltitude();
+        int type       = ai->getType();
+
+        if (fabs(tgt_alt - alt) > tgt_ht[type] + fuse_range || type == FGAIBase::otBallistic
             || type == FGAIBase::otStorm || type == FGAIBase::otThermal ) {
                 //SG_LOG(SG_AI, SG_DEBUG, "AIManager: skipping "
                 //    << fabs(tgt_alt - alt)
                 //    << " "
                 //    << type
                 //    );
-                ++ai_list_itr;
                 continue;
         }
 
-        int id         = (*ai_list_itr)->getID();
+        int id         = ai->getID();
 
-        double range = calcRangeFt(cartPos, (*ai_list_itr));
+        double range = calcRangeFt(cartPos, ai);
 
         //SG_LOG(SG_AI, SG_DEBUG, "AIManager:  AI list size "
         //    << ai_list.size()
@@ -596,18 +846,15 @@ FGAIManager::calcCollision(double alt, double lat, double lon, double fuse_range
         //    << " alt " << tgt_alt
         //    );
 
-        tgt_length[type] += fuse_range;
-
-        if (range < tgt_length[type]){
+        if (range < tgt_length[type] + fuse_range){
             SG_LOG(SG_AI, SG_DEBUG, "AIManager: HIT! "
                 << " type " << type
                 << " ID " << id
                 << " range " << range
                 << " alt " << tgt_alt
                 );
-            return (*ai_list_itr).get();
+            return ai;
         }
-        ++ai_list_itr;
     }
     return 0;
 }
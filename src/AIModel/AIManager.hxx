@@ -23,11 +23,15 @@
 #ifndef _FG_AIMANAGER_HXX
 #define _FG_AIMANAGER_HXX
 
-#include <list>
+#include <vector>
 #include <map>
+#include <memory>
 
 #include <simgear/structure/subsystem_mgr.hxx>
 #include <simgear/structure/SGSharedPtr.hxx>
+#include <simgear/threads/SGThread.hxx>
+
+#include "AITrafficSnapshot.hxx"
 
 class FGAIBase;
 class FGAIThermal;
@@ -70,6 +74,14 @@ public:
 
     FGAIBasePtr addObject(const SGPropertyNode* definition);
     bool isVisible(const SGGeod& pos) const;
+
+    /**
+     * @brief collect the AI objects within rangeM meters of a cartesian
+     * position, in the order they were attached. Uses the spatial index,
+     * so this is cheap even with many objects.
+     */
+    void findObjectsInRange(const SGVec3d& cart, double rangeM,
+                            std::vector<FGAIBase*>& result) const;
     
     /**
      * @brief given a reference to an /ai/models/<foo>[n] node, return the
@@ -77,13 +89,21 @@ public:
      */
     FGAIBasePtr getObjectFromProperty(const SGPropertyNode* aProp) const;
 
+    /**
+     * @brief the state of all AI objects as of the last update, for
+     * instruments and displays which would otherwise scan /ai/models.
+     * Never NULL; treat the snapshot as read-only.
+     */
+    FGAITrafficSnapshotPtr getTrafficSnapshot() const;
+
     static const char* subsystemName() { return "ai-model"; }
 private:
     // FGSubmodelMgr is a friend for access to the AI_list
     friend class FGSubmodelMgr;
     
-    // A list of pointers to AI objects
-    typedef std::list <FGAIBasePtr> ai_list_type;
+    // A list of pointers to AI objects, contiguous for the sake of the
+    // update loop and the spatial index
+    typedef std::vector <FGAIBasePtr> ai_list_type;
     typedef ai_list_type::iterator ai_list_iterator;
     typedef ai_list_type::const_iterator ai_list_const_iterator;
     
@@ -97,6 +117,9 @@ private:
   
     double calcRangeFt(const SGVec3d& aCartPos, FGAIBase* aObject) const;
 
+    void updateKinematics(double dt);
+    void publishTrafficSnapshot();
+
     bool loadScenarioCommand(const SGPropertyNode* args);
     bool unloadScenarioCommand(const SGPropertyNode* args);
     bool addObjectCommand(const SGPropertyNode* definition);
@@ -116,6 +139,28 @@ private:
 
 
     ai_list_type ai_list;
+
+    // Uniform grid over the objects' cartesian positions, for range and
+    // collision queries
+    std::auto_ptr<FGAIGridIndex> _index;
+    std::vector<SGVec3d> _positions;
+    std::vector<unsigned> _queryResult;
+
+    // the published traffic snapshot, and the buffer for the next one.
+    // _snapshotLock guards the pointers, getTrafficSnapshot() may be called
+    // from any thread
+    FGAITrafficSnapshotPtr _trafficSnapshot;
+    FGAITrafficSnapshotPtr _spareSnapshot;
+    mutable SGMutex _snapshotLock;
+    unsigned _snapshotFrame;
+
+    // Threads running the kinematic part of the updates, if enabled by
+    // /sim/ai/parallel-update
+    class UpdateWorkers;
+    std::auto_ptr<UpdateWorkers> _workers;
+    std::vector<FGAIBase*> _parallelObjects;
+    SGPropertyNode_ptr _parallelUpdate;
+    SGPropertyNode_ptr _updateThreads;
     
     double user_altitude_agl;
     double user_heading;
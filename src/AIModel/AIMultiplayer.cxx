@@ -47,6 +47,10 @@ FGAIMultiplayer::FGAIMultiplayer() :
    mLagAdjustSystemSpeed = 10;
    mLastTimestamp = 0;
    lastUpdateTime = 0;
+   mPropsPrev = 0;
+   mPropsNext = 0;
+   mPropsTau = 0;
+   mEcLinearVel = SGVec3f::zeros();
    playerLag = 0.03;
    compensateLag = 1;
 
@@ -114,13 +118,72 @@ SGRawValueMethods<FGAIMultiplayer, type>(*this, \
 
 void FGAIMultiplayer::update(double dt)
 {
-  using namespace simgear;
+  // the kinematics may already have been updated by the AI manager
+  runKinematics(dt);
 
   if (dt <= 0)
     return;
 
   FGAIBase::update(dt);
 
+  // Check if we already got data
+  if (mMotionInfo.empty())
+    return;
+
+  // apply the properties of the packets the position was taken from
+  if (mPropsNext) {
+    interpolateProperties(*mPropsPrev, *mPropsNext, mPropsTau);
+  } else if (mPropsPrev) {
+    setProperties(*mPropsPrev);
+  }
+  mPropsPrev = mPropsNext = 0;
+
+  // expose velocities/u,v,wbody-fps in the mp tree
+  _uBodyNode->setValue(mEcLinearVel[0] * SG_METER_TO_FEET);
+  _vBodyNode->setValue(mEcLinearVel[1] * SG_METER_TO_FEET);
+  _wBodyNode->setValue(mEcLinearVel[2] * SG_METER_TO_FEET);
+
+  //###########################//
+  // do calculations for radar //
+  //###########################//
+    double range_ft2 = UpdateRadar(manager);
+
+    //************************************//
+    // Tanker code                        //
+    //************************************//
+
+
+    if ( isTanker) {
+        //cout << "IS tanker ";
+        if ( (range_ft2 < 250.0 * 250.0) &&
+            (y_shift > 0.0)    &&
+            (elevation > 0.0) ){
+                // refuel_node->setBoolValue(true);
+                 //cout << "in contact"  << endl;
+            contact = true;
+        } else {
+            // refuel_node->setBoolValue(false);
+            //cout << "not in contact"  << endl;
+            contact = false;
+        }
+    } else {
+        //cout << "NOT tanker " << endl;
+        contact = false;
+    }
+
+  Transform();
+}
+
+// Interpolate or extrapolate the position and orientation from the motion
+// packets. This only touches members of this object, the property tree is
+// updated later on in update(), so this may run on a worker thread.
+void FGAIMultiplayer::updateKinematics(double dt)
+{
+  mPropsPrev = mPropsNext = 0;
+
+  if (dt <= 0)
+    return;
+
   // Check if we already got data
   if (mMotionInfo.empty())
     return;
@@ -233,47 +296,7 @@ void FGAIMultiplayer::update(double dt)
       ecOrient = firstIt->second.orientation;
       ecLinearVel = firstIt->second.linearVel;
       speed = norm(ecLinearVel) * SG_METER_TO_NM * 3600.0;
-
-      std::vector<FGPropertyData*>::const_iterator firstPropIt;
-      std::vector<FGPropertyData*>::const_iterator firstPropItEnd;
-      firstPropIt = firstIt->second.properties.begin();
-      firstPropItEnd = firstIt->second.properties.end();
-      while (firstPropIt != firstPropItEnd) {
-        //cout << " Setting property..." << (*firstPropIt)->id;
-        PropertyMap::iterator pIt = mPropertyMap.find((*firstPropIt)->id);
-        if (pIt != mPropertyMap.end())
-        {
-          //cout << "Found " << pIt->second->getPath() << ":";
-          switch ((*firstPropIt)->type) {
-            case props::INT:
-            case props::BOOL:
-            case props::LONG:
-              pIt->second->setIntValue((*firstPropIt)->int_value);
-              //cout << "Int: " << (*firstPropIt)->int_value << "\n";
-              break;
-            case props::FLOAT:
-            case props::DOUBLE:
-              pIt->second->setFloatValue((*firstPropIt)->float_value);
-              //cout << "Flo: " << (*firstPropIt)->float_value << "\n";
-              break;
-            case props::STRING:
-            case props::UNSPECIFIED:
-              pIt->second->setStringValue((*firstPropIt)->string_value);
-              //cout << "Str: " << (*firstPropIt)->string_value << "\n";    
-              break;
-            default:
-              // FIXME - currently defaults to float values
-              pIt->second->setFloatValue((*firstPropIt)->float_value);
-              //cout << "Unknown: " << (*firstPropIt)->float_value << "\n";
-              break;
-          }            
-        }
-        else
-        {
-          SG_LOG(SG_AI, SG_DEBUG, "Unable to find property: " << (*firstPropIt)->id << "\n");
-        }
-        ++firstPropIt;
-      }
+      mPropsPrev = &firstIt->second;
 
     } else {
       // Ok, we have really found something where our target time is in between
@@ -300,62 +323,9 @@ void FGAIMultiplayer::update(double dt)
 
       if (prevIt->second.properties.size()
           == nextIt->second.properties.size()) {
-        std::vector<FGPropertyData*>::const_iterator prevPropIt;
-        std::vector<FGPropertyData*>::const_iterator prevPropItEnd;
-        std::vector<FGPropertyData*>::const_iterator nextPropIt;
-        std::vector<FGPropertyData*>::const_iterator nextPropItEnd;
-        prevPropIt = prevIt->second.properties.begin();
-        prevPropItEnd = prevIt->second.properties.end();
-        nextPropIt = nextIt->second.properties.begin();
-        nextPropItEnd = nextIt->second.properties.end();
-        while (prevPropIt != prevPropItEnd) {
-          PropertyMap::iterator pIt = mPropertyMap.find((*prevPropIt)->id);
-          //cout << " Setting property..." << (*prevPropIt)->id;
-          
-          if (pIt != mPropertyMap.end())
-          {
-            //cout << "Found " << pIt->second->getPath() << ":";
-          
-            int ival;
-            float val;
-            switch ((*prevPropIt)->type) {
-              case props::INT:
-              case props::BOOL:
-              case props::LONG:
-                ival = (int) (0.5+(1-tau)*((double) (*prevPropIt)->int_value) +
-                  tau*((double) (*nextPropIt)->int_value));
-                pIt->second->setIntValue(ival);
-                //cout << "Int: " << ival << "\n";
-                break;
-              case props::FLOAT:
-              case props::DOUBLE:
-                val = (1-tau)*(*prevPropIt)->float_value +
-                  tau*(*nextPropIt)->float_value;
-                //cout << "Flo: " << val << "\n";
-                pIt->second->setFloatValue(val);
-                break;
-              case props::STRING:
-              case props::UNSPECIFIED:
-                //cout << "Str: " << (*nextPropIt)->string_value << "\n";
-                pIt->second->setStringValue((*nextPropIt)->string_value);
-                break;
-              default:
-                // FIXME - currently defaults to float values
-                val = (1-tau)*(*prevPropIt)->float_value +
-                  tau*(*nextPropIt)->float_value;
-                //cout << "Unk: " << val << "\n";
-                pIt->second->setFloatValue(val);
-                break;
-            }            
-          }
-          else
-          {
-            SG_LOG(SG_AI, SG_DEBUG, "Unable to find property: " << (*prevPropIt)->id << "\n");
-          }
-          
-          ++prevPropIt;
-          ++nextPropIt;
-        }
+        mPropsPrev = &prevIt->second;
+        mPropsNext = &nextIt->second;
+        mPropsTau = tau;
       }
 
       // Now throw away too old data
@@ -401,48 +371,8 @@ void FGAIMultiplayer::update(double dt)
 		ecPos += t*(ecVel);
 	}
 
-	std::vector<FGPropertyData*>::const_iterator firstPropIt;
-    std::vector<FGPropertyData*>::const_iterator firstPropItEnd;
     speed = norm(ecLinearVel) * SG_METER_TO_NM * 3600.0;
-    firstPropIt = it->second.properties.begin();
-    firstPropItEnd = it->second.properties.end();
-    while (firstPropIt != firstPropItEnd) {
-      PropertyMap::iterator pIt = mPropertyMap.find((*firstPropIt)->id);
-      //cout << " Setting property..." << (*firstPropIt)->id;
-      
-      if (pIt != mPropertyMap.end())
-      {
-        switch ((*firstPropIt)->type) {
-          case props::INT:
-          case props::BOOL:
-          case props::LONG:
-            pIt->second->setIntValue((*firstPropIt)->int_value);
-            //cout << "Int: " << (*firstPropIt)->int_value << "\n";
-            break;
-          case props::FLOAT:
-          case props::DOUBLE:
-            pIt->second->setFloatValue((*firstPropIt)->float_value);
-            //cout << "Flo: " << (*firstPropIt)->float_value << "\n";
-            break;
-          case props::STRING:
-          case props::UNSPECIFIED:
-            pIt->second->setStringValue((*firstPropIt)->string_value);
-            //cout << "Str: " << (*firstPropIt)->string_value << "\n";
-            break;
-          default:
-            // FIXME - currently defaults to float values
-            pIt->second->setFloatValue((*firstPropIt)->float_value);
-            //cout << "Unk: " << (*firstPropIt)->float_value << "\n";
-            break;
-        }            
-      }
-      else
-      {
-        SG_LOG(SG_AI, SG_DEBUG, "Unable to find property: " << (*firstPropIt)->id << "\n");
-      }
-      
-      ++firstPropIt;
-    }
+    mPropsPrev = &it->second;
   }
   
   // extract the position
@@ -474,43 +404,124 @@ void FGAIMultiplayer::update(double dt)
   roll = rDeg;
   pitch = pDeg;
 
-  // expose velocities/u,v,wbody-fps in the mp tree
-  _uBodyNode->setValue(ecLinearVel[0] * SG_METER_TO_FEET);
-  _vBodyNode->setValue(ecLinearVel[1] * SG_METER_TO_FEET);
-  _wBodyNode->setValue(ecLinearVel[2] * SG_METER_TO_FEET);
+  mEcLinearVel = ecLinearVel;
 
   SG_LOG(SG_AI, SG_DEBUG, "Multiplayer position and orientation: "
          << ecPos << ", " << hlOr);
+}
 
-  //###########################//
-  // do calculations for radar //
-  //###########################//
-    double range_ft2 = UpdateRadar(manager);
+void
+FGAIMultiplayer::setProperties(const FGExternalMotionData& motionInfo)
+{
+  using namespace simgear;
 
-    //************************************//
-    // Tanker code                        //
-    //************************************//
+  std::vector<FGPropertyData*>::const_iterator firstPropIt;
+  std::vector<FGPropertyData*>::const_iterator firstPropItEnd;
+  firstPropIt = motionInfo.properties.begin();
+  firstPropItEnd = motionInfo.properties.end();
+  while (firstPropIt != firstPropItEnd) {
+    //cout << " Setting property..." << (*firstPropIt)->id;
+    PropertyMap::iterator pIt = mPropertyMap.find((*firstPropIt)->id);
+    if (pIt != mPropertyMap.end())
+    {
+      //cout << "Found " << pIt->second->getPath() << ":";
+      switch ((*firstPropIt)->type) {
+        case props::INT:
+        case props::BOOL:
+        case props::LONG:
+          pIt->second->setIntValue((*firstPropIt)->int_value);
+          //cout << "Int: " << (*firstPropIt)->int_value << "\n";
+          break;
+        case props::FLOAT:
+        case props::DOUBLE:
+          pIt->second->setFloatValue((*firstPropIt)->float_value);
+          //cout << "Flo: " << (*firstPropIt)->float_value << "\n";
+          break;
+        case props::STRING:
+        case props::UNSPECIFIED:
+          pIt->second->setStringValue((*firstPropIt)->string_value);
+          //cout << "Str: " << (*firstPropIt)->string_value << "\n";
+          break;
+        default:
+          // FIXME - currently defaults to float values
+          pIt->second->setFloatValue((*firstPropIt)->float_value);
+          //cout << "Unknown: " << (*firstPropIt)->float_value << "\n";
+          break;
+      }
+    }
+    else
+    {
+      SG_LOG(SG_AI, SG_DEBUG, "Unable to find property: " << (*firstPropIt)->id << "\n");
+    }
+    ++firstPropIt;
+  }
+}
 
+void
+FGAIMultiplayer::interpolateProperties(const FGExternalMotionData& prev,
+                                       const FGExternalMotionData& next,
+                                       double tau)
+{
+  using namespace simgear;
 
-    if ( isTanker) {
-        //cout << "IS tanker ";
-        if ( (range_ft2 < 250.0 * 250.0) &&
-            (y_shift > 0.0)    &&
-            (elevation > 0.0) ){
-                // refuel_node->setBoolValue(true);
-                 //cout << "in contact"  << endl;
-            contact = true;
-        } else {
-            // refuel_node->setBoolValue(false);
-            //cout << "not in contact"  << endl;
-            contact = false;
-        }
-    } else {
-        //cout << "NOT tanker " << endl;
-        contact = false;
+  std::vector<FGPropertyData*>::const_iterator prevPropIt;
+  std::vector<FGPropertyData*>::const_iterator prevPropItEnd;
+  std::vector<FGPropertyData*>::const_iterator nextPropIt;
+  std::vector<FGPropertyData*>::const_iterator nextPropItEnd;
+  prevPropIt = prev.properties.begin();
+  prevPropItEnd = prev.properties.end();
+  nextPropIt = next.properties.begin();
+  nextPropItEnd = next.properties.end();
+  // a packet may carry fewer properties than the previous one (sender
+  // without a keyframe, or a truncated packet)
+  while ((prevPropIt != prevPropItEnd) && (nextPropIt != nextPropItEnd)) {
+    PropertyMap::iterator pIt = mPropertyMap.find((*prevPropIt)->id);
+    //cout << " Setting property..." << (*prevPropIt)->id;
+
+    if (pIt != mPropertyMap.end())
+    {
+      //cout << "Found " << pIt->second->getPath() << ":";
+
+      int ival;
+      float val;
+      switch ((*prevPropIt)->type) {
+        case props::INT:
+        case props::BOOL:
+        case props::LONG:
+          ival = (int) (0.5+(1-tau)*((double) (*prevPropIt)->int_value) +
+            tau*((double) (*nextPropIt)->int_value));
+          pIt->second->setIntValue(ival);
+          //cout << "Int: " << ival << "\n";
+          break;
+        case props::FLOAT:
+        case props::DOUBLE:
+          val = (1-tau)*(*prevPropIt)->float_value +
+            tau*(*nextPropIt)->float_value;
+          //cout << "Flo: " << val << "\n";
+          pIt->second->setFloatValue(val);
+          break;
+        case props::STRING:
+        case props::UNSPECIFIED:
+          //cout << "Str: " << (*nextPropIt)->string_value << "\n";
+          pIt->second->setStringValue((*nextPropIt)->string_value);
+          break;
+        default:
+          // FIXME - currently defaults to float values
+          val = (1-tau)*(*prevPropIt)->float_value +
+            tau*(*nextPropIt)->float_value;
+          //cout << "Unk: " << val << "\n";
+          pIt->second->setFloatValue(val);
+          break;
+      }
+    }
+    else
+    {
+      SG_LOG(SG_AI, SG_DEBUG, "Unable to find property: " << (*prevPropIt)->id << "\n");
     }
 
-  Transform();
+    ++prevPropIt;
+    ++nextPropIt;
+  }
 }
 
 void
@@ -518,6 +529,8 @@ FGAIMultiplayer::addMotionInfo(FGExternalMotionData& motionInfo,
                                long stamp)
 {
   mLastTimestamp = stamp;
+  // the packets may go away below
+  mPropsPrev = mPropsNext = 0;
 
   if (!mMotionInfo.empty()) {
     double diff = motionInfo.time - mMotionInfo.rbegin()->first;
@@ -36,6 +36,9 @@ public:
   virtual void bind();
   virtual void update(double dt);
 
+  // the interpolation of the motion packets only depends on this object
+  virtual bool hasIndependentKinematics() const { return true; }
+
   void addMotionInfo(FGExternalMotionData& motionInfo, long stamp);
   void setDoubleProperty(const std::string& prop, double val);
 
@@ -70,12 +73,21 @@ public:
   void setcompensateLag(int mcompensateLag)
   {compensateLag = mcompensateLag; }
 
+  bool getInvisible(void) const
+  { return invisible; }
+
   SGPropertyNode* getPropertyRoot()
   { return props; }
 
   virtual const char* getTypeString(void) const { return "multiplayer"; }
 
+protected:
+  virtual void updateKinematics(double dt);
+
 private:
+  void setProperties(const FGExternalMotionData& motionInfo);
+  void interpolateProperties(const FGExternalMotionData& prev,
+                             const FGExternalMotionData& next, double tau);
 
   // Automatic sorting of motion data according to its timestamp
   typedef std::map<double,FGExternalMotionData> MotionInfo;
@@ -92,6 +104,13 @@ private:
   int compensateLag;
   double lastUpdateTime;
 
+  // Set by updateKinematics(): the packet(s) whose properties update()
+  // has to apply, and the velocity to expose
+  const FGExternalMotionData* mPropsPrev;
+  const FGExternalMotionData* mPropsNext;
+  double mPropsTau;
+  SGVec3f mEcLinearVel;
+
   /// Properties which are for now exposed for testing
   bool mAllowExtrapolation;
   double mLagAdjustSystemSpeed;
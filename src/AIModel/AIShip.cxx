@@ -37,11 +37,20 @@
 
 #include <simgear/scene/util/SGNodeMasks.hxx>
 #include <Scenery/scenery.hxx>
+#include <Scenery/ElevationService.hxx>
 #include <Main/globals.hxx>
 
 #include "AIShip.hxx"
 
 using std::string;
+using flightgear::ElevationService;
+
+static ElevationService::CallerId elevationCaller()
+{
+    static ElevationService::CallerId id =
+        ElevationService::instance()->registerCaller("ai-ship", 10.0);
+    return id;
+}
 
 FGAIShip::FGAIShip(object_type ot) :
 // allow HOT to be enabled
@@ -1049,8 +1058,8 @@ void FGAIShip::setWPPos() {
 
     if (curr->getOn_ground()){
 
-        if (globals->get_scenery()->get_elevation_m(SGGeod::fromGeodM(wppos, 3000),
-            elevation_m, NULL, 0)){
+        if (ElevationService::instance()->getElevation(elevationCaller(),
+            SGGeod::fromGeodM(wppos, 3000), elevation_m)){
                 wppos.setElevationM(elevation_m);
         }
 
@@ -0,0 +1,204 @@
+// AITrafficSnapshot.cxx - per-frame copy of the AI traffic state, for
+// instruments and displays
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "AITrafficSnapshot.hxx"
+
+#include <cmath>
+#include <algorithm>
+
+#include <simgear/constants.h>
+
+#include "AIBase.hxx"
+#include "AIMultiplayer.hxx"
+
+namespace {
+
+// Edge length of the grid cells. Collision and radar queries are at most a
+// few kilometers, so most of them touch one to eight cells.
+const double GRID_CELL_M = 5000.0;
+
+// The AI manager builds its index from the positions at the start of the
+// update, and objects keep moving while it is in use. Queries are widened
+// by this much, the candidates are then checked against their current
+// position.
+const double GRID_MARGIN_M = 1000.0;
+
+// Queries covering more cells than this fall back to a linear scan.
+const int64_t MAX_QUERY_CELLS = 512;
+
+inline int64_t gridCoord(double v)
+{
+    return (int64_t) floor(v / GRID_CELL_M);
+}
+
+// Pack the cell coordinates into a sort key, 21 bits per axis. That covers
+// far more than the earth, even with positions in orbit.
+inline uint64_t gridKey(int64_t x, int64_t y, int64_t z)
+{
+    const int64_t offset = 1 << 20;
+    const uint64_t mask = (1 << 21) - 1;
+    return (((uint64_t) (x + offset) & mask) << 42)
+        | (((uint64_t) (y + offset) & mask) << 21)
+        | ((uint64_t) (z + offset) & mask);
+}
+
+} // anonymous namespace
+
+///////////////////////////////////////////////////////////////////////////////
+
+FGAIGridIndex::FGAIGridIndex() :
+    _indexedCount(0)
+{
+}
+
+void FGAIGridIndex::rebuild(const std::vector<SGVec3d>& positions)
+{
+    _entries.clear();
+    _entries.reserve(positions.size());
+    for (unsigned i = 0; i < positions.size(); ++i) {
+        const SGVec3d& cart = positions[i];
+        _entries.push_back(Entry(gridKey(gridCoord(cart.x()),
+                                         gridCoord(cart.y()),
+                                         gridCoord(cart.z())), i));
+    }
+
+    std::sort(_entries.begin(), _entries.end());
+    _indexedCount = positions.size();
+}
+
+void FGAIGridIndex::clear()
+{
+    _entries.clear();
+    _indexedCount = 0;
+}
+
+void FGAIGridIndex::query(const SGVec3d& cart, double rangeM,
+                          unsigned objectCount,
+                          std::vector<unsigned>& result) const
+{
+    result.clear();
+
+    double r = rangeM + GRID_MARGIN_M;
+    int64_t x0 = gridCoord(cart.x() - r), x1 = gridCoord(cart.x() + r);
+    int64_t y0 = gridCoord(cart.y() - r), y1 = gridCoord(cart.y() + r);
+    int64_t z0 = gridCoord(cart.z() - r), z1 = gridCoord(cart.z() + r);
+
+    // for huge ranges visiting the cells costs more than just
+    // returning everything
+    if ((x1 - x0 + 1) * (y1 - y0 + 1) * (z1 - z0 + 1) > MAX_QUERY_CELLS) {
+        for (unsigned i = 0; i < objectCount; ++i) {
+            result.push_back(i);
+        }
+        return;
+    }
+
+    for (int64_t x = x0; x <= x1; ++x) {
+        for (int64_t y = y0; y <= y1; ++y) {
+            for (int64_t z = z0; z <= z1; ++z) {
+                uint64_t key = gridKey(x, y, z);
+                EntryVec::const_iterator it =
+                    std::lower_bound(_entries.begin(), _entries.end(),
+                                     Entry(key, 0));
+                for (; (it != _entries.end()) && (it->first == key); ++it) {
+                    if (it->second < objectCount) {
+                        result.push_back(it->second);
+                    }
+                }
+            } // of z cells
+        } // of y cells
+    } // of x cells
+
+    for (unsigned i = _indexedCount; i < objectCount; ++i) {
+        result.push_back(i);
+    }
+
+    std::sort(result.begin(), result.end());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+FGAITrafficSnapshot::FGAITrafficSnapshot() :
+    _frame(0)
+{
+}
+
+void FGAITrafficSnapshot::findInRange(const SGVec3d& cart, double rangeM,
+                                      std::vector<unsigned>& result) const
+{
+    std::vector<unsigned> candidates;
+    _index.query(cart, rangeM, _targets.size(), candidates);
+
+    result.clear();
+    double rangeSqr = rangeM * rangeM;
+    for (unsigned i = 0; i < candidates.size(); ++i) {
+        if (distSqr(cart, _targets[candidates[i]].cart) <= rangeSqr) {
+            result.push_back(candidates[i]);
+        }
+    }
+}
+
+void FGAITrafficSnapshot::rebuild(const std::vector<SGSharedPtr<FGAIBase> >& objects,
+                                  unsigned frame)
+{
+    _frame = frame;
+    _targets.clear();
+    _positions.clear();
+    // keep the strings, so their buffers are reused
+    _callsigns.resize(objects.size());
+
+    for (unsigned i = 0; i < objects.size(); ++i) {
+        FGAIBase* ai = objects[i];
+        if (ai->getDie()) {
+            continue;
+        }
+
+        Target t;
+        t.id = ai->getID();
+        t.type = ai->getType();
+        t.typeName = ai->getTypeString();
+        t.position = SGGeod::fromDegFt(ai->_getLongitude(), ai->_getLatitude(),
+                                       ai->_getAltitude());
+        t.cart = SGVec3d::fromGeod(t.position);
+        t.headingDeg = ai->_getHeading();
+        t.speedKt = ai->_getSpeed();
+        t.verticalSpeedFps = ai->_getVS_fps();
+        t.invisible = false;
+        if (t.type == FGAIBase::otMultiplayer) {
+            t.invisible = static_cast<FGAIMultiplayer*>(ai)->getInvisible();
+        }
+
+        // velocity from the track, assuming no wind
+        double hdg = t.headingDeg * SGD_DEGREES_TO_RADIANS;
+        double speedMps = t.speedKt * SG_KT_TO_MPS;
+        SGVec3d ned(cos(hdg) * speedMps, sin(hdg) * speedMps,
+                    -t.verticalSpeedFps * SG_FEET_TO_METER);
+        t.velocity = SGQuatd::fromLonLat(t.position).backTransform(ned);
+
+        t.callsign = _targets.size();
+        _callsigns[t.callsign] = ai->_getCallsign();
+        t.props = ai->_getProps();
+
+        _targets.push_back(t);
+        _positions.push_back(t.cart);
+    }
+
+    _index.rebuild(_positions);
+}
@@ -0,0 +1,122 @@
+// AITrafficSnapshot.hxx - per-frame copy of the AI traffic state, for
+// instruments and displays
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifndef _FG_AITRAFFICSNAPSHOT_HXX
+#define _FG_AITRAFFICSNAPSHOT_HXX
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include <simgear/math/SGMath.hxx>
+#include <simgear/structure/SGReferenced.hxx>
+#include <simgear/structure/SGSharedPtr.hxx>
+
+class FGAIBase;
+class SGPropertyNode;
+
+/**
+ * Uniform grid over cartesian positions, for range queries. Positions are
+ * identified by their index in the vector the grid was built from.
+ */
+class FGAIGridIndex
+{
+public:
+    FGAIGridIndex();
+
+    void rebuild(const std::vector<SGVec3d>& positions);
+    void clear();
+
+    /**
+     * Indices of the positions which may be within range, sorted. Indices
+     * at or above the number of indexed positions (items added since the
+     * last rebuild) are always included, up to objectCount.
+     */
+    void query(const SGVec3d& cart, double rangeM, unsigned objectCount,
+               std::vector<unsigned>& result) const;
+private:
+    typedef std::pair<uint64_t, unsigned> Entry;
+    typedef std::vector<Entry> EntryVec;
+    EntryVec _entries;
+    unsigned _indexedCount;
+};
+
+/**
+ * The state of all live AI objects at the end of an AI update, as plain
+ * structs in one contiguous array, with a spatial index over them.
+ *
+ * FGAIManager publishes a new snapshot every frame, alternating between
+ * two buffers; a buffer which is still referenced by a reader is never
+ * overwritten. Once published a snapshot is immutable, so readers on any
+ * thread can use it without locking, for as long as they hold a reference.
+ * Getting a reference (FGAIManager::getTrafficSnapshot()) takes a short
+ * lock, since the published pointer is replaced by the main thread.
+ */
+class FGAITrafficSnapshot : public SGReferenced
+{
+public:
+    struct Target
+    {
+        int id;
+        int type;               ///< FGAIBase::object_type
+        const char* typeName;   ///< node name below /ai/models, e.g. "multiplayer"
+        SGVec3d cart;           ///< meters
+        SGVec3d velocity;       ///< cartesian, meters per second
+        SGGeod position;
+        double headingDeg;
+        double speedKt;         ///< true airspeed
+        double verticalSpeedFps;
+        bool invisible;         ///< multiplayer aircraft ignored by the user
+        unsigned callsign;      ///< handle for getCallsign()
+
+        /// the /ai/models child, for outputs such as tcas/threat-level.
+        /// Only valid on the main thread, until the next AI update.
+        SGPropertyNode* props;
+    };
+    typedef std::vector<Target> TargetVec;
+
+    FGAITrafficSnapshot();
+
+    const TargetVec& getTargets() const { return _targets; }
+
+    const std::string& getCallsign(const Target& target) const
+    { return _callsigns[target.callsign]; }
+
+    /// number of the AI update which published this snapshot
+    unsigned getFrame() const { return _frame; }
+
+    /**
+     * indices into getTargets() of the targets within rangeM meters of a
+     * cartesian position, in the order of the AI objects
+     */
+    void findInRange(const SGVec3d& cart, double rangeM,
+                     std::vector<unsigned>& result) const;
+
+    /// fill the snapshot from the live AI objects
+    void rebuild(const std::vector<SGSharedPtr<FGAIBase> >& objects,
+                 unsigned frame);
+private:
+    TargetVec _targets;
+    std::vector<std::string> _callsigns;
+    std::vector<SGVec3d> _positions;
+    FGAIGridIndex _index;
+    unsigned _frame;
+};
+
+typedef SGSharedPtr<FGAITrafficSnapshot> FGAITrafficSnapshotPtr;
+
+#endif // _FG_AITRAFFICSNAPSHOT_HXX
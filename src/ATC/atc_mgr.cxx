@@ -197,6 +197,7 @@ void FGATCManager::shutdown()
 {
     ai_ac.clear();
     activeStations.clear();
+    FGRadioTransmission::shutdownPropagation();
 }
 
 void FGATCManager::addController(FGATCController *controller) {
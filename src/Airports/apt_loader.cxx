@@ -47,6 +47,7 @@
 #include "runways.hxx"
 #include "pavement.hxx"
 #include <Navaids/NavDataCache.hxx>
+#include <Navaids/NavDataRebuild.hxx>
 #include <ATC/CommStation.hxx>
 
 #include <iostream>
@@ -89,20 +90,26 @@ public:
 
   void parseAPT(const SGPath &aptdb_file)
   {
-    sg_gzifstream in(aptdb_file);
+    GzLineSource in(aptdb_file);
 
-    if ( !in.is_open() ) {
+    if ( !in.isOpen() ) {
       SG_LOG( SG_GENERAL, SG_ALERT, "Cannot open file: " << aptdb_file );
       throw sg_io_exception("cannot open apt.dat file", aptdb_file);
     }
 
+    parseAPT(in, aptdb_file);
+  }
+
+  // the line source reports read errors itself, by throwing
+  void parseAPT(TextLineSource& in, const SGPath &aptdb_file)
+  {
     string line;
 
     unsigned int line_id = 0;
     unsigned int line_num = 0;
 
     // Read the apt.dat header (two lines)
-    while ( line_num < 2 && std::getline(in, line) ) {
+    while ( line_num < 2 && in.nextLine(line) ) {
       // 'line' may end with an \r character (tested on Linux, only \n was
       // stripped: std::getline() only discards the _native_ line terminator)
       line_num++;
@@ -124,9 +131,7 @@ public:
       }
     } // end of the apt.dat header
 
-    throwExceptionIfStreamError(in, "apt.dat", aptdb_file.utf8Str());
-
-    while ( std::getline(in, line) ) {
+    while ( in.nextLine(line) ) {
       // 'line' may end with an \r character, see above
       line_num++;
 
@@ -200,7 +205,6 @@ public:
       }
     }
 
-    throwExceptionIfStreamError(in, "apt.dat", aptdb_file.utf8Str());
     finishAirport();
   }
   
@@ -231,18 +235,6 @@ private:
     return ( pos == std::string::npos || line.find("##", pos) == pos );
   }
 
-  void throwExceptionIfStreamError(const sg_gzifstream& input_stream,
-                                   const std::string& short_name,
-                                   const std::string& full_path)
-  {
-    if ( input_stream.bad() ) {
-      // strerror() isn't thread-safe, unfortunately...
-      SG_LOG( SG_GENERAL, SG_ALERT, "error while reading " << full_path );
-      throw sg_io_exception("error while reading " + short_name,
-                            full_path.c_str());
-    }
-  }
-
   void finishAirport()
   {
     if (currentAirportID == 0) {
@@ -564,6 +556,13 @@ bool airportDBLoad( const SGPath &aptdb_file )
   ld.parseAPT(aptdb_file);
   return true;
 }
+
+bool airportDBLoad(TextLineSource& lines, const SGPath& aptdb_file)
+{
+  APTLoader ld;
+  ld.parseAPT(lines, aptdb_file);
+  return true;
+}
   
 bool metarDataLoad(const SGPath& metar_file)
 {
@@ -31,13 +31,19 @@ class SGPath;
 
 namespace flightgear
 {
-  
+
+class TextLineSource;
+
 // Load the airport data base from the specified aptdb file.  The
 // metar file is used to mark the airports as having metar available
 // or not.
 
 bool airportDBLoad(const SGPath& path);
 
+// As above, but reading the lines from a source such as a reader thread.
+// The path is only used for error reporting.
+bool airportDBLoad(TextLineSource& lines, const SGPath& path);
+
 bool metarDataLoad(const SGPath& path);
 
 } // of namespace flighgear
@@ -7,6 +7,7 @@
 #include <Navaids/NavDataCache.hxx>
 #include <Main/globals.hxx>
 #include <Scenery/scenery.hxx>
+#include <Scenery/ElevationService.hxx>
 
 using namespace flightgear;
 
@@ -38,11 +39,12 @@ double FGTaxiNode::getElevationFt()
   const SGGeod& pos = geod();
   if( pos.getElevationFt() == 0.0)
   {
+    static ElevationService::CallerId caller =
+      ElevationService::instance()->registerCaller("taxi-node", 1.0);
     SGGeod center2 = pos;
-    FGScenery* local_scenery = globals->get_scenery();
     center2.setElevationM(SG_MAX_ELEVATION_M);
     double elevationEnd = -100;
-    if (local_scenery->get_elevation_m( center2, elevationEnd, NULL ))
+    if (ElevationService::instance()->getElevation( caller, center2, elevationEnd ))
     {
       SGGeod newPos = pos;
       newPos.setElevationM(elevationEnd);
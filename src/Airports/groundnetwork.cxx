@@ -155,6 +155,75 @@ bool FGTaxiRoute::next(FGTaxiNodeRef& node, int *rte)
  * FGGroundNetwork()
  **************************************************************************/
 
+// upper bound for the number of cached routes per airport; the cache is
+// simply cleared once it is full
+static const size_t MAX_CACHED_ROUTES = 8192;
+
+/**
+ * Nodes are numbered 0..n-1 in m_nodes order, and the outgoing arcs of
+ * node i are arcs[firstArc[i]] .. arcs[firstArc[i+1] - 1], in the order
+ * of the segments. Arc costs include the edge penalty of the target node.
+ *
+ * The per-node search state is reused between searches: an entry is only
+ * valid if its stamp matches the current search.
+ */
+class FGGroundNetwork::RoutingGraph
+{
+public:
+  struct Arc
+  {
+    int target;
+    int segment;
+    double cost;
+  };
+
+  struct HeapEntry
+  {
+    double estimate;
+    int node;
+
+    bool operator<(const HeapEntry& other) const
+    { return estimate > other.estimate; } // min-heap ordering
+  };
+
+  RoutingGraph() :
+    currentSearch(0)
+  {}
+
+  int indexOf(const FGTaxiNode* node) const
+  {
+    NodeIndexMap::const_iterator it = nodeIndex.find(node);
+    return (it == nodeIndex.end()) ? -1 : it->second;
+  }
+
+  void beginSearch()
+  {
+    if (++currentSearch == 0) {
+      // wrapped around, make sure no stale entry matches
+      std::fill(reached.begin(), reached.end(), 0);
+      std::fill(closed.begin(), closed.end(), 0);
+      currentSearch = 1;
+    }
+    heap.clear();
+  }
+
+  bool isReached(int node) const
+  { return reached[node] == currentSearch; }
+
+  typedef std::map<const FGTaxiNode*, int> NodeIndexMap;
+  NodeIndexMap nodeIndex;
+  std::vector<SGVec3d> carts;
+  std::vector<int> firstArc;
+  std::vector<Arc> arcs;
+
+  unsigned currentSearch;
+  std::vector<unsigned> reached, closed;
+  std::vector<double> score;
+  std::vector<int> previousNode, previousSegment;
+  std::vector<HeapEntry> heap;
+};
+
+
 FGGroundNetwork::FGGroundNetwork(FGAirport* airport) :
     parent(airport)
 {
@@ -202,6 +271,8 @@ void FGGroundNetwork::init()
     }
   
     networkInitialized = true;
+    // segment indices changed
+    invalidateRoutes();
 }
 
 FGTaxiNodeRef FGGroundNetwork::findNearestNode(const SGGeod & aGeod) const
@@ -294,85 +365,193 @@ static int edgePenalty(FGTaxiNode* tn)
     (tn->getIsOnRunway() ? 1000 : 0);
 }
 
-class ShortestPathData
+FGGroundNetwork::RoutingGraph* FGGroundNetwork::routingGraph()
 {
-public:
-  ShortestPathData() :
-    score(HUGE_VAL)
-  {}
-  
-  double score;
-  FGTaxiNodeRef previousNode;
-};
+    if (m_routing.get()) {
+        return m_routing.get();
+    }
+
+    RoutingGraph* graph = new RoutingGraph;
+    m_routing.reset(graph);
+
+    size_t n = m_nodes.size();
+    graph->carts.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        graph->nodeIndex[m_nodes[i].ptr()] = i;
+        graph->carts.push_back(m_nodes[i]->cart());
+    }
+
+    // count the arcs of each node, then fill them in segment order
+    graph->firstArc.assign(n + 1, 0);
+    BOOST_FOREACH(FGTaxiSegment* seg, segments) {
+        ++graph->firstArc[graph->indexOf(seg->startNode) + 1];
+    }
+    for (size_t i = 0; i < n; ++i) {
+        graph->firstArc[i + 1] += graph->firstArc[i];
+    }
+
+    graph->arcs.resize(segments.size());
+    std::vector<int> fill(graph->firstArc.begin(), graph->firstArc.end() - 1);
+    BOOST_FOREACH(FGTaxiSegment* seg, segments) {
+        int from = graph->indexOf(seg->startNode);
+        RoutingGraph::Arc& arc = graph->arcs[fill[from]++];
+        arc.target = graph->indexOf(seg->endNode);
+        arc.segment = seg->getIndex();
+        arc.cost = dist(graph->carts[from], graph->carts[arc.target])
+            + edgePenalty(seg->getEnd());
+    }
+
+    graph->reached.assign(n, 0);
+    graph->closed.assign(n, 0);
+    graph->score.resize(n);
+    graph->previousNode.resize(n);
+    graph->previousSegment.resize(n);
+    return graph;
+}
+
+void FGGroundNetwork::invalidateRoutes()
+{
+    m_routing.reset();
+    m_routeCache.clear();
+}
 
 FGTaxiRoute FGGroundNetwork::findShortestRoute(FGTaxiNode* start, FGTaxiNode* end, bool fullSearch)
 {
     if (!start || !end) {
         throw sg_exception("Bad arguments to findShortestRoute");
     }
-//implements Dijkstra's algorithm to find shortest distance route from start to end
-//taken from http://en.wikipedia.org/wiki/Dijkstra's_algorithm
-    FGTaxiNodeVector unvisited(m_nodes);
-    std::map<FGTaxiNode*, ShortestPathData> searchData;
 
-    searchData[start].score = 0.0;
+    RoutingGraph* graph = routingGraph();
+    int startIndex = graph->indexOf(start);
+    int endIndex = graph->indexOf(end);
 
-    while (!unvisited.empty()) {
-        // find lowest scored unvisited
-        FGTaxiNodeRef best = unvisited.front();
-        BOOST_FOREACH(FGTaxiNodeRef i, unvisited) {
-            if (searchData[i].score < searchData[best].score) {
-                best = i;
-            }
+    std::pair<int, int> key(startIndex, endIndex);
+    RouteCache::const_iterator cached = m_routeCache.find(key);
+    if (cached == m_routeCache.end()) {
+        if (m_routeCache.size() >= MAX_CACHED_ROUTES) {
+            m_routeCache.clear();
         }
-      
-      // remove 'best' from the unvisited set
-        FGTaxiNodeVectorIterator newend =
-            remove(unvisited.begin(), unvisited.end(), best);
-        unvisited.erase(newend, unvisited.end());
 
-        if (best == end) { // found route or best not connected
+        FGTaxiRoute route;
+        if ((startIndex >= 0) && (endIndex >= 0)) {
+            route = findShortestRoute(graph, startIndex, endIndex);
+        }
+        cached = m_routeCache.insert(RouteCache::value_type(key, route)).first;
+    }
+
+    if (fullSearch && cached->second.empty()) {
+        SG_LOG(SG_GENERAL, SG_ALERT,
+               "Failed to find route from waypoint " << start << " to "
+               << end << " at " << parent->getId());
+    }
+
+    return cached->second;
+}
+
+FGTaxiRoute FGGroundNetwork::findShortestRoute(RoutingGraph* graph,
+                                               int start, int end)
+{
+// A* search, with the straight line distance to the end as the
+// heuristic. Arc costs are at least the straight line length of the arc,
+// so the heuristic is consistent and a node's score is final once it
+// leaves the heap.
+    const SGVec3d& endCart = graph->carts[end];
+    graph->beginSearch();
+
+    graph->reached[start] = graph->currentSearch;
+    graph->score[start] = 0.0;
+    graph->previousNode[start] = -1;
+    RoutingGraph::HeapEntry entry = { dist(graph->carts[start], endCart), start };
+    graph->heap.push_back(entry);
+
+    while (!graph->heap.empty()) {
+        std::pop_heap(graph->heap.begin(), graph->heap.end());
+        int best = graph->heap.back().node;
+        graph->heap.pop_back();
+
+        if (graph->closed[best] == graph->currentSearch) {
+            continue; // stale entry, the node was reached on a shorter path
+        }
+        graph->closed[best] = graph->currentSearch;
+
+        if (best == end) {
             break;
         }
-      
-        BOOST_FOREACH(FGTaxiNodeRef target, segmentsFrom(best)) {
-            double edgeLength = dist(best->cart(), target->cart());
-            double alt = searchData[best].score + edgeLength + edgePenalty(target);
-            if (alt < searchData[target].score) {    // Relax (u,v)
-                searchData[target].score = alt;
-                searchData[target].previousNode = best;
+
+        for (int a = graph->firstArc[best]; a < graph->firstArc[best + 1]; ++a) {
+            const RoutingGraph::Arc& arc = graph->arcs[a];
+            int target = arc.target;
+            if (graph->closed[target] == graph->currentSearch) {
+                continue;
+            }
+
+            double alt = graph->score[best] + arc.cost;
+            if (!graph->isReached(target) || (alt < graph->score[target])) {    // Relax (u,v)
+                graph->reached[target] = graph->currentSearch;
+                graph->score[target] = alt;
+                graph->previousNode[target] = best;
+                graph->previousSegment[target] = arc.segment;
+
+                entry.estimate = alt + dist(graph->carts[target], endCart);
+                entry.node = target;
+                graph->heap.push_back(entry);
+                std::push_heap(graph->heap.begin(), graph->heap.end());
             }
         } // of outgoing arcs/segments from current best node iteration
-    } // of unvisited nodes remaining
+    } // of open nodes remaining
 
-    if (searchData[end].score == HUGE_VAL) {
+    if (!graph->isReached(end)) {
         // no valid route found
-        if (fullSearch) {
-            SG_LOG(SG_GENERAL, SG_ALERT,
-                   "Failed to find route from waypoint " << start << " to "
-                   << end << " at " << parent->getId());
-        }
-      
         return FGTaxiRoute();
     }
-  
+
     // assemble route from backtrace information
     FGTaxiNodeVector nodes;
     intVec routes;
-    FGTaxiNode *bt = end;
-    
-    while (searchData[bt].previousNode != 0) {
-        nodes.push_back(bt);
-        FGTaxiSegment *segment = findSegment(searchData[bt].previousNode, bt);
-        int idx = segment->getIndex();
-        routes.push_back(idx);
-        bt = searchData[bt].previousNode;
-        
-    }
-    nodes.push_back(start);
+    for (int bt = end; bt != start; bt = graph->previousNode[bt]) {
+        nodes.push_back(m_nodes[bt]);
+        routes.push_back(graph->previousSegment[bt]);
+    }
+    nodes.push_back(m_nodes[start]);
     reverse(nodes.begin(), nodes.end());
     reverse(routes.begin(), routes.end());
-    return FGTaxiRoute(nodes, routes, searchData[end].score, 0);
+    return FGTaxiRoute(nodes, routes, graph->score[end], 0);
+}
+
+void FGGroundNetwork::benchmarkRoutes()
+{
+    FGTaxiNodeVector runwayNodes;
+    for (unsigned int r = 0; r < parent->numRunways(); ++r) {
+        FGRunwayRef rwy = parent->getRunwayByIndex(r);
+        FGTaxiNodeRef node = (version > 0) ?
+            findNearestNodeOnRunway(rwy->threshold()) :
+            findNearestNode(rwy->threshold());
+        if (node && (std::find(runwayNodes.begin(), runwayNodes.end(), node) == runwayNodes.end())) {
+            runwayNodes.push_back(node);
+        }
+    }
+
+    invalidateRoutes();
+    for (int pass = 0; pass < 2; ++pass) {
+        unsigned int count = 0, failed = 0;
+        SGTimeStamp st;
+        st.stamp();
+        BOOST_FOREACH(FGParkingRef park, m_parkings) {
+            BOOST_FOREACH(FGTaxiNodeRef rwyNode, runwayNodes) {
+                FGTaxiRoute route = findShortestRoute(park, rwyNode, false);
+                ++count;
+                if (route.empty()) {
+                    ++failed;
+                }
+            }
+        }
+
+        SG_LOG(SG_GENERAL, SG_INFO, "ground network benchmark for "
+               << parent->ident() << ": " << count << " parking to runway routes ("
+               << m_nodes.size() << " nodes, " << failed << " unreachable) in "
+               << st.elapsedMSec() << " msec, "
+               << ((pass == 0) ? "cold" : "warm") << " route cache");
+    }
 }
 
 void FGGroundNetwork::unblockAllSegments(time_t now)
@@ -424,6 +603,7 @@ void FGGroundNetwork::addSegment(const FGTaxiNodeRef &from, const FGTaxiNodeRef
 {
     FGTaxiSegment* seg = new FGTaxiSegment(from, to);
     segments.push_back(seg);
+    invalidateRoutes();
 
     FGTaxiNodeVector::iterator it = std::find(m_nodes.begin(), m_nodes.end(), from);
     if (it == m_nodes.end()) {
@@ -439,7 +619,7 @@ void FGGroundNetwork::addSegment(const FGTaxiNodeRef &from, const FGTaxiNodeRef
 void FGGroundNetwork::addParking(const FGParkingRef &park)
 {
     m_parkings.push_back(park);
-
+    invalidateRoutes();
 
     FGTaxiNodeVector::iterator it = std::find(m_nodes.begin(), m_nodes.end(), park);
     if (it == m_nodes.end()) {
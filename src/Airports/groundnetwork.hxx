@@ -27,6 +27,8 @@
 #include <simgear/compiler.h>
 
 #include <string>
+#include <map>
+#include <memory>
 
 #include "gnnode.hxx"
 #include "parking.hxx"
@@ -154,7 +156,7 @@ public:
     bool operator< (const FGTaxiRoute &other) const {
         return distance < other.distance;
     };
-    bool empty () {
+    bool empty () const {
         return nodes.empty();
     };
     bool next(FGTaxiNodeRef& nde, int *rte);
@@ -163,7 +165,7 @@ public:
         currNode = nodes.begin();
         currRoute = routes.begin();
     };
-    int size() {
+    int size() const {
         return nodes.size();
     };
     int nodesLeft() {
@@ -206,6 +208,17 @@ private:
 
     FGTaxiNodeVector segmentsFrom(const FGTaxiNodeRef& from) const;
 
+    // the network in dense, index based form for route finding, and the
+    // routes found so far, keyed by (start, end) node index. Both are
+    // built on demand and dropped by invalidateRoutes()
+    class RoutingGraph;
+    std::auto_ptr<RoutingGraph> m_routing;
+    RoutingGraph* routingGraph();
+    FGTaxiRoute findShortestRoute(RoutingGraph* graph, int start, int end);
+
+    typedef std::map<std::pair<int, int>, FGTaxiRoute> RouteCache;
+    RouteCache m_routeCache;
+
     void addAwosFreq     (int val) {
         freqAwos.push_back(val);
     };
@@ -267,6 +280,20 @@ public:
   
     FGTaxiRoute findShortestRoute(FGTaxiNode* start, FGTaxiNode* end, bool fullSearch=true);
 
+    /**
+     * Drop the cached routes. Must be called whenever segments are added
+     * or anything changes the edge penalty of a node (its type, or
+     * whether it is on a runway).
+     */
+    void invalidateRoutes();
+
+    /**
+     * Route every parking to the taxi node nearest to each runway
+     * threshold, first with an empty and then with a warm route cache,
+     * and log the timings.
+     */
+    void benchmarkRoutes();
+
 
     void blockSegmentsEndingAt(FGTaxiSegment* seg, int blockId,
                                time_t blockTime, time_t now);
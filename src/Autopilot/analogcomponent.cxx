@@ -27,11 +27,17 @@ using namespace FGXMLAutopilot;
 
 AnalogComponent::AnalogComponent() :
   Component(),
-  _feedback_if_disabled(false),
-  _passive_mode( fgGetNode("/autopilot/locks/passive-mode", true) )
+  _feedback_if_disabled(false)
 {
 }
 
+bool AnalogComponent::configure( SGPropertyNode& prop_root,
+                                 SGPropertyNode& cfg )
+{
+  _passive_mode = prop_root.getRootNode()->getNode("/autopilot/locks/passive-mode", true);
+  return Component::configure( prop_root, cfg );
+}
+
 double AnalogComponent::clamp( double value ) const
 {
     //If this is a periodical value, normalize it into our domain 
@@ -49,6 +55,30 @@ double AnalogComponent::clamp( double value ) const
     return value;
 }
 
+bool AnalogComponent::collectDependencies( PropertySet& inputs,
+                                           PropertySet& outputs ) const
+{
+    bool complete = collectEnableDependencies( inputs );
+    if( !_valueInput.collectDependencies( inputs ) ) complete = false;
+    if( !_referenceInput.collectDependencies( inputs ) ) complete = false;
+    if( !_minInput.collectDependencies( inputs ) ) complete = false;
+    if( !_maxInput.collectDependencies( inputs ) ) complete = false;
+    if( _periodical && !_periodical->collectDependencies( inputs ) )
+      complete = false;
+    if( _honor_passive )
+      inputs.insert( _passive_mode );
+
+    for( simgear::PropertyList::const_iterator it = _output_list.begin();
+         it != _output_list.end(); ++it )
+      outputs.insert( *it );
+
+    // when disabled, the output is fed back to the value inputs
+    if( _feedback_if_disabled )
+      _valueInput.collectDependencies( outputs );
+
+    return complete;
+}
+
 bool AnalogComponent::configure( SGPropertyNode& cfg_node,
                                  const std::string& cfg_name,
                                  SGPropertyNode& prop_root )
@@ -82,6 +82,15 @@ protected:
      */
     AnalogComponent();
 
+    /**
+     * @brief Binds the passive mode lock in the tree of prop_root, then
+     *        configures the component as Component::configure does.
+     * @param prop_root Property root for all relative paths
+     * @param cfg       Property node containing the configuration
+     */
+    virtual bool configure( SGPropertyNode& prop_root,
+                            SGPropertyNode& cfg );
+
     /**
      * @brief This method configures this analog component from a property node.
      *        Gets called multiple times from the base class configure method
@@ -139,6 +148,9 @@ protected:
 
 public:
     const PeriodicalValue * getPeriodicalValue() const { return _periodical; }
+
+    virtual bool collectDependencies( PropertySet& inputs,
+                                      PropertySet& outputs ) const;
 };
 
 inline void AnalogComponent::disabled( double dt )
@@ -27,7 +27,15 @@
 
 #include "autopilot.hxx"
 
+#include <cmath>
+#include <map>
+#include <set>
+
 #include <simgear/structure/StateMachine.hxx>
+#include <simgear/structure/exception.hxx>
+#include <simgear/misc/sg_path.hxx>
+#include <simgear/props/props_io.hxx>
+#include <simgear/timing/timestamp.hxx>
 #include <simgear/sg_inlines.h>
 
 #include "component.hxx"
@@ -117,10 +125,16 @@ void readInterfaceProperties( SGPropertyNode_ptr prop_root,
 
 static ComponentForge componentForge;
 
-Autopilot::Autopilot( SGPropertyNode_ptr rootNode, SGPropertyNode_ptr configNode ) :
+// as SG_MAX_SUBSYSTEM_EXCEPTIONS, for the compiled update
+static const unsigned int MAX_COMPONENT_EXCEPTIONS = 4;
+
+Autopilot::Autopilot( SGPropertyNode_ptr rootNode, SGPropertyNode_ptr configNode,
+                      SGPropertyNode_ptr propRoot ) :
   _name("unnamed autopilot"),
   _serviceable(true),
-  _rootNode(rootNode)
+  _rootNode(rootNode),
+  _compiled(false),
+  _skipped(0)
 {
   if (componentForge.empty())
   {
@@ -136,6 +150,14 @@ Autopilot::Autopilot( SGPropertyNode_ptr rootNode, SGPropertyNode_ptr configNode
   if( !configNode )
     configNode = rootNode;
 
+  if( !propRoot )
+    propRoot = fgGetNode("/", true);
+
+  // run as a compiled program, unless disabled in the config file or the
+  // local system node
+  _compile = rootNode->getBoolValue("compile",
+                                    configNode->getBoolValue("compile", true));
+
   // property-root can be set in config file and overridden in the local system
   // node. This allows using the same autopilot multiple times but with
   // different paths (with all relative property paths being relative to the
@@ -144,8 +166,9 @@ Autopilot::Autopilot( SGPropertyNode_ptr rootNode, SGPropertyNode_ptr configNode
   if( !prop_root_node )
     prop_root_node = configNode->getChild("property-root");
 
-  SGPropertyNode_ptr prop_root =
-    fgGetNode(prop_root_node ? prop_root_node->getStringValue() : "/", true);
+  SGPropertyNode_ptr prop_root = propRoot;
+  if( prop_root_node )
+    prop_root = propRoot->getNode(prop_root_node->getStringValue(), true);
 
   // Just like the JSBSim interface properties for systems, create properties
   // given in the autopilot file and set to given (default) values.
@@ -162,7 +185,8 @@ Autopilot::Autopilot( SGPropertyNode_ptr rootNode, SGPropertyNode_ptr configNode
     SGPropertyNode_ptr node = configNode->getChild(i);
     string childName = node->getName();
     if(    childName == "property"
-        || childName == "property-root" )
+        || childName == "property-root"
+        || childName == "compile" )
       continue;
     if( componentForge.count(childName) == 0 )
     {
@@ -214,11 +238,247 @@ void Autopilot::add_component( Component * component, double updateInterval )
     SG_LOG( SG_AUTOPILOT, SG_WARN, "Duplicate autopilot component " << component->get_name() << ", renamed to " << name );
 
   set_subsystem( name.c_str(), component, updateInterval );
+
+  Step step;
+  step.component = component;
+  step.name = name;
+  step.updateInterval = updateInterval;
+  step.elapsed = 0.0;
+  step.skippable = false;
+  step.recorded = false;
+  step.exceptionCount = 0;
+  _program.push_back( step );
+  _compiled = false;
+}
+
+void Autopilot::compile()
+{
+  size_t n = _program.size();
+  std::vector<Component::PropertySet> inputs(n), outputs(n);
+  std::vector<bool> known(n);
+
+  typedef map<SGPropertyNode*, std::vector<size_t> > WriterMap;
+  WriterMap writers;
+  for( size_t i = 0; i < n; ++i ) {
+    known[i] = _program[i].component->collectDependencies( inputs[i], outputs[i] );
+    Component::PropertySet::const_iterator it;
+    for( it = outputs[i].begin(); it != outputs[i].end(); ++it )
+      writers[*it].push_back( i );
+  }
+
+  // the components which have to run after each component
+  std::vector<std::set<size_t> > successors(n);
+  for( size_t i = 0; i < n; ++i ) {
+    if( known[i] ) {
+      Component::PropertySet::const_iterator it;
+      for( it = inputs[i].begin(); it != inputs[i].end(); ++it ) {
+        WriterMap::const_iterator w = writers.find( *it );
+        if( w == writers.end() )
+          continue;
+        for( size_t k = 0; k < w->second.size(); ++k ) {
+          if( w->second[k] != i )
+            successors[w->second[k]].insert( i );
+        }
+      }
+    } else {
+      // unknown dependencies: keep the XML order relative to all others
+      for( size_t j = 0; j < n; ++j ) {
+        if( j < i ) successors[j].insert( i );
+        if( j > i ) successors[i].insert( j );
+      }
+    }
+  }
+
+  std::vector<size_t> pending(n, 0);
+  for( size_t i = 0; i < n; ++i ) {
+    std::set<size_t>::const_iterator it;
+    for( it = successors[i].begin(); it != successors[i].end(); ++it )
+      ++pending[*it];
+  }
+
+  // Topological order. Whenever there's a choice, and to break cycles
+  // (feedback loops), the component coming first in the XML file runs first.
+  std::set<size_t> ready;
+  for( size_t i = 0; i < n; ++i ) {
+    if( pending[i] == 0 )
+      ready.insert( i );
+  }
+
+  std::vector<Step> program;
+  program.reserve( n );
+  std::vector<bool> done(n, false);
+  size_t first = 0;
+  unsigned int moved = 0, skippable = 0;
+  while( program.size() < n ) {
+    size_t i;
+    if( !ready.empty() ) {
+      i = *ready.begin();
+      ready.erase( ready.begin() );
+    } else {
+      while( done[first] )
+        ++first;
+      i = first;
+    }
+
+    done[i] = true;
+    if( i != program.size() )
+      ++moved;
+
+    program.push_back( _program[i] );
+    Step& step = program.back();
+    step.skippable = known[i] && step.component->isStateless();
+    step.recorded = false;
+    step.watched.assign( inputs[i].begin(), inputs[i].end() );
+    step.watched.insert( step.watched.end(), outputs[i].begin(), outputs[i].end() );
+    step.values.resize( step.watched.size() );
+    if( step.skippable )
+      ++skippable;
+
+    std::set<size_t>::const_iterator it;
+    for( it = successors[i].begin(); it != successors[i].end(); ++it ) {
+      if( !done[*it] && --pending[*it] == 0 )
+        ready.insert( *it );
+    }
+  }
+
+  _program.swap( program );
+  _compiled = true;
+
+  SG_LOG( SG_AUTOPILOT, SG_DEBUG, "compiled autopilot " << _name << ": "
+          << n << " components, " << moved << " moved by dataflow, "
+          << skippable << " skipped while their inputs are unchanged" );
+}
+
+bool Autopilot::unchanged( const Step& step ) const
+{
+  if( !step.recorded )
+    return false;
+
+  for( size_t k = 0; k < step.watched.size(); ++k ) {
+    const SGPropertyNode* node = step.watched[k];
+    // strings are compared by value, e.g. in <enable>
+    if(    node->getType() == simgear::props::STRING
+        || node->getDoubleValue() != step.values[k] )
+      return false;
+  }
+  return true;
+}
+
+void Autopilot::record( Step& step )
+{
+  for( size_t k = 0; k < step.watched.size(); ++k )
+    step.values[k] = step.watched[k]->getDoubleValue();
+  step.recorded = true;
 }
 
 void Autopilot::update( double dt ) 
 {
   if( !_serviceable || dt <= SGLimitsd::min() )
     return;
-  SGSubsystemGroup::update( dt );
+
+  if( !_compile ) {
+    SGSubsystemGroup::update( dt );
+    return;
+  }
+
+  if( !_compiled )
+    compile();
+
+  // as SGSubsystemGroup::Member::update
+  for( std::vector<Step>::iterator it = _program.begin(); it != _program.end(); ++it ) {
+    it->elapsed += dt;
+    if( it->elapsed < it->updateInterval )
+      continue;
+
+    SGSubsystem* subsystem = it->component;
+    if( subsystem->is_suspended() )
+      continue;
+
+    if( it->skippable && unchanged( *it ) ) {
+      ++_skipped;
+      it->elapsed = 0.0;
+      continue;
+    }
+
+    try {
+      subsystem->update( it->elapsed );
+      if( it->skippable )
+        record( *it );
+      it->elapsed = 0.0;
+    } catch( sg_exception& e ) {
+      SG_LOG( SG_AUTOPILOT, SG_ALERT, "caught exception processing subsystem:"
+              << it->name << "\nmessage:" << e.getMessage() );
+
+      if( ++it->exceptionCount > MAX_COMPONENT_EXCEPTIONS ) {
+        SG_LOG( SG_AUTOPILOT, SG_ALERT, "(exceeded maximum number of subsystem "
+                "exceptions, suspending)" );
+        subsystem->suspend();
+      }
+    }
+  }
+}
+
+void Autopilot::benchmark( const SGPath& path, unsigned int frames )
+{
+  const double DT = 1.0 / 60;
+
+  double usec[2][2];
+  unsigned int skipped[2] = { 0, 0 };
+  size_t components = 0, driven = 0;
+  for( int changing = 0; changing < 2; ++changing ) {
+    for( int compile = 0; compile < 2; ++compile ) {
+      SGPropertyNode_ptr config = new SGPropertyNode;
+      try {
+        readProperties( path, config );
+      } catch( const sg_exception& e ) {
+        SG_LOG( SG_AUTOPILOT, SG_ALERT, "autopilot benchmark: failed to load "
+                << path << ": " << e.getMessage() );
+        return;
+      }
+
+      SGPropertyNode_ptr root = new SGPropertyNode;
+      Autopilot ap( root->getNode("benchmark", true), config, root );
+      ap._compile = compile;
+      ap.init();
+      ap.compile();
+
+      // the analog inputs no component writes, changed every frame
+      Component::PropertySet inputs, outputs;
+      for( size_t i = 0; i < ap._program.size(); ++i )
+        ap._program[i].component->collectDependencies( inputs, outputs );
+
+      std::vector<SGPropertyNode*> external;
+      Component::PropertySet::const_iterator it;
+      for( it = inputs.begin(); it != inputs.end(); ++it ) {
+        if(    outputs.count(*it) == 0
+            && (   (*it)->getType() == simgear::props::DOUBLE
+                || (*it)->getType() == simgear::props::FLOAT
+                || (*it)->getType() == simgear::props::NONE) )
+          external.push_back( *it );
+      }
+
+      SGTimeStamp st;
+      st.stamp();
+      for( unsigned int f = 0; f < frames; ++f ) {
+        if( changing ) {
+          for( size_t k = 0; k < external.size(); ++k )
+            external[k]->setDoubleValue( sin(f * 0.05 + k) );
+        }
+        ap.update( DT );
+      }
+      usec[changing][compile] = st.elapsedMSec() * 1000.0 / SG_MAX2(frames, 1U);
+
+      components = ap._program.size();
+      driven = external.size();
+      if( compile )
+        skipped[changing] = ap._skipped;
+    }
+  }
+
+  SG_LOG( SG_AUTOPILOT, SG_INFO, "autopilot benchmark: " << path << ", "
+          << components << " components, " << frames << " frames; "
+          << "constant inputs: " << usec[0][0] << "usec per frame as subsystems, "
+          << usec[0][1] << "usec compiled (" << skipped[0] << " updates skipped); "
+          << driven << " changing inputs: " << usec[1][0] << "usec as subsystems, "
+          << usec[1][1] << "usec compiled (" << skipped[1] << " updates skipped)" );
 }
@@ -23,9 +23,13 @@
 #ifndef __AUTOPILOT_HXX
 #define __AUTOPILOT_HXX 1
 
+#include <vector>
+
 #include <simgear/props/props.hxx>
 #include <simgear/structure/subsystem_mgr.hxx>
 
+class SGPath;
+
 namespace FGXMLAutopilot {
 
 class Component;
@@ -33,11 +37,23 @@ class Component;
 /**
  * @brief A SGSubsystemGroup implementation to serve as a collection
  * of Components
+ *
+ * Unless &lt;compile&gt; is false, the components are not updated through
+ * the subsystem group but run as a flat program: ordered so that components
+ * run after those writing their inputs (as far as these are known, the XML
+ * order is kept otherwise), and with stateless components skipped while
+ * their inputs are unchanged.
  */
 class Autopilot : public SGSubsystemGroup
 {
 public:
-    Autopilot( SGPropertyNode_ptr rootNode, SGPropertyNode_ptr configNode = NULL );
+    /**
+     * @param rootNode   the local system node
+     * @param configNode the configuration, defaults to rootNode
+     * @param propRoot   the property tree to use, defaults to the global one
+     */
+    Autopilot( SGPropertyNode_ptr rootNode, SGPropertyNode_ptr configNode = NULL,
+               SGPropertyNode_ptr propRoot = NULL );
     ~Autopilot();
 
     void bind();
@@ -52,12 +68,42 @@ public:
 
     void add_component( Component * component, double updateInterval );
 
+    /**
+     * @brief time a configuration file in a scratch property tree, run as
+     *        subsystems and as compiled program, with constant and with
+     *        changing inputs
+     */
+    static void benchmark( const SGPath& path, unsigned int frames );
+
 protected:
 
 private:
+    /// a component of the compiled program
+    struct Step
+    {
+      Component* component;
+      std::string name;   ///< as registered with the group
+      double updateInterval;
+      double elapsed;
+      bool skippable;   ///< stateless, and all inputs are known
+      bool recorded;    ///< values holds the state after the last update
+      unsigned int exceptionCount;
+      std::vector<SGPropertyNode*> watched; ///< inputs and outputs
+      std::vector<double> values;
+    };
+
+    void compile();
+    bool unchanged( const Step& step ) const;
+    void record( Step& step );
+
     std::string _name;
     bool _serviceable;
     SGPropertyNode_ptr _rootNode;
+
+    bool _compile;
+    bool _compiled;
+    std::vector<Step> _program;
+    unsigned int _skipped;
 };
 
 }
@@ -87,17 +87,19 @@ bool Component::configure( SGPropertyNode& cfg_node,
   if ( cfg_name == "enable" )
   {
     SGPropertyNode_ptr prop;
+    // enable paths are relative to the root of the tree, not to prop_root
+    SGPropertyNode* root = prop_root.getRootNode();
 
     if( (prop = cfg_node.getChild("condition")) != NULL ) {
-      _condition = sgReadCondition(fgGetNode("/"), prop);
+      _condition = sgReadCondition(root, prop);
       return true;
     } 
     if ( (prop = cfg_node.getChild( "property" )) != NULL ) {
-      _enable_prop = fgGetNode( prop->getStringValue(), true );
+      _enable_prop = root->getNode( prop->getStringValue(), true );
     }
        
     if ( (prop = cfg_node.getChild( "prop" )) != NULL ) {
-      _enable_prop = fgGetNode( prop->getStringValue(), true );
+      _enable_prop = root->getNode( prop->getStringValue(), true );
     }
 
     if ( (prop = cfg_node.getChild( "value" )) != NULL ) {
@@ -131,6 +133,16 @@ bool Component::isPropertyEnabled()
     return true;
 }
 
+bool Component::collectEnableDependencies( std::set<SGPropertyNode*>& inputs ) const
+{
+    if( _condition )
+        return false;
+
+    if( _enable_prop )
+        inputs.insert( _enable_prop );
+    return true;
+}
+
 void Component::update( double dt )
 {
   bool firstTime = false;
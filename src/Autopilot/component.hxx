@@ -27,6 +27,8 @@
 #  include <config.h>
 #endif
 
+#include <set>
+
 #include <simgear/structure/subsystem_mgr.hxx>
 #include <simgear/props/propsfwd.hxx>
 
@@ -72,6 +74,13 @@ protected:
     */
     virtual void disabled( double dt ) {}
 
+    /**
+     * @brief add the property read by the &lt;enable&gt; section to inputs
+     * @return false if the component is enabled by a condition, which can't
+     *         tell which properties it reads
+     */
+    bool collectEnableDependencies( std::set<SGPropertyNode*>& inputs ) const;
+
     /** 
      * @brief debug flag, true if this component should generate some useful output
      * on every iteration
@@ -86,7 +95,8 @@ protected:
     bool _honor_passive;
     
 public:
-    
+    typedef std::set<SGPropertyNode*> PropertySet;
+
     /**
      * @brief A constructor for an empty Component.
      */
@@ -138,6 +148,25 @@ public:
      * Returns true, if neither &lt;condition&gt; nor &lt;prop&gt; exists
      */
     bool isPropertyEnabled();
+
+    /**
+     * @brief collect the properties this component reads and writes, so the
+     *        autopilot can order its components by dataflow.
+     * @param inputs  properties read by this component
+     * @param outputs properties written by this component
+     * @return true if the sets are complete. The default implementation
+     *         knows nothing and returns false.
+     */
+    virtual bool collectDependencies( PropertySet& inputs,
+                                      PropertySet& outputs ) const
+    { return false; }
+
+    /**
+     * @brief true if the outputs of this component depend on nothing but the
+     *        current values of its inputs (no internal state, no dt). Such a
+     *        component need not be updated while its inputs are unchanged.
+     */
+    virtual bool isStateless() const { return false; }
 };
 
 
@@ -49,6 +49,13 @@ class DigitalFilterImplementation:
 
     void setDigitalFilter( DigitalFilter * digitalFilter ) { _digitalFilter = digitalFilter; }
 
+    /// add the properties read by the filter parameters to inputs
+    virtual bool collectDependencies( std::set<SGPropertyNode*>& inputs ) const
+    { return false; }
+
+    /// true if compute() depends on nothing but its input and parameters
+    virtual bool isStateless() const { return false; }
+
   protected:
     DigitalFilter * _digitalFilter;
 };
@@ -64,6 +71,9 @@ protected:
 public:
   GainFilterImplementation() : _gainInput(1.0) {}
   double compute(  double dt, double input );
+  bool collectDependencies( std::set<SGPropertyNode*>& inputs ) const
+  { return _gainInput.collectDependencies(inputs); }
+  bool isStateless() const { return true; }
 };
 
 class ReciprocalFilterImplementation : public GainFilterImplementation {
@@ -81,6 +91,12 @@ public:
   DerivativeFilterImplementation();
   double compute(  double dt, double input );
   virtual void initialize( double initvalue );
+  bool collectDependencies( std::set<SGPropertyNode*>& inputs ) const
+  {
+    bool complete = GainFilterImplementation::collectDependencies(inputs);
+    return _TfInput.collectDependencies(inputs) && complete;
+  }
+  bool isStateless() const { return false; }
 };
 
 class ExponentialFilterImplementation : public GainFilterImplementation {
@@ -95,6 +111,12 @@ public:
   ExponentialFilterImplementation();
   double compute(  double dt, double input );
   virtual void initialize( double initvalue );
+  bool collectDependencies( std::set<SGPropertyNode*>& inputs ) const
+  {
+    bool complete = GainFilterImplementation::collectDependencies(inputs);
+    return _TfInput.collectDependencies(inputs) && complete;
+  }
+  bool isStateless() const { return false; }
 };
 
 class MovingAverageFilterImplementation : public DigitalFilterImplementation {
@@ -109,6 +131,11 @@ public:
   MovingAverageFilterImplementation();
   double compute(  double dt, double input );
   virtual void initialize( double initvalue );
+  bool collectDependencies( std::set<SGPropertyNode*>& inputs ) const
+  {
+    bool complete = true;
+    return _samplesInput.collectDependencies(inputs) && complete;
+  }
 };
 
 class NoiseSpikeFilterImplementation : public DigitalFilterImplementation {
@@ -122,6 +149,11 @@ public:
   NoiseSpikeFilterImplementation();
   double compute(  double dt, double input );
   virtual void initialize( double initvalue );
+  bool collectDependencies( std::set<SGPropertyNode*>& inputs ) const
+  {
+    bool complete = true;
+    return _rateOfChangeInput.collectDependencies(inputs) && complete;
+  }
 };
 
 class RateLimitFilterImplementation : public DigitalFilterImplementation {
@@ -136,6 +168,12 @@ public:
   RateLimitFilterImplementation();
   double compute(  double dt, double input );
   virtual void initialize( double initvalue );
+  bool collectDependencies( std::set<SGPropertyNode*>& inputs ) const
+  {
+    bool complete = true;
+    if( !_rateOfChangeMax.collectDependencies(inputs) ) complete = false;
+    return _rateOfChangeMin.collectDependencies(inputs) && complete;
+  }
 };
 
 class IntegratorFilterImplementation : public GainFilterImplementation {
@@ -152,6 +190,14 @@ public:
   IntegratorFilterImplementation();
   double compute(  double dt, double input );
   virtual void initialize( double initvalue );
+  bool collectDependencies( std::set<SGPropertyNode*>& inputs ) const
+  {
+    bool complete = GainFilterImplementation::collectDependencies(inputs);
+    if( !_TfInput.collectDependencies(inputs) ) complete = false;
+    if( !_minInput.collectDependencies(inputs) ) complete = false;
+    return _maxInput.collectDependencies(inputs) && complete;
+  }
+  bool isStateless() const { return false; }
 };
 
 // integrates x" + ax' + bx + c = 0
@@ -170,6 +216,14 @@ public:
   DampedOscillationFilterImplementation();
   double compute(  double dt, double input );
   virtual void initialize( double initvalue );
+  bool collectDependencies( std::set<SGPropertyNode*>& inputs ) const
+  {
+    bool complete = GainFilterImplementation::collectDependencies(inputs);
+    if( !_aInput.collectDependencies(inputs) ) complete = false;
+    if( !_bInput.collectDependencies(inputs) ) complete = false;
+    return _cInput.collectDependencies(inputs) && complete;
+  }
+  bool isStateless() const { return false; }
 };
 
 class HighPassFilterImplementation : public GainFilterImplementation {
@@ -184,6 +238,12 @@ public:
   HighPassFilterImplementation();
   double compute(  double dt, double input );
   virtual void initialize( double initvalue );
+  bool collectDependencies( std::set<SGPropertyNode*>& inputs ) const
+  {
+    bool complete = GainFilterImplementation::collectDependencies(inputs);
+    return _TfInput.collectDependencies(inputs) && complete;
+  }
+  bool isStateless() const { return false; }
 };
 class LeadLagFilterImplementation : public GainFilterImplementation {
 protected:
@@ -198,6 +258,13 @@ public:
   LeadLagFilterImplementation();
   double compute(  double dt, double input );
   virtual void initialize( double initvalue );
+  bool collectDependencies( std::set<SGPropertyNode*>& inputs ) const
+  {
+    bool complete = GainFilterImplementation::collectDependencies(inputs);
+    if( !_TfaInput.collectDependencies(inputs) ) complete = false;
+    return _TfbInput.collectDependencies(inputs) && complete;
+  }
+  bool isStateless() const { return false; }
 };
 /* --------------------------------------------------------------------------------- */
 /* --------------------------------------------------------------------------------- */
@@ -778,6 +845,22 @@ bool DigitalFilter::configure( SGPropertyNode& cfg_node,
   return AnalogComponent::configure(cfg_node, cfg_name, prop_root);
 }
 
+//------------------------------------------------------------------------------
+bool DigitalFilter::collectDependencies( PropertySet& inputs,
+                                         PropertySet& outputs ) const
+{
+  bool complete = AnalogComponent::collectDependencies(inputs, outputs);
+  if( !_implementation )
+    return complete;
+  return _implementation->collectDependencies(inputs) && complete;
+}
+
+//------------------------------------------------------------------------------
+bool DigitalFilter::isStateless() const
+{
+  return _implementation && _implementation->isStateless();
+}
+
 //------------------------------------------------------------------------------
 void DigitalFilter::update( bool firstTime, double dt)
 {
@@ -65,6 +65,9 @@ public:
     virtual bool configure( SGPropertyNode& prop_root,
                             SGPropertyNode& cfg );
 
+    virtual bool collectDependencies( PropertySet& inputs,
+                                      PropertySet& outputs ) const;
+    virtual bool isStateless() const;
 };
 
 } // namespace FGXMLAutopilot
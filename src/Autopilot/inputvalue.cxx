@@ -19,6 +19,7 @@
 //
 
 #include <cstdlib>
+#include <limits>
 
 #include "inputvalue.hxx"
 
@@ -65,6 +66,29 @@ double PeriodicalValue::normalizeSymmetric( double value ) const
   return value > width_2 ? width_2 - value : value;
 }
 
+//------------------------------------------------------------------------------
+bool PeriodicalValue::collectDependencies( std::set<SGPropertyNode*>& inputs ) const
+{
+  bool complete = true;
+  if( minPeriod && !minPeriod->collectDependencies(inputs) )
+    complete = false;
+  if( maxPeriod && !maxPeriod->collectDependencies(inputs) )
+    complete = false;
+  return complete;
+}
+
+//------------------------------------------------------------------------------
+// Replace a constant input by its value, so get_value() doesn't have to
+// evaluate it again on every call.
+static void foldConstant( InputValue_ptr& input, double& value )
+{
+  if( input && input->is_constant() )
+  {
+    value = input->get_value();
+    input = NULL;
+  }
+}
+
 //------------------------------------------------------------------------------
 InputValue::InputValue( SGPropertyNode& prop_root,
                         SGPropertyNode& cfg,
@@ -72,7 +96,11 @@ InputValue::InputValue( SGPropertyNode& prop_root,
                         double offset,
                         double scale ):
   _value(0.0),
-  _abs(false)
+  _abs(false),
+  _offsetValue(0.0),
+  _scaleValue(1.0),
+  _minValue(-std::numeric_limits<double>::infinity()),
+  _maxValue(std::numeric_limits<double>::infinity())
 {
   parse(prop_root, cfg, value, offset, scale);
 }
@@ -91,6 +119,10 @@ void InputValue::parse( SGPropertyNode& prop_root,
   _min = NULL;
   _max = NULL;
   _periodical = NULL;
+  _offsetValue = 0.0;
+  _scaleValue = 1.0;
+  _minValue = -std::numeric_limits<double>::infinity();
+  _maxValue = std::numeric_limits<double>::infinity();
 
   SGPropertyNode * n;
 
@@ -115,6 +147,11 @@ void InputValue::parse( SGPropertyNode& prop_root,
   if( (n = cfg.getChild( "period" )) != NULL )
     _periodical = new PeriodicalValue(prop_root, *n);
 
+  foldConstant(_scale, _scaleValue);
+  foldConstant(_offset, _offsetValue);
+  foldConstant(_min, _minValue);
+  foldConstant(_max, _maxValue);
+
 
   SGPropertyNode *valueNode = cfg.getChild("value");
   if( valueNode != NULL )
@@ -184,23 +221,16 @@ double InputValue::get_value() const
         value = _property->getDoubleValue();
     }
     
-    if( _scale ) 
-        value *= _scale->get_value();
+    value *= get_scale();
+    value += get_offset();
 
-    if( _offset ) 
-        value += _offset->get_value();
+    double m = _min ? _min->get_value() : _minValue;
+    if( value < m )
+        value = m;
 
-    if( _min ) {
-        double m = _min->get_value();
-        if( value < m )
-            value = m;
-    }
-
-    if( _max ) {
-        double m = _max->get_value();
-        if( value > m )
-            value = m;
-    }
+    m = _max ? _max->get_value() : _maxValue;
+    if( value > m )
+        value = m;
 
     if( _periodical ) {
       value = _periodical->normalize( value );
@@ -209,3 +239,30 @@ double InputValue::get_value() const
     return _abs ? fabs(value) : value;
 }
 
+bool InputValue::is_constant() const
+{
+    return !_property && !_expression
+        && !_scale && !_offset && !_min && !_max && !_periodical;
+}
+
+bool InputValue::collectDependencies( std::set<SGPropertyNode*>& inputs ) const
+{
+    // conditions and expressions can't tell which properties they read
+    bool complete = !_condition && !_expression;
+
+    if( _property )
+        inputs.insert( _property );
+
+    if( _scale && !_scale->collectDependencies(inputs) )
+        complete = false;
+    if( _offset && !_offset->collectDependencies(inputs) )
+        complete = false;
+    if( _min && !_min->collectDependencies(inputs) )
+        complete = false;
+    if( _max && !_max->collectDependencies(inputs) )
+        complete = false;
+    if( _periodical && !_periodical->collectDependencies(inputs) )
+        complete = false;
+
+    return complete;
+}
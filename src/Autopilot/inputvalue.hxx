@@ -26,6 +26,8 @@
 #endif
 
 
+#include <set>
+
 #include <simgear/structure/SGExpression.hxx>
 
 namespace FGXMLAutopilot {
@@ -48,6 +50,7 @@ public:
                       SGPropertyNode& cfg );
      double normalize( double value ) const;
      double normalizeSymmetric( double value ) const;
+     bool collectDependencies( std::set<SGPropertyNode*>& inputs ) const;
 };
 
 /**
@@ -66,6 +69,10 @@ private:
      InputValue_ptr _scale;    // A constant scaling factor defaults to one
      InputValue_ptr _min;      // A minimum clip defaults to no clipping
      InputValue_ptr _max;      // A maximum clip defaults to no clipping
+     double _offsetValue;      // _offset folded to a constant, if NULL
+     double _scaleValue;       // _scale folded to a constant, if NULL
+     double _minValue;         // _min folded to a constant (or -inf), if NULL
+     double _maxValue;         // _max folded to a constant (or +inf), if NULL
      PeriodicalValue_ptr  _periodical; //
      SGSharedPtr<const SGCondition> _condition;
      SGSharedPtr<SGExpressiond> _expression;  ///< expression to generate the value
@@ -98,13 +105,25 @@ public:
     void set_value( double value );
 
     inline double get_scale() const {
-      return _scale == NULL ? 1.0 : _scale->get_value();
+      return _scale == NULL ? _scaleValue : _scale->get_value();
     }
 
     inline double get_offset() const {
-      return _offset == NULL ? 0.0 : _offset->get_value();
+      return _offset == NULL ? _offsetValue : _offset->get_value();
     }
 
+    /**
+     * @brief true if the value is a constant: no property, expression or
+     *        non-constant scale, offset, clipping or period.
+     */
+    bool is_constant() const;
+
+    /**
+     * @brief add the properties this input reads to inputs
+     * @return false if some are hidden in a condition or expression
+     */
+    bool collectDependencies( std::set<SGPropertyNode*>& inputs ) const;
+
     inline bool is_enabled() const {
       return _condition == NULL ? true : _condition->test();
     }
@@ -134,6 +153,15 @@ class InputValueList : public std::vector<InputValue_ptr> {
       InputValue_ptr input = get_active();
       return input == NULL ? _def : input->get_value();
     }
+
+    bool collectDependencies( std::set<SGPropertyNode*>& inputs ) const {
+      bool complete = true;
+      for (const_iterator it = begin(); it != end(); ++it) {
+        if( !(*it)->collectDependencies(inputs) )
+          complete = false;
+      }
+      return complete;
+    }
   private:
 
     double _def;
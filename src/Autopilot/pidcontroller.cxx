@@ -240,3 +240,13 @@ bool PIDController::configure( SGPropertyNode& cfg_node,
 
   return AnalogComponent::configure(cfg_node, cfg_name, prop_root);
 }
+
+//------------------------------------------------------------------------------
+bool PIDController::collectDependencies( PropertySet& inputs,
+                                         PropertySet& outputs ) const
+{
+  bool complete = AnalogComponent::collectDependencies(inputs, outputs);
+  if( !Kp.collectDependencies(inputs) ) complete = false;
+  if( !Ti.collectDependencies(inputs) ) complete = false;
+  return Td.collectDependencies(inputs) && complete;
+}
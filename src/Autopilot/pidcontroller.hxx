@@ -70,6 +70,9 @@ public:
     ~PIDController() {}
 
     void update( bool firstTime, double dt );
+
+    virtual bool collectDependencies( PropertySet& inputs,
+                                      PropertySet& outputs ) const;
 };
 
 }
@@ -87,3 +87,12 @@ void PISimpleController::update( bool firstTime, double dt )
     set_output_value( clamped_output );
     if ( _debug ) std::cout << "output = " << clamped_output << std::endl;
 }
+
+//------------------------------------------------------------------------------
+bool PISimpleController::collectDependencies( PropertySet& inputs,
+                                              PropertySet& outputs ) const
+{
+  bool complete = AnalogComponent::collectDependencies(inputs, outputs);
+  if( !_Kp.collectDependencies(inputs) ) complete = false;
+  return _Ki.collectDependencies(inputs) && complete;
+}
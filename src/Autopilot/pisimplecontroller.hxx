@@ -59,6 +59,9 @@ public:
     ~PISimpleController() {}
 
     void update( bool firstTime, double dt );
+
+    virtual bool collectDependencies( PropertySet& inputs,
+                                      PropertySet& outputs ) const;
 };
 
 }
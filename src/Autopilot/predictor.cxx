@@ -77,3 +77,12 @@ void Predictor::update( bool firstTime, double dt )
 
     _last_value = ivalue;
 }
+
+//------------------------------------------------------------------------------
+bool Predictor::collectDependencies( PropertySet& inputs,
+                                     PropertySet& outputs ) const
+{
+  bool complete = AnalogComponent::collectDependencies(inputs, outputs);
+  if( !_seconds.collectDependencies(inputs) ) complete = false;
+  return _filter_gain.collectDependencies(inputs) && complete;
+}
@@ -62,6 +62,9 @@ public:
     ~Predictor() {}
 
     void update( bool firstTime, double dt );
+
+    virtual bool collectDependencies( PropertySet& inputs,
+                                      PropertySet& outputs ) const;
 };
 
 } // namespace FGXMLAutopilot
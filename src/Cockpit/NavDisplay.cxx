@@ -72,6 +72,8 @@ using std::string;
 #include <Navaids/fix.hxx>
 #include <Airports/airport.hxx>
 #include <Airports/runways.hxx>
+#include <AIModel/AIManager.hxx>
+#include <AIModel/AIBase.hxx>
 #include "od_gauge.hxx"
 
 static const char *DEFAULT_FONT = "typewriter.txf";
@@ -1300,53 +1302,54 @@ void NavDisplay::computePositionedState(FGPositioned* pos, string_set& states)
     } // FGPositioned::Type switch
 }
 
-static string mapAINodeToType(SGPropertyNode* model)
+static string mapAITargetToType(const FGAITrafficSnapshot::Target& target)
 {
   // assume all multiplayer items are aircraft for the moment. Not ideal.
-  if (!strcmp(model->getName(), "multiplayer")) {
+  if (target.type == FGAIBase::otMultiplayer) {
     return "ai-aircraft";
   }
   
-  return string("ai-") + model->getName();
+  return string("ai-") + target.typeName;
 }
 
 void NavDisplay::processAI()
 {
-    SGPropertyNode *ai = fgGetNode("/ai/models", true);
-    for (int i = ai->nChildren() - 1; i >= 0; i--) {
-        SGPropertyNode *model = ai->getChild(i);
-        if (!model->nChildren()) {
-            continue;
-        }
+    FGAIManager* aiManager = globals->get_subsystem<FGAIManager>();
+    if (!aiManager) {
+        return;
+    }
+    
+    FGAITrafficSnapshotPtr traffic = aiManager->getTrafficSnapshot();
+    const FGAITrafficSnapshot::TargetVec& targets = traffic->getTargets();
+    for (int i = targets.size() - 1; i >= 0; i--) {
+        const FGAITrafficSnapshot::Target& target = targets[i];
         
     // prefix types with 'ai-', to avoid any chance of namespace collisions
     // with fg-positioned.
         string_set ss;
-        computeAIStates(model, ss);        
+        computeAIStates(target, ss);        
         SymbolRuleVector rules;
-        findRules(mapAINodeToType(model), ss, rules);
+        findRules(mapAITargetToType(target), ss, rules);
         if (rules.empty()) {
             return; // no rules matched, we can skip this item
         }
 
-        double heading = model->getDoubleValue("orientation/true-heading-deg");
-        SGGeod aiModelPos = SGGeod::fromDegFt(model->getDoubleValue("position/longitude-deg"), 
-                                            model->getDoubleValue("position/latitude-deg"), 
-                                            model->getDoubleValue("position/altitude-ft"));
+        double heading = target.headingDeg;
+        const SGGeod& aiModelPos = target.position;
     // compute some additional props
         int fl = (aiModelPos.getElevationFt() / 1000);
-        model->setIntValue("flight-level", fl * 10);
+        target.props->setIntValue("flight-level", fl * 10);
                                             
         osg::Vec2 projected = projectGeod(aiModelPos);
         BOOST_FOREACH(SymbolRule* r, rules) {
-            addSymbolInstance(projected, heading, r->getDefinition(), (SGPropertyNode*) model);
+            addSymbolInstance(projected, heading, r->getDefinition(), target.props);
         }
-    } // of ai models iteration
+    } // of ai targets iteration
 }
 
-void NavDisplay::computeAIStates(const SGPropertyNode* ai, string_set& states)
+void NavDisplay::computeAIStates(const FGAITrafficSnapshot::Target& ai, string_set& states)
 {
-    int threatLevel = ai->getIntValue("tcas/threat-level",-1);
+    int threatLevel = ai.props->getIntValue("tcas/threat-level",-1);
     if (threatLevel < 1)
       threatLevel = 0;
   
@@ -1356,7 +1359,7 @@ void NavDisplay::computeAIStates(const SGPropertyNode* ai, string_set& states)
     os << "tcas-threat-level-" << threatLevel;
     states.insert(os.str());
 
-    double vspeed = ai->getDoubleValue("velocities/vertical-speed-fps");
+    double vspeed = ai.verticalSpeedFps;
     if (vspeed < -3.0) {
         states.insert("descending");
     } else if (vspeed > 3.0) {
@@ -37,6 +37,7 @@
 #include <memory>
 
 #include <Navaids/positioned.hxx>
+#include <AIModel/AITrafficSnapshot.hxx>
 
 class FGODGauge;
 class FGRouteMgr;
@@ -119,7 +120,7 @@ private:
     void processNavRadios();
     FGNavRecord* processNavRadio(const SGPropertyNode_ptr& radio);
     void processAI();
-    void computeAIStates(const SGPropertyNode* ai, string_set& states);
+    void computeAIStates(const FGAITrafficSnapshot::Target& ai, string_set& states);
     
     void computeCustomSymbolStates(const SGPropertyNode* sym, string_set& states);
     void processCustomSymbols();
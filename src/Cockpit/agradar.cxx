@@ -29,6 +29,17 @@
 #include <Main/globals.hxx>
 #include "agradar.hxx"
 
+#include <Scenery/ElevationService.hxx>
+
+using flightgear::ElevationService;
+
+static ElevationService::CallerId elevationCaller()
+{
+    static ElevationService::CallerId id =
+        ElevationService::instance()->registerCaller("ag-radar", 30.0);
+    return id;
+}
+
 
 agRadar::agRadar(SGPropertyNode *node) : wxRadarBg(node) 
 {
@@ -211,7 +222,7 @@ bool
 agRadar::getMaterial(){
 
     const simgear::BVHMaterial* mat = 0;
-    if (globals->get_scenery()->get_elevation_m(hitpos, _elevation_m, &mat)){
+    if (ElevationService::instance()->getElevation(elevationCaller(), hitpos, _elevation_m, &mat)){
         //_ht_agl_ft = pos.getElevationFt() - _elevation_m * SG_METER_TO_FEET;
         const SGMaterial* material = dynamic_cast<const SGMaterial*>(mat);
         if (material) {
@@ -284,7 +295,7 @@ agRadar::update_terrain()
         for(double elev = el_limit; elev >= - el_limit; elev -= el_step){
             setUserVec(brg, elev);
             SGVec3d nearestHit;
-            globals->get_scenery()->get_cart_ground_intersection(cartantennapos, uservec, nearestHit);
+            ElevationService::instance()->getGroundIntersection(elevationCaller(), cartantennapos, uservec, nearestHit);
             SGGeodesy::SGCartToGeod(nearestHit, hitpos);
 
             double course1, course2, distance;
@@ -56,6 +56,7 @@ using std::string;
 
 #include <Main/fg_props.hxx>
 #include <Main/globals.hxx>
+#include <AIModel/AIManager.hxx>
 
 #include "panel.hxx" // for FGTextureManager
 #include "od_gauge.hxx"
@@ -575,8 +576,8 @@ wxRadarBg::update_weather()
 
 
 void
-wxRadarBg::update_data(const SGPropertyNode *ac, double altitude, double heading,
-                       double radius, double bearing, bool selected)
+wxRadarBg::update_data(const FGAITrafficSnapshot& traffic, const FGAITrafficSnapshot::Target& ac,
+                       double altitude, double heading, double radius, double bearing, bool selected)
 {
     osgText::Text *callsign = new osgText::Text;
     callsign->setFont(_font.get());
@@ -593,16 +594,16 @@ wxRadarBg::update_data(const SGPropertyNode *ac, double altitude, double heading
     callsign->setAlignment(osgText::Text::LEFT_BOTTOM_BASE_LINE);
     callsign->setLineSpacing(_font_spacing);
 
-    const char *identity = ac->getStringValue("transponder-id");
+    const char *identity = ac.props->getStringValue("transponder-id");
     if (!identity[0])
-        identity = ac->getStringValue("callsign");
+        identity = traffic.getCallsign(ac).c_str();
 
     stringstream text;
     text << identity << endl
         << setprecision(0) << fixed
         << setw(3) << setfill('0') << heading * SG_RADIANS_TO_DEGREES << "\xB0 "
         << setw(0) << altitude << "ft" << endl
-        << ac->getDoubleValue("velocities/true-airspeed-kt") << "kts";
+        << ac.speedKt << "kts";
 
     callsign->setText(text.str());
     _textGeode->addDrawable(callsign);
@@ -705,19 +706,22 @@ wxRadarBg::update_aircraft()
 
     int selected_id = fgGetInt("/instrumentation/radar/selected-id", -1);
 
-    const SGPropertyNode *selected_ac = 0;
-    const SGPropertyNode *ai = fgGetNode("/ai/models", true);
+    FGAIManager* aiManager = globals->get_subsystem<FGAIManager>();
+    if (!aiManager)
+        return;
+
+    FGAITrafficSnapshotPtr traffic = aiManager->getTrafficSnapshot();
+    const FGAITrafficSnapshot::TargetVec& targets = traffic->getTargets();
+    const FGAITrafficSnapshot::Target *selected_ac = 0;
 
-    for (int i = ai->nChildren() - 1; i >= -1; i--) {
-        const SGPropertyNode *model;
+    for (int i = targets.size() - 1; i >= -1; i--) {
+        const FGAITrafficSnapshot::Target *model;
 
         if (i < 0) { // last iteration: selected model
             model = selected_ac;
         } else {
-            model = ai->getChild(i);
-            if (!model->nChildren())
-                continue;
-            if ((model->getIntValue("id") == selected_id)&&
+            model = &targets[i];
+            if ((model->id == selected_id)&&
                 (!draw_tcas)) {
                 selected_ac = model;  // save selected model for last iteration
                 continue;
@@ -727,7 +731,7 @@ wxRadarBg::update_aircraft()
             continue;
 
         double echo_radius, sigma;
-        const string name = model->getName();
+        const string name = model->typeName;
 
         //cout << "name "<<name << endl;
         if (name == "aircraft" || name == "tanker")
@@ -745,10 +749,10 @@ wxRadarBg::update_aircraft()
         else
             continue;
 
-        double lat = model->getDoubleValue("position/latitude-deg");
-        double lon = model->getDoubleValue("position/longitude-deg");
-        double alt = model->getDoubleValue("position/altitude-ft");
-        double heading = model->getDoubleValue("orientation/true-heading-deg");
+        double lat = model->position.getLatitudeDeg();
+        double lon = model->position.getLongitudeDeg();
+        double alt = model->position.getElevationFt();
+        double heading = model->headingDeg;
 
         double range, bearing;
         calcRangeBearing(user_lat, user_lon, lat, lon, range, bearing);
@@ -776,7 +780,7 @@ wxRadarBg::update_aircraft()
         bool is_tcas_contact = false;
         if (draw_tcas)
         {
-            is_tcas_contact = update_tcas(model,range,user_alt,alt,bearing,radius,draw_absolute);
+            is_tcas_contact = update_tcas(*model,range,user_alt,alt,bearing,radius,draw_absolute);
         }
 
         // pos mode
@@ -803,21 +807,21 @@ wxRadarBg::update_aircraft()
 
         if ((draw_data || i < 0)&&  // selected one (i == -1) is always drawn
             ((!draw_tcas)||(is_tcas_contact)||(draw_echoes)))
-            update_data(model, alt, heading, radius, bearing, i < 0);
+            update_data(*traffic, *model, alt, heading, radius, bearing, i < 0);
     }
 }
 
 /** Update TCAS display.
  * Return true when processed as TCAS contact, false otherwise. */
 bool
-wxRadarBg::update_tcas(const SGPropertyNode *model,double range,double user_alt,double alt,
+wxRadarBg::update_tcas(const FGAITrafficSnapshot::Target& model,double range,double user_alt,double alt,
                        double bearing,double radius,bool absMode)
 {
     int threatLevel=0;
     {
         // update TCAS symbol
         osg::Vec2f texBase;
-        threatLevel = model->getIntValue("tcas/threat-level",-1);
+        threatLevel = model.props->getIntValue("tcas/threat-level",-1);
         if (threatLevel == -1)
         {
             // no TCAS information (i.e. no transponder) => not visible to TCAS
@@ -825,7 +829,7 @@ wxRadarBg::update_tcas(const SGPropertyNode *model,double range,double user_alt,
         }
         int row = 7 - threatLevel;
         int col = 4;
-        double vspeed = model->getDoubleValue("velocities/vertical-speed-fps");
+        double vspeed = model.verticalSpeedFps;
         if (vspeed < -3.0) // descending
             col+=1;
         else
@@ -31,6 +31,8 @@
 #include <simgear/props/props.hxx>
 #include <simgear/structure/subsystem_mgr.hxx>
 
+#include <AIModel/AITrafficSnapshot.hxx>
+
 #include <vector>
 #include <string>
 
@@ -153,9 +155,9 @@ private:
     void update_aircraft();
     void update_tacan();
     void update_heading_marker();
-    void update_data(const SGPropertyNode *ac, double alt, double heading,
-        double radius, double bearing, bool selected);
-    bool update_tcas(const SGPropertyNode *model,double range,double user_alt,double alt,
+    void update_data(const FGAITrafficSnapshot& traffic, const FGAITrafficSnapshot::Target& ac,
+        double alt, double heading, double radius, double bearing, bool selected);
+    bool update_tcas(const FGAITrafficSnapshot::Target& model,double range,double user_alt,double alt,
                      double bearing,double radius, bool absMode);
     void center_map();
     void apply_map_offset();
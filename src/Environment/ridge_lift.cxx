@@ -34,6 +34,7 @@
 #include <Main/globals.hxx>
 #include <Main/util.hxx>
 #include <Scenery/scenery.hxx>
+#include <Scenery/ElevationService.hxx>
 #include <string>
 #include <cmath>
 #include <simgear/sg_inlines.h>
@@ -56,6 +57,8 @@ const double FGRidgeLift::dist_probe_m[] = { // in meters
 FGRidgeLift::FGRidgeLift () :
   lift_factor(0.0)
 {	
+	_elevation_caller = flightgear::ElevationService::instance()->registerCaller("ridge-lift", 30.0);
+
 	strength = 0.0;
 	timer = 0.0;
 	for( int i = 0; i < 5; i++ )
@@ -140,13 +143,21 @@ void FGRidgeLift::update(double dt) {
 		double ground_wind_from_rad = _surface_wind_from_deg_node->getDoubleValue() * SG_DEGREES_TO_RADIANS;
 
 		// compute the remaining probes
+		flightgear::ElevationService::QueryList probes;
 		for (unsigned i = 1; i < sizeof(probe_elev_m)/sizeof(probe_elev_m[0]); i++) {
 			SGGeoc probe = myGeocPos.advanceRadM( ground_wind_from_rad, dist_probe_m[i] );
 			// convert to geodetic position for ground level computation
 			SGGeod probeGeod = SGGeod::fromGeoc( probe );
 			probe_lat_deg[i] = probeGeod.getLatitudeDeg();
 			probe_lon_deg[i] = probeGeod.getLongitudeDeg();
-			if (!globals->get_scenery()->get_elevation_m( probeGeod, probe_elev_m[i], NULL )) {
+			probes.push_back(flightgear::ElevationService::Query(probeGeod));
+		}
+
+		flightgear::ElevationService::instance()->getElevations(_elevation_caller, probes);
+		for (unsigned i = 1; i < sizeof(probe_elev_m)/sizeof(probe_elev_m[0]); i++) {
+			if (probes[i-1].valid) {
+				probe_elev_m[i] = probes[i-1].elevation;
+			} else {
 				// no ground found? use elevation of previous probe :-(
 				probe_elev_m[i] = probe_elev_m[i-1];
 			}
@@ -65,6 +65,7 @@ private:
 	double probe_lat_deg[5];
 	double probe_lon_deg[5];
 	double probe_elev_m[5];
+	unsigned int _elevation_caller;
 
 	double slope[4];
 
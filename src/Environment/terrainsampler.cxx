@@ -27,6 +27,7 @@
 #include <Main/fg_props.hxx>
 #include <simgear/math/sg_random.h>
 #include <Scenery/scenery.hxx>
+#include <Scenery/ElevationService.hxx>
 #include <deque>
 
 #include "terrainsampler.hxx"
@@ -96,6 +97,7 @@ private:
     SGPropertyNode_ptr _signalNode;
     SGPropertyNode_ptr _positionLatitudeNode;
     SGPropertyNode_ptr _positionLongitudeNode;
+    unsigned int _elevationCaller;
 
     deque<double> _elevations;
     simgear::TiedPropertyList _tiedProperties;
@@ -125,6 +127,8 @@ AreaSampler::AreaSampler( SGPropertyNode_ptr rootNode ) :
     _positionLongitudeNode(fgGetNode( "/position/longitude-deg", true ))
 {
     _inputPosition.setElevationM( SG_MAX_ELEVATION_M );
+    // only the statistics of the area matter, coarse samples will do
+    _elevationCaller = flightgear::ElevationService::instance()->registerCaller( "area-sampler", 200.0 );
 }
 
 AreaSampler::~AreaSampler()
@@ -220,7 +224,7 @@ void AreaSampler::update( double dt )
     if( _signalNode->getBoolValue() )
         return; // nothing to do.
 
-    FGScenery * scenery = globals->get_scenery();
+    flightgear::ElevationService* elevationService = flightgear::ElevationService::instance();
 
     SGTimeStamp start = SGTimeStamp::now();
     while( (SGTimeStamp::now() - start).toSecs() < dt * _max_computation_time_norm ) {
@@ -231,7 +235,7 @@ void AreaSampler::update( double dt )
         SGGeod probe = SGGeod::fromGeoc(center.advanceRadM( course, distance ));
         double elevation_m = 0.0;
 
-        if (scenery->get_elevation_m( probe, elevation_m, NULL )) 
+        if (elevationService->getElevation( _elevationCaller, probe, elevation_m )) 
             _elevations.push_front(elevation_m *= SG_METER_TO_FEET);
         
         if( _elevations.size() >= (deque<unsigned>::size_type)_max_samples ) {
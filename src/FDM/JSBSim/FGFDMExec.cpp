@@ -47,6 +47,8 @@ INCLUDES
 #include <cstdlib>
 #include <iomanip>
 
+#include <simgear/timing/timestamp.hxx>
+
 #include "FGFDMExec.h"
 #include "models/atmosphere/FGStandardAtmosphere.h"
 #include "models/atmosphere/FGWinds.h"
@@ -67,6 +69,7 @@ INCLUDES
 #include "initialization/FGTrim.h"
 #include "input_output/FGScript.h"
 #include "input_output/FGXMLFileRead.h"
+#include "math/FGFunction.h"
 
 using namespace std;
 
@@ -75,6 +78,17 @@ namespace JSBSim {
 IDENT(IdSrc,"$Id: FGFDMExec.cpp,v 1.191 2016/05/16 18:19:57 bcoconni Exp $");
 IDENT(IdHdr,ID_FDMEXEC);
 
+// Names of the models in the function statistics properties, in the order of
+// the eModels enum.
+static const char* ModelNames[] = {"propagate", "input", "inertial",
+                                   "atmosphere", "winds", "systems",
+                                   "mass-balance", "auxiliary", "propulsion",
+                                   "aerodynamics", "ground-reactions",
+                                   "external-reactions", "buoyant-forces",
+                                   "aircraft", "accelerations", "output"};
+
+unsigned int FGFDMExec::LiveInstances = 0;
+
 /*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 CLASS IMPLEMENTATION
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
@@ -101,6 +115,7 @@ FGFDMExec::FGFDMExec(FGPropertyManager* root, unsigned int* fdmctr) : Root(root)
   ResetMode = 0;
   RandomSeed = 0;
   HoldDown = false;
+  GroundCallbackTime = true;
 
   IncrementThenHolding = false;  // increment then hold is off by default
   TimeStepsUntilHold = -1;
@@ -120,6 +135,8 @@ FGFDMExec::FGFDMExec(FGPropertyManager* root, unsigned int* fdmctr) : Root(root)
     debug_lvl = 1;
   }
 
+  LiveInstances++;
+
   if (Root == 0) {                 // Then this is the root FDM
     Root = new FGPropertyManager;  // Create the property manager
     StandAlone = true;
@@ -176,6 +193,12 @@ FGFDMExec::FGFDMExec(FGPropertyManager* root, unsigned int* fdmctr) : Root(root)
   instance->Tie("simulation/trim-completed", (int *)&trim_completed, false);
   instance->Tie("forces/hold-down", this, &FGFDMExec::GetHoldDown, &FGFDMExec::SetHoldDown);
 
+  for (int i = 0; i < eNumStandardModels; i++) {
+    string stats = string("simulation/function-stats/") + ModelNames[i];
+    instance->Tie(stats + "/evaluations", this, i, &FGFDMExec::GetFunctionEvaluations);
+    instance->Tie(stats + "/time-sec", this, i, &FGFDMExec::GetFunctionTime);
+  }
+
   Constructing = false;
 }
 
@@ -208,8 +231,9 @@ FGFDMExec::~FGFDMExec()
   ChildFDMList.clear();
 
   PropertyCatalog.clear();
-  
-  SetGroundCallback(0);
+
+  // The ground callback is shared by all the instances
+  if (--LiveInstances == 0) SetGroundCallback(0);
 
   if (FDMctr > 0) (*FDMctr)--;
 
@@ -229,7 +253,10 @@ bool FGFDMExec::Allocate(void)
   // Note that this does not affect the order in which the models will be
   // executed later.
   Models[eInertial]          = new FGInertial(this);
-  SetGroundCallback(new FGDefaultGroundCallback(static_cast<FGInertial*>(Models[eInertial])->GetRefRadius()));
+  // Keep the ground callback installed by the application or by another
+  // instance, if any.
+  if (!GetGroundCallback())
+    SetGroundCallback(new FGDefaultGroundCallback(static_cast<FGInertial*>(Models[eInertial])->GetRefRadius()));
 
   // See the eModels enum specification in the header file. The order of the
   // enums specifies the order of execution. The Models[] vector is the primary
@@ -340,6 +367,59 @@ bool FGFDMExec::Run(void)
   return success;
 }
 
+//%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+// The functions are evaluated in the current state of the simulation, as
+// RunFunctions() does, so they are left with the values cached for the
+// current frame.
+
+void FGFDMExec::BenchmarkFunctions(unsigned int frames)
+{
+  vector<FGFunction*> functions;
+  for (unsigned int i = 0; i < Models.size(); i++) Models[i]->GetFunctions(functions);
+
+  if (functions.empty()) {
+    cout << "No functions to benchmark" << endl;
+    return;
+  }
+
+  size_t sz = functions.size();
+  vector<double> values[2];
+  double seconds[2];
+
+  for (int pass = 0; pass < 2; pass++) {
+    FGFunction::UseBytecode(pass == 1);
+
+    SGTimeStamp start = SGTimeStamp::now();
+    for (unsigned int frame = 0; frame < frames; frame++) {
+      for (unsigned int i = 0; i < sz; i++) functions[i]->cacheValue(true);
+    }
+    seconds[pass] = (SGTimeStamp::now() - start).toSecs();
+
+    for (unsigned int i = 0; i < sz; i++) values[pass].push_back(functions[i]->GetValue());
+  }
+
+  unsigned int mismatches = 0;
+  for (unsigned int i = 0; i < sz; i++) {
+    double tree = values[0][i], bytecode = values[1][i];
+    if (tree != bytecode && (tree == tree || bytecode == bytecode)) {
+      if (mismatches++ < 10) {
+        cout << "  Function " << functions[i]->GetName() << ": tree " << tree
+             << ", bytecode " << bytecode << endl;
+      }
+    }
+  }
+
+  double evaluations = double(sz) * frames;
+  cout << "Function benchmark: " << sz << " functions, " << frames << " frames" << endl;
+  cout << "  tree interpreter: " << seconds[0] << " s, "
+       << 1e9 * seconds[0] / evaluations << " ns per function" << endl;
+  cout << "  bytecode:         " << seconds[1] << " s, "
+       << 1e9 * seconds[1] / evaluations << " ns per function" << endl;
+  if (seconds[1] > 0.0) cout << "  speedup: " << seconds[0] / seconds[1] << endl;
+  cout << "  " << mismatches << " functions gave different values"
+       << " (expected only for random and urandom)" << endl;
+}
+
 //%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 
 void FGFDMExec::LoadInputs(unsigned int idx)
@@ -1060,6 +1140,7 @@ bool FGFDMExec::ReadChild(Element* el)
 
   child->exec = new FGFDMExec(Root, FDMctr);
   child->exec->SetChild(true);
+  child->exec->SetGroundCallbackTime(GroundCallbackTime);
 
   string childAircraft = el->GetAttributeValue("name");
   string sMated = el->GetAttributeValue("mated");
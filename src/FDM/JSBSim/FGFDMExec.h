@@ -170,6 +170,19 @@ CLASS DOCUMENTATION
     - <b>16</b>: When set various parameters are sanity checked and
        a message is printed out when they go out of bounds
 
+    <h3>Multiple instances</h3>
+
+    Several independent FGFDMExec instances, each with its own property tree,
+    may be run concurrently from different threads once they are loaded. The
+    ground callback is shared by all the instances, so instances running
+    concurrently must not write their time to it: call
+    SetGroundCallbackTime(false) on each of them right after construction,
+    and use a ground callback which does not depend on the time (such as the
+    default one). Construction, model
+    loading and destruction use process wide state (debug level, unit
+    conversion tables, dispersions and the random number generator) and must
+    be serialized by the application.
+
     <h3>Properties</h3>
     @property simulator/do_trim (write only) Can be set to the integer equivalent to one of
                                 tLongitudinal (0), tFull (1), tGround (2), tPullup (3),
@@ -540,7 +553,7 @@ public:
       @return the current simulation time.      */
   double Setsim_time(double cur_time) {
     sim_time = cur_time;
-    GetGroundCallback()->SetTime(sim_time);
+    if (GroundCallbackTime) GetGroundCallback()->SetTime(sim_time);
     return sim_time;
   }
 
@@ -562,7 +575,7 @@ public:
   double IncrTime(void) {
     if (!holding && !IntegrationSuspended()) {
       sim_time += dT;
-      GetGroundCallback()->SetTime(sim_time);
+      if (GroundCallbackTime) GetGroundCallback()->SetTime(sim_time);
       Frame++;
     }
     return sim_time;
@@ -574,10 +587,32 @@ public:
   /** Retrieves the current debug level setting. */
   int GetDebugLevel(void) const {return debug_lvl;};
 
+  /** Retrieves the number of function evaluations run by a model.
+      @param model the index of the model, see eModels. */
+  long GetFunctionEvaluations(int model) const
+  { return model < (int)Models.size() ? Models[model]->GetFunctionEvaluations() : 0; }
+
+  /** Retrieves the time spent in the function evaluations of a model.
+      @param model the index of the model, see eModels.
+      @return the wall clock time in seconds */
+  double GetFunctionTime(int model) const
+  { return model < (int)Models.size() ? Models[model]->GetFunctionTime() : 0.0; }
+
+  /** Times the evaluation of the functions of all models with the tree
+      interpreter and with the compiled bytecode, and checks that both give
+      the same values. The results are printed to the console.
+      @param frames the number of times each function is evaluated */
+  void BenchmarkFunctions(unsigned int frames);
+
   /** Initializes the simulation with initial conditions
       @param FGIC The initial conditions that will be passed to the simulation. */
   void Initialize(FGInitialCondition *FGIC);
 
+  /** Sets whether the simulation time is written to the ground callback.
+      This is on by default, see "Multiple instances" above.
+      @param gt true if the ground callback follows this instance's time */
+  void SetGroundCallbackTime(bool gt) {GroundCallbackTime = gt;}
+
   /** Sets the property forces/hold-down. This allows to do hard 'hold-down'
       such as for rockets on a launch pad with engines ignited.
       @param hd enables the 'hold-down' function if non-zero
@@ -645,10 +680,14 @@ private:
   FGPropertyManager* instance;
 
   bool HoldDown;
+  bool GroundCallbackTime;
 
   // The FDM counter is used to give each child FDM an unique ID. The root FDM has the ID 0
   unsigned int*      FDMctr;
 
+  // Number of FGFDMExec objects in the process, they share the ground callback
+  static unsigned int LiveInstances;
+
   std::vector <std::string> PropertyCatalog;
   std::vector <childData*> ChildFDMList;
   std::vector <FGModel*> Models;
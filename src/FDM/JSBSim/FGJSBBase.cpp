@@ -42,6 +42,9 @@ INCLUDES
 #include <sstream>
 #include <cstdlib>
 
+#include <simgear/threads/SGThread.hxx>
+#include <simgear/threads/SGGuard.hxx>
+
 using namespace std;
 
 namespace JSBSim {
@@ -111,6 +114,10 @@ const string FGJSBBase::needed_cfg_version = "2.0";
 const string FGJSBBase::JSBSim_version = "1.0 " __DATE__ " " __TIME__ ;
 
 queue <FGJSBBase::Message> FGJSBBase::Messages;
+// The message queue and the random number generator state are shared by all
+// the FDM instances, which may run in different threads.
+static SGMutex messageMutex;
+static SGMutex randomMutex;
 FGJSBBase::Message FGJSBBase::localMsg;
 unsigned int FGJSBBase::messageId = 0;
 
@@ -122,6 +129,7 @@ short FGJSBBase::debug_lvl  = 1;
 
 void FGJSBBase::PutMessage(const Message& msg)
 {
+  SGGuard<SGMutex> lock(messageMutex);
   Messages.push(msg);
 }
 
@@ -131,9 +139,10 @@ void FGJSBBase::PutMessage(const string& text)
 {
   Message msg;
   msg.text = text;
-  msg.messageId = messageId++;
   msg.subsystem = "FDM";
   msg.type = Message::eText;
+  SGGuard<SGMutex> lock(messageMutex);
+  msg.messageId = messageId++;
   Messages.push(msg);
 }
 
@@ -143,10 +152,11 @@ void FGJSBBase::PutMessage(const string& text, bool bVal)
 {
   Message msg;
   msg.text = text;
-  msg.messageId = messageId++;
   msg.subsystem = "FDM";
   msg.type = Message::eBool;
   msg.bVal = bVal;
+  SGGuard<SGMutex> lock(messageMutex);
+  msg.messageId = messageId++;
   Messages.push(msg);
 }
 
@@ -156,10 +166,11 @@ void FGJSBBase::PutMessage(const string& text, int iVal)
 {
   Message msg;
   msg.text = text;
-  msg.messageId = messageId++;
   msg.subsystem = "FDM";
   msg.type = Message::eInteger;
   msg.iVal = iVal;
+  SGGuard<SGMutex> lock(messageMutex);
+  msg.messageId = messageId++;
   Messages.push(msg);
 }
 
@@ -169,10 +180,11 @@ void FGJSBBase::PutMessage(const string& text, double dVal)
 {
   Message msg;
   msg.text = text;
-  msg.messageId = messageId++;
   msg.subsystem = "FDM";
   msg.type = Message::eDouble;
   msg.dVal = dVal;
+  SGGuard<SGMutex> lock(messageMutex);
+  msg.messageId = messageId++;
   Messages.push(msg);
 }
 
@@ -180,6 +192,7 @@ void FGJSBBase::PutMessage(const string& text, double dVal)
 
 void FGJSBBase::ProcessMessage(void)
 {
+  SGGuard<SGMutex> lock(messageMutex);
   if (Messages.empty()) return;
   localMsg = Messages.front();
 
@@ -212,6 +225,7 @@ void FGJSBBase::ProcessMessage(void)
 
 FGJSBBase::Message* FGJSBBase::ProcessNextMessage(void)
 {
+  SGGuard<SGMutex> lock(messageMutex);
   if (Messages.empty()) return NULL;
   localMsg = Messages.front();
 
@@ -252,6 +266,8 @@ double FGJSBBase::GaussianRandomNumber(void)
   static double V1, V2, S;
   double X;
 
+  SGGuard<SGMutex> lock(randomMutex);
+
   if (gaussian_random_number_phase == 0) {
     V1 = V2 = S = X = 0.0;
 
@@ -114,6 +114,48 @@ public:
     return agl;
   }
 
+  /** Compute the altitude above ground for all gears at once. */
+  virtual bool GetAGLevels(double t, const std::vector<FGLocation>& locations,
+                           std::vector<double>& agl,
+                           std::vector<FGLocation>& contacts,
+                           std::vector<FGColumnVector3>& normals,
+                           std::vector<FGColumnVector3>& v,
+                           std::vector<FGColumnVector3>& w) const {
+    unsigned n = locations.size();
+    mBatch.resize(n);
+    for (unsigned i = 0; i < n; ++i) {
+      const FGLocation& l = locations[i];
+      mBatch.setPoint(i, SGVec3d(l(FGJSBBase::eX), l(FGJSBBase::eY),
+                                 l(FGJSBBase::eZ)));
+    }
+    mInterface->get_agl_ft(t, SG_METER_TO_FEET*2, mBatch, agl);
+
+    contacts.resize(n);
+    normals.resize(n);
+    v.resize(n);
+    w.resize(n);
+    for (unsigned i = 0; i < n; ++i) {
+      const SGVec3d& contact = mBatch.contact[i];
+      const SGVec3d& normal = mBatch.normal[i];
+      const SGVec3d& vel = mBatch.linearVel[i];
+      const SGVec3d& angularVel = mBatch.angularVel[i];
+      contacts[i] = FGColumnVector3( contact[0], contact[1], contact[2] );
+      normals[i] = FGColumnVector3( normal[0], normal[1], normal[2] );
+      v[i] = FGColumnVector3( vel[0], vel[1], vel[2] );
+      w[i] = FGColumnVector3( angularVel[0], angularVel[1], angularVel[2] );
+    }
+    return true;
+  }
+
+  /** Set up the ground surface below one point of the last batch, as the
+      single point query does. */
+  virtual void SelectContact(unsigned int index) const {
+    if (index >= mBatch.size())
+      return;
+    SGVec3d pt = mBatch.getPoint(index);
+    mInterface->update_ground_surface(mBatch.material[index], pt.data());
+  }
+
   virtual double GetTerrainGeoCentRadius(double t, const FGLocation& l) const {
     double loc_cart[3] = { l(FGJSBBase::eX), l(FGJSBBase::eY), l(FGJSBBase::eZ) };
     double contact[3], normal[3], vel[3], angularVel[3], agl = 0;
@@ -135,6 +177,7 @@ public:
   virtual void SetSeaLevelRadius(double radius) {}
 private:
   FGJSBsim* mInterface;
+  mutable FGGroundQueryBatch mBatch;
 };
 
 // FG uses a squared normalized magnitude for turbulence
@@ -1351,6 +1394,14 @@ FGJSBsim::get_agl_ft(double t, const double pt[3], double alt_off,
   SGQuatd hlToEc = SGQuatd::fromLonLat(geodPt);
   *agl = dot(hlToEc.rotate(SGVec3d(0, 0, 1)), SGVec3d(contact) - SGVec3d(pt));
 
+  update_ground_surface(material, pt);
+  return true;
+}
+
+void
+FGJSBsim::update_ground_surface(const simgear::BVHMaterial* material,
+                                const double pt[3])
+{
 #ifdef JSBSIM_USE_GROUNDREACTIONS
   bool terrain_active = (terrain->getIntValue("override-level", -1) > 0) ? false : true;
   terrain->setBoolValue("active", terrain_active);
@@ -1379,7 +1430,26 @@ FGJSBsim::get_agl_ft(double t, const double pt[3], double alt_off,
 #else
   terrain->setBoolValue("valid", false);
 #endif
-  return true;
+}
+
+void
+FGJSBsim::get_agl_ft(double t, double alt_off, FGGroundQueryBatch& batch,
+                     std::vector<double>& agl)
+{
+  // don't check the found flags, see above
+  FGInterface::get_agl_ft(t, alt_off, batch);
+
+  unsigned n = batch.size();
+  agl.resize(n);
+  for (unsigned i = 0; i < n; ++i) {
+    SGVec3d pt = batch.getPoint(i);
+    SGGeod geodPt = SGGeod::fromCart(SG_FEET_TO_METER*pt);
+    SGQuatd hlToEc = SGQuatd::fromLonLat(geodPt);
+    agl[i] = dot(hlToEc.rotate(SGVec3d(0, 0, 1)), batch.contact[i] - pt);
+  }
+
+  // the ground surface is set up per point by update_ground_surface(),
+  // before the forces at that point are computed
 }
 
 inline static double sqr(double x)
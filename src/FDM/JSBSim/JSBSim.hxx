@@ -216,9 +216,23 @@ public:
     bool ToggleDataLogging(bool state);
     bool ToggleDataLogging(void);
 
+    /// time the JSBSim functions of the aircraft, tree interpreter vs bytecode
+    void benchmarkFunctions(unsigned int frames) { fdmex->BenchmarkFunctions(frames); }
+
     bool get_agl_ft(double t, const double pt[3], double alt_off,
                     double contact[3], double normal[3], double vel[3],
                     double angularVel[3], double *agl);
+
+    // Batched version of the above, the points are taken from and the
+    // results are stored in the batch. Unlike the single point version
+    // this does not update the surface of FGGroundReactions, use
+    // update_ground_surface() for each point before its forces are computed.
+    void get_agl_ft(double t, double alt_off, FGGroundQueryBatch& batch,
+                    std::vector<double>& agl);
+
+    // Set up the FGGroundReactions surface from the ground material at pt
+    void update_ground_surface(const simgear::BVHMaterial* material,
+                               const double pt[3]);
 private:
     JSBSim::FGFDMExec *fdmex;
     JSBSim::FGInitialCondition *fgic;
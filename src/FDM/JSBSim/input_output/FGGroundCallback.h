@@ -38,6 +38,8 @@ SENTRY
 INCLUDES
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
 
+#include <vector>
+
 #include "simgear/structure/SGReferenced.hxx"
 #include "simgear/structure/SGSharedPtr.hxx"
 
@@ -110,6 +112,46 @@ public:
                             FGColumnVector3& w) const
   { return GetAGLevel(time, location, contact, normal, v, w); }
 
+  /** Compute the altitude above ground for several locations at once.
+      Implementations which can answer such a query faster than one
+      location at a time (e.g. by walking their terrain data only once)
+      should override this. The output vectors are resized to the number
+      of locations.
+      @param t simulation time
+      @param locations locations to query
+      @param agl altitudes above ground
+      @param contacts, normals, v, w see GetAGLevel()
+      @return false if batched queries are not supported, in which case
+              the outputs are left untouched and GetAGLevel() has to be
+              used for each location.
+   */
+  virtual bool GetAGLevels(double t, const std::vector<FGLocation>& locations,
+                           std::vector<double>& agl,
+                           std::vector<FGLocation>& contacts,
+                           std::vector<FGColumnVector3>& normals,
+                           std::vector<FGColumnVector3>& v,
+                           std::vector<FGColumnVector3>& w) const
+  { return false; }
+
+  /** Compute the altitude above ground for several locations at once, at
+      the current simulation time. See above.
+   */
+  bool GetAGLevels(const std::vector<FGLocation>& locations,
+                   std::vector<double>& agl,
+                   std::vector<FGLocation>& contacts,
+                   std::vector<FGColumnVector3>& normals,
+                   std::vector<FGColumnVector3>& v,
+                   std::vector<FGColumnVector3>& w) const
+  { return GetAGLevels(time, locations, agl, contacts, normals, v, w); }
+
+  /** Called before the contact forces at locations[index] of the last
+      GetAGLevels() call are computed. Callbacks which attach surface
+      properties (friction, bumpiness, ...) to each single ground query
+      should set them up for that location here.
+      @param index index into the locations of the last batched query
+   */
+  virtual void SelectContact(unsigned int index) const { }
+
   /** Compute the local terrain radius
       @param t simulation time
       @param location location
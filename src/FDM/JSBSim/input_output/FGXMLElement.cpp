@@ -707,4 +707,24 @@ void Element::MergeAttributes(Element* el)
   }
 }
 
+//%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+
+Element* Element::Clone(void) const
+{
+  Element* copy = new Element(name);
+
+  copy->attributes = attributes;
+  copy->data_lines = data_lines;
+  copy->file_name = file_name;
+  copy->line_number = line_number;
+
+  for (unsigned int i=0; i<children.size(); i++) {
+    Element* child = children[i]->Clone();
+    child->SetParent(copy);
+    copy->AddChildElement(child);
+  }
+
+  return copy;
+}
+
 } // end namespace JSBSim
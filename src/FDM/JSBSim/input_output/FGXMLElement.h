@@ -380,6 +380,12 @@ public:
    */
   void MergeAttributes(Element* el);
 
+  /** Makes a deep copy of this element and its children. The copy has no
+   *  parent and its element traversal counters are reset.
+   *  @return the new element, owned by the caller.
+   */
+  Element* Clone(void) const;
+
 private:
   std::string name;
   std::map <std::string, std::string> attributes;
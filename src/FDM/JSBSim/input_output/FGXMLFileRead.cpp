@@ -0,0 +1,122 @@
+/*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+
+ Module:       FGXMLFileRead.cpp
+ Author:       Jon S. Berndt
+ Date started: 02/04/07
+ Purpose:      Shared base class that wraps the XML file reading logic
+
+ ------------- Copyright (C) 2007  Jon S. Berndt (jon@jsbsim.org) -------------
+
+ This program is free software; you can redistribute it and/or modify it under
+ the terms of the GNU Lesser General Public License as published by the Free Software
+ Foundation; either version 2 of the License, or (at your option) any later
+ version.
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ details.
+
+ You should have received a copy of the GNU Lesser General Public License along with
+ this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ Place - Suite 330, Boston, MA  02111-1307, USA.
+
+ Further information about the GNU Lesser General Public License can also be found on
+ the world wide web at http://www.gnu.org.
+
+FUNCTIONAL DESCRIPTION
+--------------------------------------------------------------------------------
+Reads XML files, optionally through a process wide cache of the parsed
+documents so that several FGFDMExec instances loading the same aircraft only
+parse its files once.
+
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+INCLUDES
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
+
+#include <map>
+
+#include <simgear/threads/SGThread.hxx>
+#include <simgear/threads/SGGuard.hxx>
+
+#include "FGJSBBase.h"
+#include "FGXMLFileRead.h"
+
+using namespace std;
+
+namespace JSBSim {
+
+IDENT(IdSrc, "$Id: FGXMLFileRead.cpp $");
+IDENT(IdHdr, ID_XMLFILEREAD);
+
+namespace {
+
+// The cached documents are never handed out, only copies of them, so they
+// are not modified once they are stored.
+bool cacheEnabled = false;
+map<string, Element_ptr> documentCache;
+SGMutex cacheMutex;
+
+}
+
+/*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+CLASS IMPLEMENTATION
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
+
+Element* FGXMLFileRead::LoadXMLDocument(string XML_filename, FGXMLParse& fparse,
+                                        bool verbose)
+{
+  ifstream infile;
+
+  if ( !XML_filename.empty() ) {
+    if (XML_filename.find(".xml") == string::npos) XML_filename += ".xml";
+  } else {
+    cerr << "No filename given." << endl;
+    return 0L;
+  }
+
+  Element_ptr cached;
+  bool useCache;
+  {
+    SGGuard<SGMutex> lock(cacheMutex);
+    useCache = cacheEnabled;
+    if (useCache) {
+      map<string, Element_ptr>::const_iterator it = documentCache.find(XML_filename);
+      if (it != documentCache.end()) cached = it->second;
+    }
+  }
+
+  if (cached) {
+    document = cached->Clone();
+    return document;
+  }
+
+  infile.open(XML_filename.c_str());
+  if ( !infile.is_open()) {
+    if (verbose) cerr << "Could not open file: " << XML_filename << endl;
+    return 0L;
+  }
+
+  readXML(infile, fparse, XML_filename);
+  Element* parsed = fparse.GetDocument();
+  infile.close();
+
+  if (useCache && parsed) {
+    Element_ptr master = parsed->Clone();
+    SGGuard<SGMutex> lock(cacheMutex);
+    if (cacheEnabled) documentCache.insert(make_pair(XML_filename, master));
+  }
+
+  return parsed;
+}
+
+//%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+
+void FGXMLFileRead::UseDocumentCache(bool enable)
+{
+  SGGuard<SGMutex> lock(cacheMutex);
+  cacheEnabled = enable;
+  if (!enable) documentCache.clear();
+}
+
+}
@@ -61,33 +61,28 @@ public:
     return LoadXMLDocument(XML_filename, file_parser, verbose);
   }
 
-  Element* LoadXMLDocument(std::string XML_filename, FGXMLParse& fparse, bool verbose=true)
-  {
-    std::ifstream infile;
-
-    if ( !XML_filename.empty() ) {
-      if (XML_filename.find(".xml") == std::string::npos) XML_filename += ".xml";
-      infile.open(XML_filename.c_str());
-      if ( !infile.is_open()) {
-        if (verbose) std::cerr << "Could not open file: " << XML_filename << std::endl;
-        return 0L;
-      }
-    } else {
-      std::cerr << "No filename given." << std::endl;
-      return 0L;
-    }
-
-    readXML(infile, fparse, XML_filename);
-    Element* document = fparse.GetDocument();
-    infile.close();
-
-    return document;
-  }
-
-  void ResetParser(void) {file_parser.reset();}
+  /** Loads and parses an XML file. The returned document is owned by the
+      parser (or by this object when it comes from the document cache) and
+      remains valid until ResetParser() is called or the owner is destroyed.
+      @param XML_filename the file name, ".xml" is appended if missing
+      @param fparse the parser to use
+      @param verbose report files which can not be opened
+      @return the document root element, or 0L on failure */
+  Element* LoadXMLDocument(std::string XML_filename, FGXMLParse& fparse, bool verbose=true);
+
+  void ResetParser(void) {file_parser.reset(); document = 0L;}
+
+  /** Enables or disables the process wide document cache. When enabled each
+      file is parsed once; subsequent loads get a private copy of the parsed
+      document, since the models modify the documents they are given (e.g.
+      included files are attached to them). The cache is safe to use from
+      several threads. Disabling the cache also empties it.
+      @param enable true to cache the parsed documents */
+  static void UseDocumentCache(bool enable);
 
 private:
   FGXMLParse file_parser;
+  Element_ptr document;
 };
 }
 #endif
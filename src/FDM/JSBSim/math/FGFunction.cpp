@@ -32,6 +32,8 @@ INCLUDES
 #include <iomanip>
 #include <cstdlib>
 #include <cmath>
+#include <map>
+#include <utility>
 
 #include "FGFunction.h"
 #include "FGTable.h"
@@ -50,6 +52,85 @@ IDENT(IdHdr,ID_FUNCTION);
 CLASS IMPLEMENTATION
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
 
+// The compiled form of a function tree. Registers holding constants are set
+// up once by the compiler and never written by the program; the property
+// loads shared by the whole tree are collected in a prologue which is placed
+// in front of the code once compilation is complete.
+
+struct FGFunction::Program
+{
+  std::vector<Instruction> code;
+  std::vector<Instruction> prologue;
+  std::vector<double> registers;
+  std::map<std::pair<FGPropertyNode*, int>, unsigned int> loads;
+  std::vector<FGPropertyNode_ptr> nodes; // keeps the loaded nodes alive
+  unsigned int result;
+
+  unsigned int Register(double value = 0.0)
+  {
+    registers.push_back(value);
+    return registers.size() - 1;
+  }
+
+  size_t Emit(opCode op, unsigned int dst, unsigned int a = 0,
+              unsigned int b = 0, unsigned int c = 0,
+              const FGParameter* param = 0, FGPropertyNode* node = 0)
+  {
+    Instruction i = {op, dst, a, b, c, param, node};
+    code.push_back(i);
+    return code.size() - 1;
+  }
+
+  // Jump to the end of the code emitted so far.
+  void Patch(size_t jump) { code[jump].dst = code.size(); }
+
+  // Reads of a property in code which always runs are hoisted to the
+  // prologue and shared; reads in conditionally executed code are only
+  // shared with the hoisted ones.
+  unsigned int Load(FGPropertyNode* node, int sign, bool conditional)
+  {
+    std::pair<FGPropertyNode*, int> key(node, sign);
+    std::map<std::pair<FGPropertyNode*, int>, unsigned int>::iterator it = loads.find(key);
+    if (it != loads.end()) return it->second;
+
+    unsigned int dst = Register();
+    Instruction i = {sign < 0 ? opLoadNeg : opLoad, dst, 0, 0, 0, 0, node};
+    if (conditional) {
+      code.push_back(i);
+    } else {
+      prologue.push_back(i);
+      loads[key] = dst;
+    }
+    nodes.push_back(node);
+    return dst;
+  }
+
+  void Link(void)
+  {
+    for (unsigned int i=0; i<code.size(); i++) {
+      if (code[i].op == opJump || code[i].op == opJumpZero || code[i].op == opJumpNonZero)
+        code[i].dst += prologue.size();
+    }
+    code.insert(code.begin(), prologue.begin(), prologue.end());
+    prologue.clear();
+    loads.clear();
+  }
+};
+
+namespace {
+
+bool IsConstantParameter(const FGParameter* param)
+{
+  if (dynamic_cast<const FGRealValue*>(param)) return true;
+
+  const FGFunction* f = dynamic_cast<const FGFunction*>(param);
+  return f && f->IsConstant();
+}
+
+}
+
+bool FGFunction::useBytecode = true;
+
 const std::string FGFunction::property_string = "property";
 const std::string FGFunction::value_string = "value";
 const std::string FGFunction::table_string = "table";
@@ -117,6 +198,8 @@ FGFunction::FGFunction(FGPropertyManager* propMan, Element* el, const string& pr
   cachedValue = -HUGE_VAL;
   invlog2val = 1.0/log10(2.0);
   pCopyTo = 0L;
+  program = 0L;
+  compiled = false;
 
   Name = el->GetAttributeValue("name");
   operation = el->GetName();
@@ -333,6 +416,7 @@ FGFunction::FGFunction(FGPropertyManager* propMan, Element* el, const string& pr
 FGFunction::~FGFunction(void)
 {
   for (unsigned int i=0; i<Parameters.size(); i++) delete Parameters[i];
+  delete program;
 }
 
 //%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
@@ -362,13 +446,25 @@ unsigned int FGFunction::GetBinary(double val) const
 //%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 
 double FGFunction::GetValue(void) const
+{
+  if (cached) return cachedValue;
+
+  if (useBytecode) {
+    if (!compiled) Compile();
+    if (program) return Execute();
+  }
+
+  return EvaluateTree();
+}
+
+//%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+
+double FGFunction::EvaluateTree(void) const
 {
   unsigned int i;
   double scratch;
   double temp=0;
 
-  if (cached) return cachedValue;
-
   if (   Type != eRandom
       && Type != eUrandom
       && Type != ePi      ) temp = Parameters[0]->GetValue();
@@ -772,6 +868,353 @@ double FGFunction::GetValue(void) const
   return temp;
 }
 
+//%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+// Runs the compiled program. Each instruction computes exactly what the tree
+// interpreter computes for the corresponding node, so both give the same
+// results.
+
+double FGFunction::Execute(void) const
+{
+  double* r = &program->registers[0];
+  const Instruction* code = program->code.empty() ? 0 : &program->code[0];
+  unsigned int n = program->code.size();
+  unsigned int pc = 0;
+  double scratch;
+
+  while (pc < n) {
+    const Instruction& in = code[pc++];
+
+    switch (in.op) {
+    case opLoad:        r[in.dst] = in.node->getDoubleValue(); break;
+    case opLoadNeg:     r[in.dst] = -in.node->getDoubleValue(); break;
+    case opParam:       r[in.dst] = in.param->GetValue(); break;
+    case opStore:       in.node->setDoubleValue(r[in.a]); break;
+    case opMove:        r[in.dst] = r[in.a]; break;
+    case opJump:        pc = in.dst; break;
+    case opJumpZero:    if (r[in.a] == 0.0) pc = in.dst; break;
+    case opJumpNonZero: if (r[in.a] != 0.0) pc = in.dst; break;
+    case opAdd:         r[in.dst] = r[in.a] + r[in.b]; break;
+    case opSub:         r[in.dst] = r[in.a] - r[in.b]; break;
+    case opMul:         r[in.dst] = r[in.a] * r[in.b]; break;
+    case opDiv:         r[in.dst] = r[in.a] / r[in.b]; break;
+    case opQuotient:
+      r[in.dst] = (r[in.b] != 0.0) ? r[in.a] / r[in.b] : HUGE_VAL;
+      break;
+    case opPow:         r[in.dst] = pow(r[in.a], r[in.b]); break;
+    case opATan2:       r[in.dst] = atan2(r[in.a], r[in.b]); break;
+    case opMod:         r[in.dst] = ((int)r[in.a]) % ((int)r[in.b]); break;
+    case opMin:         r[in.dst] = (r[in.b] < r[in.a]) ? r[in.b] : r[in.a]; break;
+    case opMax:         r[in.dst] = (r[in.b] > r[in.a]) ? r[in.b] : r[in.a]; break;
+    case opLT:          r[in.dst] = (r[in.a] < r[in.b]) ? 1 : 0; break;
+    case opLE:          r[in.dst] = (r[in.a] <= r[in.b]) ? 1 : 0; break;
+    case opGT:          r[in.dst] = (r[in.a] > r[in.b]) ? 1 : 0; break;
+    case opGE:          r[in.dst] = (r[in.a] >= r[in.b]) ? 1 : 0; break;
+    case opEQ:          r[in.dst] = (r[in.a] == r[in.b]) ? 1 : 0; break;
+    case opNE:          r[in.dst] = (r[in.a] != r[in.b]) ? 1 : 0; break;
+    case opSqrt:        r[in.dst] = sqrt(r[in.a]); break;
+    case opExp:         r[in.dst] = exp(r[in.a]); break;
+    case opLog2:
+      r[in.dst] = (r[in.a] > 0.00) ? log10(r[in.a])*invlog2val : -HUGE_VAL;
+      break;
+    case opLn:          r[in.dst] = (r[in.a] > 0.00) ? log(r[in.a]) : -HUGE_VAL; break;
+    case opLog10:       r[in.dst] = (r[in.a] > 0.00) ? log10(r[in.a]) : -HUGE_VAL; break;
+    case opAbs:         r[in.dst] = fabs(r[in.a]); break;
+    case opSign:        r[in.dst] = r[in.a] < 0 ? -1 : 1; break;
+    case opSin:         r[in.dst] = sin(r[in.a]); break;
+    case opCos:         r[in.dst] = cos(r[in.a]); break;
+    case opTan:         r[in.dst] = tan(r[in.a]); break;
+    case opASin:        r[in.dst] = asin(r[in.a]); break;
+    case opACos:        r[in.dst] = acos(r[in.a]); break;
+    case opATan:        r[in.dst] = atan(r[in.a]); break;
+    case opFrac:        r[in.dst] = modf(r[in.a], &scratch); break;
+    case opInteger:
+      modf(r[in.a], &scratch);
+      r[in.dst] = scratch;
+      break;
+    case opRandom:      r[in.dst] = GaussianRandomNumber(); break;
+    case opUrandom:
+      r[in.dst] = -1.0 + (((double)rand()/double(RAND_MAX))*2.0);
+      break;
+    case opBool:        r[in.dst] = GetBinary(r[in.a]); break;
+    case opNot:         r[in.dst] = (GetBinary(r[in.a]) != 0) ? 0 : 1; break;
+    case opTable1:
+      r[in.dst] = static_cast<const FGTable*>(in.param)->GetValue(r[in.a]);
+      break;
+    case opTable2:
+      r[in.dst] = static_cast<const FGTable*>(in.param)->GetValue(r[in.a], r[in.b]);
+      break;
+    case opTable3:
+      r[in.dst] = static_cast<const FGTable*>(in.param)->GetValue(r[in.a], r[in.b], r[in.c]);
+      break;
+    }
+  }
+
+  return r[program->result];
+}
+
+//%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+
+void FGFunction::Compile(void) const
+{
+  compiled = true;
+  // constant functions are folded into the program of their caller, or left
+  // to the interpreter at top level
+  if (!IsCompilable() || IsConstant()) return;
+
+  Program* prog = new Program;
+  prog->result = CompileFunction(*prog, false);
+  prog->Link();
+  program = prog;
+}
+
+//%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+// The operations below are left to the tree interpreter; inside a compiled
+// program they are evaluated with an opParam instruction.
+
+bool FGFunction::IsCompilable(void) const
+{
+  switch (Type) {
+  case eSwitch:
+  case eInterpolate1D:
+  case eRotation_alpha_local:
+  case eRotation_beta_local:
+  case eRotation_gamma_local:
+  case eRotation_bf_to_wf:
+  case eRotation_wf_to_bf:
+    return false;
+  case eIfThen:
+    return Parameters.size() == 3; // else leave the error to the interpreter
+  default:
+    return true;
+  }
+}
+
+//%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+
+bool FGFunction::IsConstant(void) const
+{
+  if (Type == eTopLevel || Type == eRandom || Type == eUrandom) return false;
+
+  for (unsigned int i=0; i<Parameters.size(); i++) {
+    if (!IsConstantParameter(Parameters[i])) return false;
+  }
+
+  return true;
+}
+
+//%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+// Evaluates a constant parameter; constant functions are never compiled (see
+// Compile()) so this runs the tree interpreter. Fails if the evaluation
+// throws, in which case the parameter is compiled as usual so that the error
+// is raised at run time.
+
+bool FGFunction::FoldConstant(const FGParameter* param, double& value)
+{
+  try {
+    value = param->GetValue();
+  } catch (...) {
+    return false;
+  }
+
+  return true;
+}
+
+//%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+
+unsigned int FGFunction::CompileParameter(Program& prog, const FGParameter* param,
+                                          bool conditional) const
+{
+  double value;
+  if (IsConstantParameter(param) && FoldConstant(param, value))
+    return prog.Register(value);
+
+  const FGPropertyValue* pv = dynamic_cast<const FGPropertyValue*>(param);
+  if (pv) {
+    FGPropertyNode* node = pv->GetResolvedNode();
+    if (node) return prog.Load(node, pv->GetSign(), conditional);
+  }
+
+  const FGTable* table = dynamic_cast<const FGTable*>(param);
+  if (table) {
+    unsigned int nkeys = table->GetNumKeys();
+    unsigned int keys[3] = {0, 0, 0};
+    bool bound = true;
+    for (unsigned int i=0; i<nkeys && bound; i++) {
+      FGPropertyNode* node = table->GetLookupProperty(i);
+      if (node) keys[i] = prog.Load(node, 1, conditional);
+      else bound = false;
+    }
+    if (bound) {
+      unsigned int dst = prog.Register();
+      prog.Emit(opCode(opTable1 + nkeys - 1), dst, keys[0], keys[1], keys[2], table);
+      return dst;
+    }
+  }
+
+  const FGFunction* f = dynamic_cast<const FGFunction*>(param);
+  if (f && f->IsCompilable()) return f->CompileFunction(prog, conditional);
+
+  // late bound properties which are not bound yet, tables without lookup
+  // properties and the operations left to the interpreter
+  unsigned int dst = prog.Register();
+  prog.Emit(opParam, dst, 0, 0, 0, param);
+  return dst;
+}
+
+//%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+// Sum, difference, product, min and max are evaluated from left to right;
+// only a constant leading run of arguments is folded, so the folded program
+// rounds exactly like the interpreter.
+
+unsigned int FGFunction::CompileSeries(Program& prog, opCode op, bool conditional) const
+{
+  unsigned int i = 1, r;
+  double acc, value;
+
+  if (IsConstantParameter(Parameters[0]) && FoldConstant(Parameters[0], acc)) {
+    for (; i<Parameters.size(); i++) {
+      if (!IsConstantParameter(Parameters[i]) || !FoldConstant(Parameters[i], value))
+        break;
+      switch (op) {
+      case opAdd: acc += value; break;
+      case opSub: acc -= value; break;
+      case opMul: acc *= value; break;
+      case opMin: if (value < acc) acc = value; break;
+      case opMax: if (value > acc) acc = value; break;
+      default: break;
+      }
+    }
+    r = prog.Register(acc);
+  } else {
+    r = CompileParameter(prog, Parameters[0], conditional);
+  }
+
+  for (; i<Parameters.size(); i++) {
+    unsigned int a = CompileParameter(prog, Parameters[i], conditional);
+    unsigned int dst = prog.Register();
+    prog.Emit(op, dst, r, a);
+    r = dst;
+  }
+
+  return r;
+}
+
+//%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+// Compiles the function into prog and returns the register holding its value.
+// Arguments are evaluated in the order the interpreter evaluates them;
+// conditional is set for code which is only run depending on a condition
+// (the branches of ifthen, and the short circuited arguments of and / or).
+
+unsigned int FGFunction::CompileFunction(Program& prog, bool conditional) const
+{
+  opCode op;
+  unsigned int dst, a, b;
+  size_t jump;
+  std::vector<size_t> jumps;
+
+  switch (Type) {
+  case eTopLevel:
+    a = CompileParameter(prog, Parameters[0], conditional);
+    if (pCopyTo) prog.Emit(opStore, 0, a, 0, 0, 0, pCopyTo);
+    return a;
+  case eProduct:    return CompileSeries(prog, opMul, conditional);
+  case eDifference: return CompileSeries(prog, opSub, conditional);
+  case eSum:        return CompileSeries(prog, opAdd, conditional);
+  case eMin:        return CompileSeries(prog, opMin, conditional);
+  case eMax:        return CompileSeries(prog, opMax, conditional);
+  case eAvg:
+    a = CompileSeries(prog, opAdd, conditional);
+    dst = prog.Register();
+    prog.Emit(opDiv, dst, a, prog.Register(Parameters.size()));
+    return dst;
+  case eToRadians:
+  case eToDegrees:
+    a = CompileParameter(prog, Parameters[0], conditional);
+    dst = prog.Register();
+    prog.Emit(opMul, dst, a, prog.Register(Type == eToRadians ? M_PI/180.0 : 180.0/M_PI));
+    return dst;
+  case eRandom:
+  case eUrandom:
+    dst = prog.Register();
+    prog.Emit(Type == eRandom ? opRandom : opUrandom, dst);
+    return dst;
+  case ePi:
+    return prog.Register(M_PI);
+  case eAND:
+  case eOR:
+    dst = prog.Register();
+    a = CompileParameter(prog, Parameters[0], conditional);
+    prog.Emit(opBool, dst, a);
+    for (unsigned int i=1; i<Parameters.size(); i++) {
+      jumps.push_back(prog.Emit(Type == eAND ? opJumpZero : opJumpNonZero, 0, dst));
+      a = CompileParameter(prog, Parameters[i], true);
+      prog.Emit(opBool, dst, a);
+    }
+    for (unsigned int i=0; i<jumps.size(); i++) prog.Patch(jumps[i]);
+    return dst;
+  case eNOT:
+    a = CompileParameter(prog, Parameters[0], conditional);
+    dst = prog.Register();
+    prog.Emit(opNot, dst, a);
+    return dst;
+  case eIfThen:
+    dst = prog.Register();
+    a = CompileParameter(prog, Parameters[0], conditional);
+    prog.Emit(opBool, dst, a);
+    jump = prog.Emit(opJumpZero, 0, dst);
+    a = CompileParameter(prog, Parameters[1], true);
+    prog.Emit(opMove, dst, a);
+    jumps.push_back(prog.Emit(opJump, 0));
+    prog.Patch(jump);
+    a = CompileParameter(prog, Parameters[2], true);
+    prog.Emit(opMove, dst, a);
+    prog.Patch(jumps[0]);
+    return dst;
+  default:
+    break;
+  }
+
+  // unary and binary operations
+  switch (Type) {
+  case eQuotient: op = opQuotient; break;
+  case ePow:      op = opPow; break;
+  case eATan2:    op = opATan2; break;
+  case eMod:      op = opMod; break;
+  case eLT:       op = opLT; break;
+  case eLE:       op = opLE; break;
+  case eGT:       op = opGT; break;
+  case eGE:       op = opGE; break;
+  case eEQ:       op = opEQ; break;
+  case eNE:       op = opNE; break;
+  case eSqrt:     op = opSqrt; break;
+  case eExp:      op = opExp; break;
+  case eLog2:     op = opLog2; break;
+  case eLn:       op = opLn; break;
+  case eLog10:    op = opLog10; break;
+  case eAbs:      op = opAbs; break;
+  case eSign:     op = opSign; break;
+  case eSin:      op = opSin; break;
+  case eCos:      op = opCos; break;
+  case eTan:      op = opTan; break;
+  case eASin:     op = opASin; break;
+  case eACos:     op = opACos; break;
+  case eATan:     op = opATan; break;
+  case eFrac:     op = opFrac; break;
+  case eInteger:  op = opInteger; break;
+  default:
+    // not compilable, see IsCompilable()
+    dst = prog.Register();
+    prog.Emit(opParam, dst, 0, 0, 0, this);
+    return dst;
+  }
+
+  a = CompileParameter(prog, Parameters[0], conditional);
+  b = (op >= opQuotient && op <= opNE) ? CompileParameter(prog, Parameters[1], conditional) : 0;
+  dst = prog.Register();
+  prog.Emit(op, dst, a, b);
+  return dst;
+}
+
 //%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 
 string FGFunction::GetValueAsString(void) const
@@ -153,6 +153,13 @@ element contains all three. What is evaluated is written algebraically as:
 
 @code 3.14159 + qbar + (0.125 * wingarea) @endcode
 
+On its first evaluation a function tree is compiled to a flat, register based
+bytecode: constant subexpressions are folded, each bound property is read once
+per evaluation however often it appears in the tree, and tables are looked up
+with the keys read by the same property loads. Operations which are not
+compiled (switch, interpolate1d, the rotations, and properties which are still
+unbound) are evaluated by the tree interpreter from within the program.
+
 Some operations can take only a single argument. That argument, however, can be
 an operation (such as sum) which can contain other items. The point to keep in
 mind is that it evaluates to a single value - which is just what the trigonometric
@@ -738,7 +745,31 @@ public:
     @param shouldCache specifies whether the function should cache the computed value. */
   void cacheValue(bool shouldCache);
 
+/** Selects between the compiled bytecode (the default) and the tree
+    interpreter for all functions, for benchmarking and comparison.
+    @param use true to evaluate functions with their compiled bytecode. */
+  static void UseBytecode(bool use) {useBytecode = use;}
+
+/** Checks whether the function evaluates to a constant, i.e. it depends on
+    neither properties, tables nor random numbers.
+    @return true if the function value is constant. */
+  bool IsConstant(void) const;
+
 private:
+  enum opCode {opLoad, opLoadNeg, opParam, opStore, opMove, opJump, opJumpZero,
+               opJumpNonZero, opAdd, opSub, opMul, opDiv, opQuotient, opPow,
+               opATan2, opMod, opMin, opMax, opLT, opLE, opGT, opGE, opEQ, opNE,
+               opSqrt, opExp, opLog2, opLn, opLog10, opAbs, opSign, opSin, opCos,
+               opTan, opASin, opACos, opATan, opFrac, opInteger, opRandom,
+               opUrandom, opBool, opNot, opTable1, opTable2, opTable3};
+  struct Instruction {
+    opCode op;
+    unsigned int dst, a, b, c;    // register indices, or jump target in dst
+    const FGParameter* param;     // for opParam and opTable*
+    FGPropertyNode* node;         // for opLoad, opLoadNeg and opStore
+  };
+  struct Program;
+
   std::vector <FGParameter*> Parameters;
   FGPropertyManager* const PropertyManager;
   bool cached;
@@ -811,7 +842,20 @@ private:
   std::string sCopyTo;        // Property name to copy function value to
   FGPropertyNode_ptr pCopyTo; // Property node for CopyTo property string
 
+  mutable Program* program;   // compiled on the first evaluation
+  mutable bool compiled;
+  static bool useBytecode;
+
   unsigned int GetBinary(double) const;
+  double EvaluateTree(void) const;
+  double Execute(void) const;
+  void Compile(void) const;
+  bool IsCompilable(void) const;
+  unsigned int CompileFunction(Program& prog, bool conditional) const;
+  unsigned int CompileSeries(Program& prog, opCode op, bool conditional) const;
+  unsigned int CompileParameter(Program& prog, const FGParameter* param,
+                                bool conditional) const;
+  static bool FoldConstant(const FGParameter* param, double& value);
   void bind(void);
   void Debug(int from);
 };
@@ -41,6 +41,8 @@ INCLUDES
 #include <sstream>
 #include <string>
 
+#include <simgear/timing/timestamp.hxx>
+
 #include "FGModelFunctions.h"
 #include "FGFunction.h"
 #include "input_output/FGXMLElement.h"
@@ -123,10 +125,7 @@ void FGModelFunctions::PostLoad(Element* el, FGPropertyManager* PM, string prefi
 
 void FGModelFunctions::RunPreFunctions(void)
 {
-  size_t sz = PreFunctions.size();
-  for (unsigned int i=0; i<sz; i++) {
-    PreFunctions[i]->cacheValue(true);
-  }
+  RunFunctions(PreFunctions);
 }
 
 //%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
@@ -137,10 +136,35 @@ void FGModelFunctions::RunPreFunctions(void)
 
 void FGModelFunctions::RunPostFunctions(void)
 {
-  size_t sz = PostFunctions.size();
+  RunFunctions(PostFunctions);
+}
+
+//%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+
+double FGModelFunctions::RunFunctions(const vector<FGFunction*>& functions)
+{
+  double sum = 0.0;
+  size_t sz = functions.size();
+  if (sz == 0) return sum;
+
+  SGTimeStamp start = SGTimeStamp::now();
   for (unsigned int i=0; i<sz; i++) {
-    PostFunctions[i]->cacheValue(true);
+    functions[i]->cacheValue(true);
+    sum += functions[i]->GetValue();
   }
+
+  FunctionTime += (SGTimeStamp::now() - start).toSecs();
+  FunctionEvaluations += sz;
+
+  return sum;
+}
+
+//%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+
+void FGModelFunctions::GetFunctions(vector<FGFunction*>& functions) const
+{
+  functions.insert(functions.end(), PreFunctions.begin(), PreFunctions.end());
+  functions.insert(functions.end(), PostFunctions.begin(), PostFunctions.end());
 }
 
 //%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
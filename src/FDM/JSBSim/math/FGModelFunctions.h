@@ -81,6 +81,7 @@ DECLARATION: FGModelFunctions
 class FGModelFunctions : public FGJSBBase
 {
 public:
+  FGModelFunctions() : FunctionEvaluations(0), FunctionTime(0.0) {}
   virtual ~FGModelFunctions();
   void RunPreFunctions(void);
   void RunPostFunctions(void);
@@ -105,9 +106,27 @@ public:
    */
   FGFunction* GetPreFunction(const std::string& name);
 
+  /// Number of function evaluations run by the model so far.
+  long GetFunctionEvaluations(void) const {return FunctionEvaluations;}
+
+  /// Wall clock time spent in these evaluations, in seconds.
+  double GetFunctionTime(void) const {return FunctionTime;}
+
+  /** Appends the functions evaluated by the model every frame to a list.
+      @param functions the list the functions are appended to. */
+  virtual void GetFunctions(std::vector<FGFunction*>& functions) const;
+
 protected:
   std::vector <FGFunction*> PreFunctions;
   std::vector <FGFunction*> PostFunctions;
+  long FunctionEvaluations;
+  double FunctionTime;
+
+  /** Evaluates the functions of a list and caches their values for the
+      frame, accounting for the evaluations in the model counters.
+      @param functions the list of functions to evaluate.
+      @return the sum of the function values */
+  double RunFunctions(const std::vector<FGFunction*>& functions);
   FGPropertyReader LocalProperties;
 
   virtual bool InitModel(void);
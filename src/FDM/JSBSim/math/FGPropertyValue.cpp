@@ -81,6 +81,15 @@ double FGPropertyValue::GetValue(void) const
 
 //%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 
+FGPropertyNode* FGPropertyValue::GetResolvedNode(void) const
+{
+  if (PropertyNode) return PropertyNode;
+
+  return PropertyManager->GetNode(PropertyName);
+}
+
+//%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+
 std::string FGPropertyValue::GetName(void) const
 {
   if (PropertyNode) {
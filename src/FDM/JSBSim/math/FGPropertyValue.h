@@ -75,6 +75,11 @@ public:
 
   std::string GetName(void) const;
 
+  /** The node the value is read from. For late bound properties, the node is
+      looked up by name; NULL is returned if it does not exist yet. */
+  FGPropertyNode* GetResolvedNode(void) const;
+  int GetSign(void) const {return Sign;}
+
 private:
   FGPropertyManager* PropertyManager; // Property root used to do late binding.
   FGPropertyNode_ptr PropertyNode;
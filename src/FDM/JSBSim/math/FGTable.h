@@ -295,6 +295,12 @@ public:
 
   unsigned int GetNumRows() const {return nRows;}
 
+  /// The number of lookup keys of the table (1 to 3).
+  unsigned int GetNumKeys() const {return (unsigned int)Type + 1;}
+  /** The property providing the row (0), column (1) or table (2) key; NULL
+      for tables without lookup properties. */
+  FGPropertyNode* GetLookupProperty(unsigned int axis) const {return lookupProperty[axis];}
+
   void Print(void);
 
   std::string GetName(void) const {return Name;}
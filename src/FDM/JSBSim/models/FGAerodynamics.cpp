@@ -191,23 +191,12 @@ bool FGAerodynamics::Run(bool Holding)
   vFnativeAtCG.InitMatrix();
 
   for (axis_ctr = 0; axis_ctr < 3; ++axis_ctr) {
-    AeroFunctionArray::iterator f;
-
-    AeroFunctionArray* array = &AeroFunctions[axis_ctr];
-    for (f=array->begin(); f != array->end(); ++f) {
-      // Tell the Functions to cache values, so when the function values are
-      // being requested for output, the functions do not get calculated again
-      // in a context that might have changed, but instead use the values that
-      // have already been calculated for this frame.
-      (*f)->cacheValue(true);
-      vFnative(axis_ctr+1) += (*f)->GetValue();
-    }
-
-    array = &AeroFunctionsAtCG[axis_ctr];
-    for (f=array->begin(); f != array->end(); ++f) {
-      (*f)->cacheValue(true); // Same as above
-      vFnativeAtCG(axis_ctr+1) += (*f)->GetValue();
-    }
+    // The Functions cache their values, so when the function values are
+    // being requested for output, the functions do not get calculated again
+    // in a context that might have changed, but instead use the values that
+    // have already been calculated for this frame.
+    vFnative(axis_ctr+1) += RunFunctions(AeroFunctions[axis_ctr]);
+    vFnativeAtCG(axis_ctr+1) += RunFunctions(AeroFunctionsAtCG[axis_ctr]);
   }
 
   // Note that we still need to convert to wind axes here, because it is
@@ -277,15 +266,8 @@ bool FGAerodynamics::Run(bool Holding)
   vMomentsMRC.InitMatrix();
 
   for (axis_ctr = 0; axis_ctr < 3; axis_ctr++) {
-    AeroFunctionArray* array = &AeroFunctions[axis_ctr+3];
-    for (AeroFunctionArray::iterator f=array->begin(); f != array->end(); ++f) {
-      // Tell the Functions to cache values, so when the function values are
-      // being requested for output, the functions do not get calculated again
-      // in a context that might have changed, but instead use the values that
-      // have already been calculated for this frame.
-      (*f)->cacheValue(true);
-      vMomentsMRC(axis_ctr+1) += (*f)->GetValue();
-    }
+    // The Functions cache their values, see above.
+    vMomentsMRC(axis_ctr+1) += RunFunctions(AeroFunctions[axis_ctr+3]);
   }
   vMoments = vMomentsMRC + vDXYZcg*vForces; // M = r X F
   // Now add the "at CG" values to base forces - after the moments have been transferred
@@ -433,6 +415,18 @@ void FGAerodynamics::DetermineAxisSystem(Element* document)
 
 //%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 
+void FGAerodynamics::GetFunctions(vector<FGFunction*>& functions) const
+{
+  FGModelFunctions::GetFunctions(functions);
+
+  for (unsigned int axis = 0; axis < 6; axis++) {
+    functions.insert(functions.end(), AeroFunctions[axis].begin(), AeroFunctions[axis].end());
+    functions.insert(functions.end(), AeroFunctionsAtCG[axis].begin(), AeroFunctionsAtCG[axis].end());
+  }
+}
+
+//%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+
 string FGAerodynamics::GetAeroFunctionStrings(const string& delimeter) const
 {
   string AeroFunctionStrings = "";
@@ -212,6 +212,10 @@ public:
 
   std::vector <FGFunction*> * GetAeroFunctions(void) const { return AeroFunctions; }
 
+  /** Appends the pre/post functions and the aero functions to a list.
+      @param functions the list the functions are appended to. */
+  void GetFunctions(std::vector<FGFunction*>& functions) const;
+
   struct Inputs {
     double Alpha;
     double Beta;
@@ -42,6 +42,7 @@ INCLUDES
 #include "FGLGear.h"
 #include "FGAccelerations.h"
 #include "input_output/FGPropertyManager.h"
+#include "input_output/FGGroundCallback.h"
 #include "input_output/FGXMLElement.h"
 
 using namespace std;
@@ -58,7 +59,8 @@ CLASS IMPLEMENTATION
 FGGroundReactions::FGGroundReactions(FGFDMExec* fgex) :
    FGModel(fgex),
    FGSurface(fgex),
-   DsCmd(0.0)
+   DsCmd(0.0),
+   queryBatched(false)
 {
   Name = "FGGroundReactions";
 
@@ -109,12 +111,19 @@ bool FGGroundReactions::Run(bool Holding)
 
   multipliers.clear();
 
+  QueryGround();
+
   // Sum forces and moments for all gear, here.
   // Some optimizations may be made here - or rather in the gear code itself.
   // The gear ::Run() method is called several times - once for each gear.
   // Perhaps there is some commonality for things which only need to be
   // calculated once.
+  unsigned int query = 0;
   for (unsigned int i=0; i<lGear.size(); i++) {
+    // The surface of a batched contact is set up just before its forces are
+    // computed, as a single ground query would do.
+    if (queryBatched && query < queryGear.size() && queryGear[query] == i)
+      FGLocation::GetGroundCallback()->SelectContact(query++);
     vForces  += lGear[i]->GetBodyForces(this);
     vMoments += lGear[i]->GetMoments();
   }
@@ -124,6 +133,39 @@ bool FGGroundReactions::Run(bool Holding)
   return false;
 }
 
+//%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+// Ask the ground callback for the ground below all extended gears in one
+// go. If the callback does not support batched queries, each gear queries
+// the ground on its own in GetBodyForces().
+
+void FGGroundReactions::QueryGround(void)
+{
+  queryBatched = false;
+  queryGear.clear();
+  queryLocations.clear();
+
+  FGLocation gearLoc;
+  for (unsigned int i=0; i<lGear.size(); i++) {
+    if (lGear[i]->GetGearLocation(gearLoc)) {
+      queryGear.push_back(i);
+      queryLocations.push_back(gearLoc);
+    }
+  }
+
+  if (queryGear.size() < 2) return;
+
+  if (!FGLocation::GetGroundCallback()->GetAGLevels(queryLocations, queryAGL,
+                                                    queryContacts, queryNormals,
+                                                    queryVel, queryAngularVel))
+    return;
+
+  queryBatched = true;
+
+  for (unsigned int i=0; i<queryGear.size(); i++)
+    lGear[queryGear[i]]->SetGroundContact(queryAGL[i], queryContacts[i],
+                                          queryNormals[i], queryVel[i]);
+}
+
 //%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 
 bool FGGroundReactions::GetWOW(void) const
@@ -129,6 +129,17 @@ private:
   std::vector <LagrangeMultiplier*> multipliers;
   double DsCmd;
 
+  // Scratch space for the batched ground query of all gears
+  std::vector <unsigned int> queryGear;
+  std::vector <FGLocation> queryLocations;
+  std::vector <double> queryAGL;
+  std::vector <FGLocation> queryContacts;
+  std::vector <FGColumnVector3> queryNormals;
+  std::vector <FGColumnVector3> queryVel;
+  std::vector <FGColumnVector3> queryAngularVel;
+  bool queryBatched;
+
+  void QueryGround(void);
   void bind(void);
   void Debug(int from);
 };
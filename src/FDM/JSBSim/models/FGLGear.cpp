@@ -249,6 +249,8 @@ void FGLGear::ResetToIC(void)
   GearPos  = 1.0;
 
   WOW = lastWOW = false;
+  haveGroundContact = false;
+  groundHeight = 0.0;
   FirstContact = false;
   StartedGroundRun = false;
   LandingDistanceTraveled = TakeoffDistanceTraveled = TakeoffDistanceTraveled50ft = 0.0;
@@ -276,6 +278,30 @@ void FGLGear::ResetToIC(void)
 
 //%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 
+bool FGLGear::GetGearLocation(FGLocation& gearLoc) const
+{
+  if (isRetractable && GetGearUnitPos() <= 0.99) return false;
+
+  FGColumnVector3 vWhlBodyVec = Ts2b * (vXYZn - in.vXYZcg);
+  gearLoc = in.Location.LocalToLocation(in.Tb2l * vWhlBodyVec);
+  return true;
+}
+
+//%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+
+void FGLGear::SetGroundContact(double height, const FGLocation& contact,
+                               const FGColumnVector3& normal,
+                               const FGColumnVector3& terrainVel)
+{
+  haveGroundContact = true;
+  groundHeight = height;
+  groundContact = contact;
+  groundNormal = normal;
+  groundVel = terrainVel;
+}
+
+//%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+
 const FGColumnVector3& FGLGear::GetBodyForces(FGSurface *surface)
 {
   double gearPos = 1.0;
@@ -293,8 +319,17 @@ const FGColumnVector3& FGLGear::GetBodyForces(FGSurface *surface)
     gearLoc = in.Location.LocalToLocation(vLocalGear);
 
     // Compute the height of the theoretical location of the wheel (if strut is
-    // not compressed) with respect to the ground level
-    double height = gearLoc.GetContactPoint(contact, normal, terrainVel, dummy);
+    // not compressed) with respect to the ground level. FGGroundReactions may
+    // already have queried the ground for all gears at once.
+    double height;
+    if (haveGroundContact) {
+      height = groundHeight;
+      contact = groundContact;
+      normal = groundNormal;
+      terrainVel = groundVel;
+      haveGroundContact = false;
+    } else
+      height = gearLoc.GetContactPoint(contact, normal, terrainVel, dummy);
 
     // Does this surface contact point interact with another surface?
     if (surface) {
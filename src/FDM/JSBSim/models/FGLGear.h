@@ -241,6 +241,23 @@ public:
    */
   const FGColumnVector3& GetBodyForces(FGSurface *surface = NULL);
 
+  /** Gets the location of the wheel (with the strut not compressed).
+      @param gearLoc set to the location of the wheel
+      @return false if the gear is not down, in which case it does not
+              need a ground query. */
+  bool GetGearLocation(FGLocation& gearLoc) const;
+
+  /** Provide the ground below the wheel, as found by a batched query of
+      all gears in FGGroundReactions. The next call to GetBodyForces() then
+      uses it instead of querying the ground on its own.
+      @param height height of the wheel above the ground
+      @param contact contact point on the ground
+      @param normal ground normal at the contact point
+      @param terrainVel ground velocity at the contact point */
+  void SetGroundContact(double height, const FGLocation& contact,
+                        const FGColumnVector3& normal,
+                        const FGColumnVector3& terrainVel);
+
   /// Gets the location of the gear in Body axes
   FGColumnVector3 GetBodyLocation(void) const {
     return Ts2b * (vXYZn - in.vXYZcg);
@@ -353,6 +370,11 @@ private:
   double FCoeff;
   double WheelSlip;
   double GearPos;
+  bool haveGroundContact;
+  double groundHeight;
+  FGLocation groundContact;
+  FGColumnVector3 groundNormal;
+  FGColumnVector3 groundVel;
   bool WOW;
   bool lastWOW;
   bool FirstContact;
@@ -57,6 +57,7 @@ Airplane::Airplane()
     _tailIncidence = 0;
 
     _failureMsg = 0;
+    _haveSolution = false;
 }
 
 Airplane::~Airplane()
@@ -436,6 +437,26 @@ int Airplane::getSolutionIterations()
     return _solutionIterations;
 }
 
+void Airplane::setSolution(const Solution& s)
+{
+    _solution = s;
+    _haveSolution = true;
+}
+
+bool Airplane::getSolution(Solution* out)
+{
+    if(_failureMsg || !_wing || !_tail)
+        return false;
+
+    out->dragFactor = _dragFactor;
+    out->liftRatio = _liftRatio;
+    out->cruiseAoA = _cruiseAoA;
+    out->tailIncidence = _tailIncidence;
+    out->tailSetting = _tail->getIncidence();
+    out->approachElevator = _approachElevator.val;
+    return true;
+}
+
 void Airplane::setupState(float aoa, float speed, float gla, State* s)
 {
     float cosAoA = Math::cos(aoa);
@@ -745,7 +766,8 @@ void Airplane::compile()
     if (_failureMsg) return;
 
     solveGear();
-    if(_wing && _tail) solve();
+    if(_wing && _tail && _haveSolution) applySolution();
+    else if(_wing && _tail) solve();
     else
     {
        // The rotor(s) mass:
@@ -1138,6 +1160,25 @@ void Airplane::solve()
     }
 }
 
+// Apply the results of an earlier solve(), leaving the model in the
+// state that solve() would.  The tail's incidence is the one set by
+// the last iteration, which precedes the final _tailIncidence.
+void Airplane::applySolution()
+{
+    _solutionIterations = 0;
+    _failureMsg = 0;
+
+    applyDragFactor(Math::pow(_solution.dragFactor, 1/SOLVE_TWEAK));
+    applyLiftRatio(Math::pow(_solution.liftRatio, 1/SOLVE_TWEAK));
+    _cruiseAoA = _solution.cruiseAoA;
+    _tailIncidence = _solution.tailIncidence;
+    _tail->setIncidence(_solution.tailSetting);
+    _approachElevator.val = _solution.approachElevator;
+
+    runCruise();
+    runApproach();
+}
+
 void Airplane::solveHelicopter()
 {
     _solutionIterations = 0;
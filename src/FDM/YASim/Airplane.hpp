@@ -93,6 +93,15 @@ public:
     float getApproachElevator() { return _approachElevator.val; }
     const char* getFailureMsg();
 
+    // The results of solve(), for caching.  A solution set before
+    // compile() is applied in place of running the solver; it must
+    // come from an identical aircraft.  getSolution() returns false
+    // when there is none to keep (a failure, or a helicopter).
+    struct Solution { float dragFactor, liftRatio, cruiseAoA,
+                      tailIncidence, tailSetting, approachElevator; };
+    void setSolution(const Solution& s);
+    bool getSolution(Solution* out);
+
     static void setupState(float aoa, float speed, float gla, State* s); // utility
 
 private:
@@ -113,6 +122,7 @@ private:
     void solveGear();
     void solve();
     void solveHelicopter();
+    void applySolution();
     float compileWing(Wing* w);
     void compileRotorgear();
     float compileFuselage(Fuselage* f);
@@ -175,6 +185,9 @@ private:
     float _tailIncidence;
     Control _approachElevator;
     const char* _failureMsg;
+
+    Solution _solution;
+    bool _haveSolution;
 };
 
 }; // namespace yasim
@@ -4,6 +4,12 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <sstream>
+
+#include <simgear/debug/logstream.hxx>
+#include <simgear/misc/sgstream.hxx>
+#include <simgear/misc/strutils.hxx>
+#include <simgear/timing/timestamp.hxx>
 
 #include <Main/fg_props.hxx>
 
@@ -122,6 +128,78 @@ Airplane* FGFDM::getAirplane()
     return &_airplane;
 }
 
+// First line of a solver cache file, change it when the format or
+// the meaning of the cached values changes.
+static const char* SOLUTION_HEADER = "[YASimSolution:2]";
+// Last line, a file without it was not completely written.
+static const char* SOLUTION_END = "[end]";
+
+bool FGFDM::readSolution(const SGPath& aircraft, const SGPath& cacheDir)
+{
+    sg_ifstream xml(aircraft);
+    if(!xml.is_open())
+        return false;
+
+    // The solver code changes between versions, key the solution by
+    // the version as well as the aircraft.
+    std::ostringstream key;
+    key << VERSION << "\n" << xml.rdbuf();
+    _solutionKey = simgear::strutils::md5(key.str());
+
+    _solutionFile = cacheDir;
+    _solutionFile.append(_solutionKey + ".solution");
+    if(!_solutionFile.exists())
+        return false;
+
+    sg_ifstream in(_solutionFile);
+    std::string header, fileKey, end;
+    Airplane::Solution s;
+    in >> header >> fileKey >> s.dragFactor >> s.liftRatio >> s.cruiseAoA
+       >> s.tailIncidence >> s.tailSetting >> s.approachElevator >> end;
+    if(in.fail() || header != SOLUTION_HEADER || fileKey != _solutionKey
+       || end != SOLUTION_END) {
+        SG_LOG(SG_FLIGHT, SG_WARN, "YASim: ignoring invalid solver cache file "
+               << _solutionFile);
+        return false;
+    }
+
+    SG_LOG(SG_FLIGHT, SG_INFO, "YASim: using cached solution " << _solutionFile);
+    _airplane.setSolution(s);
+    return true;
+}
+
+bool FGFDM::writeSolution()
+{
+    Airplane::Solution s;
+    if(_solutionKey.empty() || !_airplane.getSolution(&s))
+        return false;
+
+    // Other FlightGear instances (or yasim -c) may share the cache
+    // directory: write a file of our own and rename it into place, so
+    // readers never see a partly written one.
+    _solutionFile.create_dir(0755);
+    std::ostringstream tmpName;
+    tmpName << _solutionFile.str() << "." << std::hex
+            << SGTimeStamp::now().toUSecs() << "." << (size_t)this << ".tmp";
+    SGPath tmpFile(tmpName.str());
+
+    sg_ofstream out(tmpFile);
+    // 9 digits, so that the floats read back unchanged
+    out.precision(9);
+    out << SOLUTION_HEADER << "\n" << _solutionKey << "\n"
+        << s.dragFactor << "\n" << s.liftRatio << "\n" << s.cruiseAoA << "\n"
+        << s.tailIncidence << "\n" << s.tailSetting << "\n"
+        << s.approachElevator << "\n" << SOLUTION_END << "\n";
+    out.close();
+    if(out.fail() || !tmpFile.rename(_solutionFile)) {
+        SG_LOG(SG_FLIGHT, SG_WARN, "YASim: could not write solver cache file "
+               << _solutionFile);
+        tmpFile.remove();
+        return false;
+    }
+    return true;
+}
+
 void FGFDM::init()
 {
     _turb_magnitude_norm = fgGetNode("/environment/turbulence/magnitude-norm", true);
@@ -3,6 +3,7 @@
 
 #include <simgear/xml/easyxml.hxx>
 #include <simgear/props/props.hxx>
+#include <simgear/misc/sg_path.hxx>
 
 #include "Airplane.hpp"
 #include "Vector.hpp"
@@ -30,6 +31,14 @@ public:
 
     float getVehicleRadius(void) const { return _vehicle_radius; }
 
+    // Solver cache, see Airplane::setSolution().  Solutions are kept
+    // in cacheDir, named by a hash of the aircraft file's contents and
+    // the FlightGear version.  Call readSolution() after parsing and
+    // before Airplane::compile(); it returns true on a cache hit.
+    // writeSolution() stores the result of the compile().
+    bool readSolution(const SGPath& aircraft, const SGPath& cacheDir);
+    bool writeSolution();
+
 private:
     struct AxisRec { char* name; int handle; };
     struct EngRec { char* prefix; Thruster* eng; };
@@ -80,6 +89,10 @@ private:
     // Radius of the vehicle, for intersection testing.
     float _vehicle_radius;
 
+    // The solver cache file of this aircraft, and its hash
+    SGPath _solutionFile;
+    std::string _solutionKey;
+
     // Parsing temporaries
     void* _currObj;
     bool _cruiseCurr;
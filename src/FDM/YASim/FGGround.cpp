@@ -51,6 +51,30 @@ void FGGround::getGroundPlane(const double pos[3],
     for(int i=0; i<3; i++) vel[i] = dvel[i];
 }
 
+void FGGround::getGroundPlanes(int n, const double (*pos)[3],
+                               double (*plane)[4], float (*vel)[3],
+                               const simgear::BVHMaterial **material)
+{
+    _batch.resize(n);
+    for(int i=0; i<n; i++)
+        _batch.setPoint(i, SGVec3d(pos[i]));
+
+    _iface->get_agl_m(_toff, 2, _batch);
+
+    for(int i=0; i<n; i++) {
+        const SGVec3d& cp = _batch.contact[i];
+        const SGVec3d& normal = _batch.normal[i];
+        for(int j=0; j<3; j++) {
+            plane[i][j] = normal[j];
+            vel[i][j] = _batch.linearVel[i][j];
+        }
+
+        // The plane below the actual contact point.
+        plane[i][3] = plane[i][0]*cp[0] + plane[i][1]*cp[1] + plane[i][2]*cp[2];
+        material[i] = _batch.material[i];
+    }
+}
+
 bool FGGround::caughtWire(const double pos[4][3])
 {
     return _iface->caught_wire_m(_toff, pos);
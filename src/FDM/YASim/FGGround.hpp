@@ -1,6 +1,8 @@
 #ifndef _FGGROUND_HPP
 #define _FGGROUND_HPP
 
+#include <FDM/groundcache.hxx>
+
 #include "Ground.hpp"
 
 class FGInterface;
@@ -25,6 +27,10 @@ public:
                                 double plane[4], float vel[3],
                                 const simgear::BVHMaterial **material);
 
+    virtual void getGroundPlanes(int n, const double (*pos)[3],
+                                 double (*plane)[4], float (*vel)[3],
+                                 const simgear::BVHMaterial **material);
+
     virtual bool caughtWire(const double pos[4][3]);
 
     virtual bool getWire(double end[2][3], float vel[2][3]);
@@ -39,6 +45,7 @@ public:
 private:
     FGInterface *_iface;
     double _toff;
+    FGGroundQueryBatch _batch;
 };
 
 }; // namespace yasim
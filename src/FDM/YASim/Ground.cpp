@@ -40,6 +40,16 @@ void Ground::getGroundPlane(const double pos[3],
     getGroundPlane(pos,plane,vel);
 }
 
+void Ground::getGroundPlanes(int n, const double (*pos)[3],
+                             double (*plane)[4], float (*vel)[3],
+                             const simgear::BVHMaterial **material)
+{
+    for(int i=0; i<n; i++) {
+        material[i] = 0;
+        getGroundPlane(pos[i], plane[i], vel[i], &material[i]);
+    }
+}
+
 bool Ground::caughtWire(const double pos[4][3])
 {
     return false;
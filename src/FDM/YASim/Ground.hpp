@@ -18,6 +18,13 @@ public:
                                 double plane[4], float vel[3],
                                 const simgear::BVHMaterial **material);
 
+    // Ground planes for n points at once, which can be much cheaper than
+    // asking for each of them.  The default implementation just calls
+    // getGroundPlane() for every point.
+    virtual void getGroundPlanes(int n, const double (*pos)[3],
+                                 double (*plane)[4], float (*vel)[3],
+                                 const simgear::BVHMaterial **material);
+
     virtual bool caughtWire(const double pos[4][3]);
 
     virtual bool getWire(double end[2][3], float vel[2][3]);
@@ -62,10 +62,17 @@ Model::Model()
     _agl = 0;
     _crashed = false;
     _turb = 0;
+    _surfaceKernel = true;
     _ground_cb = new Ground();
     _hook = 0;
     _launchbar = 0;
 
+    _groundQuerySize = 0;
+    _groundPos = 0;
+    _groundPlane = 0;
+    _groundVel = 0;
+    _groundMaterial = 0;
+
     _groundEffectSpan = 0;
     _groundEffect = 0;
     for(i=0; i<3; i++) _wingCenter[i] = 0;
@@ -83,6 +90,10 @@ Model::~Model()
     delete _launchbar;
     for(int i=0; i<_hitches.size();i++)
         delete (Hitch*)_hitches.get(i);
+    delete[] _groundPos;
+    delete[] _groundPlane;
+    delete[] _groundVel;
+    delete[] _groundMaterial;
 
 }
 
@@ -248,6 +259,7 @@ void Model::setThruster(int handle, Thruster* t)
 
 int Model::addSurface(Surface* surf)
 {
+    _surfaceArray.add(surf);
     return _surfaces.add(surf);
 }
 
@@ -301,14 +313,37 @@ void Model::setWind(float* wind)
     Math::set3(wind, _wind);
 }
 
+void Model::growGroundQuery(int n)
+{
+    if(n <= _groundQuerySize) return;
+
+    delete[] _groundPos;
+    delete[] _groundPlane;
+    delete[] _groundVel;
+    delete[] _groundMaterial;
+    _groundPos = new double[n][3];
+    _groundPlane = new double[n][4];
+    _groundVel = new float[n][3];
+    _groundMaterial = new const simgear::BVHMaterial*[n];
+    _groundQuerySize = n;
+}
+
 void Model::updateGround(State* s)
 {
-    float dummy[3];
-    _ground_cb->getGroundPlane(s->pos, _global_ground, dummy);
+    // Collect all the points we need the ground for: the aircraft
+    // origin, the gear contact points, the hitches, the hook and the
+    // launchbar tips.  They are then looked up with a single query.
+    int ngear = _gears.size();
+    int nhitch = _hitches.size();
+    int n = 1 + ngear + nhitch + (_hook ? 1 : 0) + (_launchbar ? 1 : 0);
+    growGroundQuery(n);
+
+    int i, q = 0;
+    for(i=0; i<3; i++) _groundPos[q][i] = s->pos[i];
+    q++;
 
-    int i;
     // The landing gear
-    for(i=0; i<_gears.size(); i++) {
+    for(i=0; i<ngear; i++) {
 	Gear* g = (Gear*)_gears.get(i);
 
 	// Get the point of ground contact
@@ -320,34 +355,44 @@ void Model::updateGround(State* s)
 	Math::add3(cmpr, pos, pos);
         // Transform the local coordinates of the contact point to
         // global coordinates.
-        double pt[3];
-        s->posLocalToGlobal(pos, pt);
-
-        // Ask for the ground plane in the global coordinate system
-        double global_ground[4];
-        float global_vel[3];
-        const simgear::BVHMaterial* material;
-        _ground_cb->getGroundPlane(pt, global_ground, global_vel, &material);
-        g->setGlobalGround(global_ground, global_vel, pt[0], pt[1], material);
+        s->posLocalToGlobal(pos, _groundPos[q++]);
     }
 
-    for(i=0; i<_hitches.size(); i++) {
+    for(i=0; i<nhitch; i++) {
         Hitch* h = (Hitch*)_hitches.get(i);
 
         // Get the point of interest
         float pos[3];
         h->getPosition(pos);
+        s->posLocalToGlobal(pos, _groundPos[q++]);
+    }
 
-        // Transform the local coordinates of the contact point to
-        // global coordinates.
-        double pt[3];
-        s->posLocalToGlobal(pos, pt);
-
-        // Ask for the ground plane in the global coordinate system
-        double global_ground[4];
-        float global_vel[3];
-        _ground_cb->getGroundPlane(pt, global_ground, global_vel);
-        h->setGlobalGround(global_ground, global_vel);
+    // The arrester hook
+    if(_hook)
+        _hook->getTipGlobalPosition(s, _groundPos[q++]);
+
+    // The launchbar/holdback
+    if(_launchbar)
+        _launchbar->getTipGlobalPosition(s, _groundPos[q++]);
+
+    // Ask for the ground planes in the global coordinate system
+    _ground_cb->getGroundPlanes(n, _groundPos, _groundPlane, _groundVel,
+                                _groundMaterial);
+
+    q = 0;
+    for(i=0; i<4; i++) _global_ground[i] = _groundPlane[q][i];
+    q++;
+
+    for(i=0; i<ngear; i++, q++) {
+	Gear* g = (Gear*)_gears.get(i);
+        g->setGlobalGround(_groundPlane[q], _groundVel[q],
+                           _groundPos[q][0], _groundPos[q][1],
+                           _groundMaterial[q]);
+    }
+
+    for(i=0; i<nhitch; i++, q++) {
+        Hitch* h = (Hitch*)_hitches.get(i);
+        h->setGlobalGround(_groundPlane[q], _groundVel[q]);
     }
 
     for(i=0; i<_rotorgear.getRotors()->size(); i++) {
@@ -355,23 +400,11 @@ void Model::updateGround(State* s)
         r->findGroundEffectAltitude(_ground_cb,s);
     }
 
-    // The arrester hook
-    if(_hook) {
-        double pt[3];
-        _hook->getTipGlobalPosition(s, pt);
-        double global_ground[4];
-        _ground_cb->getGroundPlane(pt, global_ground, dummy);
-        _hook->setGlobalGround(global_ground);
-    }
+    if(_hook)
+        _hook->setGlobalGround(_groundPlane[q++]);
 
-    // The launchbar/holdback
-    if(_launchbar) {
-        double pt[3];
-        _launchbar->getTipGlobalPosition(s, pt);
-        double global_ground[4];
-        _ground_cb->getGroundPlane(pt, global_ground, dummy);
-        _launchbar->setGlobalGround(global_ground);
-    }
+    if(_launchbar)
+        _launchbar->setGlobalGround(_groundPlane[q++]);
 }
 
 void Model::calcForces(State* s)
@@ -411,20 +444,37 @@ void Model::calcForces(State* s)
     // point is different due to rotation.
     float faero[3];
     faero[0] = faero[1] = faero[2] = 0;
-    for(i=0; i<_surfaces.size(); i++) {
-	Surface* sf = (Surface*)_surfaces.get(i);
+    if(_surfaceKernel) {
+        _surfaceArray.update();
+        for(i=0; i<_surfaceArray.size(); i++) {
+            // Vsurf = wind - velocity + (rot cross (cg - pos))
+            float vs[3], pos[3];
+            _surfaceArray.getPosition(i, pos);
+            localWind(pos, s, vs, alt);
+            _surfaceArray.setWind(i, vs);
+        }
 
-	// Vsurf = wind - velocity + (rot cross (cg - pos))
-	float vs[3], pos[3];
-	sf->getPosition(pos);
-        localWind(pos, s, vs, alt);
+        float cg[3], torque[3];
+        _body.getCG(cg);
+        _surfaceArray.calcForces(_rho, cg, faero, torque);
+        _body.addForce(faero);
+        _body.addTorque(torque);
+    } else {
+        for(i=0; i<_surfaces.size(); i++) {
+            Surface* sf = (Surface*)_surfaces.get(i);
+
+            // Vsurf = wind - velocity + (rot cross (cg - pos))
+            float vs[3], pos[3];
+            sf->getPosition(pos);
+            localWind(pos, s, vs, alt);
 
-	float force[3], torque[3];
-	sf->calcForce(vs, _rho, force, torque);
-	Math::add3(faero, force, faero);
+            float force[3], torque[3];
+            sf->calcForce(vs, _rho, force, torque);
+            Math::add3(faero, force, faero);
 
-	_body.addForce(pos, force);
-	_body.addTorque(torque);
+            _body.addForce(pos, force);
+            _body.addTorque(torque);
+        }
     }
     for (j=0; j<_rotorgear.getRotors()->size();j++)
     {
@@ -5,9 +5,13 @@
 #include "RigidBody.hpp"
 #include "BodyEnvironment.hpp"
 #include "Vector.hpp"
+#include "SurfaceArray.hpp"
 #include "Turbulence.hpp"
 #include "Rotor.hpp"
 
+namespace simgear {
+class BVHMaterial;
+}
 namespace yasim {
 
 // Declare the types whose pointers get passed around here
@@ -60,6 +64,10 @@ public:
     void initIteration();
     void getThrust(float* out);
 
+    // Compute the surface forces with the SurfaceArray kernel (the
+    // default), or with one Surface::calcForce() call per surface.
+    void setSurfaceKernel(bool kernel) { _surfaceKernel = kernel; }
+
     void setGroundCallback(Ground* ground_cb);
     Ground* getGroundCallback(void);
 
@@ -90,6 +98,8 @@ private:
 
     Vector _thrusters;
     Vector _surfaces;
+    SurfaceArray _surfaceArray;
+    bool _surfaceKernel;
     Rotorgear _rotorgear;
     Vector _gears;
     Hook* _hook;
@@ -102,6 +112,14 @@ private:
 
     Ground* _ground_cb;
     double _global_ground[4];
+
+    // Scratch space for the ground query of all contact points
+    void growGroundQuery(int n);
+    int _groundQuerySize;
+    double (*_groundPos)[3];
+    double (*_groundPlane)[4];
+    float (*_groundVel)[3];
+    const simgear::BVHMaterial** _groundMaterial;
     float _pressure;
     float _temp;
     float _rho;
@@ -30,12 +30,14 @@ Surface::Surface( Version * version ) :
     _slatAlpha = 0;
     _spoilerLift = 1;
     _inducedDrag = 1;
+    _dirty = true;
 }
 
 void Surface::setPosition(float* p)
 {
     int i;
     for(i=0; i<3; i++) _pos[i] = p[i];
+    _dirty = true;
 }
 
 void Surface::getPosition(float* out)
@@ -47,11 +49,13 @@ void Surface::getPosition(float* out)
 void Surface::setChord(float chord)
 {
     _chord = chord;
+    _dirty = true;
 }
 
 void Surface::setTotalDrag(float c0)
 {
     _c0 = c0;
+    _dirty = true;
 }
 
 float Surface::getTotalDrag()
@@ -62,16 +66,19 @@ float Surface::getTotalDrag()
 void Surface::setXDrag(float cx)
 {
     _cx = cx;
+    _dirty = true;
 }
 
 void Surface::setYDrag(float cy)
 {
     _cy = cy;
+    _dirty = true;
 }
 
 void Surface::setZDrag(float cz)
 {
     _cz = cz;
+    _dirty = true;
 }
 
 float Surface::getXDrag()
@@ -82,21 +89,25 @@ float Surface::getXDrag()
 void Surface::setBaseZDrag(float cz0)
 {
     _cz0 = cz0;
+    _dirty = true;
 }
 
 void Surface::setStallPeak(int i, float peak)
 {
     _peaks[i] = peak;
+    _dirty = true;
 }
 
 void Surface::setStall(int i, float alpha)
 {
     _stalls[i] = alpha;
+    _dirty = true;
 }
 
 void Surface::setStallWidth(int i, float width)
 {
     _widths[i] = width;
+    _dirty = true;
 }
 
 void Surface::setOrientation(float* o)
@@ -104,44 +115,52 @@ void Surface::setOrientation(float* o)
     int i;
     for(i=0; i<9; i++)
         _orient[i] = o[i];
+    _dirty = true;
 }
 
 void Surface::setIncidence(float angle)
 {
     _incidence = angle;
+    _dirty = true;
 }
 
 void Surface::setTwist(float angle)
 {
     _twist = angle;
+    _dirty = true;
 }
 
 void Surface::setSlatParams(float stallDelta, float dragPenalty)
 {
     _slatAlpha = stallDelta;
     _slatDrag = dragPenalty;
+    _dirty = true;
 }
 
 void Surface::setFlapParams(float liftAdd, float dragPenalty)
 {
     _flapLift = liftAdd;
     _flapDrag = dragPenalty;
+    _dirty = true;
 }
 
 void Surface::setSpoilerParams(float liftPenalty, float dragPenalty)
 {
     _spoilerLift = liftPenalty;
     _spoilerDrag = dragPenalty;
+    _dirty = true;
 }
 
 void Surface::setFlap(float pos)
 {
     _flapPos = pos;
+    _dirty = true;
 }
 
 void Surface::setFlapEffectiveness(float effectiveness)
 {
     _flapEffectiveness = effectiveness;
+    _dirty = true;
 }
 
 double Surface::getFlapEffectiveness()
@@ -153,11 +172,13 @@ double Surface::getFlapEffectiveness()
 void Surface::setSlat(float pos)
 {
     _slatPos = pos;
+    _dirty = true;
 }
 
 void Surface::setSpoiler(float pos)
 {
     _spoilerPos = pos;
+    _dirty = true;
 }
 
 // Calculate the aerodynamic force given a wind vector v (in the
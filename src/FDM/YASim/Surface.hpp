@@ -70,11 +70,14 @@ public:
     void setStallWidth(int i, float width);
 
     // Induced drag multiplier
-    void setInducedDrag(float mul) { _inducedDrag = mul; }
+    void setInducedDrag(float mul) { _inducedDrag = mul; _dirty = true; }
 
     void calcForce(float* v, float rho, float* forceOut, float* torqueOut);
 
 private:
+    // SurfaceArray packs the coefficients and control positions
+    friend class SurfaceArray;
+
     float stallFunc(float* v);
     float flapLift(float alpha);
     float controlDrag(float lift, float drag);
@@ -107,6 +110,9 @@ private:
     float _inducedDrag;
 
     Version * _version;
+
+    // set by all the setters, cleared when packed into a SurfaceArray
+    bool _dirty;
 };
 
 }; // namespace yasim
@@ -0,0 +1,395 @@
+#include <string.h>
+
+#include "Math.hpp"
+#include "Surface.hpp"
+#include "SurfaceArray.hpp"
+
+#if defined(__AVX__)
+#  include <immintrin.h>
+#  define SURFACE_LANES Lanes8
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#  include <xmmintrin.h>
+#  define SURFACE_LANES Lanes4
+#else
+#  define SURFACE_LANES Lanes1
+#endif
+
+namespace yasim {
+
+namespace {
+
+// The kernel below is written once against these "lanes" types: plain
+// floats, and SSE and AVX registers holding 4 and 8 of them.  Masks
+// come from comparisons and pick values with select(); both sides of a
+// select are always computed, so divisors get replaced where they
+// could be zero (floating point exceptions may be enabled).
+
+// The array length is rounded up to a multiple of this
+const int MAX_LANES = 8;
+
+struct Lanes1
+{
+    enum { N = 1 };
+    typedef bool Mask;
+
+    Lanes1() {}
+    Lanes1(float f) : v(f) {}
+    static Lanes1 load(const float* p) { return Lanes1(*p); }
+    float sum() const { return v; }
+
+    float v;
+};
+
+inline Lanes1 operator+(Lanes1 a, Lanes1 b) { return a.v + b.v; }
+inline Lanes1 operator-(Lanes1 a, Lanes1 b) { return a.v - b.v; }
+inline Lanes1 operator*(Lanes1 a, Lanes1 b) { return a.v * b.v; }
+inline Lanes1 operator/(Lanes1 a, Lanes1 b) { return a.v / b.v; }
+inline Lanes1 operator-(Lanes1 a) { return -a.v; }
+inline bool operator<(Lanes1 a, Lanes1 b) { return a.v < b.v; }
+inline bool operator<=(Lanes1 a, Lanes1 b) { return a.v <= b.v; }
+inline bool operator>(Lanes1 a, Lanes1 b) { return a.v > b.v; }
+inline bool operator==(Lanes1 a, Lanes1 b) { return a.v == b.v; }
+inline Lanes1 select(bool m, Lanes1 a, Lanes1 b) { return m ? a : b; }
+inline Lanes1 abs(Lanes1 a) { return Math::abs(a.v); }
+inline Lanes1 sqrt(Lanes1 a) { return Math::sqrt(a.v); }
+inline Lanes1 clamp01(Lanes1 a) { return Math::clamp(a.v, 0, 1); }
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+struct Mask4
+{
+    Mask4(__m128 mask) : m(mask) {}
+    __m128 m;
+};
+
+struct Lanes4
+{
+    enum { N = 4 };
+    typedef Mask4 Mask;
+
+    Lanes4() {}
+    Lanes4(__m128 vec) : v(vec) {}
+    Lanes4(float f) : v(_mm_set1_ps(f)) {}
+    static Lanes4 load(const float* p) { return _mm_loadu_ps(p); }
+    float sum() const
+    {
+        float f[4];
+        _mm_storeu_ps(f, v);
+        return (f[0] + f[1]) + (f[2] + f[3]);
+    }
+
+    __m128 v;
+};
+
+inline Lanes4 operator+(Lanes4 a, Lanes4 b) { return _mm_add_ps(a.v, b.v); }
+inline Lanes4 operator-(Lanes4 a, Lanes4 b) { return _mm_sub_ps(a.v, b.v); }
+inline Lanes4 operator*(Lanes4 a, Lanes4 b) { return _mm_mul_ps(a.v, b.v); }
+inline Lanes4 operator/(Lanes4 a, Lanes4 b) { return _mm_div_ps(a.v, b.v); }
+inline Lanes4 operator-(Lanes4 a) { return _mm_xor_ps(a.v, _mm_set1_ps(-0.0f)); }
+inline Mask4 operator<(Lanes4 a, Lanes4 b) { return _mm_cmplt_ps(a.v, b.v); }
+inline Mask4 operator<=(Lanes4 a, Lanes4 b) { return _mm_cmple_ps(a.v, b.v); }
+inline Mask4 operator>(Lanes4 a, Lanes4 b) { return _mm_cmpgt_ps(a.v, b.v); }
+inline Mask4 operator==(Lanes4 a, Lanes4 b) { return _mm_cmpeq_ps(a.v, b.v); }
+inline Mask4 operator|(Mask4 a, Mask4 b) { return _mm_or_ps(a.m, b.m); }
+inline Lanes4 select(Mask4 m, Lanes4 a, Lanes4 b)
+{
+    return _mm_or_ps(_mm_and_ps(m.m, a.v), _mm_andnot_ps(m.m, b.v));
+}
+inline Lanes4 abs(Lanes4 a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v); }
+inline Lanes4 sqrt(Lanes4 a) { return _mm_sqrt_ps(a.v); }
+inline Lanes4 clamp01(Lanes4 a)
+{
+    return _mm_min_ps(_mm_max_ps(a.v, _mm_setzero_ps()), _mm_set1_ps(1));
+}
+#endif
+
+#if defined(__AVX__)
+struct Mask8
+{
+    Mask8(__m256 mask) : m(mask) {}
+    __m256 m;
+};
+
+struct Lanes8
+{
+    enum { N = 8 };
+    typedef Mask8 Mask;
+
+    Lanes8() {}
+    Lanes8(__m256 vec) : v(vec) {}
+    Lanes8(float f) : v(_mm256_set1_ps(f)) {}
+    static Lanes8 load(const float* p) { return _mm256_loadu_ps(p); }
+    float sum() const
+    {
+        float f[8];
+        _mm256_storeu_ps(f, v);
+        return ((f[0] + f[1]) + (f[2] + f[3])) + ((f[4] + f[5]) + (f[6] + f[7]));
+    }
+
+    __m256 v;
+};
+
+inline Lanes8 operator+(Lanes8 a, Lanes8 b) { return _mm256_add_ps(a.v, b.v); }
+inline Lanes8 operator-(Lanes8 a, Lanes8 b) { return _mm256_sub_ps(a.v, b.v); }
+inline Lanes8 operator*(Lanes8 a, Lanes8 b) { return _mm256_mul_ps(a.v, b.v); }
+inline Lanes8 operator/(Lanes8 a, Lanes8 b) { return _mm256_div_ps(a.v, b.v); }
+inline Lanes8 operator-(Lanes8 a) { return _mm256_xor_ps(a.v, _mm256_set1_ps(-0.0f)); }
+inline Mask8 operator<(Lanes8 a, Lanes8 b) { return _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ); }
+inline Mask8 operator<=(Lanes8 a, Lanes8 b) { return _mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ); }
+inline Mask8 operator>(Lanes8 a, Lanes8 b) { return _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ); }
+inline Mask8 operator==(Lanes8 a, Lanes8 b) { return _mm256_cmp_ps(a.v, b.v, _CMP_EQ_OQ); }
+inline Mask8 operator|(Mask8 a, Mask8 b) { return _mm256_or_ps(a.m, b.m); }
+inline Lanes8 select(Mask8 m, Lanes8 a, Lanes8 b)
+{
+    return _mm256_blendv_ps(b.v, a.v, m.m);
+}
+inline Lanes8 abs(Lanes8 a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v); }
+inline Lanes8 sqrt(Lanes8 a) { return _mm256_sqrt_ps(a.v); }
+inline Lanes8 clamp01(Lanes8 a)
+{
+    return _mm256_min_ps(_mm256_max_ps(a.v, _mm256_setzero_ps()), _mm256_set1_ps(1));
+}
+#endif
+
+// Surface::calcForce() for all the surfaces, N at a time.  The comments
+// name the Surface methods that each part follows, operation by
+// operation.
+template<class F>
+void surfaceKernel(float** fields, int count, float rho, float* cg,
+                   float* forceOut, float* torqueOut)
+{
+    typedef typename F::Mask M;
+    const F zero(0.0f), one(1.0f), two(2.0f), three(3.0f);
+    const F halfRho(0.5f*rho);
+    const F cgx(cg[0]), cgy(cg[1]), cgz(cg[2]);
+    F sfx(zero), sfy(zero), sfz(zero), stx(zero), sty(zero), stz(zero);
+
+    for(int i=0; i<count; i+=F::N) {
+#define FIELD(f) F::load(fields[SurfaceArray::f] + i)
+        // Split v into magnitude and direction
+        F vx = FIELD(WIND_X), vy = FIELD(WIND_Y), vz = FIELD(WIND_Z);
+        F vel = sqrt(vx*vx + vy*vy + vz*vz);
+        M still = vel == zero;
+        F ivel = one / select(still, one, vel);
+
+        // Convert to the surface's coordinates, and apply the incidence
+        F o0 = FIELD(ORIENT_0), o1 = FIELD(ORIENT_1), o2 = FIELD(ORIENT_2);
+        F o3 = FIELD(ORIENT_3), o4 = FIELD(ORIENT_4), o5 = FIELD(ORIENT_5);
+        F o6 = FIELD(ORIENT_6), o7 = FIELD(ORIENT_7), o8 = FIELD(ORIENT_8);
+        F dx = ivel*vx, dy = ivel*vy, dz = ivel*vz;
+        F x = dx*o0 + dy*o1 + dz*o2;
+        F y = dx*o3 + dy*o4 + dz*o5;
+        F z = dx*o6 + dy*o7 + dz*o8;
+        F incidence = FIELD(INCIDENCE);
+        z = z + incidence*x;
+        F lx = x, ly = y, lz = z;
+
+        // stallFunc()
+        F s0 = FIELD(STALL_0), s1 = FIELD(STALL_1);
+        F s2 = FIELD(STALL_2), s3 = FIELD(STALL_3);
+        F w0 = FIELD(WIDTH_0), w1 = FIELD(WIDTH_1);
+        F w2 = FIELD(WIDTH_2), w3 = FIELD(WIDTH_3);
+        M noX = x == zero;
+        M fwdBak = x > zero;
+        M posNeg = z < zero;
+        F alpha = abs(z / select(noX, one, x));
+        F stall = select(fwdBak, select(posNeg, s3, s2), select(posNeg, s1, s0));
+        F width = select(fwdBak, select(posNeg, w3, w2), select(posNeg, w1, w0));
+        F stallAlpha = select(fwdBak | posNeg, stall, FIELD(SLAT_STALL_0));
+        F posStall = select(fwdBak, s2, s0);
+        F scale = F(0.5f) * select(fwdBak, FIELD(PEAK_1), FIELD(PEAK_0))
+            / select(posStall == zero, one, posStall);
+        F frac = clamp01((alpha - stallAlpha) / select(width == zero, one, width));
+        frac = frac*frac*(three - two*frac);
+        F stallMul = select(noX | (stall == zero) | (alpha > stallAlpha + width), one,
+                            select(alpha <= stallAlpha, scale,
+                                   scale*(one - frac) + frac));
+        stallMul = stallMul * FIELD(SPOILER_LIFT);
+        F cz = FIELD(CZ);
+        F stallLift = (stallMul - one) * cz * z;
+
+        // flapLift()
+        F absZ = abs(z);
+        F flapLift = FIELD(FLAP_LIFT);
+        F flapFrac = clamp01((absZ - s0) / select(w0 == zero, one, w0));
+        flapFrac = flapFrac*flapFrac*(three - two*flapFrac);
+        F flaplift = select(s0 == zero, zero,
+                            select(absZ < s0, flapLift,
+                                   select(absZ > s0 + w0, zero,
+                                          flapLift*(one - flapFrac))));
+
+        F czCz0 = FIELD(CZ_CZ0);
+        F fz = z*cz;
+        fz = fz + czCz0;
+        fz = fz + stallLift;
+        fz = fz + flaplift;
+
+        // The pitching torque, converted to local coordinates
+        F t = F(0.1667f) * FIELD(CHORD) * (flaplift - (czCz0 + stallLift));
+        F tx = t*o3, ty = t*o4, tz = t*o5;
+
+        // controlDrag()
+        F drag = FIELD(CX) * x;
+        F fd = abs(fz * FIELD(FLAP_DRAG_AOA) * FIELD(FLAP_DRAG_POS));
+        drag = drag + select(drag < zero, -fd, fd);
+        drag = drag * FIELD(FLAP_DRAG);
+        drag = drag * FIELD(SPOILER_DRAG);
+        drag = drag * FIELD(SLAT_DRAG);
+        F fx = drag;
+        F fy = y * FIELD(CY);
+
+        // Induced drag
+        F induced = F(-1.0f) * FIELD(INDUCED_DRAG) * fz * lz;
+        fx = induced*lx + fx;
+        fy = induced*ly + fy;
+        fz = induced*lz + fz;
+
+        // Reverse the incidence rotation
+        M v32 = FIELD(VERSION_32) > zero;
+        F rx = select(v32, fx + incidence*fz, fx);
+        F rz = select(v32, fz, fz - incidence*fx);
+
+        // Convert back to external coordinates, and scale
+        F q = halfRho*vel*vel*FIELD(C0);
+        M off = still | (FIELD(ACTIVE) == zero);
+        F ox = select(off, zero, (rx*o0 + fy*o3 + rz*o6) * q);
+        F oy = select(off, zero, (rx*o1 + fy*o4 + rz*o7) * q);
+        F oz = select(off, zero, (rx*o2 + fy*o5 + rz*o8) * q);
+        tx = select(off, zero, tx*q);
+        ty = select(off, zero, ty*q);
+        tz = select(off, zero, tz*q);
+
+        // Accumulate, with the torque of the force about the c.g. as
+        // in RigidBody::addForce()
+        F px = cgx - FIELD(POS_X), py = cgy - FIELD(POS_Y), pz = cgz - FIELD(POS_Z);
+        sfx = sfx + ox;
+        sfy = sfy + oy;
+        sfz = sfz + oz;
+        stx = stx + tx + (oy*pz - py*oz);
+        sty = sty + ty + (oz*px - pz*ox);
+        stz = stz + tz + (ox*py - px*oy);
+#undef FIELD
+    }
+
+    forceOut[0] = sfx.sum();
+    forceOut[1] = sfy.sum();
+    forceOut[2] = sfz.sum();
+    torqueOut[0] = stx.sum();
+    torqueOut[1] = sty.sum();
+    torqueOut[2] = stz.sum();
+}
+
+} // anonymous namespace
+
+SurfaceArray::SurfaceArray()
+{
+    _stride = 0;
+    _data = 0;
+}
+
+SurfaceArray::~SurfaceArray()
+{
+    delete[] _data;
+}
+
+void SurfaceArray::add(Surface* surf)
+{
+    _surfaces.add(surf);
+}
+
+void SurfaceArray::update()
+{
+    int n = _surfaces.size();
+    int stride = (n + MAX_LANES - 1) / MAX_LANES * MAX_LANES;
+    bool all = false;
+    if(stride != _stride) {
+        // The padding is all zero, which makes inactive surfaces
+        delete[] _data;
+        _stride = stride;
+        _data = new float[NUM_FIELDS * _stride];
+        memset(_data, 0, NUM_FIELDS * _stride * sizeof(float));
+        all = true;
+    }
+
+    for(int i=0; i<n; i++) {
+        Surface* s = (Surface*)_surfaces.get(i);
+        if(all || s->_dirty)
+            pack(i, s);
+    }
+}
+
+void SurfaceArray::pack(int i, Surface* s)
+{
+    int j;
+    for(j=0; j<3; j++)
+        field(POS_X + j)[i] = s->_pos[j];
+    for(j=0; j<9; j++)
+        field(ORIENT_0 + j)[i] = s->_orient[j];
+
+    // See Surface::calcForce()
+    bool active = !(s->_cx == 0. && s->_cy == 0. && s->_cz == 0.);
+    bool v32 = s->_version->isVersionOrNewer(Version::YASIM_VERSION_32);
+    field(ACTIVE)[i] = active ? 1 : 0;
+    field(VERSION_32)[i] = v32 ? 1 : 0;
+    field(INCIDENCE)[i] = s->_incidence + s->_twist;
+    field(CHORD)[i] = s->_chord;
+    field(C0)[i] = s->_c0;
+    field(CX)[i] = s->_cx;
+    field(CY)[i] = s->_cy;
+    field(CZ)[i] = s->_cz;
+    field(CZ_CZ0)[i] = s->_cz*s->_cz0;
+
+    // Surface::stallFunc(), the slats move the fwd/+z stall
+    for(j=0; j<4; j++) {
+        field(STALL_0 + j)[i] = s->_stalls[j];
+        field(WIDTH_0 + j)[i] = s->_widths[j];
+    }
+    field(SLAT_STALL_0)[i] = s->_stalls[0]
+        + (v32 ? s->_slatPos * s->_slatAlpha : s->_slatAlpha);
+    field(PEAK_0)[i] = s->_peaks[0];
+    field(PEAK_1)[i] = s->_peaks[1];
+    field(SPOILER_LIFT)[i] = 1 + s->_spoilerPos * (s->_spoilerLift - 1);
+
+    // Surface::flapLift()
+    field(FLAP_LIFT)[i] = s->_cz * s->_flapPos * (s->_flapLift-1) * s->_flapEffectiveness;
+
+    // Surface::controlDrag()
+    float fp = s->_flapPos;
+    if(fp < 0) {
+        fp = -fp;
+        fp -= s->_cz0/(s->_flapLift-1);
+        if(fp < 0) fp = 0;
+    }
+    field(FLAP_DRAG_POS)[i] = fp;
+    field(FLAP_DRAG_AOA)[i] = (s->_flapLift - 1 - s->_cz0) * s->_stalls[0];
+    field(FLAP_DRAG)[i] = 1 + fp * (s->_flapDrag - 1);
+    field(SPOILER_DRAG)[i] = 1 + s->_spoilerPos * (s->_spoilerDrag - 1);
+    field(SLAT_DRAG)[i] = 1 + s->_slatPos * (s->_slatDrag - 1);
+
+    field(INDUCED_DRAG)[i] = s->_inducedDrag;
+
+    s->_dirty = false;
+}
+
+void SurfaceArray::getPosition(int i, float* out)
+{
+    for(int j=0; j<3; j++)
+        out[j] = field(POS_X + j)[i];
+}
+
+void SurfaceArray::setWind(int i, float* v)
+{
+    for(int j=0; j<3; j++)
+        field(WIND_X + j)[i] = v[j];
+}
+
+void SurfaceArray::calcForces(float rho, float* cg, float* forceOut,
+                              float* torqueOut)
+{
+    float* fields[NUM_FIELDS];
+    for(int f=0; f<NUM_FIELDS; f++)
+        fields[f] = field(f);
+
+    surfaceKernel<SURFACE_LANES>(fields, _stride, rho, cg, forceOut, torqueOut);
+}
+
+}; // namespace yasim
@@ -0,0 +1,67 @@
+#ifndef _SURFACEARRAY_HPP
+#define _SURFACEARRAY_HPP
+
+#include "Vector.hpp"
+
+namespace yasim {
+
+class Surface;
+
+// The surfaces of a Model, with their coefficients and control
+// positions packed into structure-of-arrays form so that the forces
+// can be computed for several surfaces at once with SSE (or AVX, when
+// the compiler targets it) instructions.  The results match
+// Surface::calcForce() to within float rounding.  Surfaces are
+// re-packed only after one of their setters has been called.
+class SurfaceArray
+{
+public:
+    SurfaceArray();
+    ~SurfaceArray();
+
+    void add(Surface* surf);
+    int size() { return _surfaces.size(); }
+
+    // Re-pack the surfaces modified since the last call
+    void update();
+
+    void getPosition(int i, float* out);
+
+    // The wind vector at surface i, in local coordinates (the "v"
+    // argument of Surface::calcForce())
+    void setWind(int i, float* v);
+
+    // The total force of all the surfaces, and their total torque
+    // about the c.g.
+    void calcForces(float rho, float* cg, float* forceOut, float* torqueOut);
+
+    // Arrays of per-surface values, see pack()
+    enum Field {
+        POS_X, POS_Y, POS_Z,
+        WIND_X, WIND_Y, WIND_Z,
+        ORIENT_0, ORIENT_1, ORIENT_2,
+        ORIENT_3, ORIENT_4, ORIENT_5,
+        ORIENT_6, ORIENT_7, ORIENT_8,
+        ACTIVE, VERSION_32,
+        INCIDENCE, CHORD, C0, CX, CY, CZ, CZ_CZ0,
+        STALL_0, STALL_1, STALL_2, STALL_3, SLAT_STALL_0,
+        WIDTH_0, WIDTH_1, WIDTH_2, WIDTH_3,
+        PEAK_0, PEAK_1,
+        SPOILER_LIFT, FLAP_LIFT,
+        FLAP_DRAG_POS, FLAP_DRAG_AOA,
+        FLAP_DRAG, SPOILER_DRAG, SLAT_DRAG,
+        INDUCED_DRAG,
+        NUM_FIELDS
+    };
+
+private:
+    float* field(int f) { return _data + f * _stride; }
+    void pack(int i, Surface* s);
+
+    Vector _surfaces;
+    int _stride; // array length, the number of surfaces rounded up
+    float* _data;
+};
+
+}; // namespace yasim
+#endif // _SURFACEARRAY_HPP
@@ -31,6 +31,7 @@ public:
     void setTwist(float angle);
     void setCamber(float camber);
     void setIncidence(float incidence);
+    float getIncidence() { return _incidence; }
     void setInducedDrag(float drag) { _inducedDrag = drag; }
     
     void setFlap0(float start, float end, float lift, float drag);
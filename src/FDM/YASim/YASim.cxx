@@ -178,8 +178,19 @@ void YASim::init()
         throw e;
     }
 
-    // Compile it into a real airplane, and tell the user what they got
+    // Compile it into a real airplane, and tell the user what they got.
+    // The solver results are kept in $FG_HOME/yasim-solutions, set
+    // /sim/yasim/solution-cache to false to always run the solver.
+    bool useCache = fgGetBool("/sim/yasim/solution-cache", true);
+    bool cached = false;
+    if (useCache) {
+        SGPath cacheDir(globals->get_fg_home());
+        cacheDir.append("yasim-solutions");
+        cached = _fdm->readSolution(f, cacheDir);
+    }
     airplane->compile();
+    if (useCache && !cached)
+        _fdm->writeSolution();
     report();
 
     _fdm->init();
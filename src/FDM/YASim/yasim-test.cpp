@@ -6,6 +6,7 @@
 #include <simgear/props/props.hxx>
 #include <simgear/xml/easyxml.hxx>
 #include <simgear/misc/sg_path.hxx>
+#include <simgear/timing/timestamp.hxx>
 
 #include "FGFDM.hpp"
 #include "Atmosphere.hpp"
@@ -68,9 +69,84 @@ void yasim_graph(Airplane* a, float alt, float kts)
     }
 }
 
+static void yasim_calcForces(Model* m, State* s, bool kernel,
+                             float* acc, float* rot)
+{
+    m->setSurfaceKernel(kernel);
+    m->getBody()->reset();
+    m->calcForces(s);
+    m->getBody()->getAccel(acc);
+    m->getBody()->getAngularAccel(rot);
+}
+
+static float yasim_diff(float* a, float* b)
+{
+    float d[3];
+    Math::sub3(a, b, d);
+    float mag = Math::mag3(b);
+    return mag > 0 ? Math::mag3(d) / mag : Math::mag3(d);
+}
+
+// Time Model::calcForces() with the SurfaceArray kernel and with the
+// per-surface Surface::calcForce() calls, over a sweep of AoA at the
+// specified speed and altitude, and compare the accelerations they
+// produce.
+void yasim_bench(Airplane* a, float alt, float kts, int count)
+{
+    Model* m = a->getModel();
+    State s;
+
+    m->setAir(Atmosphere::getStdPressure(alt),
+              Atmosphere::getStdTemperature(alt),
+              Atmosphere::getStdDensity(alt));
+    m->getBody()->recalc();
+    m->initIteration();
+
+    float maxAcc = 0, maxRot = 0;
+    double kernelTime = 0, scalarTime = 0;
+    int deg, i, calls = 0;
+    for(deg=-175; deg<=175; deg+=5) {
+        Airplane::setupState(deg * DEG2RAD, kts * KTS2MPS, 0, &s);
+
+        float acc[3], rot[3], refAcc[3], refRot[3];
+        yasim_calcForces(m, &s, true, acc, rot);
+        yasim_calcForces(m, &s, false, refAcc, refRot);
+        float d = yasim_diff(acc, refAcc);
+        if(d > maxAcc) maxAcc = d;
+        d = yasim_diff(rot, refRot);
+        if(d > maxRot) maxRot = d;
+
+        SGTimeStamp start = SGTimeStamp::now();
+        m->setSurfaceKernel(true);
+        for(i=0; i<count; i++) {
+            m->getBody()->reset();
+            m->calcForces(&s);
+        }
+        kernelTime += (SGTimeStamp::now() - start).toSecs();
+
+        start = SGTimeStamp::now();
+        m->setSurfaceKernel(false);
+        for(i=0; i<count; i++) {
+            m->getBody()->reset();
+            m->calcForces(&s);
+        }
+        scalarTime += (SGTimeStamp::now() - start).toSecs();
+        calls += count;
+    }
+    m->setSurfaceKernel(true);
+
+    printf("calcForces, %d calls at %g ft, %g kts:\n", calls, alt, kts);
+    printf("  Surface kernel: %.1f ns/call\n", 1e9 * kernelTime / calls);
+    printf("  Surface::calcForce: %.1f ns/call\n", 1e9 * scalarTime / calls);
+    printf("  Max relative difference: accel %g, angular accel %g\n",
+           maxAcc, maxRot);
+}
+
 int usage()
 {
     fprintf(stderr, "Usage: yasim <ac.xml> [-g [-a alt] [-s kts]]\n");
+    fprintf(stderr, "       yasim <ac.xml> -b [-a alt] [-s kts] [-n count]\n");
+    fprintf(stderr, "       yasim <ac.xml> -c <solution cache dir>\n");
     return 1;
 }
 
@@ -90,11 +166,25 @@ int main(int argc, char** argv)
                e.getFormattedMessage().c_str(), e.getOrigin());
     }
 
+    // Fill in a solver cache directory, like FlightGear's
+    // $FG_HOME/yasim-solutions
+    const char* cacheDir = 0;
+    bool cached = false;
+    if(argc > 3 && strcmp(argv[2], "-c") == 0) {
+        cacheDir = argv[3];
+        cached = fdm->readSolution(SGPath(argv[1]), SGPath(cacheDir));
+    }
+
     // ... and run
     a->compile();
     if(a->getFailureMsg())
         printf("SOLUTION FAILURE: %s\n", a->getFailureMsg());
 
+    if(cached)
+        printf("Using the cached solution in %s\n", cacheDir);
+    else if(cacheDir && fdm->writeSolution())
+        printf("Solution cached in %s\n", cacheDir);
+
     if(!a->getFailureMsg() && argc > 2 && strcmp(argv[2], "-g") == 0) {
         float alt = 5000, kts = 100;
         for(int i=3; i<argc; i++) {
@@ -103,6 +193,16 @@ int main(int argc, char** argv)
             else return usage();
         }
         yasim_graph(a, alt, kts);
+    } else if(!a->getFailureMsg() && argc > 2 && strcmp(argv[2], "-b") == 0) {
+        float alt = 5000, kts = 100;
+        int count = 10000;
+        for(int i=3; i<argc; i++) {
+            if     (std::strcmp(argv[i], "-a") == 0) alt = std::atof(argv[++i]);
+            else if(std::strcmp(argv[i], "-s") == 0) kts = std::atof(argv[++i]);
+            else if(std::strcmp(argv[i], "-n") == 0) count = std::atoi(argv[++i]);
+            else return usage();
+        }
+        yasim_bench(a, alt, kts, count);
     } else {
         float aoa = a->getCruiseAoA() * RAD2DEG;
         float tail = -1 * a->getTailIncidence() * RAD2DEG;
@@ -416,6 +416,23 @@ FGInterface::bind ()
 
   _tiedProperties.Tie("/accelerations/n-z-cg-fps_sec",
                       this, &FGInterface::get_N_Z_cg); // read-only
+
+  // Ground cache prefetching and statistics
+  _tiedProperties.Tie("/fdm/ground-cache/prefetch", &ground_cache,
+                      &FGGroundCache::get_prefetch,
+                      &FGGroundCache::set_prefetch);
+  _tiedProperties.Tie("/fdm/ground-cache/sync-builds", &ground_cache,
+                      &FGGroundCache::get_sync_builds); // read-only
+  _tiedProperties.Tie("/fdm/ground-cache/last-build-ms", &ground_cache,
+                      &FGGroundCache::get_last_build_msec); // read-only
+  _tiedProperties.Tie("/fdm/ground-cache/prefetch-hits", &ground_cache,
+                      &FGGroundCache::get_prefetch_hits); // read-only
+  _tiedProperties.Tie("/fdm/ground-cache/prefetch-misses", &ground_cache,
+                      &FGGroundCache::get_prefetch_misses); // read-only
+  _tiedProperties.Tie("/fdm/ground-cache/prefetch-builds", &ground_cache,
+                      &FGGroundCache::get_prefetch_builds); // read-only
+  _tiedProperties.Tie("/fdm/ground-cache/last-prefetch-ms", &ground_cache,
+                      &FGGroundCache::get_last_prefetch_msec); // read-only
 }
 
 
@@ -776,6 +793,49 @@ FGInterface::get_agl_ft(double t, const double pt[3], double max_altoff,
   return ret;
 }
 
+void
+FGInterface::get_agl_m(double t, double max_altoff, FGGroundQueryBatch& batch)
+{
+  get_agl_batch(t, max_altoff, 1, batch);
+}
+
+void
+FGInterface::get_agl_ft(double t, double max_altoff, FGGroundQueryBatch& batch)
+{
+  get_agl_batch(t, max_altoff, SG_FEET_TO_METER, batch);
+}
+
+void
+FGInterface::get_agl_batch(double t, double max_altoff, double scale,
+                           FGGroundQueryBatch& batch)
+{
+  // scale converts the callers units to meters, see get_agl_ft
+  unsigned n = batch.size();
+  _groundQuery.resize(n);
+  for (unsigned i = 0; i < n; ++i) {
+    SGVec3d pt = batch.getPoint(i) - max_altoff*ground_cache.get_down();
+    _groundQuery.setPoint(i, scale*pt);
+  }
+
+  ground_cache.get_agl(t, _groundQuery);
+
+  for (unsigned i = 0; i < n; ++i) {
+    // correct the linear velocity, since the line intersector delivers
+    // values for the start point, see get_agl_m
+    SGVec3d linearVel = _groundQuery.linearVel[i];
+    linearVel += cross(_groundQuery.angularVel[i],
+                       _groundQuery.contact[i] - _groundQuery.getPoint(i));
+
+    batch.contact[i] = (1/scale)*_groundQuery.contact[i];
+    batch.normal[i] = _groundQuery.normal[i];
+    batch.linearVel[i] = (1/scale)*linearVel;
+    batch.angularVel[i] = _groundQuery.angularVel[i];
+    batch.material[i] = _groundQuery.material[i];
+    batch.id[i] = _groundQuery.id[i];
+    batch.found[i] = _groundQuery.found[i];
+  }
+}
+
 bool
 FGInterface::get_nearest_m(double t, const double pt[3], double maxDist,
                            double contact[3], double normal[3],
@@ -209,6 +209,11 @@ private:
 
     // the ground cache object itself.
     FGGroundCache ground_cache;
+    // scratch space for the batched ground queries
+    FGGroundQueryBatch _groundQuery;
+
+    void get_agl_batch(double t, double max_altoff, double scale,
+                       FGGroundQueryBatch& batch);
 
     void set_A_X_pilot(double x)
     { _set_Accels_Pilot_Body(x, _state.a_pilot_body_v[1], _state.a_pilot_body_v[2]); }
@@ -719,6 +724,14 @@ public:
                     double contact[3], double normal[3], double linearVel[3],
                     double angularVel[3], simgear::BVHMaterial const*& material,
                     simgear::BVHNode::Id& id);
+
+    // Same as above for all points of the batch at once, which is a lot
+    // cheaper than single queries as the ground cache is only traversed
+    // once. Points and results are in meters or feet respectively, and
+    // batch.found[i] is what the single point query returns for point i.
+    void get_agl_m(double t, double max_altoff, FGGroundQueryBatch& batch);
+    void get_agl_ft(double t, double max_altoff, FGGroundQueryBatch& batch);
+
     double get_groundlevel_m(double lat, double lon, double alt);
     double get_groundlevel_m(const SGGeod& geod);
 
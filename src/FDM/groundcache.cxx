@@ -59,6 +59,9 @@
 #include <simgear/bvh/BVHSubTreeCollector.hxx>
 #include <simgear/bvh/BVHLineSegmentVisitor.hxx>
 #include <simgear/bvh/BVHNearestPointVisitor.hxx>
+#include <simgear/threads/SGThread.hxx>
+#include <simgear/threads/SGGuard.hxx>
+#include <simgear/timing/timestamp.hxx>
 
 #ifdef GROUNDCACHE_DEBUG
 #include <simgear/scene/model/BVHDebugCollectVisitor.hxx>
@@ -73,10 +76,23 @@
 
 using namespace simgear;
 
+// How far ahead of the vehicle the prefetched cache reaches, in seconds.
+// Also bounds the age of a prefetched cache, so newly loaded scenery
+// shows up.
+static const double PREFETCH_HORIZON_SEC = 2.0;
+// Velocities above that are jumps in position, not vehicle movement.
+static const double PREFETCH_MAX_SPEED = 3000.0;
+
+// In coarse mode the CacheFill visitor does not collect the sub tree
+// intersecting the ball, but just references the whole bounding volume
+// tree of any scenery node which might contribute. The real sub tree is
+// then collected from that result, which no longer needs the scene graph
+// and can be done on another thread.
 class FGGroundCache::CacheFill : public osg::NodeVisitor {
 public:
     CacheFill(const SGVec3d& center, const SGVec3d& down, const double& radius,
-              const double& startTime, const double& endTime) :
+              const double& startTime, const double& endTime,
+              bool coarse = false) :
         osg::NodeVisitor(osg::NodeVisitor::TRAVERSE_ACTIVE_CHILDREN),
         _center(center),
         _down(down),
@@ -86,7 +102,9 @@ public:
         _sceneryHit(0, 0, 0),
         _maxDown(SGGeod::fromCart(center).getElevationM() + 9999),
         _material(0),
-        _haveHit(false)
+        _haveHit(false),
+        _coarse(coarse),
+        _haveMotion(false)
     {
         setTraversalMask(SG_NODEMASK_TERRAIN_BIT);
     }
@@ -181,6 +199,7 @@ public:
 
         if (mSubTreeCollector.haveChildren()) {
             if (velocity) {
+                _haveMotion = true;
                 simgear::BVHMotionTransform* bvhTransform;
                 bvhTransform = new simgear::BVHMotionTransform;
                 bvhTransform->setToWorldTransform(SGMatrixd(matrix.ptr()));
@@ -241,6 +260,12 @@ public:
         if (!bvNode)
             return;
 
+        if (_coarse) {
+            // The bounding sphere test for the node already passed
+            mSubTreeCollector.addNode(bvNode);
+            return;
+        }
+
         // Find a croase ground intersection 
         SGLineSegmentd line(_center + _radius*_down, _center + _maxDown*_down);
         simgear::BVHLineSegmentVisitor lineSegmentVisitor(line, _startTime);
@@ -278,6 +303,10 @@ public:
     { return SGGeod::fromCart(_sceneryHit).getElevationM(); }
     const simgear::BVHMaterial* getMaterialBelowCache() const
     { return _material; }
+
+    // True if moving scenery, like a carrier, was collected
+    bool getHaveMotion() const
+    { return _haveMotion; }
     
 private:
     SGVec3d _center;
@@ -291,6 +320,150 @@ private:
     double _maxDown;
     const simgear::BVHMaterial* _material;
     bool _haveHit;
+    bool _coarse;
+    bool _haveMotion;
+};
+
+/// Background thread collecting the local sub tree from the result of a
+/// coarse CacheFill. Holds at most one pending job and one result.
+class FGGroundCache::Prefetcher : public SGThread {
+public:
+    struct Job {
+        Job() :
+            center(0, 0, 0), down(0, 0, 0), radius(0),
+            startTime(0), endTime(0), cacheTimeOffset(0)
+        { }
+
+        SGSharedPtr<BVHNode> coarseTree;
+        SGVec3d center;
+        SGVec3d down;
+        double radius;
+        // the simulation times, without the cache time offset
+        double startTime;
+        double endTime;
+        double cacheTimeOffset;
+    };
+
+    Prefetcher() :
+        _haveJob(false),
+        _busy(false),
+        _haveResult(false),
+        _quit(false)
+    { }
+
+    virtual void run()
+    {
+        for (;;) {
+            Job job;
+            {
+                SGGuard<SGMutex> g(_lock);
+                while (!_haveJob && !_quit)
+                    _wake.wait(_lock);
+                if (_quit)
+                    return;
+                std::swap(job, _job);
+                _haveJob = false;
+            }
+
+            SGTimeStamp st = SGTimeStamp::now();
+            PrefetchResult result = build(job);
+            result.buildMSec = 1e3*(SGTimeStamp::now() - st).toSecs();
+
+            SGGuard<SGMutex> g(_lock);
+            std::swap(_result, result);
+            _haveResult = true;
+            _busy = false;
+        }
+    }
+
+    void quit()
+    {
+        {
+            SGGuard<SGMutex> g(_lock);
+            _quit = true;
+            _wake.signal();
+        }
+        join();
+    }
+
+    bool busy() const
+    {
+        SGGuard<SGMutex> g(_lock);
+        return _busy;
+    }
+
+    void submit(Job& job)
+    {
+        SGGuard<SGMutex> g(_lock);
+        std::swap(_job, job);
+        _haveJob = true;
+        _busy = true;
+        _wake.signal();
+    }
+
+    bool takeResult(PrefetchResult& result)
+    {
+        SGGuard<SGMutex> g(_lock);
+        if (!_haveResult)
+            return false;
+        std::swap(result, _result);
+        _result = PrefetchResult();
+        _haveResult = false;
+        return true;
+    }
+
+private:
+    static PrefetchResult build(const Job& job)
+    {
+        PrefetchResult result;
+        result.center = job.center;
+        result.radius = job.radius;
+        result.startTime = job.startTime;
+        result.endTime = job.endTime;
+
+        double startTime = job.startTime + job.cacheTimeOffset;
+
+        // Same coarse ground intersection as CacheFill does
+        double maxDown = SGGeod::fromCart(job.center).getElevationM() + 9999;
+        SGLineSegmentd line(job.center + job.radius*job.down,
+                            job.center + maxDown*job.down);
+        BVHLineSegmentVisitor lineSegmentVisitor(line, startTime);
+        job.coarseTree->accept(lineSegmentVisitor);
+        if (!lineSegmentVisitor.empty()) {
+            SGGeod geodPt = SGGeod::fromCart(lineSegmentVisitor.getPoint());
+            result.altitude = geodPt.getElevationM();
+            result.material = lineSegmentVisitor.getMaterial();
+            result.foundGround = true;
+        }
+
+        BVHSubTreeCollector subTreeCollector(SGSphered(job.center, job.radius));
+        job.coarseTree->accept(subTreeCollector);
+        result.tree = subTreeCollector.getNode();
+
+        if (!result.foundGround && result.tree) {
+            SGLineSegmentd line(job.center + job.radius*job.down,
+                                job.center - 1e3*job.down);
+            BVHLineSegmentVisitor lineSegmentVisitor(line, startTime);
+            result.tree->accept(lineSegmentVisitor);
+            if (!lineSegmentVisitor.empty()) {
+                SGGeod geodPt = SGGeod::fromCart(lineSegmentVisitor.getPoint());
+                result.altitude = geodPt.getElevationM();
+                result.material = lineSegmentVisitor.getMaterial();
+                result.foundGround = true;
+            }
+        }
+
+        return result;
+    }
+
+    mutable SGMutex _lock;
+    SGWaitCondition _wake;
+    Job _job;
+    bool _haveJob;
+    bool _busy;
+    PrefetchResult _result;
+    bool _haveResult;
+    bool _quit;
 };
 
 FGGroundCache::FGGroundCache() :
@@ -302,7 +475,18 @@ FGGroundCache::FGGroundCache() :
     reference_wgs84_point(SGVec3d(0, 0, 0)),
     reference_vehicle_radius(0),
     down(0.0, 0.0, 0.0),
-    found_ground(false)
+    found_ground(false),
+    _prefetchEnabled(false),
+    _prefetchRetryTime(0),
+    _lastPoint(0, 0, 0),
+    _lastTime(0),
+    _velocity(0, 0, 0),
+    _syncBuilds(0),
+    _prefetchHits(0),
+    _prefetchMisses(0),
+    _prefetchBuilds(0),
+    _lastBuildMSec(0),
+    _lastPrefetchMSec(0)
 {
 #ifdef GROUNDCACHE_DEBUG
     _lookupTime = SGTimeStamp::fromSec(0.0);
@@ -314,6 +498,107 @@ FGGroundCache::FGGroundCache() :
 
 FGGroundCache::~FGGroundCache()
 {
+    set_prefetch(false);
+}
+
+void
+FGGroundCache::set_prefetch(bool enable)
+{
+    if (enable == _prefetchEnabled)
+        return;
+
+    _prefetchEnabled = enable;
+    if (enable) {
+        _prefetcher.reset(new Prefetcher);
+        _prefetcher->start();
+    } else if (_prefetcher.get()) {
+        _prefetcher->quit();
+        _prefetcher.reset();
+        _prefetched = PrefetchResult();
+    }
+}
+
+bool
+FGGroundCache::use_prefetched(double startSimTime, double endSimTime,
+                              const SGVec3d& pt, double rad)
+{
+    PrefetchResult result;
+    if (_prefetcher->takeResult(result)) {
+        _lastPrefetchMSec = result.buildMSec;
+        ++_prefetchBuilds;
+        if (result.foundGround)
+            std::swap(_prefetched, result);
+    }
+
+    if (!_prefetched.foundGround)
+        return false;
+    if (startSimTime < _prefetched.startTime ||
+        _prefetched.endTime < endSimTime)
+        return false;
+    if (_prefetched.radius < dist(pt, _prefetched.center) + rad)
+        return false;
+
+    SGGeod geodPt = SGGeod::fromCart(pt);
+    if (!globals->get_tile_mgr()->schedule_scenery(geodPt, rad, 1.0))
+        return false;
+
+    reference_wgs84_point = pt;
+    reference_vehicle_radius = rad;
+    cache_ref_time = startSimTime;
+    SGQuatd hlToEc = SGQuatd::fromLonLat(geodPt);
+    down = hlToEc.rotate(SGVec3d(0, 0, 1));
+
+    _localBvhTree = _prefetched.tree;
+    _altitude = _prefetched.altitude;
+    _material = _prefetched.material;
+    found_ground = true;
+    return true;
+}
+
+void
+FGGroundCache::schedule_prefetch(double startSimTime, const SGVec3d& pt,
+                                 double rad)
+{
+    if (_prefetcher->busy() || startSimTime < _prefetchRetryTime)
+        return;
+
+    // Still good for the next half of the horizon?
+    double halfHorizon = 0.5*PREFETCH_HORIZON_SEC;
+    SGVec3d ahead = pt + halfHorizon*_velocity;
+    if (_prefetched.foundGround &&
+        startSimTime + halfHorizon <= _prefetched.endTime &&
+        dist(ahead, _prefetched.center) + rad <= _prefetched.radius)
+        return;
+
+    // A ball around the path for the whole horizon
+    Prefetcher::Job job;
+    job.center = ahead;
+    job.radius = 2*rad + halfHorizon*norm(_velocity);
+    job.startTime = startSimTime;
+    job.endTime = startSimTime + PREFETCH_HORIZON_SEC;
+    job.cacheTimeOffset = cache_time_offset;
+
+    SGGeod geodCenter = SGGeod::fromCart(job.center);
+    if (!globals->get_tile_mgr()->schedule_scenery(geodCenter, job.radius, 1.0))
+        return;
+    SGQuatd hlToEc = SGQuatd::fromLonLat(geodCenter);
+    job.down = hlToEc.rotate(SGVec3d(0, 0, 1));
+
+    // Only the scene graph traversal happens here, on the fdm thread
+    CacheFill coarseFill(job.center, job.down, job.radius,
+                         job.startTime + cache_time_offset,
+                         job.endTime + cache_time_offset, true);
+    globals->get_scenery()->get_scene_graph()->accept(coarseFill);
+    job.coarseTree = coarseFill.getBVHNode();
+
+    // Moving scenery can not be predicted that far, build synchronously
+    // while it is around.
+    if (coarseFill.getHaveMotion() || !job.coarseTree) {
+        _prefetchRetryTime = job.endTime;
+        return;
+    }
+
+    _prefetcher->submit(job);
 }
 
 bool
@@ -324,6 +609,27 @@ FGGroundCache::prepare_ground_cache(double startSimTime, double endSimTime,
     SGTimeStamp t0 = SGTimeStamp::now();
 #endif
 
+    if (_lastTime < startSimTime) {
+        SGVec3d velocity = (pt - _lastPoint)/(startSimTime - _lastTime);
+        if (norm(velocity) < PREFETCH_MAX_SPEED)
+            _velocity = velocity;
+        else
+            _velocity = SGVec3d::zeros();
+    }
+    _lastPoint = pt;
+    _lastTime = startSimTime;
+
+    if (_prefetchEnabled && !_wire) {
+        if (use_prefetched(startSimTime, endSimTime, pt, rad)) {
+            ++_prefetchHits;
+            schedule_prefetch(startSimTime, pt, rad);
+            return found_ground;
+        }
+        ++_prefetchMisses;
+    }
+
+    SGTimeStamp buildStart = SGTimeStamp::now();
+
     // Empty cache.
     found_ground = false;
 
@@ -352,6 +658,8 @@ FGGroundCache::prepare_ground_cache(double startSimTime, double endSimTime,
     down = hlToEc.rotate(SGVec3d(0, 0, 1));
     
     // Get the ground cache, that is a local collision tree of the environment
+    // The prefetcher works in unshifted simulation time.
+    double prefetchStartTime = startSimTime;
     startSimTime += cache_time_offset;
     endSimTime += cache_time_offset;
     CacheFill subtreeCollector(pt, down, rad, startSimTime, endSimTime);
@@ -394,6 +702,12 @@ FGGroundCache::prepare_ground_cache(double startSimTime, double endSimTime,
         SG_LOG(SG_FLIGHT, SG_WARN, "prepare_ground_cache(): trying to build "
                "cache without any scenery below the aircraft");
 
+    ++_syncBuilds;
+    _lastBuildMSec = 1e3*(SGTimeStamp::now() - buildStart).toSecs();
+
+    if (_prefetchEnabled && !_wire)
+        schedule_prefetch(prefetchStartTime, pt, rad);
+
 #ifdef GROUNDCACHE_DEBUG
     t0 = SGTimeStamp::now() - t0;
     _buildTime += t0;
@@ -741,6 +1055,307 @@ FGGroundCache::get_agl(double t, const SGVec3d& pt, SGVec3d& contact,
 }
 
 
+void
+FGGroundQueryBatch::resize(unsigned n)
+{
+    x.resize(n);
+    y.resize(n);
+    z.resize(n);
+    contact.resize(n);
+    normal.resize(n);
+    linearVel.resize(n);
+    angularVel.resize(n);
+    id.resize(n);
+    material.resize(n);
+    found.resize(n);
+}
+
+// Works like the BVHLineSegmentVisitor, but for a set of line segments at
+// once. At every node only those segments which still intersect the
+// node's bounding volume are carried on to the children. These active
+// sets are kept as frames on a single index stack, so the traversal does
+// not allocate once the stacks have grown to the tree depth.
+class FGGroundCache::MultiLineSegmentVisitor : public BVHVisitor {
+public:
+    MultiLineSegmentVisitor(const double& t) :
+        _frameBegin(0),
+        _time(t)
+    { }
+
+    void addLineSegment(const SGLineSegmentd& lineSegment)
+    {
+        Ray ray;
+        ray.lineSegment = lineSegment;
+        ray.normal = SGVec3d::zeros();
+        ray.linearVelocity = SGVec3d::zeros();
+        ray.angularVelocity = SGVec3d::zeros();
+        ray.material = 0;
+        ray.id = 0;
+        ray.haveHit = false;
+        _rays.push_back(ray);
+        _active.push_back(_rays.size() - 1);
+    }
+
+    virtual void apply(BVHGroup& group)
+    {
+        size_t frame;
+        if (!pushActive(group.getBoundingSphere(), frame))
+            return;
+        group.traverse(*this);
+        popActive(frame);
+    }
+    virtual void apply(BVHPageNode& pageNode)
+    {
+        size_t frame;
+        if (!pushActive(pageNode.getBoundingSphere(), frame))
+            return;
+        pageNode.traverse(*this);
+        popActive(frame);
+    }
+    virtual void apply(BVHTransform& transform)
+    {
+        size_t frame;
+        if (!pushActive(transform.getBoundingSphere(), frame))
+            return;
+
+        size_t saved = saveRays();
+        for (size_t i = _frameBegin; i < _active.size(); ++i) {
+            Ray& ray = _rays[_active[i]];
+            ray.lineSegment = transform.lineSegmentToLocal(ray.lineSegment);
+        }
+
+        transform.traverse(*this);
+
+        for (size_t i = _frameBegin; i < _active.size(); ++i) {
+            Ray& ray = _rays[_active[i]];
+            const SavedRay& old = _savedRays[saved + i - _frameBegin];
+            if (ray.haveHit) {
+                ray.linearVelocity = transform.vecToWorld(ray.linearVelocity);
+                ray.angularVelocity = transform.vecToWorld(ray.angularVelocity);
+                SGVec3d point(transform.ptToWorld(ray.lineSegment.getEnd()));
+                ray.lineSegment.set(old.lineSegment.getStart(), point);
+                ray.normal = transform.vecToWorld(ray.normal);
+            } else {
+                ray.lineSegment = old.lineSegment;
+                ray.haveHit = old.haveHit;
+            }
+        }
+        _savedRays.resize(saved);
+        popActive(frame);
+    }
+    virtual void apply(BVHMotionTransform& transform)
+    {
+        size_t frame;
+        if (!pushActive(transform.getBoundingSphere(), frame))
+            return;
+
+        size_t saved = saveRays();
+        SGMatrixd toLocal = transform.getToLocalTransform(_time);
+        for (size_t i = _frameBegin; i < _active.size(); ++i) {
+            Ray& ray = _rays[_active[i]];
+            ray.lineSegment = ray.lineSegment.transform(toLocal);
+        }
+
+        transform.traverse(*this);
+
+        SGMatrixd toWorld = transform.getToWorldTransform(_time);
+        for (size_t i = _frameBegin; i < _active.size(); ++i) {
+            Ray& ray = _rays[_active[i]];
+            const SavedRay& old = _savedRays[saved + i - _frameBegin];
+            if (ray.haveHit) {
+                SGVec3d localStart = ray.lineSegment.getStart();
+                ray.linearVelocity += transform.getLinearVelocityAt(localStart);
+                ray.angularVelocity += transform.getAngularVelocity();
+                ray.linearVelocity = toWorld.xformVec(ray.linearVelocity);
+                ray.angularVelocity = toWorld.xformVec(ray.angularVelocity);
+                SGVec3d localEnd = ray.lineSegment.getEnd();
+                ray.lineSegment.set(old.lineSegment.getStart(),
+                                    toWorld.xformPt(localEnd));
+                ray.normal = toWorld.xformVec(ray.normal);
+                if (!ray.id)
+                    ray.id = transform.getId();
+            } else {
+                ray.lineSegment = old.lineSegment;
+                ray.haveHit = old.haveHit;
+            }
+        }
+        _savedRays.resize(saved);
+        popActive(frame);
+    }
+    virtual void apply(BVHLineGeometry&)
+    { }
+    virtual void apply(BVHStaticGeometry& node)
+    {
+        size_t frame;
+        if (!pushActive(node.getBoundingSphere(), frame))
+            return;
+        node.traverse(*this);
+        popActive(frame);
+    }
+
+    virtual void apply(const BVHStaticBinary& node, const BVHStaticData& data)
+    {
+        size_t frame = _frameBegin;
+        size_t end = _active.size();
+        for (size_t i = _frameBegin; i < end; ++i) {
+            SGLineSegmentf lineSegment(_rays[_active[i]].lineSegment);
+            if (intersects(lineSegment, node.getBoundingBox()))
+                _active.push_back(_active[i]);
+        }
+        if (_active.size() == end)
+            return;
+        _frameBegin = end;
+
+        // As in the single segment visitor, enter the box containing the
+        // start point first. The segments are all parallel and close
+        // together, so the first one is good enough for all of them.
+        SGVec3f start(_rays[_active[_frameBegin]].lineSegment.getStart());
+        node.traverse(*this, data, start);
+        popActive(frame);
+    }
+    virtual void apply(const BVHStaticTriangle& triangle,
+                       const BVHStaticData& data)
+    {
+        SGTrianglef tri = triangle.getTriangle(data);
+        for (size_t i = _frameBegin; i < _active.size(); ++i) {
+            Ray& ray = _rays[_active[i]];
+            SGVec3f point;
+            if (!intersects(point, tri, SGLineSegmentf(ray.lineSegment), 1e-4f))
+                continue;
+            ray.lineSegment.set(ray.lineSegment.getStart(), SGVec3d(point));
+            ray.normal = SGVec3d(tri.getNormal());
+            ray.linearVelocity = SGVec3d::zeros();
+            ray.angularVelocity = SGVec3d::zeros();
+            ray.material = data.getMaterial(triangle.getMaterialIndex());
+            ray.id = 0;
+            ray.haveHit = true;
+        }
+    }
+
+    bool empty(unsigned i) const
+    { return !_rays[i].haveHit; }
+    SGVec3d getPoint(unsigned i) const
+    { return _rays[i].lineSegment.getEnd(); }
+    const SGVec3d& getNormal(unsigned i) const
+    { return _rays[i].normal; }
+    const SGVec3d& getLinearVelocity(unsigned i) const
+    { return _rays[i].linearVelocity; }
+    const SGVec3d& getAngularVelocity(unsigned i) const
+    { return _rays[i].angularVelocity; }
+    const BVHMaterial* getMaterial(unsigned i) const
+    { return _rays[i].material; }
+    BVHNode::Id getId(unsigned i) const
+    { return _rays[i].id; }
+
+private:
+    struct Ray {
+        SGLineSegmentd lineSegment;
+        SGVec3d normal;
+        SGVec3d linearVelocity;
+        SGVec3d angularVelocity;
+        const BVHMaterial* material;
+        BVHNode::Id id;
+        bool haveHit;
+    };
+    struct SavedRay {
+        SGLineSegmentd lineSegment;
+        bool haveHit;
+    };
+
+    // Push a new frame with the active segments intersecting the sphere.
+    // Returns false and leaves the stack alone if there are none.
+    bool pushActive(const SGSphered& sphere, size_t& frame)
+    {
+        frame = _frameBegin;
+        size_t end = _active.size();
+        for (size_t i = _frameBegin; i < end; ++i) {
+            if (intersects(_rays[_active[i]].lineSegment, sphere))
+                _active.push_back(_active[i]);
+        }
+        if (_active.size() == end)
+            return false;
+        _frameBegin = end;
+        return true;
+    }
+    void popActive(size_t frame)
+    {
+        _active.resize(_frameBegin);
+        _frameBegin = frame;
+    }
+    // Remember the world space state of the active segments before
+    // descending into a transform, returns the start of the saved range.
+    size_t saveRays()
+    {
+        size_t saved = _savedRays.size();
+        for (size_t i = _frameBegin; i < _active.size(); ++i) {
+            Ray& ray = _rays[_active[i]];
+            SavedRay old;
+            old.lineSegment = ray.lineSegment;
+            old.haveHit = ray.haveHit;
+            _savedRays.push_back(old);
+            ray.haveHit = false;
+        }
+        return saved;
+    }
+
+    std::vector<Ray> _rays;
+    std::vector<unsigned> _active;
+    size_t _frameBegin;
+    std::vector<SavedRay> _savedRays;
+    double _time;
+};
+
+void
+FGGroundCache::get_agl(double t, FGGroundQueryBatch& batch)
+{
+#ifdef GROUNDCACHE_DEBUG
+    SGTimeStamp t0 = SGTimeStamp::now();
+#endif
+
+    unsigned n = batch.size();
+    t += cache_time_offset;
+    MultiLineSegmentVisitor lineSegmentVisitor(t);
+    for (unsigned i = 0; i < n; ++i) {
+        SGVec3d pt = batch.getPoint(i);
+        lineSegmentVisitor.addLineSegment(
+            SGLineSegmentd(pt, pt + 10*reference_vehicle_radius*down));
+    }
+    if (_localBvhTree && n)
+        _localBvhTree->accept(lineSegmentVisitor);
+
+#ifdef GROUNDCACHE_DEBUG
+    t0 = SGTimeStamp::now() - t0;
+    _lookupTime += t0;
+    _lookupCount += n;
+#endif
+
+    for (unsigned i = 0; i < n; ++i) {
+        if (!lineSegmentVisitor.empty(i)) {
+            batch.contact[i] = lineSegmentVisitor.getPoint(i);
+            SGVec3d normal = lineSegmentVisitor.getNormal(i);
+            if (0 < dot(normal, down))
+                normal = -normal;
+            batch.normal[i] = normal;
+            batch.linearVel[i] = lineSegmentVisitor.getLinearVelocity(i);
+            batch.angularVel[i] = lineSegmentVisitor.getAngularVelocity(i);
+            batch.material[i] = lineSegmentVisitor.getMaterial(i);
+            batch.id[i] = lineSegmentVisitor.getId(i);
+            batch.found[i] = true;
+        } else {
+            // Same fallback as for the single point query
+            SGGeod geodPt = SGGeod::fromCart(batch.getPoint(i));
+            geodPt.setElevationM(_altitude);
+            batch.contact[i] = SGVec3d::fromGeod(geodPt);
+            batch.normal[i] = -down;
+            batch.linearVel[i] = SGVec3d(0, 0, 0);
+            batch.angularVel[i] = SGVec3d(0, 0, 0);
+            batch.material[i] = _material;
+            batch.id[i] = 0;
+            batch.found[i] = found_ground;
+        }
+    }
+}
+
 bool
 FGGroundCache::get_nearest(double t, const SGVec3d& pt, double maxDist,
                            SGVec3d& contact, SGVec3d& linearVel,
@@ -30,6 +30,9 @@
 #include <simgear/bvh/BVHNode.hxx>
 #include <simgear/structure/SGSharedPtr.hxx>
 
+#include <memory>
+#include <vector>
+
 // #define GROUNDCACHE_DEBUG
 #ifdef GROUNDCACHE_DEBUG
 #include <osg/Group>
@@ -42,6 +45,33 @@ class BVHLineGeometry;
 class BVHMaterial;
 }
 
+// Points and results of a batched ground query, see
+// FGGroundCache::get_agl(double, FGGroundQueryBatch&).
+// Kept as one array per component, so an FDM can fill in its whole gear
+// table and read back the results without per point bookkeeping.
+struct FGGroundQueryBatch {
+    void resize(unsigned n);
+    unsigned size() const
+    { return x.size(); }
+
+    SGVec3d getPoint(unsigned i) const
+    { return SGVec3d(x[i], y[i], z[i]); }
+    void setPoint(unsigned i, const SGVec3d& pt)
+    { x[i] = pt[0]; y[i] = pt[1]; z[i] = pt[2]; }
+
+    // The query points in wgs84 cartesian coordinates
+    std::vector<double> x, y, z;
+
+    // The results per point, as returned by the single point get_agl
+    std::vector<SGVec3d> contact;
+    std::vector<SGVec3d> normal;
+    std::vector<SGVec3d> linearVel;
+    std::vector<SGVec3d> angularVel;
+    std::vector<simgear::BVHNode::Id> id;
+    std::vector<const simgear::BVHMaterial*> material;
+    std::vector<int> found;
+};
+
 class FGGroundCache {
 public:
     FGGroundCache();
@@ -92,6 +122,11 @@ public:
                  simgear::BVHNode::Id& id,
                  const simgear::BVHMaterial*& material);
 
+    // Same as above for all points of the batch at once. The rays are
+    // walked through the cache together, so the tree is traversed only
+    // once instead of once per gear.
+    void get_agl(double t, FGGroundQueryBatch& batch);
+
     bool get_nearest(double t, const SGVec3d& pt, double maxDist,
                      SGVec3d& contact, SGVec3d& linearVel, SGVec3d& angularVel,
                      simgear::BVHNode::Id& id,
@@ -111,10 +146,36 @@ public:
     // the wire end position.
     void release_wire(void);
 
+    // Build the cache ahead of the vehicle on a background thread.
+    // prepare_ground_cache() then just swaps in the prefetched tree as
+    // long as it covers the requested ball, instead of collecting the
+    // scene graph on every call.
+    void set_prefetch(bool enable);
+    bool get_prefetch() const
+    { return _prefetchEnabled; }
+
+    // Statistics: synchronous builds, calls served from or missed by the
+    // prefetched cache, completed background builds, and the duration in
+    // milliseconds of the last synchronous and background build.
+    int get_sync_builds() const
+    { return _syncBuilds; }
+    int get_prefetch_hits() const
+    { return _prefetchHits; }
+    int get_prefetch_misses() const
+    { return _prefetchMisses; }
+    int get_prefetch_builds() const
+    { return _prefetchBuilds; }
+    double get_last_build_msec() const
+    { return _lastBuildMSec; }
+    double get_last_prefetch_msec() const
+    { return _lastPrefetchMSec; }
+
 private:
     class CacheFill;
+    class Prefetcher;
     class BodyFinder;
     class CatapultFinder;
+    class MultiLineSegmentVisitor;
     class WireIntersector;
     class WireFinder;
 
@@ -140,6 +201,50 @@ private:
 
     SGSharedPtr<simgear::BVHNode> _localBvhTree;
 
+    // A cache built by the Prefetcher, valid for the ball and the
+    // time interval given here.
+    struct PrefetchResult {
+        PrefetchResult() :
+            center(0, 0, 0), radius(0), startTime(0), endTime(0),
+            foundGround(false), altitude(0), material(0), buildMSec(0)
+        { }
+
+        SGSharedPtr<simgear::BVHNode> tree;
+        SGVec3d center;
+        double radius;
+        double startTime;
+        double endTime;
+        bool foundGround;
+        double altitude;
+        const simgear::BVHMaterial* material;
+        double buildMSec;
+    };
+
+    bool use_prefetched(double startSimTime, double endSimTime,
+                        const SGVec3d& pt, double rad);
+    void schedule_prefetch(double startSimTime, const SGVec3d& pt,
+                           double rad);
+
+    bool _prefetchEnabled;
+    std::auto_ptr<Prefetcher> _prefetcher;
+    PrefetchResult _prefetched;
+    // Do not try to prefetch before that time, set when moving
+    // scenery was in the way.
+    double _prefetchRetryTime;
+
+    // Vehicle velocity estimated from consecutive calls to
+    // prepare_ground_cache, used to place the prefetched ball.
+    SGVec3d _lastPoint;
+    double _lastTime;
+    SGVec3d _velocity;
+
+    int _syncBuilds;
+    int _prefetchHits;
+    int _prefetchMisses;
+    int _prefetchBuilds;
+    double _lastBuildMSec;
+    double _lastPrefetchMSec;
+
 #ifdef GROUNDCACHE_DEBUG
     SGTimeStamp _lookupTime;
     unsigned _lookupCount;
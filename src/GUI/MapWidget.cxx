@@ -709,26 +709,30 @@ void MapWidget::updateAIObjects()
     
     AIDrawVec newDrawVec;
     
-    const SGPropertyNode* ai = fgGetNode("/ai/models", true);
-    for (int i = 0; i < ai->nChildren(); ++i) {
-        const SGPropertyNode *model = ai->getChild(i);
-        // skip bad or dead entries
-        if (!model || model->getIntValue("id", -1) == -1) {
-            continue;
-        }
-        
-        SGGeod pos = SGGeod::fromDegFt(
-                                       model->getDoubleValue("position/longitude-deg"),
-                                       model->getDoubleValue("position/latitude-deg"),
-                                       model->getDoubleValue("position/altitude-ft"));
-        
-        double dist = SGGeodesy::distanceNm(_projectionCenter, pos);
+    FGAIManager* aiManager = globals->get_subsystem<FGAIManager>();
+    if (!aiManager) {
+        _aiDrawVec.clear();
+        return;
+    }
+    
+    // the index works on straight-line distances, allow for the altitude
+    // of the traffic before the exact check below
+    const double ALTITUDE_ALLOWANCE_M = 20000.0;
+    FGAITrafficSnapshotPtr traffic = aiManager->getTrafficSnapshot();
+    std::vector<unsigned> inRange;
+    traffic->findInRange(SGVec3d::fromGeod(_projectionCenter),
+                         _drawRangeNm * SG_NM_TO_METER + ALTITUDE_ALLOWANCE_M,
+                         inRange);
+    
+    for (unsigned i = 0; i < inRange.size(); ++i) {
+        const FGAITrafficSnapshot::Target& target = traffic->getTargets()[inRange[i]];
+        double dist = SGGeodesy::distanceNm(_projectionCenter, target.position);
         if (dist > _drawRangeNm) {
             continue;
         }
     
-        newDrawVec.push_back(DrawAIObject((SGPropertyNode*) model, pos));
-    } // of ai/models iteration
+        newDrawVec.push_back(DrawAIObject(target.props, target.position));
+    } // of ai targets iteration
 
     _aiDrawVec.swap(newDrawVec);
 }
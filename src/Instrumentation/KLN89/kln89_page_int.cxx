@@ -40,7 +40,7 @@ KLN89IntPage::KLN89IntPage(KLN89* parent)
 	_name = "INT";
 	_int_id = "PORTE";
 	_last_int_id = "";
-	_fp = NULL;
+	_fp.clear();
 	_nearestVor = NULL;
 	_refNav = NULL;
 }
@@ -173,7 +173,7 @@ void KLN89IntPage::SetId(const string& s) {
 	_last_int_id = _int_id;
 	_save_int_id = _int_id;
 	_int_id = s;
-	_fp = NULL;
+	_fp.clear();
 }
 
 void KLN89IntPage::CrsrPressed() {
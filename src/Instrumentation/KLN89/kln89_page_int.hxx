@@ -48,7 +48,7 @@ private:
 	std::string _int_id;
 	std::string _last_int_id;
 	std::string _save_int_id;
-	const FGFix* _fp;
+	SGSharedPtr<const FGFix> _fp;	// hold a reference, so the NavDataCache can not evict it
 	FGNavRecord* _nearestVor;
 	FGNavRecord* _refNav;	// Will usually be the same as _nearestVor, and gets reset to _nearestVor when page looses focus.
 	double _nvRadial;	// radial from nearest VOR
@@ -33,6 +33,16 @@
 #include <Main/fg_props.hxx>
 #include <Main/globals.hxx>
 #include <Scenery/scenery.hxx>
+#include <Scenery/ElevationService.hxx>
+
+using flightgear::ElevationService;
+
+static ElevationService::CallerId elevationCaller()
+{
+    static ElevationService::CallerId id =
+        ElevationService::instance()->registerCaller("radar-altimeter", 0.0);
+    return id;
+}
 
 
 RadarAltimeter::RadarAltimeter(SGPropertyNode *node) :
@@ -144,7 +154,7 @@ RadarAltimeter::update_altitude()
             SGVec3d userVec = rayVector(brg, elev);
 
             SGVec3d nearestHit;
-            globals->get_scenery()->get_cart_ground_intersection(cartantennapos, userVec, nearestHit);
+            ElevationService::instance()->getGroundIntersection(elevationCaller(), cartantennapos, userVec, nearestHit);
             double measuredDistance = dist(cartantennapos, nearestHit);
 
             if (measuredDistance >= min_range && measuredDistance <= max_range) {                
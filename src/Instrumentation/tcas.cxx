@@ -120,6 +120,8 @@ using std::string;
 
 #include <Main/fg_props.hxx>
 #include <Main/globals.hxx>
+#include <AIModel/AIManager.hxx>
+#include <AIModel/AIBase.hxx>
 #include "instrument_mgr.hxx"
 #include "tcas.hxx"
 
@@ -587,24 +589,23 @@ TCAS::ThreatDetector::update(void)
 
 /** Check if plane's transponder is enabled. */
 bool
-TCAS::ThreatDetector::checkTransponder(const SGPropertyNode* pModel, float velocityKt)
+TCAS::ThreatDetector::checkTransponder(const FGAITrafficSnapshot::Target& target)
 {
-    const string name = pModel->getName();
-    if (name != "multiplayer" && name != "aircraft")
+    if ((target.type != FGAIBase::otMultiplayer)&&
+        (target.type != FGAIBase::otAircraft))
     {
         // assume non-MP/non-AI planes (e.g. ships) have no transponder
         return false;
     }
 
-    if (velocityKt < 40)
+    if (target.speedKt < 40)
     {
         /* assume all pilots have their transponder switched off while taxiing/parking
          * (at low speed) */
         return false;
     }
 
-    if ((name == "multiplayer")&&
-        (pModel->getBoolValue("controls/invisible")))
+    if (target.invisible)
     {
         // ignored MP plane: pretend transponder is switched off
         return false;
@@ -615,19 +616,20 @@ TCAS::ThreatDetector::checkTransponder(const SGPropertyNode* pModel, float veloc
 
 /** Check if plane is a threat. */
 int
-TCAS::ThreatDetector::checkThreat(int mode, const SGPropertyNode* pModel)
+TCAS::ThreatDetector::checkThreat(int mode, const FGAITrafficSnapshot& traffic,
+                                  const FGAITrafficSnapshot::Target& target)
 {
 #ifdef FEATURE_TCAS_DEBUG_THREAT_DETECTOR
     checkCount++;
 #endif
     
-    float velocityKt  = pModel->getDoubleValue("velocities/true-airspeed-kt");
+    float velocityKt  = target.speedKt;
 
-    if (!checkTransponder(pModel, velocityKt))
+    if (!checkTransponder(target))
         return ThreatInvisible;
 
     int threatLevel = ThreatNone;
-    float altFt = pModel->getDoubleValue("position/altitude-ft");
+    float altFt = target.position.getElevationFt();
     currentThreat.relativeAltitudeFt = altFt - self.pressureAltFt;
 
     // save computation time: don't care when relative altitude is excessive
@@ -635,9 +637,9 @@ TCAS::ThreatDetector::checkThreat(int mode, const SGPropertyNode* pModel)
         return threatLevel;
 
     // position data of current intruder
-    double lat        = pModel->getDoubleValue("position/latitude-deg");
-    double lon        = pModel->getDoubleValue("position/longitude-deg");
-    float heading     = pModel->getDoubleValue("orientation/true-heading-deg");
+    double lat        = target.position.getLatitudeDeg();
+    double lon        = target.position.getLongitudeDeg();
+    float heading     = target.headingDeg;
 
     double distanceNm, bearing;
     calcRangeBearing(self.lat, self.lon, lat, lon, distanceNm, bearing);
@@ -646,7 +648,7 @@ TCAS::ThreatDetector::checkThreat(int mode, const SGPropertyNode* pModel)
     if ((distanceNm > 10)||(distanceNm < 0))
         return threatLevel;
 
-    currentThreat.verticalFps = pModel->getDoubleValue("velocities/vertical-speed-fps");
+    currentThreat.verticalFps = target.verticalSpeedFps;
     
     /* Detect proximity targets
      * [TCASII]: "Any target that is less than 6 nmi in range and within +/-1200ft
@@ -667,7 +669,7 @@ TCAS::ThreatDetector::checkThreat(int mode, const SGPropertyNode* pModel)
 
     if (tcas->tracker.active())
     {
-        currentThreat.callsign = pModel->getStringValue("callsign");
+        currentThreat.callsign = traffic.getCallsign(target);
         currentThreat.isTracked = tcas->tracker.isTracked(currentThreat.callsign);
     }
     else
@@ -694,14 +696,14 @@ TCAS::ThreatDetector::checkThreat(int mode, const SGPropertyNode* pModel)
             (currentThreat.verticalTau < 0))
         {
             // do not trigger new alerts when Tau is negative, but keep existing alerts
-            int previousThreatLevel = pModel->getIntValue("tcas/threat-level", 0);
+            int previousThreatLevel = target.props->getIntValue("tcas/threat-level", 0);
             if (previousThreatLevel == 0)
                 return threatLevel;
         }
     }
 
 #ifdef FEATURE_TCAS_DEBUG_THREAT_DETECTOR
-    cout << "#" << checkCount << ": " << pModel->getStringValue("callsign") << endl;
+    cout << "#" << checkCount << ": " << traffic.getCallsign(target) << endl;
 #endif
 
     
@@ -715,7 +717,7 @@ TCAS::ThreatDetector::checkThreat(int mode, const SGPropertyNode* pModel)
         threatLevel = ThreatRA;
 
     if (!tcas->tracker.active())
-        currentThreat.callsign = pModel->getStringValue("callsign");
+        currentThreat.callsign = traffic.getCallsign(target);
 
     tcas->tracker.add(currentThreat.callsign, threatLevel);
     
@@ -1284,20 +1286,22 @@ TCAS::update(double dt)
         else
 #endif
         {
-            SGPropertyNode* pAi = fgGetNode("/ai/models", true);
-
-            // check all aircraft
-            for (int i = pAi->nChildren() - 1; i >= -1; i--)
+            FGAIManager* aiManager = globals->get_subsystem<FGAIManager>();
+            if (aiManager)
             {
-                SGPropertyNode* pModel = pAi->getChild(i);
-                if ((pModel)&&(pModel->nChildren()))
+                FGAITrafficSnapshotPtr traffic = aiManager->getTrafficSnapshot();
+                const FGAITrafficSnapshot::TargetVec& targets = traffic->getTargets();
+
+                // check all aircraft
+                for (unsigned i = 0; i < targets.size(); i++)
                 {
-                    int threatLevel = threatDetector.checkThreat(mode, pModel);
+                    const FGAITrafficSnapshot::Target& target = targets[i];
+                    int threatLevel = threatDetector.checkThreat(mode, *traffic, target);
                     /* expose aircraft threat-level (to be used by other instruments,
                      * i.e. TCAS display) */
                     if (threatLevel==ThreatRA)
-                        pModel->setIntValue("tcas/ra-sense", -threatDetector.getRASense());
-                    pModel->setIntValue("tcas/threat-level", threatLevel);
+                        target.props->setIntValue("tcas/ra-sense", -threatDetector.getRASense());
+                    target.props->setIntValue("tcas/threat-level", threatLevel);
                 }
             }
         }
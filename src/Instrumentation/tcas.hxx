@@ -30,6 +30,7 @@
 #include <simgear/props/props.hxx>
 #include <simgear/structure/subsystem_mgr.hxx>
 #include <Sound/voiceplayer.hxx>
+#include <AIModel/AITrafficSnapshot.hxx>
 
 using std::vector;
 using std::deque;
@@ -317,8 +318,9 @@ class TCAS : public SGSubsystem
         void  init                (void);
         void  update              (void);
 
-        bool  checkTransponder    (const SGPropertyNode* pModel, float velocityKt);
-        int   checkThreat         (int mode, const SGPropertyNode* pModel);
+        bool  checkTransponder    (const FGAITrafficSnapshot::Target& target);
+        int   checkThreat         (int mode, const FGAITrafficSnapshot& traffic,
+                                   const FGAITrafficSnapshot::Target& target);
         void  checkVerticalThreat (void);
         void  horizontalThreat    (float bearing, float distanceNm, float heading,
                                    float velocityKt);
@@ -33,14 +33,24 @@
 #include <Aircraft/replay.hxx>
 #include <Scenery/scenery.hxx>
 #include <Scenery/tilemgr.hxx>
+#include <Scenery/tilecache.hxx>
+#include <Radio/radio.hxx>
 #include <Scripting/NasalSys.hxx>
 #include <Sound/sample_queue.hxx>
 #include <Airports/xmlloader.hxx>
+#include <Airports/airport.hxx>
+#include <Airports/groundnetwork.hxx>
+#include <Autopilot/autopilot.hxx>
 #include <Network/HTTPClient.hxx>
 #include <Viewer/viewmgr.hxx>
 #include <Viewer/view.hxx>
 #include <Environment/presets.hxx>
 #include <Navaids/NavDataCache.hxx>
+#include <FDM/fdm_shell.hxx>
+
+#ifdef ENABLE_JSBSIM
+#include <FDM/JSBSim/JSBSim.hxx>
+#endif
 
 #include "fg_init.hxx"
 #include "fg_io.hxx"
@@ -1300,6 +1310,128 @@ do_release_cockpit_button (const SGPropertyNode *arg)
   return true;
 }
 
+/**
+ * Time the taxi route finding of an airport's ground network.
+ *
+ * airport: the ICAO id, defaults to the closest airport.
+ */
+static bool
+do_groundnet_route_benchmark(const SGPropertyNode *arg)
+{
+  std::string ident = arg->getStringValue("airport",
+    fgGetString("/sim/airport/closest-airport-id"));
+  FGAirportRef apt = FGAirport::findByIdent(ident);
+  if (!apt) {
+    SG_LOG(SG_GENERAL, SG_WARN, "groundnet-route-benchmark: unknown airport '"
+           << ident << "'");
+    return false;
+  }
+
+  FGGroundNetwork* gn = apt->groundNetwork();
+  if (!gn->exists()) {
+    SG_LOG(SG_GENERAL, SG_WARN, "groundnet-route-benchmark: no ground network for "
+           << ident);
+    return false;
+  }
+
+  gn->benchmarkRoutes();
+  return true;
+}
+
+/**
+ * Time the tile cache bookkeeping for a simulated long flight.
+ *
+ * steps: number of positions along the flight, default 4000.
+ * range: tiles requested around each position, default 6.
+ */
+static bool
+do_tile_cache_benchmark(const SGPropertyNode *arg)
+{
+  int steps = arg->getIntValue("steps", 4000);
+  int range = arg->getIntValue("range", 6);
+  if ((steps <= 0) || (range <= 0)) {
+    return false;
+  }
+
+  TileCache::benchmark(steps, range);
+  return true;
+}
+
+/**
+ * Time radio propagation for a fixed grid of transmitter/receiver pairs,
+ * serially, through the worker pool and from the result cache.
+ *
+ * grid: transmitters and receivers per grid side (default 4).
+ * passes: number of passes through the worker pool (default 4).
+ */
+static bool
+do_radio_propagation_benchmark(const SGPropertyNode *arg)
+{
+  int grid = arg->getIntValue("grid", 4);
+  int passes = arg->getIntValue("passes", 4);
+  if ((grid <= 0) || (passes <= 0)) {
+    return false;
+  }
+
+  FGRadioTransmission::benchmark(grid, passes);
+  return true;
+}
+
+/**
+ * Time an autopilot / property-rule configuration in a scratch property
+ * tree, updated as subsystems and as compiled program.
+ *
+ * path: the configuration file, relative to the aircraft directory or
+ *       $FG_ROOT.
+ * frames: number of updates per run, default 10000.
+ */
+static bool
+do_autopilot_benchmark(const SGPropertyNode *arg)
+{
+  std::string file = arg->getStringValue("path");
+  int frames = arg->getIntValue("frames", 10000);
+  if (frames <= 0) {
+    return false;
+  }
+
+  SGPath path = globals->resolve_maybe_aircraft_path(file);
+  if (path.isNull()) {
+    SG_LOG(SG_GENERAL, SG_WARN, "autopilot-benchmark: cannot find '"
+           << file << "'");
+    return false;
+  }
+
+  FGXMLAutopilot::Autopilot::benchmark(path, frames);
+  return true;
+}
+
+#ifdef ENABLE_JSBSIM
+/**
+ * Time the functions of the JSBSim aircraft, evaluated by the tree
+ * interpreter and as compiled bytecode. Results go to the console.
+ *
+ * frames: number of evaluations of each function, default 1000.
+ */
+static bool
+do_jsbsim_function_benchmark(const SGPropertyNode *arg)
+{
+  int frames = arg->getIntValue("frames", 1000);
+  if (frames <= 0) {
+    return false;
+  }
+
+  FDMShell* shell = static_cast<FDMShell*>(globals->get_subsystem("flight"));
+  FGJSBsim* jsb = dynamic_cast<FGJSBsim*>(shell ? shell->getInterface() : 0);
+  if (!jsb) {
+    SG_LOG(SG_GENERAL, SG_WARN, "jsbsim-function-benchmark: the FDM is not JSBSim");
+    return false;
+  }
+
+  jsb->benchmarkFunctions(frames);
+  return true;
+}
+#endif
+
 // Optional profiling commands using gperftools:
 // http://code.google.com/p/gperftools/
 
@@ -1450,6 +1582,13 @@ static struct {
     { "reload-shaders", do_reload_shaders },
     { "reload-materials", do_materials_reload },
     { "set-scenery-paths", do_set_scenery_paths },
+    { "groundnet-route-benchmark", do_groundnet_route_benchmark },
+    { "tile-cache-benchmark", do_tile_cache_benchmark },
+    { "radio-propagation-benchmark", do_radio_propagation_benchmark },
+    { "autopilot-benchmark", do_autopilot_benchmark },
+#ifdef ENABLE_JSBSIM
+    { "jsbsim-function-benchmark", do_jsbsim_function_benchmark },
+#endif
   
     { "profiler-start", do_profiler_start },
     { "profiler-stop",  do_profiler_stop },
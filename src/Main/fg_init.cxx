@@ -610,6 +610,8 @@ fgInitNav ()
         }
     }
 
+  cache->initOctreeSnapshot();
+
   FGTACANList *channellist = new FGTACANList;
   globals->set_channellist( channellist );
   
@@ -55,6 +55,25 @@ const uint32_t PROTO_VER = 0x00010001;  // 1.1
 #define OLD_PROP_MSG_ID         5
 #define RESET_DATA_ID           6
 #define POS_DATA_ID             7
+#define POS_DATA_V2_ID          8
+
+// Capability word, sent in the (otherwise obsolete) ReplyAddress field of
+// the message header: the sender understands POS_DATA_V2_ID messages.
+const uint32_t PROTO_CAP_V2 = 0x46475632; // "FGV2"
+
+// A POS_DATA_V2_ID message is a T_MsgHdr and a T_PositionMsg, like a
+// POS_DATA_ID message, but the properties which follow only contain the
+// values which changed recently, in the compact encoding of tiny_xdr:
+//   uint16 id, with V2_FULL_FLOAT_FLAG set if a float is not quantised
+//   the value:
+//     INT, LONG:     uint32
+//     BOOL:          uint8
+//     FLOAT, DOUBLE: half precision float, or float with V2_FULL_FLOAT_FLAG
+//     STRING:        uint8 length, followed by the characters
+// Properties not mentioned keep the value of the sender's last
+// POS_DATA_ID message, which serves as the keyframe.
+#define V2_FULL_FLOAT_FLAG      0x8000
+#define V2_PROPERTY_ID_MASK     0x7fff
 
 // XDR demands 4 byte alignment, but some compilers use8 byte alignment
 // so it's safe to let the overall size of a network message be a 
@@ -36,6 +36,10 @@
 #include <cstring>
 #include <errno.h>
 
+#ifdef HAVE_RECVMMSG
+#include <sys/socket.h>
+#endif
+
 #include <simgear/misc/stdint.hxx>
 #include <simgear/timing/timestamp.hxx>
 #include <simgear/debug/logstream.hxx>
@@ -349,6 +353,29 @@ namespace
   }
 }
 
+namespace
+{
+  // number of v2 messages a changed property is repeated in, so a lost
+  // packet does not leave it stale until the next keyframe
+  const unsigned DELTA_REDUNDANCY = 3;
+
+  // a float may be sent in half precision if that keeps it within 0.1%,
+  // or within 0.001 for small values
+  bool canQuantise(float value)
+  {
+    float q = XDR_half_to_float(XDR_float_to_half(value));
+    float tolerance = 1e-3f*std::max(1.0f, static_cast<float>(fabs(value)));
+    return fabs(q - value) <= tolerance;
+  }
+
+  bool sameQuantised(float a, float b)
+  {
+    if (canQuantise(a) && canQuantise(b))
+      return XDR_float_to_half(a) == XDR_float_to_half(b);
+    return a == b;
+  }
+}
+
 class MPPropertyListener : public SGPropertyChangeListener
 {
 public:
@@ -366,6 +393,110 @@ private:
   FGMultiplayMgr* _multiplay;
 };
 
+/**
+ * The buffer that holds a multi-player message, suitably aligned.
+ */
+union FGMultiplayMgr::MsgBuf
+{
+    MsgBuf()
+    {
+        memset(&Msg, 0, sizeof(Msg));
+    }
+
+    T_MsgHdr* msgHdr()
+    {
+        return &Header;
+    }
+
+    const T_MsgHdr* msgHdr() const
+    {
+        return reinterpret_cast<const T_MsgHdr*>(&Header);
+    }
+
+    T_PositionMsg* posMsg()
+    {
+        return reinterpret_cast<T_PositionMsg*>(Msg + sizeof(T_MsgHdr));
+    }
+
+    const T_PositionMsg* posMsg() const
+    {
+        return reinterpret_cast<const T_PositionMsg*>(Msg + sizeof(T_MsgHdr));
+    }
+
+    xdr_data_t* properties()
+    {
+        return reinterpret_cast<xdr_data_t*>(Msg + sizeof(T_MsgHdr)
+                                             + sizeof(T_PositionMsg));
+    }
+
+    const xdr_data_t* properties() const
+    {
+        return reinterpret_cast<const xdr_data_t*>(Msg + sizeof(T_MsgHdr)
+                                                   + sizeof(T_PositionMsg));
+    }
+    /**
+     * The end of the properties buffer.
+     */
+    xdr_data_t* propsEnd()
+    {
+        return reinterpret_cast<xdr_data_t*>(Msg + MAX_PACKET_SIZE);
+    };
+
+    const xdr_data_t* propsEnd() const
+    {
+        return reinterpret_cast<const xdr_data_t*>(Msg + MAX_PACKET_SIZE);
+    };
+    /**
+     * The end of properties actually in the buffer. This assumes that
+     * the message header is valid.
+     */
+    xdr_data_t* propsRecvdEnd()
+    {
+        return reinterpret_cast<xdr_data_t*>(Msg + Header.MsgLen);
+    }
+
+    const xdr_data_t* propsRecvdEnd() const
+    {
+        return reinterpret_cast<const xdr_data_t*>(Msg + Header.MsgLen);
+    }
+    
+    xdr_data2_t double_val;
+    char Msg[MAX_PACKET_SIZE];
+    T_MsgHdr Header;
+};
+
+/**
+ * The receive buffers. They are allocated once, and update() drains the
+ * socket into them a batch at a time, with a single recvmmsg call where
+ * the platform has it, or a recvfrom per slot otherwise.
+ */
+struct FGMultiplayMgr::RxRing
+{
+  enum { SIZE = 32 };
+
+  RxRing()
+  {
+#ifdef HAVE_RECVMMSG
+    memset(headers, 0, sizeof(headers));
+    for (unsigned i = 0; i < SIZE; ++i) {
+      iovecs[i].iov_base = bufs[i].Msg;
+      iovecs[i].iov_len = sizeof(bufs[i].Msg);
+      headers[i].msg_hdr.msg_iov = &iovecs[i];
+      headers[i].msg_hdr.msg_iovlen = 1;
+    }
+#endif
+    memset(lengths, 0, sizeof(lengths));
+  }
+
+  MsgBuf bufs[SIZE];
+  simgear::IPAddress senders[SIZE];
+  size_t lengths[SIZE];
+#ifdef HAVE_RECVMMSG
+  struct iovec iovecs[SIZE];
+  struct mmsghdr headers[SIZE];
+#endif
+};
+
 //////////////////////////////////////////////////////////////////////
 //
 //  handle command "multiplayer-connect"
@@ -469,7 +600,12 @@ static bool do_multiplayer_refreshserverlist(const SGPropertyNode * arg) {
 //  MultiplayMgr constructor
 //
 //////////////////////////////////////////////////////////////////////
-FGMultiplayMgr::FGMultiplayMgr() 
+FGMultiplayMgr::FGMultiplayMgr() :
+  mRxMotionInfo(new FGExternalMotionData),
+  mSendV2(false),
+  mKeyframeInterval(20),
+  mTxSequence(0),
+  mPacketsSinceKeyframe(0)
 {
   mInitialised   = false;
   mHaveServer    = false;
@@ -528,6 +664,14 @@ FGMultiplayMgr::init (void)
   
   mDt = 1.0 / hz;
   mTimeUntilSend = 0.0;
+
+  // v2 position messages only carry changed properties, with a full
+  // message as keyframe every keyframe-interval messages
+  mSendV2 = fgGetBool("/sim/multiplay/protocol-v2", false);
+  int keyframeInterval = fgGetInt("/sim/multiplay/keyframe-interval", 20);
+  mKeyframeInterval = (keyframeInterval < 1) ? 1 : keyframeInterval;
+  mPacketsSinceKeyframe = mKeyframeInterval;
+  mTxProperties.clear();
   
   mCallsign = fgGetString("/sim/multiplay/callsign");
   fgGetNode("/sim/multiplay/callsign", true)->setAttribute(SGPropertyNode::PRESERVE, true);
@@ -577,6 +721,20 @@ FGMultiplayMgr::init (void)
             << strerror(errno) << "(errno " << errno << ")");
     return;
   }
+
+  if (!mRxRing.get()) {
+    mRxRing.reset(new RxRing);
+  }
+
+  SGPropertyNode* stats = fgGetNode("/sim/multiplay/stats", true);
+  mRxPacketsNode = stats->getNode("rx-packets", true);
+  mRxBytesNode = stats->getNode("rx-bytes", true);
+  mRxBatchesNode = stats->getNode("rx-batches", true);
+  mRxDroppedNode = stats->getNode("rx-dropped", true);
+  mRxDecodeMsNode = stats->getNode("rx-decode-ms", true);
+  mRxPeersNode = stats->getNode("peers", true);
+  mTxBytesNode = stats->getNode("tx-bytes", true);
+  mTxV2Node = stats->getNode("tx-v2", true);
   
   mPropertiesChanged = true;
   mListener = new MPPropertyListener(this);
@@ -614,7 +772,7 @@ FGMultiplayMgr::shutdown (void)
   MultiPlayerMap::iterator it = mMultiPlayerMap.begin(),
     end = mMultiPlayerMap.end();
   for (; it != end; ++it) {
-    it->second->setDie(true);
+    it->mp->setDie(true);
   }
   mMultiPlayerMap.clear();
   
@@ -641,78 +799,6 @@ FGMultiplayMgr::reinit()
 //
 //////////////////////////////////////////////////////////////////////
 
-/**
- * The buffer that holds a multi-player message, suitably aligned.
- */
-union FGMultiplayMgr::MsgBuf
-{
-    MsgBuf()
-    {
-        memset(&Msg, 0, sizeof(Msg));
-    }
-
-    T_MsgHdr* msgHdr()
-    {
-        return &Header;
-    }
-
-    const T_MsgHdr* msgHdr() const
-    {
-        return reinterpret_cast<const T_MsgHdr*>(&Header);
-    }
-
-    T_PositionMsg* posMsg()
-    {
-        return reinterpret_cast<T_PositionMsg*>(Msg + sizeof(T_MsgHdr));
-    }
-
-    const T_PositionMsg* posMsg() const
-    {
-        return reinterpret_cast<const T_PositionMsg*>(Msg + sizeof(T_MsgHdr));
-    }
-
-    xdr_data_t* properties()
-    {
-        return reinterpret_cast<xdr_data_t*>(Msg + sizeof(T_MsgHdr)
-                                             + sizeof(T_PositionMsg));
-    }
-
-    const xdr_data_t* properties() const
-    {
-        return reinterpret_cast<const xdr_data_t*>(Msg + sizeof(T_MsgHdr)
-                                                   + sizeof(T_PositionMsg));
-    }
-    /**
-     * The end of the properties buffer.
-     */
-    xdr_data_t* propsEnd()
-    {
-        return reinterpret_cast<xdr_data_t*>(Msg + MAX_PACKET_SIZE);
-    };
-
-    const xdr_data_t* propsEnd() const
-    {
-        return reinterpret_cast<const xdr_data_t*>(Msg + MAX_PACKET_SIZE);
-    };
-    /**
-     * The end of properties actually in the buffer. This assumes that
-     * the message header is valid.
-     */
-    xdr_data_t* propsRecvdEnd()
-    {
-        return reinterpret_cast<xdr_data_t*>(Msg + Header.MsgLen);
-    }
-
-    const xdr_data_t* propsRecvdEnd() const
-    {
-        return reinterpret_cast<const xdr_data_t*>(Msg + Header.MsgLen);
-    }
-    
-    xdr_data2_t double_val;
-    char Msg[MAX_PACKET_SIZE];
-    T_MsgHdr Header;
-};
-
 bool
 FGMultiplayMgr::isSane(const FGExternalMotionData& motionInfo)
 {
@@ -755,6 +841,7 @@ FGMultiplayMgr::SendMyPosition(const FGExternalMotionData& motionInfo)
 
   static MsgBuf msgBuf;
   static unsigned msgLen = 0;
+  bool sendDelta = false;
   T_PositionMsg* PosMsg = msgBuf.posMsg();
 
   strncpy(PosMsg->Model, fgGetString("/sim/model/path"), MAX_MODEL_NAME_LEN);
@@ -807,12 +894,22 @@ FGMultiplayMgr::SendMyPosition(const FGExternalMotionData& motionInfo)
         for (unsigned i = 0 ; i < 3; ++i)
           PosMsg->angularAccel[i] = XDR_encode_float (motionInfo.angularAccel(i) * timeAccel * timeAccel);
       }
+
+      // send a full message as keyframe every mKeyframeInterval messages,
+      // or when a peer can only handle full messages
+      UpdateTxProperties(motionInfo);
+      sendDelta = mSendV2 && (mPacketsSinceKeyframe < mKeyframeInterval)
+        && peersSupportV2();
+      if (!sendDelta)
+        mPacketsSinceKeyframe = 0;
+      ++mPacketsSinceKeyframe;
+
       xdr_data_t* ptr = msgBuf.properties();
       std::vector<FGPropertyData*>::const_iterator it;
       it = motionInfo.properties.begin();
       //cout << "OUTPUT PROPERTIES\n";
       xdr_data_t* msgEnd = msgBuf.propsEnd();
-      while (it != motionInfo.properties.end()) {
+      while (!sendDelta && (it != motionInfo.properties.end())) {
 
         if (ptr + 2 >= msgEnd)
         {
@@ -924,14 +1021,144 @@ FGMultiplayMgr::SendMyPosition(const FGExternalMotionData& motionInfo)
         ++it;
       }
   escape:
-      msgLen = reinterpret_cast<char*>(ptr) - msgBuf.Msg;
-      FillMsgHdr(msgBuf.msgHdr(), POS_DATA_ID, msgLen);
+      if (sendDelta) {
+        msgLen = EncodePropertyDeltas(msgBuf);
+        FillMsgHdr(msgBuf.msgHdr(), POS_DATA_V2_ID, msgLen);
+      } else {
+        msgLen = reinterpret_cast<char*>(ptr) - msgBuf.Msg;
+        FillMsgHdr(msgBuf.msgHdr(), POS_DATA_ID, msgLen);
+      }
+      mTxV2Node->setBoolValue(sendDelta);
   }
-  if (msgLen>0)
+  if (msgLen>0) {
       mSocket->sendto(msgBuf.Msg, msgLen, 0, &mServer);
+      mTxBytesNode->setIntValue(msgLen);
+  }
   SG_LOG(SG_NETWORK, SG_DEBUG, "FGMultiplayMgr::SendMyPosition");
 } // FGMultiplayMgr::SendMyPosition()
 
+//////////////////////////////////////////////////////////////////////
+//
+//  Record which of the properties to send changed since they were
+//  last sent.
+//
+//////////////////////////////////////////////////////////////////////
+void
+FGMultiplayMgr::UpdateTxProperties(const FGExternalMotionData& motionInfo)
+{
+  using namespace simgear;
+
+  ++mTxSequence;
+  size_t knownProperties = mTxProperties.size();
+
+  std::vector<FGPropertyData*>::const_iterator it;
+  for (it = motionInfo.properties.begin();
+       it != motionInfo.properties.end(); ++it) {
+    PropertyValue& value = propertyValue(mTxProperties, (*it)->id,
+                                         (*it)->type);
+    bool changed;
+    switch ((*it)->type) {
+      case props::INT:
+      case props::BOOL:
+      case props::LONG:
+        changed = (value.int_value != (*it)->int_value);
+        if (changed)
+          value.int_value = (*it)->int_value;
+        break;
+      case props::STRING:
+      case props::UNSPECIFIED:
+        {
+          const char* str = (*it)->string_value ? (*it)->string_value : "";
+          changed = (value.string_value != str);
+          if (changed)
+            value.string_value = str;
+        }
+        break;
+      default:
+        // compare against the last value sent, so slow drifts below the
+        // quantisation still get through eventually
+        changed = !sameQuantised(value.float_value, (*it)->float_value);
+        if (changed)
+          value.float_value = (*it)->float_value;
+        break;
+    }
+
+    if (changed)
+      value.changedAt = mTxSequence;
+  }
+
+  // the receivers only learn about new properties from a keyframe
+  if (mTxProperties.size() != knownProperties)
+    mPacketsSinceKeyframe = mKeyframeInterval;
+}
+
+//////////////////////////////////////////////////////////////////////
+//
+//  Write the recently changed properties in the compact v2 encoding,
+//  returns the message length.
+//
+//////////////////////////////////////////////////////////////////////
+unsigned
+FGMultiplayMgr::EncodePropertyDeltas(MsgBuf& msgBuf)
+{
+  using namespace simgear;
+
+  char* p = reinterpret_cast<char*>(msgBuf.properties());
+  char* end = reinterpret_cast<char*>(msgBuf.propsEnd());
+
+  PropertyValues::const_iterator it;
+  for (it = mTxProperties.begin(); it != mTxProperties.end(); ++it) {
+    if (mTxSequence - it->changedAt >= DELTA_REDUNDANCY)
+      continue;
+
+    uint16_t id = static_cast<uint16_t>(it->id & V2_PROPERTY_ID_MASK);
+    switch (it->type) {
+      case props::INT:
+      case props::LONG:
+        if (end - p < 6)
+          goto truncated;
+        p = XDR_pack_uint16(p, id);
+        p = XDR_pack_uint32(p, static_cast<uint32_t>(it->int_value));
+        break;
+      case props::BOOL:
+        if (end - p < 3)
+          goto truncated;
+        p = XDR_pack_uint16(p, id);
+        p = XDR_pack_uint8(p, it->int_value ? 1 : 0);
+        break;
+      case props::STRING:
+      case props::UNSPECIFIED:
+        {
+          size_t len = std::min(it->string_value.size(),
+                                size_t(MAX_TEXT_SIZE - 1));
+          if (end - p < static_cast<ptrdiff_t>(3 + len))
+            goto truncated;
+          p = XDR_pack_uint16(p, id);
+          p = XDR_pack_uint8(p, static_cast<uint8_t>(len));
+          memcpy(p, it->string_value.data(), len);
+          p += len;
+        }
+        break;
+      default:
+        if (end - p < 6)
+          goto truncated;
+        if (canQuantise(it->float_value)) {
+          p = XDR_pack_uint16(p, id);
+          p = XDR_pack_half(p, it->float_value);
+        } else {
+          p = XDR_pack_uint16(p, id | V2_FULL_FLOAT_FLAG);
+          p = XDR_pack_float(p, it->float_value);
+        }
+        break;
+    }
+  }
+  return p - msgBuf.Msg;
+
+truncated:
+  SG_LOG(SG_NETWORK, SG_ALERT, "Multiplayer packet truncated prop id: " << it->id);
+  return p - msgBuf.Msg;
+}
+
 //////////////////////////////////////////////////////////////////////
 
 //////////////////////////////////////////////////////////////////////
@@ -999,20 +1226,93 @@ FGMultiplayMgr::update(double dt)
   }
 
   //////////////////////////////////////////////////
-  //  Read the receive socket and process any data
+  //  Read the receive socket and process any data,
+  //  a batch at a time until it is drained
   //////////////////////////////////////////////////
-  ssize_t bytes;
+  unsigned packets = 0, batches = 0, dropped = 0;
+  size_t bytes = 0;
+  SGTimeStamp decodeTime = SGTimeStamp::fromSec(0.0);
+  int count;
   do {
-    MsgBuf msgBuf;
+    count = ReceiveBatch();
+    if (count <= 0)
+      break;
+
+    ++batches;
+    SGTimeStamp st = SGTimeStamp::now();
+    for (int i = 0; i < count; ++i) {
+      if (!ProcessMsg(mRxRing->bufs[i], mRxRing->lengths[i],
+                      mRxRing->senders[i], stamp))
+        ++dropped;
+      bytes += mRxRing->lengths[i];
+    }
+    decodeTime += SGTimeStamp::now() - st;
+    packets += count;
+  } while (count == RxRing::SIZE);
+
+  mRxPacketsNode->setIntValue(packets);
+  mRxBytesNode->setIntValue(bytes);
+  mRxBatchesNode->setIntValue(batches);
+  mRxDroppedNode->setIntValue(dropped);
+  mRxDecodeMsNode->setDoubleValue(1e3*decodeTime.toSecs());
+
+  // check for expiry
+  MultiPlayerMap::iterator it = mMultiPlayerMap.begin();
+  while (it != mMultiPlayerMap.end()) {
+    if (it->mp->getLastTimestamp() + 10 < stamp) {
+      it->mp->setDie(true);
+      it = mMultiPlayerMap.erase(it);
+    } else
+      ++it;
+  }
+  mRxPeersNode->setIntValue(mMultiPlayerMap.size());
+} // FGMultiplayMgr::ProcessData(void)
+//////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////
+//
+//  Fill the receive ring with the packets waiting at the socket,
+//  returns the number of packets received
+//
+//////////////////////////////////////////////////////////////////////
+int
+FGMultiplayMgr::ReceiveBatch()
+{
+  RxRing& ring = *mRxRing;
+#ifdef HAVE_RECVMMSG
+  for (unsigned i = 0; i < RxRing::SIZE; ++i) {
+    // the address length is in/out, so reset it each time
+    ring.headers[i].msg_hdr.msg_name = ring.senders[i].getAddr();
+    ring.headers[i].msg_hdr.msg_namelen = ring.senders[i].getAddrLen();
+    ring.headers[i].msg_hdr.msg_flags = 0;
+    ring.headers[i].msg_len = 0;
+  }
+
+  int count = recvmmsg(mSocket->getHandle(), ring.headers, RxRing::SIZE,
+                       MSG_DONTWAIT, NULL);
+  if (count < 0) {
+    if ((errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+      SG_LOG(SG_NETWORK, SG_DEBUG, "FGMultiplayMgr::MP_ProcessData - Unable to receive data. "
+             << strerror(errno) << "(errno " << errno << ")");
+    }
+    return 0;
+  }
+
+  for (int i = 0; i < count; ++i)
+    ring.lengths[i] = ring.headers[i].msg_len;
+  return count;
+#else
+  int count = 0;
+  for (; count < RxRing::SIZE; ++count) {
     //////////////////////////////////////////////////
     //  Although the recv call asks for 
     //  MAX_PACKET_SIZE of data, the number of bytes
     //  returned will only be that of the next
     //  packet waiting to be processed.
     //////////////////////////////////////////////////
-    simgear::IPAddress SenderAddress;
+    MsgBuf& msgBuf = ring.bufs[count];
     int RecvStatus = mSocket->recvfrom(msgBuf.Msg, sizeof(msgBuf.Msg), 0,
-                              &SenderAddress);
+                                       &ring.senders[count]);
     //////////////////////////////////////////////////
     //  no Data received
     //////////////////////////////////////////////////
@@ -1036,73 +1336,76 @@ FGMultiplayMgr::update(double dt)
         break;
     }
 
-    // status is positive: bytes received
-    bytes = (ssize_t) RecvStatus;
-    if (bytes <= static_cast<ssize_t>(sizeof(T_MsgHdr))) {
-      SG_LOG( SG_NETWORK, SG_DEBUG, "FGMultiplayMgr::MP_ProcessData - "
-              << "received message with insufficient data" );
-      break;
-    }
-    //////////////////////////////////////////////////
-    //  Read header
-    //////////////////////////////////////////////////
-    T_MsgHdr* MsgHdr = msgBuf.msgHdr();
-    MsgHdr->Magic       = XDR_decode_uint32 (MsgHdr->Magic);
-    MsgHdr->Version     = XDR_decode_uint32 (MsgHdr->Version);
-    MsgHdr->MsgId       = XDR_decode_uint32 (MsgHdr->MsgId);
-    MsgHdr->MsgLen      = XDR_decode_uint32 (MsgHdr->MsgLen);
-    MsgHdr->ReplyPort   = XDR_decode_uint32 (MsgHdr->ReplyPort);
-    MsgHdr->Callsign[MAX_CALLSIGN_LEN -1] = '\0';
-    if (MsgHdr->Magic != MSG_MAGIC) {
-      SG_LOG( SG_NETWORK, SG_DEBUG, "FGMultiplayMgr::MP_ProcessData - "
-              << "message has invalid magic number!" );
-      break;
-    }
-    if (MsgHdr->Version != PROTO_VER) {
-      SG_LOG( SG_NETWORK, SG_DEBUG, "FGMultiplayMgr::MP_ProcessData - "
-              << "message has invalid protocol number!" );
-      break;
-    }
-    if (static_cast<ssize_t>(MsgHdr->MsgLen) != bytes) {
-      SG_LOG(SG_NETWORK, SG_DEBUG, "FGMultiplayMgr::MP_ProcessData - "
-             << "message from " << MsgHdr->Callsign << " has invalid length!");
-      break;
-    }
-    //////////////////////////////////////////////////
-    //  Process messages
-    //////////////////////////////////////////////////
-    switch (MsgHdr->MsgId) {
-    case CHAT_MSG_ID:
-      ProcessChatMsg(msgBuf, SenderAddress);
-      break;
-    case POS_DATA_ID:
-      ProcessPosMsg(msgBuf, SenderAddress, stamp);
-      break;
-    case UNUSABLE_POS_DATA_ID:
-    case OLD_OLD_POS_DATA_ID:
-    case OLD_PROP_MSG_ID:
-    case OLD_POS_DATA_ID:
-      break;
-    default:
-      SG_LOG( SG_NETWORK, SG_DEBUG, "FGMultiplayMgr::MP_ProcessData - "
-              << "Unknown message Id received: " << MsgHdr->MsgId );
-      break;
-    }
-  } while (bytes > 0);
-
-  // check for expiry
-  MultiPlayerMap::iterator it = mMultiPlayerMap.begin();
-  while (it != mMultiPlayerMap.end()) {
-    if (it->second->getLastTimestamp() + 10 < stamp) {
-      std::string name = it->first;
-      it->second->setDie(true);
-      mMultiPlayerMap.erase(it);
-      it = mMultiPlayerMap.upper_bound(name);
-    } else
-      ++it;
+    ring.lengths[count] = RecvStatus;
   }
-} // FGMultiplayMgr::ProcessData(void)
+  return count;
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////
+//
+//  Validate the header of a received message and dispatch it,
+//  returns false if the message was dropped
+//
 //////////////////////////////////////////////////////////////////////
+bool
+FGMultiplayMgr::ProcessMsg(MsgBuf& msgBuf, size_t bytes,
+                           const simgear::IPAddress& SenderAddress, long stamp)
+{
+  if (bytes <= sizeof(T_MsgHdr)) {
+    SG_LOG( SG_NETWORK, SG_DEBUG, "FGMultiplayMgr::MP_ProcessData - "
+            << "received message with insufficient data" );
+    return false;
+  }
+  //////////////////////////////////////////////////
+  //  Read header
+  //////////////////////////////////////////////////
+  T_MsgHdr* MsgHdr = msgBuf.msgHdr();
+  MsgHdr->Magic       = XDR_decode_uint32 (MsgHdr->Magic);
+  MsgHdr->Version     = XDR_decode_uint32 (MsgHdr->Version);
+  MsgHdr->MsgId       = XDR_decode_uint32 (MsgHdr->MsgId);
+  MsgHdr->MsgLen      = XDR_decode_uint32 (MsgHdr->MsgLen);
+  MsgHdr->ReplyAddress = XDR_decode_uint32 (MsgHdr->ReplyAddress);
+  MsgHdr->ReplyPort   = XDR_decode_uint32 (MsgHdr->ReplyPort);
+  MsgHdr->Callsign[MAX_CALLSIGN_LEN -1] = '\0';
+  if (MsgHdr->Magic != MSG_MAGIC) {
+    SG_LOG( SG_NETWORK, SG_DEBUG, "FGMultiplayMgr::MP_ProcessData - "
+            << "message has invalid magic number!" );
+    return false;
+  }
+  if (MsgHdr->Version != PROTO_VER) {
+    SG_LOG( SG_NETWORK, SG_DEBUG, "FGMultiplayMgr::MP_ProcessData - "
+            << "message has invalid protocol number!" );
+    return false;
+  }
+  if (MsgHdr->MsgLen != bytes) {
+    SG_LOG(SG_NETWORK, SG_DEBUG, "FGMultiplayMgr::MP_ProcessData - "
+           << "message from " << MsgHdr->Callsign << " has invalid length!");
+    return false;
+  }
+  //////////////////////////////////////////////////
+  //  Process messages
+  //////////////////////////////////////////////////
+  switch (MsgHdr->MsgId) {
+  case CHAT_MSG_ID:
+    ProcessChatMsg(msgBuf, SenderAddress);
+    break;
+  case POS_DATA_ID:
+  case POS_DATA_V2_ID:
+    ProcessPosMsg(msgBuf, SenderAddress, stamp);
+    break;
+  case UNUSABLE_POS_DATA_ID:
+  case OLD_OLD_POS_DATA_ID:
+  case OLD_PROP_MSG_ID:
+  case OLD_POS_DATA_ID:
+    break;
+  default:
+    SG_LOG( SG_NETWORK, SG_DEBUG, "FGMultiplayMgr::MP_ProcessData - "
+            << "Unknown message Id received: " << MsgHdr->MsgId );
+    return false;
+  }
+  return true;
+}
 
 void
 FGMultiplayMgr::Send()
@@ -1254,7 +1557,9 @@ FGMultiplayMgr::ProcessPosMsg(const FGMultiplayMgr::MsgBuf& Msg,
     return;
   }
   const T_PositionMsg* PosMsg = Msg.posMsg();
-  FGExternalMotionData motionInfo;
+  // the property records are handed over to the FGAIMultiplayer, but the
+  // list itself keeps its storage from packet to packet
+  FGExternalMotionData& motionInfo = *mRxMotionInfo;
   motionInfo.time = XDR_decode_double(PosMsg->time);
   motionInfo.lag = XDR_decode_double(PosMsg->lag);
   for (unsigned i = 0; i < 3; ++i)
@@ -1282,6 +1587,49 @@ FGMultiplayMgr::ProcessPosMsg(const FGMultiplayMgr::MsgBuf& Msg,
       return;
   }
 
+  CallsignKey key = callsignKey(MsgHdr->Callsign);
+  Peer* peer = getPeer(key);
+  if (!peer)
+    peer = addPeer(key, MsgHdr->Callsign, PosMsg->Model);
+  peer->v2Capable = (MsgHdr->ReplyAddress == PROTO_CAP_V2);
+
+  if (MsgHdr->MsgId == POS_DATA_V2_ID) {
+    DecodePropertyDeltas(Msg, *peer);
+  } else {
+    DecodeProperties(Msg);
+    // a full message from a v2 capable peer is the keyframe for the
+    // deltas that follow
+    if (peer->v2Capable)
+      StoreKeyframe(*peer, motionInfo);
+    else if (peer->haveKeyframe) {
+      peer->props.clear();
+      peer->haveKeyframe = false;
+    }
+  }
+
+  peer->mp->addMotionInfo(motionInfo, stamp);
+
+  // packets arriving out of order are not taken over, release them here
+  std::vector<FGPropertyData*>::iterator propIt;
+  for (propIt = motionInfo.properties.begin();
+       propIt != motionInfo.properties.end(); ++propIt)
+    delete *propIt;
+  motionInfo.properties.clear();
+} // FGMultiplayMgr::ProcessPosMsg()
+//////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////
+//
+//  decode the properties of a POS_DATA_ID message
+//
+//////////////////////////////////////////////////////////////////////
+void
+FGMultiplayMgr::DecodeProperties(const FGMultiplayMgr::MsgBuf& Msg)
+{
+  const T_MsgHdr* MsgHdr = Msg.msgHdr();
+  const T_PositionMsg* PosMsg = Msg.posMsg();
+  FGExternalMotionData& motionInfo = *mRxMotionInfo;
+
   //cout << "INPUT MESSAGE\n";
 
   // There was a bug in 1.9.0 and before: T_PositionMsg was 196 bytes
@@ -1304,7 +1652,7 @@ FGMultiplayMgr::ProcessPosMsg(const FGMultiplayMgr::MsgBuf& Msg,
     if (verifyProperties(&PosMsg->pad, Msg.propsRecvdEnd()))
       xdr = &PosMsg->pad;
     else if (!verifyProperties(xdr, Msg.propsRecvdEnd()))
-      goto noprops;
+      return;
   }
   while (xdr < Msg.propsRecvdEnd()) {
     // simgear::props::Type type = simgear::props::UNSPECIFIED;
@@ -1389,12 +1737,177 @@ FGMultiplayMgr::ProcessPosMsg(const FGMultiplayMgr::MsgBuf& Msg,
              << id); 
     }
   }
- noprops:
-  FGAIMultiplayer* mp = getMultiplayer(MsgHdr->Callsign);
-  if (!mp)
-    mp = addMultiplayer(MsgHdr->Callsign, PosMsg->Model);
-  mp->addMotionInfo(motionInfo, stamp);
-} // FGMultiplayMgr::ProcessPosMsg()
+} // FGMultiplayMgr::DecodeProperties()
+//////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////
+//
+//  remember the properties of a POS_DATA_ID message from a v2 capable
+//  peer, as the base for its deltas
+//
+//////////////////////////////////////////////////////////////////////
+void
+FGMultiplayMgr::StoreKeyframe(Peer& peer,
+                              const FGExternalMotionData& motionInfo)
+{
+  if (peer.haveKeyframe && (motionInfo.time <= peer.propsTime))
+    return; // older than what we have
+
+  peer.props.clear();
+  std::vector<FGPropertyData*>::const_iterator it;
+  for (it = motionInfo.properties.begin();
+       it != motionInfo.properties.end(); ++it) {
+    PropertyValue value;
+    value.id = (*it)->id;
+    value.type = (*it)->type;
+    value.int_value = 0;
+    value.float_value = 0;
+    value.changedAt = 0;
+    switch ((*it)->type) {
+      case simgear::props::INT:
+      case simgear::props::BOOL:
+      case simgear::props::LONG:
+        value.int_value = (*it)->int_value;
+        break;
+      case simgear::props::STRING:
+      case simgear::props::UNSPECIFIED:
+        if ((*it)->string_value)
+          value.string_value = (*it)->string_value;
+        break;
+      default:
+        value.float_value = (*it)->float_value;
+        break;
+    }
+    peer.props.push_back(value);
+  }
+  std::sort(peer.props.begin(), peer.props.end());
+
+  peer.haveKeyframe = true;
+  peer.propsTime = motionInfo.time;
+}
+
+//////////////////////////////////////////////////////////////////////
+//
+//  apply the properties of a POS_DATA_V2_ID message to the peer's
+//  keyframe, and hand out the complete set
+//
+//////////////////////////////////////////////////////////////////////
+void
+FGMultiplayMgr::DecodePropertyDeltas(const FGMultiplayMgr::MsgBuf& Msg,
+                                     Peer& peer)
+{
+  using namespace simgear;
+
+  // without a keyframe there is nothing to apply the deltas to, the
+  // properties stay unchanged until the next one arrives
+  if (!peer.haveKeyframe)
+    return;
+
+  const T_MsgHdr* MsgHdr = Msg.msgHdr();
+  FGExternalMotionData& motionInfo = *mRxMotionInfo;
+
+  // deltas arriving out of order must not overwrite newer values
+  if (motionInfo.time > peer.propsTime) {
+    const char* p = reinterpret_cast<const char*>(Msg.properties());
+    const char* end = reinterpret_cast<const char*>(Msg.propsRecvdEnd());
+    bool truncated = false;
+    while (!truncated && (end - p >= 2)) {
+      uint16_t word;
+      p = XDR_unpack_uint16(p, word);
+      unsigned id = word & V2_PROPERTY_ID_MASK;
+      const IdPropertyList* plist = findProperty(id);
+      if (!plist) {
+        // the size of the value is unknown, so give up on the rest
+        SG_LOG(SG_NETWORK, SG_DEBUG, "FGMultiplayMgr::DecodePropertyDeltas - "
+               "message from " << MsgHdr->Callsign << " has unknown property id "
+               << id);
+        break;
+      }
+
+      PropertyValue& value = propertyValue(peer.props, id, plist->type);
+      switch (plist->type) {
+        case props::INT:
+        case props::LONG:
+          if (end - p < 4) {
+            truncated = true;
+          } else {
+            uint32_t i;
+            p = XDR_unpack_uint32(p, i);
+            value.int_value = static_cast<int32_t>(i);
+          }
+          break;
+        case props::BOOL:
+          if (end - p < 1) {
+            truncated = true;
+          } else {
+            uint8_t b;
+            p = XDR_unpack_uint8(p, b);
+            value.int_value = b;
+          }
+          break;
+        case props::STRING:
+        case props::UNSPECIFIED:
+          {
+            uint8_t length = 0;
+            if (end - p >= 1)
+              p = XDR_unpack_uint8(p, length);
+            else
+              truncated = true;
+            if (truncated || (end - p < length) || (length > MAX_TEXT_SIZE)) {
+              truncated = true;
+            } else {
+              value.string_value.assign(p, length);
+              p += length;
+            }
+          }
+          break;
+        default:
+          if (word & V2_FULL_FLOAT_FLAG) {
+            if (end - p < 4)
+              truncated = true;
+            else
+              p = XDR_unpack_float(p, value.float_value);
+          } else {
+            if (end - p < 2)
+              truncated = true;
+            else
+              p = XDR_unpack_half(p, value.float_value);
+          }
+          break;
+      }
+    }
+
+    if (truncated) {
+      SG_LOG(SG_NETWORK, SG_DEBUG, "FGMultiplayMgr::DecodePropertyDeltas - "
+             "message from " << MsgHdr->Callsign << " is truncated");
+    }
+    peer.propsTime = motionInfo.time;
+  }
+
+  // the interpolation needs the same properties in every message
+  PropertyValues::const_iterator it;
+  for (it = peer.props.begin(); it != peer.props.end(); ++it) {
+    FGPropertyData* pData = new FGPropertyData;
+    pData->id = it->id;
+    pData->type = it->type;
+    switch (it->type) {
+      case props::INT:
+      case props::BOOL:
+      case props::LONG:
+        pData->int_value = it->int_value;
+        break;
+      case props::STRING:
+      case props::UNSPECIFIED:
+        pData->string_value = new char[it->string_value.size() + 1];
+        strcpy(pData->string_value, it->string_value.c_str());
+        break;
+      default:
+        pData->float_value = it->float_value;
+        break;
+    }
+    motionInfo.properties.push_back(pData);
+  }
+} // FGMultiplayMgr::DecodePropertyDeltas()
 //////////////////////////////////////////////////////////////////////
 
 //////////////////////////////////////////////////////////////////////
@@ -1447,23 +1960,45 @@ FGMultiplayMgr::FillMsgHdr(T_MsgHdr *MsgHdr, int MsgId, unsigned _len)
   MsgHdr->Version         = XDR_encode_uint32(PROTO_VER);
   MsgHdr->MsgId           = XDR_encode_uint32(MsgId);
   MsgHdr->MsgLen          = XDR_encode_uint32(len);
-  MsgHdr->ReplyAddress    = 0; // Are obsolete, keep them for the server for
-  MsgHdr->ReplyPort       = 0; // now
+  // ReplyAddress and ReplyPort are obsolete, keep them for the server for
+  // now. The address field advertises what we can receive.
+  MsgHdr->ReplyAddress    = XDR_encode_uint32(PROTO_CAP_V2);
+  MsgHdr->ReplyPort       = 0;
   strncpy(MsgHdr->Callsign, mCallsign.c_str(), MAX_CALLSIGN_LEN);
   MsgHdr->Callsign[MAX_CALLSIGN_LEN - 1] = '\0';
 }
 
-FGAIMultiplayer*
-FGMultiplayMgr::addMultiplayer(const std::string& callsign,
-                               const std::string& modelName)
+FGMultiplayMgr::CallsignKey
+FGMultiplayMgr::callsignKey(const char* callsign)
+{
+  // first character in the most significant byte, so keys sort like
+  // the callsigns
+  CallsignKey key = 0;
+  for (unsigned i = 0; i < MAX_CALLSIGN_LEN; ++i) {
+    unsigned char c = callsign[i];
+    key |= CallsignKey(c) << (8*(MAX_CALLSIGN_LEN - 1 - i));
+    if (c == '\0')
+      break;
+  }
+  return key;
+}
+
+FGMultiplayMgr::Peer*
+FGMultiplayMgr::addPeer(CallsignKey key, const std::string& callsign,
+                        const std::string& modelName)
 {
-  if (0 < mMultiPlayerMap.count(callsign))
-    return mMultiPlayerMap[callsign].get();
+  Peer peer;
+  peer.key = key;
+  MultiPlayerMap::iterator it = std::lower_bound(mMultiPlayerMap.begin(),
+                                                 mMultiPlayerMap.end(), peer);
+  if ((it != mMultiPlayerMap.end()) && (it->key == key))
+    return &(*it);
 
   FGAIMultiplayer* mp = new FGAIMultiplayer;
   mp->setPath(modelName.c_str());
   mp->setCallSign(callsign);
-  mMultiPlayerMap[callsign] = mp;
+  peer.mp = mp;
+  it = mMultiPlayerMap.insert(it, peer);
 
   FGAIManager *aiMgr = (FGAIManager*)globals->get_subsystem("ai-model");
   if (aiMgr) {
@@ -1474,18 +2009,51 @@ FGMultiplayMgr::addMultiplayer(const std::string& callsign,
       mp->addPropertyId(sIdPropertyList[i].id, sIdPropertyList[i].name);
   }
 
-  return mp;
+  return &(*it);
 }
 
-FGAIMultiplayer*
-FGMultiplayMgr::getMultiplayer(const std::string& callsign)
+FGMultiplayMgr::Peer*
+FGMultiplayMgr::getPeer(CallsignKey key)
 {
-  if (0 < mMultiPlayerMap.count(callsign))
-    return mMultiPlayerMap[callsign].get();
+  Peer peer;
+  peer.key = key;
+  MultiPlayerMap::iterator it = std::lower_bound(mMultiPlayerMap.begin(),
+                                                 mMultiPlayerMap.end(), peer);
+  if ((it != mMultiPlayerMap.end()) && (it->key == key))
+    return &(*it);
   else
     return 0;
 }
 
+bool
+FGMultiplayMgr::peersSupportV2() const
+{
+  MultiPlayerMap::const_iterator it;
+  for (it = mMultiPlayerMap.begin(); it != mMultiPlayerMap.end(); ++it) {
+    if (!it->v2Capable)
+      return false;
+  }
+  return true;
+}
+
+FGMultiplayMgr::PropertyValue&
+FGMultiplayMgr::propertyValue(PropertyValues& values, unsigned id,
+                              simgear::props::Type type)
+{
+  PropertyValue value;
+  value.id = id;
+  PropertyValues::iterator it = std::lower_bound(values.begin(), values.end(),
+                                                 value);
+  if ((it != values.end()) && (it->id == id))
+    return *it;
+
+  value.type = type;
+  value.int_value = 0;
+  value.float_value = 0;
+  value.changedAt = 0;
+  return *values.insert(it, value);
+}
+
 void
 FGMultiplayMgr::findProperties()
 {
@@ -37,6 +37,7 @@
 #include <memory>
 
 #include <simgear/compiler.h>
+#include <simgear/misc/stdint.hxx>
 #include <simgear/props/props.hxx>
 #include <simgear/io/raw_socket.hxx>
 #include <simgear/structure/subsystem_mgr.hxx>
@@ -77,19 +78,105 @@ private:
   void SendMyPosition(const FGExternalMotionData& motionInfo);
 
   union MsgBuf;
-  FGAIMultiplayer* addMultiplayer(const std::string& callsign,
-                                  const std::string& modelName);
-  FGAIMultiplayer* getMultiplayer(const std::string& callsign);
+  struct RxRing;
+
+  /**
+   * Callsigns are at most MAX_CALLSIGN_LEN bytes including the terminating
+   * zero, so they pack exactly into a 64 bit key. Comparing peers is then
+   * a single integer compare, and no string is built per packet.
+   */
+  typedef uint64_t CallsignKey;
+  static CallsignKey callsignKey(const char* callsign);
+
+  /// a property value, as last sent to or received from a peer
+  struct PropertyValue
+  {
+    unsigned id;
+    simgear::props::Type type;
+    int int_value;
+    float float_value;
+    std::string string_value;
+    /// only used for sending: the position message it last changed in
+    unsigned changedAt;
+
+    bool operator<(const PropertyValue& other) const
+    { return id < other.id; }
+  };
+  /// sorted by id
+  typedef std::vector<PropertyValue> PropertyValues;
+  static PropertyValue& propertyValue(PropertyValues& values, unsigned id,
+                                      simgear::props::Type type);
+
+  struct Peer;
+  Peer* addPeer(CallsignKey key, const std::string& callsign,
+                const std::string& modelName);
+  Peer* getPeer(CallsignKey key);
+  bool peersSupportV2() const;
   void FillMsgHdr(T_MsgHdr *MsgHdr, int iMsgId, unsigned _len = 0u);
+  void UpdateTxProperties(const FGExternalMotionData& motionInfo);
+  unsigned EncodePropertyDeltas(MsgBuf& msgBuf);
+  void StoreKeyframe(Peer& peer, const FGExternalMotionData& motionInfo);
+  void DecodeProperties(const MsgBuf& Msg);
+  void DecodePropertyDeltas(const MsgBuf& Msg, Peer& peer);
+  int ReceiveBatch();
+  bool ProcessMsg(MsgBuf& Msg, size_t bytes,
+                  const simgear::IPAddress& SenderAddress, long stamp);
   void ProcessPosMsg(const MsgBuf& Msg, const simgear::IPAddress& SenderAddress,
                      long stamp);
   void ProcessChatMsg(const MsgBuf& Msg, const simgear::IPAddress& SenderAddress);
   bool isSane(const FGExternalMotionData& motionInfo);
 
-  /// maps from the callsign string to the FGAIMultiplayer
-  typedef std::map<std::string, SGSharedPtr<FGAIMultiplayer> > MultiPlayerMap;
+  struct Peer
+  {
+    Peer() :
+      key(0),
+      v2Capable(false),
+      haveKeyframe(false),
+      propsTime(0.0)
+    {
+    }
+
+    CallsignKey key;
+    SGSharedPtr<FGAIMultiplayer> mp;
+
+    /// the peer advertises PROTO_CAP_V2
+    bool v2Capable;
+    /// the property values of a v2 capable peer which its delta messages
+    /// apply to, and the time of the message they were last updated from
+    PropertyValues props;
+    bool haveKeyframe;
+    double propsTime;
+
+    bool operator<(const Peer& other) const
+    { return key < other.key; }
+  };
+
+  /// the known peers, sorted by callsign key
+  typedef std::vector<Peer> MultiPlayerMap;
   MultiPlayerMap mMultiPlayerMap;
 
+  /// pooled receive buffers, filled by one recvmmsg call where available
+  std::auto_ptr<RxRing> mRxRing;
+  /// decode target for position messages, reused for every packet
+  std::auto_ptr<FGExternalMotionData> mRxMotionInfo;
+
+  // per-frame receive statistics, under /sim/multiplay/stats
+  SGPropertyNode_ptr mRxPacketsNode;
+  SGPropertyNode_ptr mRxBytesNode;
+  SGPropertyNode_ptr mRxBatchesNode;
+  SGPropertyNode_ptr mRxDroppedNode;
+  SGPropertyNode_ptr mRxDecodeMsNode;
+  SGPropertyNode_ptr mRxPeersNode;
+  SGPropertyNode_ptr mTxBytesNode;
+  SGPropertyNode_ptr mTxV2Node;
+
+  // sending v2 (delta) position messages
+  bool mSendV2;
+  unsigned mKeyframeInterval;
+  unsigned mTxSequence;
+  unsigned mPacketsSinceKeyframe;
+  PropertyValues mTxProperties;
+
   std::auto_ptr<simgear::Socket> mSocket;
   simgear::IPAddress mServer;
   bool mHaveServer;
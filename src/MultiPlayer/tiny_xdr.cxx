@@ -168,3 +168,166 @@ XDR_decode_double ( const xdr_data2_t & d_Val )
     return tmp.d;
 }
 
+/* compact encoding */
+char*
+XDR_pack_uint8 ( char* p, const uint8_t & n_Val )
+{
+    *p++ = static_cast<char> (n_Val);
+    return p;
+}
+
+char*
+XDR_pack_uint16 ( char* p, const uint16_t & n_Val )
+{
+    *p++ = static_cast<char> (n_Val >> 8);
+    *p++ = static_cast<char> (n_Val);
+    return p;
+}
+
+char*
+XDR_pack_uint32 ( char* p, const uint32_t & n_Val )
+{
+    *p++ = static_cast<char> (n_Val >> 24);
+    *p++ = static_cast<char> (n_Val >> 16);
+    *p++ = static_cast<char> (n_Val >> 8);
+    *p++ = static_cast<char> (n_Val);
+    return p;
+}
+
+char*
+XDR_pack_float ( char* p, const float & f_Val )
+{
+    union {
+        uint32_t x;
+        float f;
+    } tmp;
+
+    tmp.f = f_Val;
+    return XDR_pack_uint32 (p, tmp.x);
+}
+
+const char*
+XDR_unpack_uint8 ( const char* p, uint8_t & n_Val )
+{
+    n_Val = static_cast<uint8_t> (*p++);
+    return p;
+}
+
+const char*
+XDR_unpack_uint16 ( const char* p, uint16_t & n_Val )
+{
+    const unsigned char* u = reinterpret_cast<const unsigned char*> (p);
+    n_Val = static_cast<uint16_t> ((u[0] << 8) | u[1]);
+    return p + 2;
+}
+
+const char*
+XDR_unpack_uint32 ( const char* p, uint32_t & n_Val )
+{
+    const unsigned char* u = reinterpret_cast<const unsigned char*> (p);
+    n_Val = (static_cast<uint32_t> (u[0]) << 24)
+          | (static_cast<uint32_t> (u[1]) << 16)
+          | (static_cast<uint32_t> (u[2]) << 8)
+          |  static_cast<uint32_t> (u[3]);
+    return p + 4;
+}
+
+const char*
+XDR_unpack_float ( const char* p, float & f_Val )
+{
+    union {
+        uint32_t x;
+        float f;
+    } tmp;
+
+    p = XDR_unpack_uint32 (p, tmp.x);
+    f_Val = tmp.f;
+    return p;
+}
+
+/* quantised float */
+uint16_t
+XDR_float_to_half ( const float & f_Val )
+{
+    union {
+        uint32_t x;
+        float f;
+    } tmp;
+
+    tmp.f = f_Val;
+    uint32_t sign = (tmp.x >> 16) & 0x8000;
+    int32_t  exp  = static_cast<int32_t> ((tmp.x >> 23) & 0xff) - 127 + 15;
+    uint32_t mant = tmp.x & 0x007fffff;
+
+    if (((tmp.x >> 23) & 0xff) == 0xff) {
+        // inf stays inf, NaN stays NaN
+        return static_cast<uint16_t> (sign | 0x7c00 | (mant ? 0x0200 : 0));
+    }
+    if (exp >= 0x1f) {
+        // too large, saturate to inf
+        return static_cast<uint16_t> (sign | 0x7c00);
+    }
+    if (exp <= 0) {
+        // denormal or zero
+        if (exp < -10)
+            return static_cast<uint16_t> (sign);
+        mant |= 0x00800000;
+        uint32_t shift = 14 - exp;
+        uint32_t half = mant >> shift;
+        // round to nearest
+        if ((mant >> (shift - 1)) & 1)
+            ++half;
+        return static_cast<uint16_t> (sign | half);
+    }
+
+    uint32_t half = sign | (exp << 10) | (mant >> 13);
+    // round to nearest, a carry into the exponent is still correct
+    if (mant & 0x00001000)
+        ++half;
+    return static_cast<uint16_t> (half);
+}
+
+float
+XDR_half_to_float ( const uint16_t & h_Val )
+{
+    union {
+        uint32_t x;
+        float f;
+    } tmp;
+
+    uint32_t sign = static_cast<uint32_t> (h_Val & 0x8000) << 16;
+    uint32_t exp  = (h_Val >> 10) & 0x1f;
+    uint32_t mant = h_Val & 0x03ff;
+
+    if (exp == 0x1f) {
+        tmp.x = sign | 0x7f800000 | (mant << 13);
+    } else if (exp != 0) {
+        tmp.x = sign | ((exp - 15 + 127) << 23) | (mant << 13);
+    } else if (mant != 0) {
+        // denormal, normalise it
+        exp = 127 - 15 + 1;
+        while (!(mant & 0x0400)) {
+            mant <<= 1;
+            --exp;
+        }
+        tmp.x = sign | (exp << 23) | ((mant & 0x03ff) << 13);
+    } else {
+        tmp.x = sign;
+    }
+    return tmp.f;
+}
+
+char*
+XDR_pack_half ( char* p, const float & f_Val )
+{
+    return XDR_pack_uint16 (p, XDR_float_to_half (f_Val));
+}
+
+const char*
+XDR_unpack_half ( const char* p, float & f_Val )
+{
+    uint16_t h;
+    p = XDR_unpack_uint16 (p, h);
+    f_Val = XDR_half_to_float (h);
+    return p;
+}
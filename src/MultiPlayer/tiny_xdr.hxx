@@ -74,4 +74,31 @@ float           XDR_decode_float    ( const xdr_data_t & f_Val );
 xdr_data2_t     XDR_encode_double   ( const double & d_Val );
 double          XDR_decode_double   ( const xdr_data2_t & d_Val );
 
+//////////////////////////////////////////////////
+//
+//  Compact encoding, used for the property block
+//  of v2 position messages. This is not XDR: the
+//  values are packed byte-wise in network order,
+//  without padding to XDR_BYTES_PER_UNIT, so the
+//  buffer needs no alignment. The pack functions
+//  return the position after the written value,
+//  the unpack functions the position after the
+//  read value.
+//
+//////////////////////////////////////////////////
+char*           XDR_pack_uint8      ( char* p, const uint8_t & n_Val );
+char*           XDR_pack_uint16     ( char* p, const uint16_t & n_Val );
+char*           XDR_pack_uint32     ( char* p, const uint32_t & n_Val );
+char*           XDR_pack_float      ( char* p, const float & f_Val );
+const char*     XDR_unpack_uint8    ( const char* p, uint8_t & n_Val );
+const char*     XDR_unpack_uint16   ( const char* p, uint16_t & n_Val );
+const char*     XDR_unpack_uint32   ( const char* p, uint32_t & n_Val );
+const char*     XDR_unpack_float    ( const char* p, float & f_Val );
+
+/* quantised float: IEEE 754 half precision */
+uint16_t        XDR_float_to_half   ( const float & f_Val );
+float           XDR_half_to_float   ( const uint16_t & h_Val );
+char*           XDR_pack_half       ( char* p, const float & f_Val );
+const char*     XDR_unpack_half     ( const char* p, float & f_Val );
+
 #endif
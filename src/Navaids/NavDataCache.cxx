@@ -32,6 +32,7 @@
 #include <sstream>  // for std::ostringstream
 // boost
 #include <boost/foreach.hpp>
+#include <boost/unordered_map.hpp>
 
 
 #ifdef SYSTEM_SQLITE
@@ -57,6 +58,7 @@
 #include <simgear/misc/strutils.hxx>
 #include <simgear/threads/SGThread.hxx>
 #include <simgear/threads/SGGuard.hxx>
+#include <simgear/props/tiedpropertylist.hxx>
 
 #include <Main/globals.hxx>
 #include <Main/fg_props.hxx>
@@ -70,9 +72,11 @@
 #include <Navaids/fixlist.hxx>
 #include <Navaids/navdb.hxx>
 #include "PositionedOctree.hxx"
+#include "OctreeSnapshot.hxx"
 #include <Airports/apt_loader.hxx>
 #include <Navaids/airways.hxx>
 #include "poidb.hxx"
+#include "NavDataRebuild.hxx"
 #include <Airports/parking.hxx>
 #include <Airports/gnnode.hxx>
 #include "CacheSchema.h"
@@ -88,6 +92,29 @@ const int MAX_RETRIES = 10;
 
 const int CACHE_SIZE_KBYTES= 32 * 1024;
 
+// default budget for the in-memory FGPositioned cache, see
+// /sim/navdb/cache/max-size-kbytes. Zero disables eviction.
+const int DEFAULT_POSITIONED_CACHE_KBYTES = 16 * 1024;
+
+// bounds on the data buffered ahead of the writer, in a parallel rebuild
+const size_t MAX_QUEUED_LINE_BATCHES = 64;
+const size_t MAX_QUEUED_ROW_BATCHES = 256;
+
+// input files, as tracked in the stat_cache table. Apart from apt.dat, each
+// can be re-imported on its own; almost everything refers to airports or
+// runways, so a change to apt.dat always means a full rebuild.
+enum DataSource
+{
+  SOURCE_APT = 1 << 0,
+  SOURCE_METAR = 1 << 1,
+  SOURCE_FIX = 1 << 2,
+  SOURCE_NAV = 1 << 3,
+  SOURCE_POI = 1 << 4,
+  SOURCE_CARRIER = 1 << 5,
+  SOURCE_AIRWAY = 1 << 6,
+  SOURCE_ALL = 0x7f
+};
+
 // bind a std::string to a sqlite statement. The std::string must live the
 // entire duration of the statement execution - do not pass a temporary
 // std::string, or the compiler may delete it, freeing the C-string storage,
@@ -219,9 +246,227 @@ private:
   bool _isFinished;
 };
 
+/**
+ * Worker threads for a parallel rebuild. apt.dat is decompressed and split
+ * into lines, fix.dat and poi.dat are parsed completely, ahead of the
+ * RebuildThread which consumes them. All sqlite access stays on the
+ * RebuildThread; the queues are bounded so memory use stays reasonable.
+ */
+class RebuildPipeline
+{
+public:
+  RebuildPipeline(const SGPath& aptDat, const SGPath& fixDat, const SGPath& poiDat)
+  {
+    aptLines.reset(new LineReadWorker(aptDat, MAX_QUEUED_LINE_BATCHES));
+    aptLines->start();
+
+    fixes.reset(new RowParseWorker(fixDat, parseFixes, MAX_QUEUED_ROW_BATCHES));
+    fixes->start();
+
+#ifndef SG_WINDOWS
+    if (poiDat.exists()) {
+      pois.reset(new RowParseWorker(poiDat, parsePOIs, MAX_QUEUED_ROW_BATCHES));
+      pois->start();
+    }
+#endif
+  }
+
+  ~RebuildPipeline()
+  {
+    // harmless if the workers completed normally; otherwise the writer
+    // failed and we must unblock the workers before joining them
+    aptLines->cancel();
+    fixes->cancel();
+    if (pois.get()) {
+      pois->cancel();
+    }
+  }
+
+  std::auto_ptr<LineReadWorker> aptLines;
+  std::auto_ptr<RowParseWorker> fixes, pois;
+};
+
 ////////////////////////////////////////////////////////////////////////////
 
-typedef std::map<PositionedID, FGPositionedRef> PositionedCache;
+/**
+ * In-memory cache of loaded FGPositioned instances, indexed by ID. Entries
+ * nothing else holds a reference to can be evicted, using a CLOCK (second
+ * chance) sweep, once the estimated memory use exceeds a budget.
+ *
+ * Airports, runways and navaids are never evicted: various places still
+ * keep raw pointers to them, and airports carry lazily-built state which
+ * would be lost.
+ */
+class PositionedCache
+{
+public:
+  PositionedCache() :
+    _clockHand(0),
+    _residentBytes(0),
+    _resweepBytes(0),
+    _evictions(0)
+  {
+  }
+
+  FGPositioned* find(PositionedID id)
+  {
+    IndexMap::iterator it = _index.find(id);
+    if (it == _index.end()) {
+      return NULL;
+    }
+
+    Entry& e(_entries[it->second]);
+    e.referenced = true;
+    return e.item.get();
+  }
+
+  void insert(PositionedID id, FGPositioned* pos)
+  {
+    size_t slot;
+    if (_freeSlots.empty()) {
+      slot = _entries.size();
+      _entries.push_back(Entry());
+    } else {
+      slot = _freeSlots.back();
+      _freeSlots.pop_back();
+    }
+
+    Entry& e(_entries[slot]);
+    e.id = id;
+    e.item = pos;
+    e.bytes = estimatedSize(pos);
+    e.referenced = true;
+
+    _index[id] = slot;
+    _residentBytes += e.bytes;
+  }
+
+  /**
+   * evict unreferenced entries until we're within the budget, or nothing
+   * more can be evicted. When a sweep could not get within the budget
+   * (because too much is still referenced elsewhere), the next one waits
+   * until the cache has grown by another eighth, so misses don't each pay
+   * for a full sweep.
+   */
+  void evictToBudget(size_t budgetBytes)
+  {
+    if ((_residentBytes <= budgetBytes) || (_residentBytes < _resweepBytes)) {
+      return;
+    }
+
+    // two full sweeps: the first may only clear reference bits
+    size_t steps = _entries.size() * 2;
+    for (; (steps > 0) && (_residentBytes > budgetBytes); --steps) {
+      if (_clockHand >= _entries.size()) {
+        _clockHand = 0;
+      }
+
+      Entry& e(_entries[_clockHand++]);
+      if (!e.item || !isEvictable(e.item)) {
+        continue;
+      }
+
+      if (e.referenced) {
+        e.referenced = false;
+        continue;
+      }
+
+      _index.erase(e.id);
+      _residentBytes -= e.bytes;
+      e.item.clear();
+      _freeSlots.push_back(_clockHand - 1);
+      ++_evictions;
+    }
+
+    if (_residentBytes > budgetBytes) {
+      _resweepBytes = _residentBytes + _residentBytes / 8;
+    } else {
+      _resweepBytes = 0;
+    }
+  }
+
+  /**
+   * drop all entries in a type range, because the rows they were loaded
+   * from are about to be deleted. Other holders keep their references.
+   */
+  void eraseTypes(FGPositioned::Type minTy, FGPositioned::Type maxTy)
+  {
+    for (size_t slot = 0; slot < _entries.size(); ++slot) {
+      Entry& e(_entries[slot]);
+      if (!e.item || (e.item->type() < minTy) || (e.item->type() > maxTy)) {
+        continue;
+      }
+
+      _index.erase(e.id);
+      _residentBytes -= e.bytes;
+      e.item.clear();
+      _freeSlots.push_back(slot);
+    }
+  }
+
+  size_t size() const
+  { return _index.size(); }
+
+  size_t residentBytes() const
+  { return _residentBytes; }
+
+  unsigned int evictions() const
+  { return _evictions; }
+private:
+  struct Entry
+  {
+    Entry() : id(0), bytes(0), referenced(false) {}
+
+    PositionedID id;
+    FGPositionedRef item;
+    size_t bytes;
+    bool referenced;
+  };
+
+  static bool isEvictable(const FGPositionedRef& pos)
+  {
+    // only the cache holds a reference
+    if (SGReferenced::count(pos.get()) > 1) {
+      return false;
+    }
+
+    FGPositioned::Type ty = pos->type();
+    return (ty == FGPositioned::FIX) || (ty == FGPositioned::WAYPOINT) ||
+      (ty == FGPositioned::TOWER) ||
+      ((ty >= FGPositioned::COUNTRY) && (ty <= FGPositioned::VILLAGE)) ||
+      ((ty >= FGPositioned::FREQ_GROUND) && (ty <= FGPositioned::FREQ_UNICOM));
+  }
+
+  static size_t estimatedSize(FGPositioned* pos)
+  {
+    size_t sz = sizeof(FGPositioned);
+    FGPositioned::Type ty = pos->type();
+    if ((ty >= FGPositioned::AIRPORT) && (ty <= FGPositioned::SEAPORT)) {
+      sz = sizeof(FGAirport);
+    } else if ((ty >= FGPositioned::RUNWAY) && (ty <= FGPositioned::TAXIWAY)) {
+      sz = sizeof(FGRunway);
+    } else if ((ty >= FGPositioned::NDB) && (ty <= FGPositioned::MOBILE_TACAN)) {
+      sz = sizeof(FGNavRecord);
+    } else if (ty == FGPositioned::FIX) {
+      sz = sizeof(FGFix);
+    } else if ((ty >= FGPositioned::FREQ_GROUND) && (ty <= FGPositioned::FREQ_UNICOM)) {
+      sz = sizeof(CommStation);
+    }
+
+    // strings, plus the slot and hash index overhead
+    return sz + pos->ident().size() + pos->name().size() +
+      sizeof(Entry) + 4 * sizeof(void*);
+  }
+
+  typedef boost::unordered_map<PositionedID, size_t> IndexMap;
+  IndexMap _index;
+  std::vector<Entry> _entries;
+  std::vector<size_t> _freeSlots;
+  size_t _clockHand;
+  size_t _residentBytes;
+  size_t _resweepBytes; ///< no sweep before the cache grows to this size
+  unsigned int _evictions;
+};
 
 class AirportTower : public FGPositioned
 {
@@ -241,8 +486,17 @@ public:
     db(NULL),
     path(p),
     readOnly(false),
+    parallelRebuild(false),
+    incrementalRebuild(true),
+    staleSources(SOURCE_ALL),
+    cacheBudgetBytes(0),
+    hitCount(0),
+    missCount(0),
     cacheHits(0),
     cacheMisses(0),
+    cacheEvictions(0),
+    cacheEntries(0),
+    cacheResidentKBytes(0),
     transactionLevel(0),
     transactionAborted(false)
   {
@@ -526,6 +780,7 @@ public:
     runwayLengthFtQuery = prepare("SELECT length_ft FROM runway WHERE rowid=?1");
 
     removePOIQuery = prepare("DELETE FROM positioned WHERE type=?1 AND ident=?2");
+    findPositionedWithIdent = prepare("SELECT rowid FROM positioned WHERE type=?1 AND ident=?2");
 
   // query statement
     findClosestWithIdent = prepare("SELECT rowid FROM positioned WHERE ident=?1 "
@@ -747,6 +1002,10 @@ public:
     sqlite3_bind_double(insertPositionedQuery, 11, cartPos.z());
 
     PositionedID r = execInsert(insertPositionedQuery);
+    if (spatialIndex && octreeSnapshot.get()) {
+      // added after the snapshot was written, eg a user waypoint
+      octreeSnapshot->addOverlayItem(ty, r, cartPos);
+    }
     return r;
   }
 
@@ -822,8 +1081,69 @@ public:
     deferredOctreeUpdates.clear();
   }
 
+  bool writeOctreeSnapshot(const SGPath& snapshotPath, int64_t stamp)
+  {
+    SGTimeStamp st;
+    st.stamp();
+    Octree::SnapshotBuilder builder;
+
+    sqlite3_stmt_ptr nodes = prepare("SELECT rowid, children FROM octree");
+    while (stepSelect(nodes)) {
+      builder.addNode(sqlite3_column_int64(nodes, 0), sqlite3_column_int(nodes, 1));
+    }
+    finalize(nodes);
+
+    sqlite3_stmt_ptr items = prepare("SELECT octree_node, type, rowid, cart_x, cart_y, cart_z "
+                                     "FROM positioned WHERE octree_node IS NOT NULL");
+    while (stepSelect(items)) {
+      SGVec3d cart(sqlite3_column_double(items, 3),
+                   sqlite3_column_double(items, 4),
+                   sqlite3_column_double(items, 5));
+      builder.addItem(sqlite3_column_int64(items, 0),
+                      static_cast<FGPositioned::Type>(sqlite3_column_int(items, 1)),
+                      sqlite3_column_int64(items, 2), cart);
+    }
+    finalize(items);
+
+    bool ok = builder.write(snapshotPath, stamp,
+                            Octree::global_spatialOctree->bbox());
+    SG_LOG(SG_NAVCACHE, SG_INFO, "octree snapshot generation took:" << st.elapsedMSec());
+    return ok;
+  }
+
+  /**
+   * delete every positioned row in a type range, with its navaid data.
+   * Octree nodes are left alone: a leaf which ends up empty costs one
+   * query when visited, and is re-used by later inserts.
+   */
+  void removePositionedOfTypes(FGPositioned::Type minTy, FGPositioned::Type maxTy)
+  {
+    cache.eraseTypes(minTy, maxTy);
+
+    sqlite3_stmt_ptr removeNavaids = prepare("DELETE FROM navaid WHERE rowid IN "
+      "(SELECT rowid FROM positioned WHERE type>=?1 AND type<=?2)");
+    sqlite3_bind_int(removeNavaids, 1, minTy);
+    sqlite3_bind_int(removeNavaids, 2, maxTy);
+    execUpdate(removeNavaids);
+    finalize(removeNavaids);
+
+    sqlite3_stmt_ptr removePositioned = prepare("DELETE FROM positioned WHERE type>=?1 AND type<=?2");
+    sqlite3_bind_int(removePositioned, 1, minTy);
+    sqlite3_bind_int(removePositioned, 2, maxTy);
+    execUpdate(removePositioned);
+    finalize(removePositioned);
+  }
+
   void removePositionedWithIdent(FGPositioned::Type ty, const std::string& aIdent)
   {
+    if (octreeSnapshot.get()) {
+      sqlite3_bind_int(findPositionedWithIdent, 1, ty);
+      sqlite_bind_stdstring(findPositionedWithIdent, 2, aIdent);
+      BOOST_FOREACH(PositionedID id, selectIds(findPositionedWithIdent)) {
+        octreeSnapshot->removeItem(id);
+      }
+    }
+
     sqlite3_bind_int(removePOIQuery, 1, ty);
     sqlite_bind_stdstring(removePOIQuery, 2, aIdent);
     execUpdate(removePOIQuery);
@@ -834,12 +1154,40 @@ public:
   sqlite3* db;
   SGPath path;
     bool readOnly;
+    bool parallelRebuild; ///< parse input files on worker threads
+    bool incrementalRebuild; ///< re-import only the changed input files
+    unsigned int staleSources; ///< DataSource bits found modified
 
   /// the actual cache of ID -> instances. This holds an owning reference,
-  /// so once items are in the cache they will never be deleted until
-  /// the cache drops its reference
+  /// items are only deleted once evicted (see PositionedCache)
   PositionedCache cache;
-  unsigned int cacheHits, cacheMisses;
+
+  /// cache budget, read from /sim/navdb/cache/max-size-kbytes on the main
+  /// thread; zero disables eviction
+  size_t cacheBudgetBytes;
+  SGPropertyNode_ptr cacheBudgetNode;
+
+  /// counted by whichever thread loads, published from the main thread
+  unsigned int hitCount, missCount;
+
+  /// cache statistics, published under /sim/navdb/cache
+  int cacheHits, cacheMisses, cacheEvictions, cacheEntries, cacheResidentKBytes;
+  simgear::TiedPropertyList cacheProps;
+
+  void readCacheBudget()
+  {
+    int budgetKBytes = cacheBudgetNode->getIntValue();
+    cacheBudgetBytes = (budgetKBytes > 0) ? static_cast<size_t>(budgetKBytes) * 1024 : 0;
+  }
+
+  void updateCacheStats()
+  {
+    cacheHits = hitCount;
+    cacheMisses = missCount;
+    cacheEvictions = cache.evictions();
+    cacheEntries = cache.size();
+    cacheResidentKBytes = cache.residentBytes() / 1024;
+  }
 
   /**
    * record the levels of open transaction objects we have
@@ -861,7 +1209,7 @@ public:
   insertCommStation, insertNavaid;
   sqlite3_stmt_ptr setAirportMetar, setRunwayReciprocal, setRunwayILS, setNavaidColocated,
     setAirportPos;
-  sqlite3_stmt_ptr removePOIQuery;
+  sqlite3_stmt_ptr removePOIQuery, findPositionedWithIdent;
 
   sqlite3_stmt_ptr findClosestWithIdent;
 // octree (spatial index) related queries
@@ -895,6 +1243,9 @@ public:
   // if we're performing a rebuild, the thread that is doing the work.
   // otherwise, NULL
   std::auto_ptr<RebuildThread> rebuilder;
+
+  /// memory-mapped spatial index, if enabled
+  std::auto_ptr<Octree::Snapshot> octreeSnapshot;
 };
 
 //////////////////////////////////////////////////////////////////////
@@ -1070,12 +1421,28 @@ NavDataCache::NavDataCache()
 
   d->airwayDatPath = SGPath(globals->get_fg_root());
   d->airwayDatPath.append("Navaids/awy.dat.gz");
+
+  SGPropertyNode* cacheNode = fgGetNode("/sim/navdb/cache", true);
+  d->cacheBudgetNode = cacheNode->getNode("max-size-kbytes", true);
+  if (!d->cacheBudgetNode->hasValue()) {
+    d->cacheBudgetNode->setIntValue(DEFAULT_POSITIONED_CACHE_KBYTES);
+  }
+  d->readCacheBudget();
+
+  d->cacheProps.setRoot(cacheNode);
+  d->cacheProps.Tie("hits", &d->cacheHits);
+  d->cacheProps.Tie("misses", &d->cacheMisses);
+  d->cacheProps.Tie("evictions", &d->cacheEvictions);
+  d->cacheProps.Tie("entries", &d->cacheEntries);
+  d->cacheProps.Tie("resident-kbytes", &d->cacheResidentKBytes);
 }
 
 NavDataCache::~NavDataCache()
 {
   assert(static_instance == this);
   static_instance = NULL;
+  d->cacheProps.Untie();
+  Octree::global_snapshot = NULL;
   d.reset();
 }
 
@@ -1098,21 +1465,45 @@ bool NavDataCache::isRebuildRequired()
 
     if (flightgear::Options::sharedInstance()->isOptionSet("restore-defaults")) {
         SG_LOG(SG_NAVCACHE, SG_INFO, "NavCache: restore-defaults requested, will rebuild cache");
+        d->staleSources = SOURCE_ALL;
         return true;
     }
 
-  if (d->isCachedFileModified(d->aptDatPath, true) ||
-      d->isCachedFileModified(d->metarDatPath, true) ||
-      d->isCachedFileModified(d->navDatPath, true) ||
-      d->isCachedFileModified(d->fixDatPath, true) ||
-      d->isCachedFileModified(d->carrierDatPath, true) ||
+  if (d->isCachedFileModified(d->aptDatPath, true)) {
+    // everything refers to airports, no point checking further
+    d->staleSources = SOURCE_ALL;
+  } else {
+    d->staleSources = 0;
+    if (d->isCachedFileModified(d->metarDatPath, true)) {
+      d->staleSources |= SOURCE_METAR;
+    }
+
+    if (d->isCachedFileModified(d->navDatPath, true)) {
+      d->staleSources |= SOURCE_NAV;
+    }
+
+    if (d->isCachedFileModified(d->fixDatPath, true)) {
+      d->staleSources |= SOURCE_FIX;
+    }
+
+    if (d->isCachedFileModified(d->carrierDatPath, true)) {
+      d->staleSources |= SOURCE_CARRIER;
+    }
+
 // since POI loading is disabled on Windows, don't check for it
 // this caused: https://code.google.com/p/flightgear-bugs/issues/detail?id=1227
 #ifndef SG_WINDOWS
-      d->isCachedFileModified(d->poiDatPath, true) ||
+    if (d->isCachedFileModified(d->poiDatPath, true)) {
+      d->staleSources |= SOURCE_POI;
+    }
 #endif
-      d->isCachedFileModified(d->airwayDatPath, true))
-  {
+
+    if (d->isCachedFileModified(d->airwayDatPath, true)) {
+      d->staleSources |= SOURCE_AIRWAY;
+    }
+  }
+
+  if (d->staleSources != 0) {
     SG_LOG(SG_NAVCACHE, SG_INFO, "NavCache: main cache rebuild required");
     return true;
   }
@@ -1124,6 +1515,10 @@ bool NavDataCache::isRebuildRequired()
 NavDataCache::RebuildPhase NavDataCache::rebuild()
 {
     if (!d->rebuilder.get()) {
+        // property access is not thread-safe, so read the mode here
+        d->parallelRebuild = fgGetBool("/sim/navdb/parallel-rebuild", false);
+        d->incrementalRebuild = fgGetBool("/sim/navdb/incremental-rebuild", true);
+        d->readCacheBudget();
         d->rebuilder.reset(new RebuildThread(this));
         d->rebuilder->start();
     }
@@ -1132,6 +1527,7 @@ NavDataCache::RebuildPhase NavDataCache::rebuild()
     RebuildPhase phase = d->rebuilder->currentPhase();
     if (phase == REBUILD_DONE) {
         d->rebuilder.reset(); // all done!
+        d->updateCacheStats();
     }
     return phase;
 }
@@ -1156,6 +1552,11 @@ void NavDataCache::setRebuildPhaseProgress(RebuildPhase ph, unsigned int percent
 
 void NavDataCache::doRebuild()
 {
+  if (d->incrementalRebuild && ((d->staleSources & SOURCE_APT) == 0)) {
+    doIncrementalRebuild();
+    return;
+  }
+
   try {
     d->close(); // completely close the sqlite object
     d->path.remove(); // remove the file on disk
@@ -1164,12 +1565,22 @@ void NavDataCache::doRebuild()
     // initialise the root octree node
     d->runSQL("INSERT INTO octree (rowid, children) VALUES (1, 0)");
 
+    std::auto_ptr<RebuildPipeline> pipeline;
+    if (d->parallelRebuild) {
+        SG_LOG(SG_NAVCACHE, SG_INFO, "NavCache: using parallel rebuild");
+        pipeline.reset(new RebuildPipeline(d->aptDatPath, d->fixDatPath, d->poiDatPath));
+    }
+
     SGTimeStamp st;
     {
         Transaction txn(this);
 
         st.stamp();
-        airportDBLoad(d->aptDatPath);
+        if (pipeline.get()) {
+            airportDBLoad(*pipeline->aptLines, d->aptDatPath);
+        } else {
+            airportDBLoad(d->aptDatPath);
+        }
         SG_LOG(SG_NAVCACHE, SG_INFO, "apt.dat load took:" << st.elapsedMSec());
 
         setRebuildPhaseProgress(REBUILD_UNKNOWN);
@@ -1178,7 +1589,12 @@ void NavDataCache::doRebuild()
         stampCacheFile(d->metarDatPath);
 
         st.stamp();
-        loadFixes(d->fixDatPath);
+        if (pipeline.get()) {
+            CacheInsertSink sink(REBUILD_FIXES, LINES_IN_FIX_DAT);
+            pipeline->fixes->drainInto(sink);
+        } else {
+            loadFixes(d->fixDatPath);
+        }
         stampCacheFile(d->fixDatPath);
         SG_LOG(SG_NAVCACHE, SG_INFO, "fix.dat load took:" << st.elapsedMSec());
 
@@ -1200,7 +1616,12 @@ void NavDataCache::doRebuild()
           Transaction txn(this);
 
           st.stamp();
-          poiDBInit(d->poiDatPath);
+          if (!pipeline.get()) {
+              poiDBInit(d->poiDatPath);
+          } else if (pipeline->pois.get()) {
+              CacheInsertSink sink(REBUILD_POIS, LINES_IN_POI_DAT);
+              pipeline->pois->drainInto(sink);
+          }
           stampCacheFile(d->poiDatPath);
           SG_LOG(SG_NAVCACHE, SG_INFO, "poi.dat load took:" << st.elapsedMSec());
 
@@ -1237,6 +1658,116 @@ void NavDataCache::doRebuild()
   }
 }
 
+void NavDataCache::doIncrementalRebuild()
+{
+  unsigned int sources = d->staleSources;
+  // airway edges refer to fixes and navaids by ID
+  if (sources & (SOURCE_FIX | SOURCE_NAV)) {
+    sources |= SOURCE_AIRWAY;
+  }
+
+  SG_LOG(SG_NAVCACHE, SG_INFO, "NavCache: incremental rebuild, sources:" << sources);
+
+  try {
+    SGTimeStamp st;
+    Transaction txn(this);
+
+    if (sources & SOURCE_METAR) {
+      d->runSQL("UPDATE airport SET has_metar=0");
+      metarDataLoad(d->metarDatPath);
+      stampCacheFile(d->metarDatPath);
+    }
+
+    // remove airway data first, it refers to everything else
+    if (sources & SOURCE_AIRWAY) {
+      d->runSQL("DELETE FROM airway_edge");
+      d->runSQL("DELETE FROM airway");
+    }
+
+    if (sources & SOURCE_FIX) {
+      st.stamp();
+      d->removePositionedOfTypes(FGPositioned::FIX, FGPositioned::FIX);
+      loadFixes(d->fixDatPath);
+      stampCacheFile(d->fixDatPath);
+      SG_LOG(SG_NAVCACHE, SG_INFO, "fix.dat reload took:" << st.elapsedMSec());
+    }
+
+    if (sources & SOURCE_NAV) {
+      st.stamp();
+      d->runSQL("UPDATE runway SET ils=0");
+      d->removePositionedOfTypes(FGPositioned::NDB, FGPositioned::TACAN);
+      navDBInit(d->navDatPath);
+      stampCacheFile(d->navDatPath);
+      SG_LOG(SG_NAVCACHE, SG_INFO, "nav.dat reload took:" << st.elapsedMSec());
+    }
+
+    if (sources & SOURCE_CARRIER) {
+      d->removePositionedOfTypes(FGPositioned::MOBILE_TACAN, FGPositioned::MOBILE_TACAN);
+      loadCarrierNav(d->carrierDatPath);
+      stampCacheFile(d->carrierDatPath);
+    }
+
+#ifndef SG_WINDOWS
+    if (sources & SOURCE_POI) {
+      st.stamp();
+      d->removePositionedOfTypes(FGPositioned::COUNTRY, FGPositioned::VILLAGE);
+      poiDBInit(d->poiDatPath);
+      stampCacheFile(d->poiDatPath);
+      SG_LOG(SG_NAVCACHE, SG_INFO, "poi.dat reload took:" << st.elapsedMSec());
+    }
+#endif
+
+    if (sources & SOURCE_AIRWAY) {
+      st.stamp();
+      Airway::load(d->airwayDatPath);
+      stampCacheFile(d->airwayDatPath);
+      SG_LOG(SG_NAVCACHE, SG_INFO, "awy.dat reload took:" << st.elapsedMSec());
+    }
+
+    d->flushDeferredOctreeUpdates();
+
+    // the octree snapshot no longer matches
+    writeStringProperty("octree-snapshot-stamp", string());
+
+    setRebuildPhaseProgress(REBUILD_UNKNOWN);
+    st.stamp();
+    txn.commit();
+    SG_LOG(SG_NAVCACHE, SG_INFO, "incremental commit took:" << st.elapsedMSec());
+  } catch (sg_exception& e) {
+    SG_LOG(SG_NAVCACHE, SG_ALERT, "caught exception updating navCache:" << e.what());
+  }
+}
+
+void NavDataCache::initOctreeSnapshot()
+{
+  if (!fgGetBool("/sim/navdb/octree-snapshot", false)) {
+    return;
+  }
+
+  // navdata_X_Y.cache -> navdata_X_Y.octree
+  SGPath snapshotPath(d->path.base() + ".octree");
+
+  int64_t stamp = 0;
+  std::istringstream is(readStringProperty("octree-snapshot-stamp"));
+  is >> stamp;
+
+  if (stamp > 0) {
+    d->octreeSnapshot.reset(Octree::Snapshot::open(snapshotPath, stamp));
+  }
+
+  if (!d->octreeSnapshot.get() && !d->readOnly) {
+    stamp = SGTimeStamp::now().toUSecs();
+    if (d->writeOctreeSnapshot(snapshotPath, stamp)) {
+      std::ostringstream os;
+      os << stamp;
+      writeStringProperty("octree-snapshot-stamp", os.str());
+      d->octreeSnapshot.reset(Octree::Snapshot::open(snapshotPath, stamp));
+    }
+  }
+
+  Octree::global_snapshot = d->octreeSnapshot.get();
+}
+
 int NavDataCache::readIntProperty(const string& key)
 {
   sqlite_bind_stdstring(d->readPropertyQuery, 1, key);
@@ -1416,16 +1947,35 @@ FGPositionedRef NavDataCache::loadById(PositionedID rowid)
     return NULL;
   }
 
-  PositionedCache::iterator it = d->cache.find(rowid);
-  if (it != d->cache.end()) {
-    d->cacheHits++;
-    return it->second; // cache it
+  // properties are not thread-safe: while the RebuildThread runs, it may
+  // be the one loading, so only touch them once it is gone
+  bool mainThread = !d->rebuilder.get();
+
+  FGPositioned* cached = d->cache.find(rowid);
+  if (cached) {
+    d->hitCount++;
+    if (mainThread) {
+      d->cacheHits = d->hitCount;
+    }
+    return cached;
+  }
+
+  if (mainThread) {
+    d->readCacheBudget();
+  }
+
+  // make room before inserting, so the new item is never a candidate
+  if (d->cacheBudgetBytes > 0) {
+    d->cache.evictToBudget(d->cacheBudgetBytes);
   }
 
   sqlite3_int64 aptId;
-  FGPositioned* pos = d->loadById(rowid, aptId);
-  d->cache.insert(it, PositionedCache::value_type(rowid, pos));
-  d->cacheMisses++;
+  FGPositionedRef pos = d->loadById(rowid, aptId);
+  d->cache.insert(rowid, pos.get());
+  d->missCount++;
+  if (mainThread) {
+    d->updateCacheStats();
+  }
 
   // when we loaded an ILS, we must apply per-airport changes
   if ((pos->type() == FGPositioned::ILS) && (aptId > 0)) {
@@ -1454,9 +2004,10 @@ PositionedID NavDataCache::insertAirport(FGPositioned::Type ty, const string& id
 
 void NavDataCache::updatePosition(PositionedID item, const SGGeod &pos)
 {
-  if (d->cache.find(item) != d->cache.end()) {
+  FGPositioned* cached = d->cache.find(item);
+  if (cached) {
     SG_LOG(SG_NAVCACHE, SG_DEBUG, "updating position of an item in the cache");
-    d->cache[item]->modifyPosition(pos);
+    cached->modifyPosition(pos);
   }
 
   SGVec3d cartPos(SGVec3d::fromGeod(pos));
@@ -1533,8 +2084,8 @@ void NavDataCache::setRunwayILS(PositionedID runway, PositionedID ils)
   d->execUpdate(d->setRunwayILS);
 
   // and the in-memory one
-  if (d->cache.find(runway) != d->cache.end()) {
-    FGRunway* instance = (FGRunway*) d->cache[runway].ptr();
+  FGRunway* instance = (FGRunway*) d->cache.find(runway);
+  if (instance) {
     instance->setILS(ils);
   }
 }
@@ -1569,8 +2120,8 @@ void NavDataCache::setNavaidColocated(PositionedID navaid, PositionedID colocate
   d->execUpdate(d->setNavaidColocated);
 
   // ...and the in-memory copy of the navrecord
-  if (d->cache.find(navaid) != d->cache.end()) {
-    FGNavRecord* rec = (FGNavRecord*) d->cache[navaid].get();
+  FGNavRecord* rec = (FGNavRecord*) d->cache.find(navaid);
+  if (rec) {
     rec->setColocatedDME(colocatedDME);
   }
 }
@@ -222,6 +222,14 @@ public:
    */
   TypedPositionedVec getOctreeLeafChildren(int64_t octreeNodeId);
 
+  /**
+   * Map the read-only octree snapshot stored alongside the cache file,
+   * (re)writing it first if it is missing or stale. Spatial queries then
+   * use the snapshot instead of the octree nodes above. Does nothing unless
+   * /sim/navdb/octree-snapshot is set.
+   */
+  void initOctreeSnapshot();
+
 // airways
   int findAirway(int network, const std::string& aName);
 
@@ -279,6 +287,7 @@ private:
 
   friend class RebuildThread;
   void doRebuild();
+  void doIncrementalRebuild();
 
   friend class Transaction;
 
@@ -0,0 +1,245 @@
+// NavDataRebuild.cxx - helpers to run the NavDataCache rebuild as a
+// pipeline: text parsing on worker threads, feeding a single sqlite writer.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "NavDataRebuild.hxx"
+
+#include <simgear/sg_inlines.h>
+#include <simgear/debug/logstream.hxx>
+#include <simgear/structure/exception.hxx>
+
+namespace {
+
+// rows / lines per batch handed between threads. Large enough that the
+// queue locking is negligible, small enough to keep the writer busy early.
+const size_t ROW_BATCH_SIZE = 1024;
+const size_t LINE_BATCH_SIZE = 4096;
+
+} // anonymous namespace
+
+namespace flightgear
+{
+
+CacheInsertSink::CacheInsertSink(NavDataCache::RebuildPhase phase,
+                                 unsigned int expectedRows) :
+  _cache(NavDataCache::instance()),
+  _phase(phase),
+  _expectedRows(expectedRows),
+  _rowCount(0)
+{
+}
+
+void CacheInsertSink::addRow(FGPositioned::Type ty, const std::string& ident,
+                             const SGGeod& pos)
+{
+  if (ty == FGPositioned::FIX) {
+    _cache->insertFix(ident, pos);
+  } else {
+    _cache->createPOI(ty, ident, pos);
+  }
+
+  ++_rowCount;
+  if ((_rowCount % 100) == 0) {
+    // every 100 rows
+    unsigned int percent = (_rowCount * 100) / _expectedRows;
+    _cache->setRebuildPhaseProgress(_phase, SG_MIN2(percent, 100U));
+  }
+}
+
+void CacheInsertSink::addBatch(const PositionedRowBatch& batch)
+{
+  PositionedRowBatch::const_iterator it;
+  for (it = batch.begin(); it != batch.end(); ++it) {
+    addRow(it->type, it->ident, it->pos);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+GzLineSource::GzLineSource(const SGPath& path) :
+  _path(path),
+  _stream(path)
+{
+}
+
+bool GzLineSource::nextLine(std::string& line)
+{
+  if (std::getline(_stream, line)) {
+    return true;
+  }
+
+  if (_stream.bad()) {
+    SG_LOG(SG_NAVAID, SG_ALERT, "error while reading " << _path);
+    throw sg_io_exception("error reading file", _path);
+  }
+
+  return false;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+RebuildWorker::RebuildWorker(const SGPath& path) :
+  _path(path)
+{
+}
+
+void RebuildWorker::checkError() const
+{
+  SGGuard<SGMutex> g(_lock);
+  if (!_error.empty()) {
+    throw sg_io_exception(_error, _path);
+  }
+}
+
+void RebuildWorker::setError(const std::string& msg)
+{
+  SG_LOG(SG_NAVAID, SG_ALERT, "NavCache rebuild worker failed for "
+         << _path << ":" << msg);
+  SGGuard<SGMutex> g(_lock);
+  _error = msg;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+LineReadWorker::LineReadWorker(const SGPath& path, size_t maxQueuedBatches) :
+  RebuildWorker(path),
+  _queue(maxQueuedBatches),
+  _currentIndex(0)
+{
+}
+
+void LineReadWorker::run()
+{
+  try {
+    GzLineSource in(_path);
+    if (!in.isOpen()) {
+      throw sg_io_exception("Cannot open file:", _path);
+    }
+
+    TextLineBatch batch;
+    batch.reserve(LINE_BATCH_SIZE);
+    std::string line;
+    while (in.nextLine(line)) {
+      batch.push_back(std::string());
+      batch.back().swap(line);
+      if (batch.size() >= LINE_BATCH_SIZE) {
+        if (!_queue.push(batch)) {
+          return; // cancelled
+        }
+        batch.reserve(LINE_BATCH_SIZE);
+      }
+    }
+
+    if (!batch.empty()) {
+      _queue.push(batch);
+    }
+  } catch (sg_exception& e) {
+    setError(e.getFormattedMessage());
+  }
+
+  _queue.close();
+}
+
+void LineReadWorker::cancel()
+{
+  _queue.abort();
+  join();
+}
+
+bool LineReadWorker::nextLine(std::string& line)
+{
+  if (_currentIndex >= _current.size()) {
+    _current.clear();
+    _currentIndex = 0;
+    if (!_queue.pop(_current)) {
+      checkError();
+      return false;
+    }
+  }
+
+  line.swap(_current[_currentIndex++]);
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+RowParseWorker::RowParseWorker(const SGPath& path, ParseFunction fn,
+                               size_t maxQueuedBatches) :
+  RebuildWorker(path),
+  _parse(fn),
+  _queue(maxQueuedBatches),
+  _cancelled(false)
+{
+}
+
+void RowParseWorker::run()
+{
+  try {
+    _pending.reserve(ROW_BATCH_SIZE);
+    _parse(_path, this);
+    if (!_pending.empty()) {
+      _queue.push(_pending);
+    }
+  } catch (sg_exception& e) {
+    if (!_cancelled) {
+      setError(e.getFormattedMessage());
+    }
+  }
+
+  _queue.close();
+}
+
+void RowParseWorker::cancel()
+{
+  _queue.abort();
+  join();
+}
+
+void RowParseWorker::addRow(FGPositioned::Type ty, const std::string& ident,
+                            const SGGeod& pos)
+{
+  _pending.push_back(PositionedRow());
+  PositionedRow& r(_pending.back());
+  r.type = ty;
+  r.ident = ident;
+  r.pos = pos;
+
+  if (_pending.size() >= ROW_BATCH_SIZE) {
+    if (!_queue.push(_pending)) {
+      // unwind out of the parse function
+      _cancelled = true;
+      throw sg_exception("NavCache rebuild cancelled");
+    }
+    _pending.reserve(ROW_BATCH_SIZE);
+  }
+}
+
+void RowParseWorker::drainInto(CacheInsertSink& sink)
+{
+  PositionedRowBatch batch;
+  while (_queue.pop(batch)) {
+    sink.addBatch(batch);
+    batch.clear();
+  }
+
+  checkError();
+}
+
+} // of namespace flightgear
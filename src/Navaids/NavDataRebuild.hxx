@@ -0,0 +1,271 @@
+/**
+ * NavDataRebuild.hxx - helpers to run the NavDataCache rebuild as a
+ * pipeline: text parsing on worker threads, feeding a single sqlite writer.
+ */
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifndef FG_NAVDATA_REBUILD_HXX
+#define FG_NAVDATA_REBUILD_HXX
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <algorithm> // for std::swap
+
+#include <simgear/misc/sg_path.hxx>
+#include <simgear/misc/sgstream.hxx>
+#include <simgear/threads/SGThread.hxx>
+#include <simgear/threads/SGGuard.hxx>
+
+#include <Navaids/positioned.hxx>
+#include <Navaids/NavDataCache.hxx>
+
+namespace flightgear
+{
+
+/**
+ * A positioned item parsed from a simple text source (fix.dat, poi.dat),
+ * ready to be inserted into the cache.
+ */
+struct PositionedRow
+{
+  FGPositioned::Type type;
+  std::string ident;
+  SGGeod pos;
+};
+
+typedef std::vector<PositionedRow> PositionedRowBatch;
+typedef std::vector<std::string> TextLineBatch;
+
+/**
+ * Receiver for rows produced by a parser. Parsers never touch the cache
+ * directly, so they can run on any thread.
+ */
+class PositionedRowSink
+{
+public:
+  virtual ~PositionedRowSink() {}
+
+  virtual void addRow(FGPositioned::Type ty, const std::string& ident,
+                      const SGGeod& pos) = 0;
+};
+
+/**
+ * Sink which inserts rows into the cache, and reports the rebuild progress
+ * as it does so. Must be used on the thread which owns the cache.
+ */
+class CacheInsertSink : public PositionedRowSink
+{
+public:
+  CacheInsertSink(NavDataCache::RebuildPhase phase, unsigned int expectedRows);
+
+  virtual void addRow(FGPositioned::Type ty, const std::string& ident,
+                      const SGGeod& pos);
+
+  void addBatch(const PositionedRowBatch& batch);
+private:
+  NavDataCache* _cache;
+  NavDataCache::RebuildPhase _phase;
+  unsigned int _expectedRows;
+  unsigned int _rowCount;
+};
+
+/**
+ * Line-oriented text input, so loaders don't care if the data comes
+ * straight from the (compressed) file or via a reader thread.
+ */
+class TextLineSource
+{
+public:
+  virtual ~TextLineSource() {}
+
+  /**
+   * Retrieve the next line, returns false at end of the input. I/O errors
+   * are reported by throwing an sg_io_exception.
+   */
+  virtual bool nextLine(std::string& line) = 0;
+};
+
+class GzLineSource : public TextLineSource
+{
+public:
+  GzLineSource(const SGPath& path);
+
+  virtual bool nextLine(std::string& line);
+
+  bool isOpen()
+  { return _stream.is_open(); }
+private:
+  SGPath _path;
+  sg_gzifstream _stream;
+};
+
+/**
+ * Fixed capacity, thread-safe FIFO. Producers block while the queue is
+ * full, consumers block while it is empty and not yet closed. Items are
+ * swapped in and out, so batches are never copied.
+ */
+template <class T>
+class BoundedQueue
+{
+public:
+  BoundedQueue(size_t capacity) :
+    _capacity(capacity),
+    _closed(false),
+    _aborted(false)
+  {
+  }
+
+  /**
+   * Add an item (which is left empty on return). Returns false if the
+   * queue was aborted, in which case the producer should give up.
+   */
+  bool push(T& item)
+  {
+    SGGuard<SGMutex> g(_lock);
+    while (!_aborted && (_items.size() >= _capacity)) {
+      _notFull.wait(_lock);
+    }
+
+    if (_aborted) {
+      return false;
+    }
+
+    _items.push_back(T());
+    std::swap(_items.back(), item);
+    _notEmpty.signal();
+    return true;
+  }
+
+  /**
+   * Retrieve the oldest item, returns false once the queue is closed and
+   * drained, or aborted.
+   */
+  bool pop(T& item)
+  {
+    SGGuard<SGMutex> g(_lock);
+    while (_items.empty() && !_closed && !_aborted) {
+      _notEmpty.wait(_lock);
+    }
+
+    if (_aborted || _items.empty()) {
+      return false;
+    }
+
+    std::swap(item, _items.front());
+    _items.pop_front();
+    _notFull.signal();
+    return true;
+  }
+
+  /// no more items will be pushed
+  void close()
+  {
+    SGGuard<SGMutex> g(_lock);
+    _closed = true;
+    _notEmpty.broadcast();
+  }
+
+  /// wake up everyone and discard pending items
+  void abort()
+  {
+    SGGuard<SGMutex> g(_lock);
+    _aborted = true;
+    _items.clear();
+    _notFull.broadcast();
+    _notEmpty.broadcast();
+  }
+private:
+  const size_t _capacity;
+  bool _closed, _aborted;
+  std::deque<T> _items;
+  SGMutex _lock;
+  SGWaitCondition _notFull, _notEmpty;
+};
+
+/**
+ * Base for the rebuild worker threads: records any error from the
+ * parsing, so the writer can re-throw it on its own thread.
+ */
+class RebuildWorker : public SGThread
+{
+public:
+  RebuildWorker(const SGPath& path);
+
+  /// stop the worker and wait for it to exit
+  virtual void cancel() = 0;
+
+  /// throw an sg_io_exception if the worker failed
+  void checkError() const;
+protected:
+  void setError(const std::string& msg);
+
+  const SGPath _path;
+private:
+  mutable SGMutex _lock;
+  std::string _error;
+};
+
+/**
+ * Decompress and split a text file into batches of lines.
+ */
+class LineReadWorker : public RebuildWorker, public TextLineSource
+{
+public:
+  LineReadWorker(const SGPath& path, size_t maxQueuedBatches);
+
+  virtual void run();
+  virtual void cancel();
+
+  // TextLineSource, only for use by the writer thread
+  virtual bool nextLine(std::string& line);
+private:
+  BoundedQueue<TextLineBatch> _queue;
+  TextLineBatch _current;
+  size_t _currentIndex;
+};
+
+/**
+ * Run a row parser (such as parseFixes) and queue the resulting rows.
+ */
+class RowParseWorker : public RebuildWorker, public PositionedRowSink
+{
+public:
+  typedef void (*ParseFunction)(const SGPath& path, PositionedRowSink* sink);
+
+  RowParseWorker(const SGPath& path, ParseFunction fn, size_t maxQueuedBatches);
+
+  virtual void run();
+  virtual void cancel();
+
+  virtual void addRow(FGPositioned::Type ty, const std::string& ident,
+                      const SGGeod& pos);
+
+  /**
+   * Insert all rows into the sink, blocking until parsing is finished.
+   * Only for use by the writer thread.
+   */
+  void drainInto(CacheInsertSink& sink);
+private:
+  ParseFunction _parse;
+  BoundedQueue<PositionedRowBatch> _queue;
+  PositionedRowBatch _pending;
+  bool _cancelled;
+};
+
+} // of namespace flightgear
+
+#endif // of FG_NAVDATA_REBUILD_HXX
@@ -0,0 +1,550 @@
+// OctreeSnapshot.cxx - a read-only, memory-mapped copy of the positioned
+// octree, so spatial queries need no sqlite access.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "OctreeSnapshot.hxx"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+
+#include <simgear/compiler.h>
+
+#if defined(SG_WINDOWS)
+#  include <windows.h>
+#else
+#  include <sys/types.h>
+#  include <sys/stat.h>
+#  include <sys/mman.h>
+#  include <fcntl.h>
+#  include <unistd.h>
+#endif
+
+#include <simgear/debug/logstream.hxx>
+#include <simgear/misc/sgstream.hxx>
+#include <simgear/timing/timestamp.hxx>
+
+#include <Navaids/NavDataCache.hxx>
+
+namespace flightgear
+{
+
+namespace Octree
+{
+
+Snapshot* global_snapshot = NULL;
+
+namespace {
+
+const char SNAPSHOT_MAGIC[8] = {'F', 'G', 'O', 'C', 'T', 'R', 'E', 'E'};
+const uint32_t SNAPSHOT_VERSION = 1;
+const uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+
+#pragma pack(push, 4)
+struct SnapshotHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t byteOrder;
+  int64_t stamp;
+  uint32_t nodeCount;
+  uint32_t itemCount;
+};
+#pragma pack(pop)
+
+struct ItemTypeLess
+{
+  bool operator()(const SnapshotItem& a, int ty) const
+  { return a.type < ty; }
+
+  bool operator()(int ty, const SnapshotItem& a) const
+  { return ty < a.type; }
+
+  bool operator()(const SnapshotItem& a, const SnapshotItem& b) const
+  { return a.type < b.type; }
+};
+
+double distToBox(const SnapshotNode& nd, const SGVec3d& aPos)
+{
+  double d2 = 0.0;
+  for (int i=0; i<3; ++i) {
+    double v = aPos[i];
+    if (v < nd.boxMin[i]) {
+      d2 += (nd.boxMin[i] - v) * (nd.boxMin[i] - v);
+    } else if (v > nd.boxMax[i]) {
+      d2 += (v - nd.boxMax[i]) * (v - nd.boxMax[i]);
+    }
+  }
+
+  return sqrt(d2);
+}
+
+SnapshotNode makeNode(const SGBoxd& box, bool isLeaf)
+{
+  SnapshotNode nd;
+  memset(&nd, 0, sizeof(SnapshotNode));
+  for (int i=0; i<3; ++i) {
+    nd.boxMin[i] = box.getMin()[i];
+    nd.boxMax[i] = box.getMax()[i];
+  }
+  nd.isLeaf = isLeaf ? 1 : 0;
+  return nd;
+}
+
+} // of anonymous namespace
+
+///////////////////////////////////////////////////////////////////////////////
+
+void SnapshotBuilder::addNode(int64_t guid, int childMask)
+{
+  _childMasks[guid] = childMask;
+}
+
+void SnapshotBuilder::addItem(int64_t leafGuid, FGPositioned::Type ty,
+                              PositionedID guid, const SGVec3d& cart)
+{
+  SnapshotItem item;
+  memset(&item, 0, sizeof(SnapshotItem));
+  item.cart[0] = cart.x();
+  item.cart[1] = cart.y();
+  item.cart[2] = cart.z();
+  item.guid = guid;
+  item.type = ty;
+  _leafItems[leafGuid].push_back(item);
+}
+
+bool SnapshotBuilder::write(const SGPath& path, int64_t stamp,
+                            const SGBoxd& rootBox) const
+{
+  std::vector<SnapshotNode> nodes;
+  std::vector<SGBoxd> boxes;
+  std::vector<int64_t> guids;
+  std::vector<SnapshotItem> items;
+
+  // breadth-first layout, so the children of each branch are contiguous.
+  // Node boxes and leaf-ness follow the same rules as Branch::childAtIndex
+  nodes.push_back(makeNode(rootBox, false));
+  boxes.push_back(rootBox);
+  guids.push_back(1);
+
+  for (size_t i=0; i<nodes.size(); ++i) {
+    const int64_t guid = guids[i];
+    const SGBoxd box = boxes[i];
+
+    if (nodes[i].isLeaf) {
+      nodes[i].first = items.size();
+      LeafItemsMap::const_iterator it = _leafItems.find(guid);
+      if (it != _leafItems.end()) {
+        std::vector<SnapshotItem> leafItems(it->second);
+        std::stable_sort(leafItems.begin(), leafItems.end(), ItemTypeLess());
+        items.insert(items.end(), leafItems.begin(), leafItems.end());
+        nodes[i].count = leafItems.size();
+      }
+      continue;
+    }
+
+    std::map<int64_t, int>::const_iterator m = _childMasks.find(guid);
+    const int mask = (m == _childMasks.end()) ? 0 : m->second;
+    const uint32_t first = nodes.size();
+    uint32_t count = 0;
+
+    for (unsigned int c=0; c<8; ++c) {
+      if (((1 << c) & mask) == 0) {
+        continue;
+      }
+
+      SGBoxd cb(box.getCenter());
+      cb.expandBy(box.getCorner(c));
+      bool leaf = dot(cb.getSize(), cb.getSize()) < LEAF_SIZE_SQR;
+
+      nodes.push_back(makeNode(cb, leaf));
+      boxes.push_back(cb);
+      guids.push_back((guid << 3) | c);
+      ++count;
+    }
+
+    nodes[i].first = first;
+    nodes[i].count = count;
+  } // of breadth-first iteration
+
+  SnapshotHeader header;
+  memset(&header, 0, sizeof(SnapshotHeader));
+  memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+  header.version = SNAPSHOT_VERSION;
+  header.byteOrder = SNAPSHOT_BYTE_ORDER;
+  header.stamp = stamp;
+  header.nodeCount = nodes.size();
+  header.itemCount = items.size();
+
+  // write to a temporary and rename, since other processes may have the
+  // existing snapshot mapped
+  SGPath tmpPath(path.utf8Str() + ".tmp");
+  {
+    sg_ofstream out(tmpPath, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+      SG_LOG(SG_NAVAID, SG_WARN, "unable to write octree snapshot:" << tmpPath);
+      return false;
+    }
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(SnapshotHeader));
+    if (!nodes.empty()) {
+      out.write(reinterpret_cast<const char*>(&nodes.front()),
+                sizeof(SnapshotNode) * nodes.size());
+    }
+
+    if (!items.empty()) {
+      out.write(reinterpret_cast<const char*>(&items.front()),
+                sizeof(SnapshotItem) * items.size());
+    }
+
+    if (out.fail()) {
+      SG_LOG(SG_NAVAID, SG_WARN, "failed writing octree snapshot:" << tmpPath);
+      out.close();
+      tmpPath.remove();
+      return false;
+    }
+  }
+
+  if (path.exists()) {
+    SGPath(path).remove();
+  }
+
+  if (!tmpPath.rename(path)) {
+    SG_LOG(SG_NAVAID, SG_WARN, "failed to rename octree snapshot to:" << path);
+    return false;
+  }
+
+  SG_LOG(SG_NAVAID, SG_INFO, "wrote octree snapshot with " << nodes.size()
+         << " nodes, " << items.size() << " items to " << path);
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+Snapshot::Snapshot() :
+  _mapping(NULL),
+  _mappingSize(0),
+#if defined(SG_WINDOWS)
+  _fileHandle(INVALID_HANDLE_VALUE),
+  _mapHandle(NULL),
+#endif
+  _nodes(NULL),
+  _nodeCount(0),
+  _items(NULL),
+  _itemCount(0)
+{
+}
+
+Snapshot::~Snapshot()
+{
+#if defined(SG_WINDOWS)
+  if (_mapping) {
+    UnmapViewOfFile(_mapping);
+  }
+
+  if (_mapHandle) {
+    CloseHandle(_mapHandle);
+  }
+
+  if (_fileHandle != INVALID_HANDLE_VALUE) {
+    CloseHandle(_fileHandle);
+  }
+#else
+  if (_mapping) {
+    munmap(_mapping, _mappingSize);
+  }
+#endif
+}
+
+Snapshot* Snapshot::open(const SGPath& path, int64_t stamp)
+{
+  if (!path.exists()) {
+    return NULL;
+  }
+
+  std::auto_ptr<Snapshot> s(new Snapshot);
+#if defined(SG_WINDOWS)
+  std::wstring wpath = path.wstr();
+  s->_fileHandle = CreateFileW(wpath.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                               NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (s->_fileHandle == INVALID_HANDLE_VALUE) {
+    return NULL;
+  }
+
+  LARGE_INTEGER sz;
+  if (!GetFileSizeEx(s->_fileHandle, &sz)) {
+    return NULL;
+  }
+
+  s->_mappingSize = static_cast<size_t>(sz.QuadPart);
+  if (s->_mappingSize < sizeof(SnapshotHeader)) {
+    return NULL;
+  }
+
+  s->_mapHandle = CreateFileMapping(s->_fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (!s->_mapHandle) {
+    return NULL;
+  }
+
+  s->_mapping = MapViewOfFile(s->_mapHandle, FILE_MAP_READ, 0, 0, 0);
+  if (!s->_mapping) {
+    return NULL;
+  }
+#else
+  std::string upath = path.utf8Str();
+  int fd = ::open(upath.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return NULL;
+  }
+
+  struct stat st;
+  if ((fstat(fd, &st) != 0) || (st.st_size < (off_t) sizeof(SnapshotHeader))) {
+    ::close(fd);
+    return NULL;
+  }
+
+  s->_mappingSize = st.st_size;
+  void* m = mmap(NULL, s->_mappingSize, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd); // the mapping keeps the file open
+  if (m == MAP_FAILED) {
+    return NULL;
+  }
+  s->_mapping = m;
+#endif
+
+  const char* base = static_cast<const char*>(s->_mapping);
+  const SnapshotHeader* header = reinterpret_cast<const SnapshotHeader*>(base);
+  if (memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) ||
+      (header->version != SNAPSHOT_VERSION) ||
+      (header->byteOrder != SNAPSHOT_BYTE_ORDER))
+  {
+    SG_LOG(SG_NAVAID, SG_INFO, "octree snapshot has wrong format:" << path);
+    return NULL;
+  }
+
+  if (header->stamp != stamp) {
+    SG_LOG(SG_NAVAID, SG_INFO, "octree snapshot is stale:" << path);
+    return NULL;
+  }
+
+  size_t expectedSize = sizeof(SnapshotHeader) +
+    sizeof(SnapshotNode) * header->nodeCount +
+    sizeof(SnapshotItem) * header->itemCount;
+  if ((s->_mappingSize != expectedSize) || (header->nodeCount == 0)) {
+    SG_LOG(SG_NAVAID, SG_WARN, "octree snapshot is truncated:" << path);
+    return NULL;
+  }
+
+  s->_nodeCount = header->nodeCount;
+  s->_itemCount = header->itemCount;
+  s->_nodes = reinterpret_cast<const SnapshotNode*>(base + sizeof(SnapshotHeader));
+  s->_items = reinterpret_cast<const SnapshotItem*>(s->_nodes + s->_nodeCount);
+
+  SG_LOG(SG_NAVAID, SG_INFO, "mapped octree snapshot:" << path << " with "
+         << s->_nodeCount << " nodes, " << s->_itemCount << " items");
+  return s.release();
+}
+
+void Snapshot::addOverlayItem(FGPositioned::Type ty, PositionedID guid,
+                              const SGVec3d& cart)
+{
+  SnapshotItem item;
+  memset(&item, 0, sizeof(SnapshotItem));
+  item.cart[0] = cart.x();
+  item.cart[1] = cart.y();
+  item.cart[2] = cart.z();
+  item.guid = guid;
+  item.type = ty;
+  _overlay.push_back(item);
+  _removed.erase(guid);
+}
+
+void Snapshot::removeItem(PositionedID guid)
+{
+  _removed.insert(guid);
+
+  std::vector<SnapshotItem>::iterator it;
+  for (it = _overlay.begin(); it != _overlay.end(); ++it) {
+    if (it->guid == guid) {
+      _overlay.erase(it);
+      break;
+    }
+  }
+}
+
+void Snapshot::visitItems(const SnapshotItem* begin, const SnapshotItem* end,
+                          const SGVec3d& aPos, double aCutoff,
+                          FGPositioned::Filter* aFilter,
+                          FindNearestResults& aResults) const
+{
+  const int minType = aFilter ? aFilter->minType() : FGPositioned::INVALID;
+  const int maxType = aFilter ? aFilter->maxType() : FGPositioned::LAST_TYPE;
+  const size_t previousResultsSize = aResults.size();
+  NavDataCache* cache = NavDataCache::instance();
+
+  for (const SnapshotItem* it = begin; it != end; ++it) {
+    if ((it->type < minType) || (it->type > maxType)) {
+      continue;
+    }
+
+    double d = dist(aPos, SGVec3d(it->cart[0], it->cart[1], it->cart[2]));
+    if (d > aCutoff) {
+      continue;
+    }
+
+    if (!_removed.empty() && (_removed.find(it->guid) != _removed.end())) {
+      continue;
+    }
+
+    // only now do we need the real object
+    FGPositionedRef p = cache->loadById(it->guid);
+    if (!p || (aFilter && !aFilter->pass(p))) {
+      continue;
+    }
+
+    aResults.push_back(OrderedPositioned(p, d));
+  }
+
+  if (aResults.size() == previousResultsSize) {
+    return;
+  }
+
+  // keep aResults sorted, as Leaf::visit does
+  std::sort(aResults.begin() + previousResultsSize, aResults.end());
+  std::inplace_merge(aResults.begin(),
+                     aResults.begin() + previousResultsSize, aResults.end());
+}
+
+void Snapshot::visitNode(uint32_t index, const SGVec3d& aPos, double aCutoff,
+                         FGPositioned::Filter* aFilter,
+                         FindNearestResults& aResults, CandidateHeap& aQ) const
+{
+  const SnapshotNode& nd(_nodes[index]);
+  if (nd.isLeaf) {
+    const SnapshotItem* begin = _items + nd.first;
+    const SnapshotItem* end = begin + nd.count;
+    if (aFilter) {
+      // items are sorted by type, skip directly to the filter range
+      begin = std::lower_bound(begin, end, (int) aFilter->minType(), ItemTypeLess());
+      end = std::upper_bound(begin, end, (int) aFilter->maxType(), ItemTypeLess());
+    }
+
+    visitItems(begin, end, aPos, aCutoff, aFilter, aResults);
+    return;
+  }
+
+  for (uint32_t c = nd.first; c < nd.first + nd.count; ++c) {
+    double d = distToBox(_nodes[c], aPos);
+    if (d > aCutoff) {
+      continue; // exceeded cutoff
+    }
+
+    Candidate cand;
+    cand.dist = d;
+    cand.index = c;
+    aQ.push_back(cand);
+    std::push_heap(aQ.begin(), aQ.end());
+  }
+}
+
+void Snapshot::startQuery(const SGVec3d& aPos, double aCutoff,
+                          FGPositioned::Filter* aFilter,
+                          FindNearestResults& aResults, CandidateHeap& aQ) const
+{
+  aQ.reserve(64);
+  if (!_overlay.empty()) {
+    const SnapshotItem* begin = &_overlay.front();
+    visitItems(begin, begin + _overlay.size(), aPos, aCutoff, aFilter, aResults);
+  }
+
+  Candidate root;
+  root.dist = 0.0;
+  root.index = 0;
+  aQ.push_back(root);
+}
+
+bool Snapshot::findNearestN(const SGVec3d& aPos, unsigned int aN, double aCutoffM,
+                            FGPositioned::Filter* aFilter,
+                            FGPositionedList& aResults, int aCutoffMsec) const
+{
+  aResults.clear();
+  CandidateHeap q;
+  FindNearestResults results;
+  startQuery(aPos, aCutoffM, aFilter, results, q);
+
+  SGTimeStamp tm;
+  tm.stamp();
+
+  while (!q.empty() && (tm.elapsedMSec() < aCutoffMsec)) {
+    // terminate the search if we have sufficent results, and we are
+    // sure no node still on the queue contains a closer match
+    if ((results.size() >= aN) && (results.back().order() < q.front().dist)) {
+      q.clear();
+      break;
+    }
+
+    uint32_t index = q.front().index;
+    std::pop_heap(q.begin(), q.end());
+    q.pop_back();
+
+    visitNode(index, aPos, aCutoffM, aFilter, results, q);
+  }
+
+  unsigned int numResults = std::min((unsigned int) results.size(), aN);
+  aResults.resize(numResults);
+  for (unsigned int r=0; r<numResults; ++r) {
+    aResults[r] = results[r].get();
+  }
+
+  return !q.empty();
+}
+
+bool Snapshot::findAllWithinRange(const SGVec3d& aPos, double aRangeM,
+                                  FGPositioned::Filter* aFilter,
+                                  FGPositionedList& aResults, int aCutoffMsec) const
+{
+  aResults.clear();
+  CandidateHeap q;
+  FindNearestResults results;
+  startQuery(aPos, aRangeM, aFilter, results, q);
+
+  SGTimeStamp tm;
+  tm.stamp();
+
+  while (!q.empty() && (tm.elapsedMSec() < aCutoffMsec)) {
+    uint32_t index = q.front().index;
+    std::pop_heap(q.begin(), q.end());
+    q.pop_back();
+
+    visitNode(index, aPos, aRangeM, aFilter, results, q);
+  }
+
+  aResults.resize(results.size());
+  for (unsigned int r=0; r<results.size(); ++r) {
+    aResults[r] = results[r].get();
+  }
+
+  return !q.empty();
+}
+
+} // of namespace Octree
+
+} // of namespace flightgear
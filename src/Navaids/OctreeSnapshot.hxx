@@ -0,0 +1,164 @@
+/**
+ * OctreeSnapshot.hxx - a read-only, memory-mapped copy of the positioned
+ * octree, so spatial queries need no sqlite access.
+ */
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifndef FG_OCTREE_SNAPSHOT_HXX
+#define FG_OCTREE_SNAPSHOT_HXX
+
+#include <map>
+#include <set>
+#include <vector>
+#include <stdint.h>
+
+#include <simgear/math/SGMath.hxx>
+#include <simgear/misc/sg_path.hxx>
+
+#include <Navaids/positioned.hxx>
+#include <Navaids/PositionedOctree.hxx>
+
+namespace flightgear
+{
+
+namespace Octree
+{
+
+#pragma pack(push, 4)
+
+/// on-disk record for a positioned item; items of a leaf are stored
+/// contiguously, sorted by type
+struct SnapshotItem
+{
+  double cart[3];
+  int64_t guid;
+  int32_t type;
+  int32_t reserved;
+};
+
+/// on-disk record for an octree node; the children of a branch are stored
+/// contiguously, in child-index order
+struct SnapshotNode
+{
+  double boxMin[3];
+  double boxMax[3];
+  uint32_t first;  ///< first child node for branches, first item for leaves
+  uint32_t count;  ///< number of child nodes / items
+  uint32_t isLeaf;
+  uint32_t reserved;
+};
+
+#pragma pack(pop)
+
+/**
+ * Collects the octree nodes and items from the NavDataCache, and writes
+ * them out in breadth-first order.
+ */
+class SnapshotBuilder
+{
+public:
+  void addNode(int64_t guid, int childMask);
+  void addItem(int64_t leafGuid, FGPositioned::Type ty, PositionedID guid,
+               const SGVec3d& cart);
+
+  /**
+   * write the snapshot file. The stamp is stored in the header, and must be
+   * passed to Snapshot::open for the file to be accepted.
+   */
+  bool write(const SGPath& path, int64_t stamp, const SGBoxd& rootBox) const;
+private:
+  std::map<int64_t, int> _childMasks;
+  typedef std::map<int64_t, std::vector<SnapshotItem> > LeafItemsMap;
+  LeafItemsMap _leafItems;
+};
+
+/**
+ * The memory-mapped snapshot. Queries mirror findNearestN and
+ * findAllWithinRange; positions and types are checked from the mapped
+ * records, so only items which pass the distance test are loaded from the
+ * NavDataCache, via its in-memory cache.
+ *
+ * Items added or removed after the snapshot was written (user waypoints)
+ * are tracked in a small overlay.
+ */
+class Snapshot
+{
+public:
+  ~Snapshot();
+
+  /**
+   * map a snapshot file, returns NULL if it is missing, damaged or the
+   * stamp does not match
+   */
+  static Snapshot* open(const SGPath& path, int64_t stamp);
+
+  bool findNearestN(const SGVec3d& aPos, unsigned int aN, double aCutoffM,
+                    FGPositioned::Filter* aFilter, FGPositionedList& aResults,
+                    int aCutoffMsec) const;
+
+  bool findAllWithinRange(const SGVec3d& aPos, double aRangeM,
+                          FGPositioned::Filter* aFilter,
+                          FGPositionedList& aResults, int aCutoffMsec) const;
+
+  void addOverlayItem(FGPositioned::Type ty, PositionedID guid, const SGVec3d& cart);
+  void removeItem(PositionedID guid);
+private:
+  Snapshot();
+
+  struct Candidate
+  {
+    double dist;
+    uint32_t index;
+
+    bool operator<(const Candidate& other) const
+    { return dist > other.dist; } // min-heap ordering
+  };
+  typedef std::vector<Candidate> CandidateHeap;
+
+  void visitItems(const SnapshotItem* begin, const SnapshotItem* end,
+                  const SGVec3d& aPos, double aCutoff,
+                  FGPositioned::Filter* aFilter,
+                  FindNearestResults& aResults) const;
+  void visitNode(uint32_t index, const SGVec3d& aPos, double aCutoff,
+                 FGPositioned::Filter* aFilter, FindNearestResults& aResults,
+                 CandidateHeap& aQ) const;
+  void startQuery(const SGVec3d& aPos, double aCutoff,
+                  FGPositioned::Filter* aFilter, FindNearestResults& aResults,
+                  CandidateHeap& aQ) const;
+
+  void* _mapping;
+  size_t _mappingSize;
+#if defined(SG_WINDOWS)
+  void* _fileHandle;
+  void* _mapHandle;
+#endif
+
+  const SnapshotNode* _nodes;
+  uint32_t _nodeCount;
+  const SnapshotItem* _items;
+  uint32_t _itemCount;
+
+  std::vector<SnapshotItem> _overlay;
+  std::set<PositionedID> _removed;
+};
+
+extern Snapshot* global_snapshot;
+
+} // of namespace Octree
+
+} // of namespace flightgear
+
+#endif // of FG_OCTREE_SNAPSHOT_HXX
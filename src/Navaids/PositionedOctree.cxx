@@ -26,6 +26,7 @@
 #endif
 
 #include "PositionedOctree.hxx"
+#include "OctreeSnapshot.hxx"
 #include "positioned.hxx"
 
 #include <cassert>
@@ -298,6 +299,10 @@ int Branch::childMask() const
 
 bool findNearestN(const SGVec3d& aPos, unsigned int aN, double aCutoffM, FGPositioned::Filter* aFilter, FGPositionedList& aResults, int aCutoffMsec)
 {
+  if (global_snapshot) {
+    return global_snapshot->findNearestN(aPos, aN, aCutoffM, aFilter, aResults, aCutoffMsec);
+  }
+
   aResults.clear();
   FindNearestPQueue pq;
   FindNearestResults results;
@@ -339,6 +344,10 @@ bool findNearestN(const SGVec3d& aPos, unsigned int aN, double aCutoffM, FGPosit
 
 bool findAllWithinRange(const SGVec3d& aPos, double aRangeM, FGPositioned::Filter* aFilter, FGPositionedList& aResults, int aCutoffMsec)
 {
+  if (global_snapshot) {
+    return global_snapshot->findAllWithinRange(aPos, aRangeM, aFilter, aResults, aCutoffMsec);
+  }
+
   aResults.clear();
   FindNearestPQueue pq;
   FindNearestResults results;
@@ -110,7 +110,9 @@ namespace Octree
    */
   typedef std::priority_queue<OrderedNode, std::vector<OrderedNode>, FNPQCompare> FindNearestPQueue;
   
-  typedef Ordered<FGPositioned*> OrderedPositioned;
+  // hold a reference, so results can't be evicted from the NavDataCache
+  // while the search is still running
+  typedef Ordered<FGPositionedRef> OrderedPositioned;
   typedef std::vector<OrderedPositioned> FindNearestResults;
   
   // for extracting lines, we don't care about distance ordering, since
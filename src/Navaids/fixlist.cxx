@@ -36,6 +36,7 @@
 #include "fixlist.hxx"
 #include <Navaids/fix.hxx>
 #include <Navaids/NavDataCache.hxx>
+#include <Navaids/NavDataRebuild.hxx>
 
 FGFix::FGFix(PositionedID aGuid, const std::string& aIdent, const SGGeod& aPos) :
   FGPositioned(aGuid, FIX, aIdent, aPos)
@@ -47,8 +48,8 @@ namespace flightgear
 {
 
 const unsigned int LINES_IN_FIX_DAT = 119724;
-  
-void loadFixes(const SGPath& path)
+
+void parseFixes(const SGPath& path, PositionedRowSink* sink)
 {
   sg_gzifstream in( path );
   if ( !in.is_open() ) {
@@ -58,9 +59,6 @@ void loadFixes(const SGPath& path)
   // toss the first two lines of the file
   in >> skipeol;
   in >> skipeol;
-  
-  NavDataCache* cache = NavDataCache::instance();
-  unsigned int lineNumber = 2;
 
   // read in each remaining line of the file
   while ( ! in.eof() ) {
@@ -69,17 +67,15 @@ void loadFixes(const SGPath& path)
     in >> lat >> lon >> ident;
     if (lat > 95) break;
     
-    cache->insertFix(ident, SGGeod::fromDeg(lon, lat));
+    sink->addRow(FGPositioned::FIX, ident, SGGeod::fromDeg(lon, lat));
     in >> skipcomment;
-
-      ++lineNumber;
-      if ((lineNumber % 100) == 0) {
-          // every 100 lines
-          unsigned int percent = (lineNumber * 100) / LINES_IN_FIX_DAT;
-          cache->setRebuildPhaseProgress(NavDataCache::REBUILD_FIXES, percent);
-      }
   }
+}
 
+void loadFixes(const SGPath& path)
+{
+  CacheInsertSink sink(NavDataCache::REBUILD_FIXES, LINES_IN_FIX_DAT);
+  parseFixes(path, &sink);
 }
 
 } // of namespace flightgear;
@@ -31,8 +31,18 @@ class SGPath;
 
 namespace flightgear
 {
-  
+  class PositionedRowSink;
+
+  /// approximate number of records, for progress reporting
+  extern const unsigned int LINES_IN_FIX_DAT;
+
   void loadFixes(const SGPath& path);
+
+  /**
+   * parse fix.dat without touching the cache, passing each fix to the
+   * sink. Safe to call from a worker thread.
+   */
+  void parseFixes(const SGPath& path, PositionedRowSink* sink);
   
 }
 
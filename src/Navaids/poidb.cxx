@@ -32,6 +32,7 @@
 #include <simgear/misc/sgstream.hxx>
 
 #include <Navaids/NavDataCache.hxx>
+#include <Navaids/NavDataRebuild.hxx>
 
 
 using std::string;
@@ -52,19 +53,19 @@ mapPOITypeToFGPType(int aTy)
 namespace flightgear
 {
 
-    const int LINES_IN_POI_DAT = 769019;
+const unsigned int LINES_IN_POI_DAT = 769019;
 
-static PositionedID readPOIFromStream(std::istream& aStream, NavDataCache* cache,
-                                        FGPositioned::Type type = FGPositioned::INVALID)
+static void readPOIFromStream(std::istream& aStream, PositionedRowSink* sink,
+                              FGPositioned::Type type = FGPositioned::INVALID)
 {
     if (aStream.eof()) {
-        return 0;
+        return;
     }
 
     aStream >> skipws;
     if (aStream.peek() == '#') {
         aStream >> skipeol;
-        return 0;
+        return;
     }
     
   int rawType;
@@ -83,34 +84,35 @@ static PositionedID readPOIFromStream(std::istream& aStream, NavDataCache* cache
     type = mapPOITypeToFGPType(rawType);
   }
   if (type == FGPositioned::INVALID) {
-    return 0;
+    return;
   }
 
-  return cache->createPOI(type, name, pos);
+  sink->addRow(type, name, pos);
 }
 
-// load and initialize the POI database
-bool poiDBInit(const SGPath& path)
+void parsePOIs(const SGPath& path, PositionedRowSink* sink)
 {
     sg_gzifstream in( path );
     if ( !in.is_open() ) {
         SG_LOG( SG_NAVAID, SG_ALERT, "Cannot open file: " << path );
-      return false;
+        return;
     }
 
-    unsigned int lineNumber = 0;
-    NavDataCache* cache = NavDataCache::instance();
     while (!in.eof()) {
-      readPOIFromStream(in, cache);
-
-        ++lineNumber;
-        if ((lineNumber % 100) == 0) {
-            // every 100 lines
-            unsigned int percent = (lineNumber * 100) / LINES_IN_POI_DAT;
-            cache->setRebuildPhaseProgress(NavDataCache::REBUILD_POIS, percent);
-        }
+      readPOIFromStream(in, sink);
     } // of stream data loop
+}
+
+// load and initialize the POI database
+bool poiDBInit(const SGPath& path)
+{
+    if (!path.exists()) {
+        SG_LOG( SG_NAVAID, SG_ALERT, "Cannot open file: " << path );
+        return false;
+    }
 
+    CacheInsertSink sink(NavDataCache::REBUILD_POIS, LINES_IN_POI_DAT);
+    parsePOIs(path, &sink);
     return true;
 }
 
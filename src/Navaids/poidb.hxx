@@ -31,6 +31,16 @@ class SGPath;
 
 namespace flightgear
 {
+class PositionedRowSink;
+
+/// approximate number of records, for progress reporting
+extern const unsigned int LINES_IN_POI_DAT;
+
+/**
+ * parse poi.dat without touching the cache, passing each POI to the
+ * sink. Safe to call from a worker thread.
+ */
+void parsePOIs(const SGPath& path, PositionedRowSink* sink);
 
 // load and initialize the POI database
 bool poiDBInit(const SGPath& path);
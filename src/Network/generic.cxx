@@ -27,6 +27,7 @@
 #include <string.h>                // strstr()
 #include <stdlib.h>                // strtod(), atoi()
 #include <cstdio>
+#include <deque>
 
 #include <simgear/debug/logstream.hxx>
 #include <simgear/io/iochannel.hxx>
@@ -37,6 +38,8 @@
 #include <simgear/props/props.hxx>
 #include <simgear/props/props_io.hxx>
 #include <simgear/math/SGMath.hxx>
+#include <simgear/threads/SGThread.hxx>
+#include <simgear/threads/SGGuard.hxx>
 
 #include <Main/globals.hxx>
 #include <Main/fg_props.hxx>
@@ -221,7 +224,141 @@ int FGSTXETXWrapper::unwrap( size_t n, uint8_t * buf )
   return n;
 }
 
-FGGeneric::FGGeneric(vector<string> tokens) : exitOnError(false), initOk(false), wrapper(NULL)
+/**
+ * Runs the I/O of a generic channel on its own thread, so a slow peer can't
+ * stall the frame. Output records are still encoded on the main thread, once
+ * per frame, and handed over here; when the peer falls behind, the pending
+ * record is replaced by the newest one. Input records are queued for the
+ * main thread, which parses them into the property tree.
+ */
+class FGGenericIOThread : public SGThread {
+public:
+  FGGenericIOThread( SGIOChannel *io, bool input, bool binary, int record_length ) :
+    _io(io), _input(input), _binary(binary), _record_length(record_length),
+    _has_pending(false), _stop(false), _failed(false), _dropped(0)
+  { }
+
+  /// replace the pending output record
+  void send( const char *data, int length )
+  {
+    SGGuard<SGMutex> g(_lock);
+    if( _has_pending ) ++_dropped;
+    _pending.assign( data, length );
+    _has_pending = true;
+    _wake.signal();
+  }
+
+  /// next received input record, if any
+  bool receive( std::string &record )
+  {
+    SGGuard<SGMutex> g(_lock);
+    if( _received.empty() ) return false;
+    record.swap( _received.front() );
+    _received.pop_front();
+    return true;
+  }
+
+  bool failed()
+  {
+    SGGuard<SGMutex> g(_lock);
+    return _failed;
+  }
+
+  void stop()
+  {
+    {
+      SGGuard<SGMutex> g(_lock);
+      _stop = true;
+      _wake.signal();
+    }
+    join();
+    if( _dropped > 0 )
+      SG_LOG( SG_IO, SG_INFO, "Generic protocol: " << _dropped
+              << " records dropped by the I/O thread" );
+  }
+
+  virtual void run();
+
+private:
+  // input channels are polled at this interval when there is no output
+  static const unsigned POLL_INTERVAL_MSEC = 5;
+  static const size_t MAX_QUEUED_RECORDS = 64;
+
+  void read_records();
+
+  SGIOChannel *_io;
+  bool _input;
+  bool _binary;
+  int _record_length;
+
+  SGMutex _lock;
+  SGWaitCondition _wake;
+  std::string _pending;
+  bool _has_pending;
+  std::deque<std::string> _received;
+  bool _stop;
+  bool _failed;
+  unsigned _dropped;
+};
+
+void FGGenericIOThread::run()
+{
+  std::string record;
+  for(;;) {
+    bool write = false;
+    {
+      SGGuard<SGMutex> g(_lock);
+      if( !_stop && !_has_pending )
+        _wake.wait( _lock, POLL_INTERVAL_MSEC );
+      if( _stop ) return;
+      if( _has_pending ) {
+        record.swap( _pending );
+        _has_pending = false;
+        write = true;
+      }
+    }
+
+    if( write && !_io->write( record.data(), record.size() ) ) {
+      SGGuard<SGMutex> g(_lock);
+      _failed = true;
+    }
+
+    if( _input ) read_records();
+  }
+}
+
+void FGGenericIOThread::read_records()
+{
+  char buf[ FG_MAX_MSG_SIZE ];
+  int length;
+  for(;;) {
+    if( _binary ) {
+      length = _io->read( buf, _record_length );
+      if( length > 0 && length != _record_length ) {
+        SG_LOG( SG_IO, SG_ALERT,
+            "Generic protocol: Received binary "
+            "record of unexpected size, expected: "
+            << _record_length << " but received: "
+            << length);
+        return;
+      }
+    } else {
+      length = _io->readline( buf, FG_MAX_MSG_SIZE );
+    }
+
+    if( length <= 0 ) return;
+
+    SGGuard<SGMutex> g(_lock);
+    if( _received.size() >= MAX_QUEUED_RECORDS ) {
+      _received.pop_front();
+      ++_dropped;
+    }
+    _received.push_back( std::string( buf, length ) );
+  }
+}
+
+FGGeneric::FGGeneric(vector<string> tokens) : exitOnError(false), initOk(false), threaded(false),
+    wrapper(NULL), io_thread(NULL)
 {
     size_t configToken;
     if (tokens[1] == "socket") {
@@ -252,6 +389,10 @@ FGGeneric::FGGeneric(vector<string> tokens) : exitOnError(false), initOk(false),
 }
 
 FGGeneric::~FGGeneric() {
+  if( io_thread ) {
+    io_thread->stop();
+    delete io_thread;
+  }
   delete wrapper;
 }
 
@@ -265,122 +406,95 @@ union u64 {
     double doubleVal;
 };
 
+static inline void put16( char *p, uint16_t v ) { memcpy( p, &v, sizeof(v) ); }
+static inline void put32( char *p, uint32_t v ) { memcpy( p, &v, sizeof(v) ); }
+static inline void put64( char *p, uint64_t v ) { memcpy( p, &v, sizeof(v) ); }
+static inline uint16_t get16( const char *p ) { uint16_t v; memcpy( &v, p, sizeof(v) ); return v; }
+static inline uint32_t get32( const char *p ) { uint32_t v; memcpy( &v, p, sizeof(v) ); return v; }
+static inline uint64_t get64( const char *p ) { uint64_t v; memcpy( &v, p, sizeof(v) ); return v; }
+
 // generate the message
 bool FGGeneric::gen_message_binary() {
-    string generic_sentence;
-    length = 0;
-
-    double val;
-    for (unsigned int i = 0; i < _out_message.size(); i++) {
-
-        switch (_out_message[i].type) {
-        case FG_INT:
-        {
-            val = _out_message[i].offset +
-                  _out_message[i].prop->getIntValue() * _out_message[i].factor;
-            int32_t intVal = val;
-            if (binary_byte_order != BYTE_ORDER_MATCHES_NETWORK_ORDER) {
-                intVal = (int32_t) sg_bswap_32((uint32_t)intVal);
-            }
-            memcpy(&buf[length], &intVal, sizeof(int32_t));
-            length += sizeof(int32_t);
+    size_t base = 0;    // end of the last string
+    size_t end = 0;
+    u32 tmpun32;
+    u64 tmpun64;
+
+    vector<_binary_op>::const_iterator it;
+    for (it = _out_plan.begin(); it != _out_plan.end(); ++it) {
+        char *p = &buf[base + it->pos];
+
+        switch (it->op) {
+        case OP_BOOL:
+            *p = (char) (it->prop->getBoolValue() ? true : false);
             break;
-        }
 
-        case FG_BOOL:
-            buf[length] = (char) (_out_message[i].prop->getBoolValue() ? true : false);
-            length += 1;
+        case OP_INT:
+            put32(p, (int32_t) (it->offset + it->prop->getIntValue() * it->factor));
             break;
 
-        case FG_FIXED:
-        {
-            val = _out_message[i].offset +
-                 _out_message[i].prop->getFloatValue() * _out_message[i].factor;
+        case OP_INT_SWAP:
+            put32(p, sg_bswap_32((int32_t) (it->offset + it->prop->getIntValue() * it->factor)));
+            break;
 
-            int32_t fixed = (int)(val * 65536.0f);
-            if (binary_byte_order != BYTE_ORDER_MATCHES_NETWORK_ORDER) {
-                fixed = (int32_t) sg_bswap_32((uint32_t)fixed);
-            } 
-            memcpy(&buf[length], &fixed, sizeof(int32_t));
-            length += sizeof(int32_t);
+        case OP_FIXED:
+            put32(p, (int32_t) ((it->offset + it->prop->getFloatValue() * it->factor) * 65536.0f));
             break;
-        }
 
-        case FG_FLOAT:
-        {
-            val = _out_message[i].offset +
-                 _out_message[i].prop->getFloatValue() * _out_message[i].factor;
-            u32 tmpun32;
-            tmpun32.floatVal = static_cast<float>(val);
+        case OP_FIXED_SWAP:
+            put32(p, sg_bswap_32((int32_t) ((it->offset + it->prop->getFloatValue() * it->factor) * 65536.0f)));
+            break;
 
-            if (binary_byte_order != BYTE_ORDER_MATCHES_NETWORK_ORDER) {
-                tmpun32.intVal = sg_bswap_32(tmpun32.intVal);
-            }
-            memcpy(&buf[length], &tmpun32.intVal, sizeof(uint32_t));
-            length += sizeof(uint32_t);
+        case OP_FLOAT:
+            tmpun32.floatVal = static_cast<float>(it->offset + it->prop->getFloatValue() * it->factor);
+            put32(p, tmpun32.intVal);
             break;
-        }
 
-        case FG_DOUBLE:
-        {
-            val = _out_message[i].offset +
-                 _out_message[i].prop->getDoubleValue() * _out_message[i].factor;
-            u64 tmpun64;
-            tmpun64.doubleVal = val;
+        case OP_FLOAT_SWAP:
+            tmpun32.floatVal = static_cast<float>(it->offset + it->prop->getFloatValue() * it->factor);
+            put32(p, sg_bswap_32(tmpun32.intVal));
+            break;
 
-            if (binary_byte_order != BYTE_ORDER_MATCHES_NETWORK_ORDER) {
-                tmpun64.longVal = sg_bswap_64(tmpun64.longVal);
-            }
-            memcpy(&buf[length], &tmpun64.longVal, sizeof(uint64_t));
-            length += sizeof(uint64_t);
+        case OP_DOUBLE:
+            tmpun64.doubleVal = it->offset + it->prop->getDoubleValue() * it->factor;
+            put64(p, tmpun64.longVal);
             break;
-        }
 
-        case FG_BYTE:
-        {
-            val = _out_message[i].offset +
-                  _out_message[i].prop->getIntValue() * _out_message[i].factor;
-            int8_t byteVal = val;
-            memcpy(&buf[length], &byteVal, sizeof(int8_t));
-            length += sizeof(int8_t);
+        case OP_DOUBLE_SWAP:
+            tmpun64.doubleVal = it->offset + it->prop->getDoubleValue() * it->factor;
+            put64(p, sg_bswap_64(tmpun64.longVal));
             break;
-        }
 
-        case FG_WORD:
-        {
-            val = _out_message[i].offset +
-                  _out_message[i].prop->getIntValue() * _out_message[i].factor;
-            int16_t wordVal = val;
-            memcpy(&buf[length], &wordVal, sizeof(int16_t));
-            length += sizeof(int16_t);
+        case OP_BYTE:
+            *p = (int8_t) (it->offset + it->prop->getIntValue() * it->factor);
             break;
-        }
 
-        default: // SG_STRING
-            const char *strdata = _out_message[i].prop->getStringValue();
-            int32_t strlength = strlen(strdata);
+        case OP_WORD:
+        case OP_WORD_SWAP: // words are written in host byte order
+            put16(p, (int16_t) (it->offset + it->prop->getIntValue() * it->factor));
+            break;
 
-            if (binary_byte_order == BYTE_ORDER_NEEDS_CONVERSION) {
-                SG_LOG( SG_IO, SG_ALERT, "Generic protocol: "
-                        "FG_STRING will be written in host byte order.");
-            }
-            /* Format for strings is 
+        case OP_STRING:
+        case OP_STRING_SWAP: {
+            /* Format for strings is
              * [length as int, 4 bytes][ASCII data, length bytes]
              */
-            if (binary_byte_order != BYTE_ORDER_MATCHES_NETWORK_ORDER) {
-                strlength = sg_bswap_32(strlength);
-            }
-            memcpy(&buf[length], &strlength, sizeof(int32_t));
-            length += sizeof(int32_t);
-            strncpy(&buf[length], strdata, strlength);
-            length += strlength; 
-            /* FIXME padding for alignment? Something like: 
+            const char *strdata = it->prop->getStringValue();
+            size_t room = FG_MAX_MSG_SIZE - (base + it->pos) - 2 * sizeof(int32_t);
+            uint32_t strlength = std::min(strlen(strdata), room);
+            put32(p, it->op == OP_STRING_SWAP ? sg_bswap_32(strlength) : strlength);
+            memcpy(p + sizeof(int32_t), strdata, strlength);
+            /* FIXME padding for alignment? Something like:
              * length += (strlength % 4 > 0 ? sizeof(int32_t) - strlength % 4 : 0;
              */
+            base += it->pos + sizeof(int32_t) + strlength;
             break;
-
         }
+        }
+
+        end = base + (it->size ? it->pos + it->size : 0);
     }
+    length = end;
 
     // add the footer to the packet ("line")
     switch (binary_footer_type) {
@@ -481,80 +595,73 @@ bool FGGeneric::gen_message() {
 }
 
 bool FGGeneric::parse_message_binary(int length) {
-    char *p2, *p1 = buf;
-    int32_t tmp32;
-    int i = -1;
+    u32 tmpun32;
+    u64 tmpun64;
 
-    p2 = p1 + length;
-    while ((++i < (int)_in_message.size()) && (p1  < p2)) {
+    vector<_binary_op>::const_iterator it;
+    for (it = _in_plan.begin(); it != _in_plan.end(); ++it) {
+        // input records have no strings, positions are absolute
+        if (it->pos + it->size > (size_t) length) {
+            break;
+        }
 
-        switch (_in_message[i].type) {
-        case FG_INT:
-            if (binary_byte_order == BYTE_ORDER_NEEDS_CONVERSION) {
-                tmp32 = sg_bswap_32(*(int32_t *)p1);
-            } else {
-                tmp32 = *(int32_t *)p1;
-            }
-            updateValue(_in_message[i], (int)tmp32);
-            p1 += sizeof(int32_t);
+        const char *p = &buf[it->pos];
+        _serial_prot &chunk = _in_message[it->chunk];
+
+        switch (it->op) {
+        case OP_INT:
+            updateValue(chunk, (int)(int32_t) get32(p));
             break;
 
-        case FG_BOOL:
-            updateValue(_in_message[i], p1[0] != 0);
-            p1 += 1;
+        case OP_INT_SWAP:
+            updateValue(chunk, (int)(int32_t) sg_bswap_32(get32(p)));
             break;
 
-        case FG_FIXED:
-            if (binary_byte_order == BYTE_ORDER_NEEDS_CONVERSION) {
-                tmp32 = sg_bswap_32(*(int32_t *)p1);
-            } else {
-                tmp32 = *(int32_t *)p1;
-            }
-            updateValue(_in_message[i], (float)tmp32 / 65536.0f);
-            p1 += sizeof(int32_t);
+        case OP_BOOL:
+            updateValue(chunk, p[0] != 0);
             break;
 
-        case FG_FLOAT:
-            u32 tmpun32;
-            if (binary_byte_order == BYTE_ORDER_NEEDS_CONVERSION) {
-                tmpun32.intVal = sg_bswap_32(*(uint32_t *)p1);
-            } else {
-                tmpun32.floatVal = *(float *)p1;
-            }
-            updateValue(_in_message[i], tmpun32.floatVal);
-            p1 += sizeof(int32_t);
+        case OP_FIXED:
+            updateValue(chunk, (float)(int32_t) get32(p) / 65536.0f);
             break;
 
-        case FG_DOUBLE:
-            u64 tmpun64;
-            if (binary_byte_order == BYTE_ORDER_NEEDS_CONVERSION) {
-                tmpun64.longVal = sg_bswap_64(*(uint64_t *)p1);
-            } else {
-                tmpun64.doubleVal = *(double *)p1;
-            }
-            updateValue(_in_message[i], tmpun64.doubleVal);
-            p1 += sizeof(int64_t);
+        case OP_FIXED_SWAP:
+            updateValue(chunk, (float)(int32_t) sg_bswap_32(get32(p)) / 65536.0f);
             break;
 
-        case FG_BYTE:
-            tmp32 = *(int8_t *)p1;
-            updateValue(_in_message[i], (int)tmp32);
-            p1 += sizeof(int8_t);
+        case OP_FLOAT:
+            tmpun32.intVal = get32(p);
+            updateValue(chunk, tmpun32.floatVal);
             break;
 
-        case FG_WORD:
-            if (binary_byte_order == BYTE_ORDER_NEEDS_CONVERSION) {
-                tmp32 = sg_bswap_16(*(int16_t *)p1);
-            } else {
-                tmp32 = *(int16_t *)p1;
-            }
-            updateValue(_in_message[i], (int)tmp32);
-            p1 += sizeof(int16_t);
+        case OP_FLOAT_SWAP:
+            tmpun32.intVal = sg_bswap_32(get32(p));
+            updateValue(chunk, tmpun32.floatVal);
             break;
 
-        default: // SG_STRING
-            SG_LOG( SG_IO, SG_ALERT, "Generic protocol: "
-                    "Ignoring unsupported binary input chunk type.");
+        case OP_DOUBLE:
+            tmpun64.longVal = get64(p);
+            updateValue(chunk, tmpun64.doubleVal);
+            break;
+
+        case OP_DOUBLE_SWAP:
+            tmpun64.longVal = sg_bswap_64(get64(p));
+            updateValue(chunk, tmpun64.doubleVal);
+            break;
+
+        case OP_BYTE:
+            updateValue(chunk, (int) *(const int8_t *)p);
+            break;
+
+        case OP_WORD:
+            updateValue(chunk, (int)(int16_t) get16(p));
+            break;
+
+        case OP_WORD_SWAP: // swapped words are read unsigned
+            updateValue(chunk, (int) sg_bswap_16(get16(p)));
+            break;
+
+        default: // strings are not compiled into input records
             break;
         }
     }
@@ -656,14 +763,58 @@ bool FGGeneric::open() {
         }
     }
 
+    if ( threaded && io->get_type() != sgFileType ) {
+        SG_LOG( SG_IO, SG_INFO, "Generic protocol: running I/O of "
+                << file_name << " on its own thread" );
+        bool input = ( get_direction() == SG_IO_IN ) ||
+                     ( get_direction() == SG_IO_BI );
+        io_thread = new FGGenericIOThread( io, input, binary_mode,
+                                           binary_record_length );
+        io_thread->start();
+    }
+
     return true;
 }
 
 
+// exchange the records of this frame with the I/O thread
+bool FGGeneric::process_threaded() {
+    if ( io_thread->failed() ) {
+        SG_LOG( SG_IO, SG_WARN, "Error writing data." );
+        return false;
+    }
+
+    if ( (get_direction() == SG_IO_OUT) ||
+         (get_direction() == SG_IO_BI) ) {
+        gen_message();
+        io_thread->send( buf, length );
+    }
+
+    if (( get_direction() == SG_IO_IN ) ||
+        (get_direction() == SG_IO_BI) ) {
+        std::string record;
+        while ( io_thread->receive( record ) ) {
+            length = std::min( record.size(), size_t(FG_MAX_MSG_SIZE - 1) );
+            memcpy( buf, record.data(), length );
+            buf[length] = 0;
+            parse_message_len( length );
+        }
+    }
+
+    return true;
+}
+
 // process work for this port
 bool FGGeneric::process() {
     SGIOChannel *io = get_io_channel();
 
+    if ( io_thread ) {
+        if ( process_threaded() ) {
+            return true;
+        }
+        goto error_out;
+    }
+
     if ( (get_direction() == SG_IO_OUT) ||
          (get_direction() == SG_IO_BI) ) {
         gen_message();
@@ -731,6 +882,12 @@ error_out:
 bool FGGeneric::close() {
     SGIOChannel *io = get_io_channel();
 
+    if ( io_thread ) {
+        io_thread->stop();
+        delete io_thread;
+        io_thread = NULL;
+    }
+
     if ( ((get_direction() == SG_IO_OUT)||
           (get_direction() == SG_IO_BI))
           && ! postamble.empty() ) {
@@ -778,6 +935,9 @@ FGGeneric::reinit()
                 // bad configuration
                 return;
             }
+            if (binary_mode) {
+                compile_binary(_out_message, _out_plan, false);
+            }
         }
     } else if (direction == "in") {
         SGPropertyNode *input = root.getNode("generic/input");
@@ -788,6 +948,9 @@ FGGeneric::reinit()
                 // bad configuration
                 return;
             }
+            if (binary_mode) {
+                compile_binary(_in_message, _in_plan, true);
+            }
             if (!binary_mode && (line_separator.empty() ||
                 *line_separator.rbegin() != '\n')) {
 
@@ -806,6 +969,8 @@ bool
 FGGeneric::read_config(SGPropertyNode *root, vector<_serial_prot> &msg)
 {
     binary_mode = root->getBoolValue("binary_mode");
+    threaded = root->getBoolValue("threaded",
+                                  fgGetBool("/sim/io/generic/threaded", false));
 
     if (!binary_mode) {
         /* These variables specified in the $FG_ROOT/data/Protocol/xxx.xml
@@ -990,6 +1155,74 @@ FGGeneric::read_config(SGPropertyNode *root, vector<_serial_prot> &msg)
     return true;
 }
 
+// Resolve the encoding, byte order and position of every chunk once, so
+// records are written and read without per-field configuration checks.
+void
+FGGeneric::compile_binary(const vector<_serial_prot> &msg,
+                          vector<_binary_op> &plan, bool input)
+{
+    bool swap = (binary_byte_order == BYTE_ORDER_NEEDS_CONVERSION);
+    size_t pos = 0;
+
+    plan.clear();
+    for (size_t i = 0; i < msg.size(); i++) {
+        _binary_op op;
+        op.prop = msg[i].prop;
+        op.offset = msg[i].offset;
+        op.factor = msg[i].factor;
+        op.pos = pos;
+        op.chunk = i;
+
+        switch (msg[i].type) {
+        case FG_BOOL:
+            op.op = OP_BOOL;
+            op.size = 1;
+            break;
+        case FG_INT:
+            op.op = swap ? OP_INT_SWAP : OP_INT;
+            op.size = sizeof(int32_t);
+            break;
+        case FG_FIXED:
+            op.op = swap ? OP_FIXED_SWAP : OP_FIXED;
+            op.size = sizeof(int32_t);
+            break;
+        case FG_FLOAT:
+            op.op = swap ? OP_FLOAT_SWAP : OP_FLOAT;
+            op.size = sizeof(int32_t);
+            break;
+        case FG_DOUBLE:
+            op.op = swap ? OP_DOUBLE_SWAP : OP_DOUBLE;
+            op.size = sizeof(int64_t);
+            break;
+        case FG_BYTE:
+            op.op = OP_BYTE;
+            op.size = sizeof(int8_t);
+            break;
+        case FG_WORD:
+            op.op = swap ? OP_WORD_SWAP : OP_WORD;
+            op.size = sizeof(int16_t);
+            break;
+        default: // FG_STRING
+            if (input) {
+                SG_LOG( SG_IO, SG_ALERT, "Generic protocol: "
+                        "Ignoring unsupported binary input chunk type.");
+                continue;
+            }
+            if (swap) {
+                SG_LOG( SG_IO, SG_ALERT, "Generic protocol: "
+                        "FG_STRING will be written in host byte order.");
+            }
+            op.op = swap ? OP_STRING_SWAP : OP_STRING;
+            op.size = 0;
+            break;
+        }
+
+        plan.push_back(op);
+        // positions after a string are relative to its end
+        pos = op.size ? pos + op.size : 0;
+    }
+}
+
 void FGGeneric::updateValue(FGGeneric::_serial_prot& prot, bool val)
 {
   if( prot.rel )
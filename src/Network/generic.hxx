@@ -73,6 +73,22 @@ protected:
         SGPropertyNode_ptr prop;
     } _serial_prot;
 
+    // binary chunk encodings, with the byte order resolved
+    enum e_binary_op { OP_BOOL=0, OP_INT, OP_INT_SWAP, OP_FIXED, OP_FIXED_SWAP,
+                       OP_FLOAT, OP_FLOAT_SWAP, OP_DOUBLE, OP_DOUBLE_SWAP,
+                       OP_BYTE, OP_WORD, OP_WORD_SWAP, OP_STRING, OP_STRING_SWAP };
+
+    // one step of a compiled binary record
+    typedef struct {
+        e_binary_op op;
+        SGPropertyNode *prop;   // held by the chunk
+        double offset;
+        double factor;
+        size_t pos;             // relative to the end of the preceding string
+        size_t size;            // 0 for strings
+        size_t chunk;           // index of the chunk in the message
+    } _binary_op;
+
 private:
 
     string file_name;
@@ -89,6 +105,8 @@ private:
     string line_sep_string;
     vector<_serial_prot> _out_message;
     vector<_serial_prot> _in_message;
+    vector<_binary_op> _out_plan;
+    vector<_binary_op> _in_plan;
 
     bool binary_mode;
     enum {FOOTER_NONE, FOOTER_LENGTH, FOOTER_MAGIC} binary_footer_type;
@@ -101,10 +119,15 @@ private:
     bool parse_message_ascii(int length);
     bool parse_message_binary(int length);
     bool read_config(SGPropertyNode *root, vector<_serial_prot> &msg);
+    void compile_binary(const vector<_serial_prot> &msg, vector<_binary_op> &plan,
+                        bool input);
+    bool process_threaded();
     bool exitOnError;
     bool initOk;
+    bool threaded;
 
     class FGProtocolWrapper * wrapper;
+    class FGGenericIOThread * io_thread;
     
     template<class T>
     static void updateValue(_serial_prot& prot, const T& val)
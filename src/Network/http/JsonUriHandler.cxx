@@ -28,6 +28,17 @@ using std::string;
 namespace flightgear {
 namespace http {
 
+// output per chunk; larger trees are sent over several frames
+const static size_t CHUNK_SIZE = 64 * 1024;
+const static string KEY("JsonUriHandler::JsonWriter");
+
+class JsonWriterData : public ConnectionData {
+public:
+  JsonWriterData(SGPropertyNode_ptr n, int depth, bool indent, double timestamp) :
+    writer(n, depth, indent, timestamp) {}
+  JSONWriter writer;
+};
+
 bool JsonUriHandler::handleRequest( const HTTPRequest & request, HTTPResponse & response, Connection * connection )
 {
   response.Header["Content-Type"] = "application/json; charset=UTF-8";
@@ -56,9 +67,13 @@ bool JsonUriHandler::handleRequest( const HTTPRequest & request, HTTPResponse &
       return true;
     } 
 
-    response.Content = JSON::toJsonString( indent, node, depth, timestamp ? fgGetDouble("/sim/time/elapsed-sec") : -1.0 );
+    SGSharedPtr<JsonWriterData> data = new JsonWriterData( node, depth, indent, timestamp ? fgGetDouble("/sim/time/elapsed-sec") : -1.0 );
+    if( data->writer.write( response.Content, connection ? CHUNK_SIZE : string::npos ) )
+      return true;
 
-    return true;
+    // send the first chunk now, the remainder thru poll
+    connection->put(KEY, data);
+    return false;
   }
 
   if( request.Method == "POST" ) {
@@ -88,6 +103,21 @@ bool JsonUriHandler::handleRequest( const HTTPRequest & request, HTTPResponse &
 
 }
 
+bool JsonUriHandler::poll( Connection * connection )
+{
+  SGSharedPtr<ConnectionData> data = connection->get(KEY);
+  JsonWriterData * writerData = dynamic_cast<JsonWriterData*>(data.get());
+  if ( NULL == writerData) return true; // Should not happen, kill the connection
+
+  string chunk;
+  bool done = writerData->writer.write( chunk, CHUNK_SIZE );
+  if( false == chunk.empty() )
+    connection->write( chunk.data(), chunk.size() );
+
+  if( done ) connection->remove(KEY);
+  return done;
+}
+
 SGPropertyNode_ptr JsonUriHandler::getRequestedNode(const HTTPRequest & request)
 {
   SG_LOG(SG_NETWORK,SG_INFO, "JsonUriHandler: request is '" << request.Uri << "'" );
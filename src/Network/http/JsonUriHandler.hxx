@@ -31,6 +31,7 @@ class JsonUriHandler : public URIHandler {
 public:
   JsonUriHandler( const char * uri = "/json/" ) : URIHandler( uri  ) {}
   virtual bool handleRequest( const HTTPRequest & request, HTTPResponse & response, Connection * connection );
+  virtual bool poll( Connection * connection );
 private:
   SGPropertyNode_ptr getRequestedNode(const HTTPRequest & request);
 };
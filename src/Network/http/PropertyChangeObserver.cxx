@@ -20,12 +20,74 @@
 
 #include "PropertyChangeObserver.hxx"
 
+#include <algorithm>
+
 #include <Main/fg_props.hxx>
 using std::string;
 namespace flightgear {
 namespace http {
 
+static bool isNumericType(simgear::props::Type type)
+{
+  switch (type) {
+  case simgear::props::BOOL:
+  case simgear::props::INT:
+  case simgear::props::LONG:
+  case simgear::props::FLOAT:
+  case simgear::props::DOUBLE:
+    return true;
+  default:
+    return false;
+  }
+}
+
+PropertyChangeObserverEntry::PropertyChangeObserverEntry(PropertyChangeObserver * observer, SGPropertyNode * node)
+    : _observer(observer), _node(node), _clients(0), _queued(false), _polling(isPolled()),
+    _isNumber(false), _prevNumber(0.0)
+{
+  update();
+  if (!_polling)
+    _node->addChangeListener(this);
+}
+
+PropertyChangeObserverEntry::~PropertyChangeObserverEntry()
+{
+  if (!_polling)
+    _node->removeChangeListener(this);
+}
+
+void PropertyChangeObserverEntry::valueChanged(SGPropertyNode * node)
+{
+  // listeners see the changes of all descendants, only our own value counts
+  if (node != _node || _queued || (0 == _clients))
+    return;
+
+  _queued = true;
+  _observer->_queued.push_back(this);
+}
+
+bool PropertyChangeObserverEntry::update()
+{
+  if (isNumericType(_node->getType())) {
+    double value = _node->getDoubleValue();
+    // NaN compares unequal to itself, but hasn't changed
+    if (_isNumber && ((value == _prevNumber) || ((value != value) && (_prevNumber != _prevNumber))))
+      return false;
+
+    _isNumber = true;
+    _prevNumber = value;
+    _prevString.clear();
+    return true;
+  }
+
+  const char * value = _node->getStringValue();
+  if (!_isNumber && (_prevString == value))
+    return false;
 
+  _isNumber = false;
+  _prevString = value;
+  return true;
+}
 
 PropertyChangeObserver::PropertyChangeObserver()
 {
@@ -33,72 +95,98 @@ PropertyChangeObserver::PropertyChangeObserver()
 
 PropertyChangeObserver::~PropertyChangeObserver()
 {
-  //
+  clear();
 }
 
 void PropertyChangeObserver::check()
 {
+  _changedNodes.clear();
+
+  for (Entries_t::iterator it = _queued.begin(); it != _queued.end(); ++it) {
+    (*it)->_queued = false;
+    if (((*it)->_clients > 0) && (*it)->update())
+      _changedNodes.push_back((*it)->_node.get());
+  }
+  _queued.clear();
 
-  for (Entries_t::iterator it = _entries.begin(); it != _entries.end(); ++it) {
-    if (false == (*it)->_node.isShared()) {
-      // node is no longer used but by us - remove the entry
-      it = _entries.erase(it);
+  // a tied node never notifies its listeners, poll it from now on
+  for (size_t i = 0; i < _listening.size(); ) {
+    PropertyChangeObserverEntryRef entry = _listening[i];
+    if (!entry->isPolled()) {
+      ++i;
       continue;
     }
 
-    if( false == (*it)->_changed ) {
-      (*it)->_changed = (*it)->_prevValue != (*it)->_node->getStringValue();
-      if ((*it)->_changed)
-        (*it)->_prevValue = (*it)->_node->getStringValue();
+    entry->_node->removeChangeListener(entry.get());
+    entry->_polling = true;
+    _polled.push_back(entry);
+    _listening[i] = _listening.back();
+    _listening.pop_back();
+  }
 
-    }
+  for (Entries_t::iterator it = _polled.begin(); it != _polled.end(); ++it) {
+    if ((*it)->update())
+      _changedNodes.push_back((*it)->_node.get());
   }
 }
 
 void PropertyChangeObserver::uncheck()
 {
-  for (Entries_t::iterator it = _entries.begin(); it != _entries.end(); ++it) {
-    (*it)->_changed = false;
-  }
+  _changedNodes.clear();
 }
 
-const SGPropertyNode_ptr PropertyChangeObserver::addObservation( const string propertyName)
+void PropertyChangeObserver::clear()
 {
-  for (Entries_t::iterator it = _entries.begin(); it != _entries.end(); ++it) {
-    if (propertyName == (*it)->_node->getPath(true) ) {
-      // if a new observer is added to a property, mark it as changed to ensure the observer
-      // gets notified on initial call. This also causes a notification for all other observers of this
-      // property.
-      (*it)->_changed = true;
-      return (*it)->_node;
-    }
-  }
+  _changedNodes.clear();
+  _queued.clear();
+  _polled.clear();
+  _listening.clear();
+  _entries.clear();
+}
 
+const SGPropertyNode_ptr PropertyChangeObserver::addObservation( const string propertyName)
+{
+  SGPropertyNode_ptr node;
   try {
-    PropertyChangeObserverEntryRef entry = new PropertyChangeObserverEntry();
-    entry->_node = fgGetNode( propertyName, true );
-    _entries.push_back( entry );
-    return entry->_node;
+    node = fgGetNode( propertyName, true );
   }
   catch( string & s ) {
     SG_LOG(SG_NETWORK,SG_WARN,"httpd: can't observer '" << propertyName << "'. Invalid name." );
   }
 
-  SGPropertyNode_ptr empty;
-  return empty;
+  if (!node.valid())
+    return node;
+
+  EntryMap::iterator it = _entries.find(node.get());
+  if (it == _entries.end()) {
+    PropertyChangeObserverEntryRef entry = new PropertyChangeObserverEntry(this, node);
+    it = _entries.insert(std::make_pair(node.get(), entry)).first;
+    if (entry->_polling)
+      _polled.push_back(entry);
+    else
+      _listening.push_back(entry);
+  }
+
+  ++it->second->_clients;
+  return node;
 }
 
-bool PropertyChangeObserver::isChangedValue(const SGPropertyNode_ptr node)
+void PropertyChangeObserver::removeObservation(SGPropertyNode * node)
 {
-  for (Entries_t::iterator it = _entries.begin(); it != _entries.end(); ++it) {
-    PropertyChangeObserverEntryRef entry = *it;
-
-    if( entry->_node == node && entry->_changed ) {
-      return true;
-    }
-  }
-
-  return false;
+  EntryMap::iterator it = _entries.find(node);
+  if (it == _entries.end())
+    return;
+
+  PropertyChangeObserverEntryRef entry = it->second;
+  if (--entry->_clients > 0)
+    return;
+
+  _entries.erase(it);
+  Entries_t& list = entry->_polling ? _polled : _listening;
+  Entries_t::iterator p = std::find(list.begin(), list.end(), entry);
+  if (p != list.end())
+    list.erase(p);
+  // a queued entry is skipped by check(), and released with the queue
 }
 
 }  // namespace http
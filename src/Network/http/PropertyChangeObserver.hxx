@@ -25,38 +25,79 @@
 #include <string>
 #include <vector>
 
+#include <boost/unordered_map.hpp>
+
 namespace flightgear {
 namespace http {
 
-struct PropertyChangeObserverEntry : public SGReferenced {
-  PropertyChangeObserverEntry()
-      : _changed(true)
-  {
-  }
+class PropertyChangeObserver;
+
+/**
+ * An observed node. Changes are reported by a change listener; tied and
+ * aliased nodes don't notify listeners and get polled instead, also when
+ * they get tied or aliased after the observation started. The last
+ * value is kept typed, so numeric nodes are compared without string
+ * conversions.
+ */
+class PropertyChangeObserverEntry : public SGReferenced, public SGPropertyChangeListener {
+public:
+  PropertyChangeObserverEntry(PropertyChangeObserver * observer, SGPropertyNode * node);
+  virtual ~PropertyChangeObserverEntry();
+
+  virtual void valueChanged(SGPropertyNode * node);
+
+  /// compare against the last value, returns true (and stores it) if it changed
+  bool update();
+
+  bool isPolled() const { return _node->isTied() || _node->isAlias(); }
+
+  PropertyChangeObserver * _observer;
   SGPropertyNode_ptr _node;
-  std::string _prevValue;
-  bool _changed;
+  unsigned _clients;
+  bool _queued;
+  bool _polling;  ///< in the observer's polled list, no listener
+  bool _isNumber;
+  double _prevNumber;
+  std::string _prevString;
 };
 
 typedef SGSharedPtr<PropertyChangeObserverEntry> PropertyChangeObserverEntryRef;
 
 class PropertyChangeObserver {
 public:
+  typedef std::vector<SGPropertyNode*> NodeList;
+
   PropertyChangeObserver();
   virtual ~PropertyChangeObserver();
 
+  /**
+   * start observing a property, or add a client to an existing observation.
+   * Returns an invalid pointer if the name is invalid.
+   */
   const SGPropertyNode_ptr addObservation( const std::string propertyName);
-  bool isChangedValue(const SGPropertyNode_ptr node);
+
+  /// drop a client of an observation, the last one removes it
+  void removeObservation(SGPropertyNode * node);
+
+  /// the nodes whose value changed since the previous check()
+  const NodeList& getChangedNodes() const { return _changedNodes; }
 
   void check();
   void uncheck();
 
-  void clear() { _entries.clear(); }
+  void clear();
 
 private:
+  friend class PropertyChangeObserverEntry;
+
+  typedef boost::unordered_map<SGPropertyNode*, PropertyChangeObserverEntryRef> EntryMap;
   typedef std::vector<PropertyChangeObserverEntryRef> Entries_t;
-  Entries_t _entries;
 
+  EntryMap _entries;
+  Entries_t _queued;  ///< notified by their listener since the last check
+  Entries_t _polled;  ///< tied or aliased, compared on every check
+  Entries_t _listening;  ///< the others, checked for getting tied
+  NodeList _changedNodes;
 };
 }  // namespace http
 }  // namespace flightgear
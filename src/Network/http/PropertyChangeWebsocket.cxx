@@ -32,6 +32,10 @@
 
 #include <3rdparty/cjson/cJSON.h>
 
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
 namespace flightgear {
 namespace http {
 
@@ -118,7 +122,10 @@ static void handleExecCommand(cJSON* json)
 }
   
 PropertyChangeWebsocket::PropertyChangeWebsocket(PropertyChangeObserver * propertyChangeObserver)
-    : id(++nextid), _propertyChangeObserver(propertyChangeObserver)
+    : id(++nextid), _propertyChangeObserver(propertyChangeObserver),
+    _minInterval(fgGetDouble("/sim/http/websocket/min-interval-sec", 0.0)),
+    _deadband(fgGetDouble("/sim/http/websocket/deadband", 0.0)),
+    _batch(fgGetBool("/sim/http/websocket/batch", false))
 {
 }
 
@@ -129,7 +136,12 @@ PropertyChangeWebsocket::~PropertyChangeWebsocket()
 void PropertyChangeWebsocket::close()
 {
   SG_LOG(SG_NETWORK, SG_INFO, "closing PropertyChangeWebsocket #" << id);
+  for (WatchedNodeMap::iterator it = _watchedNodes.begin(); it != _watchedNodes.end(); ++it) {
+    _propertyChangeObserver->removeObservation(it->first);
+  }
   _watchedNodes.clear();
+  _pendingNodes.clear();
+  _heldNodes.clear();
 }
 
 void PropertyChangeWebsocket::handleGetCommand(const string_list& nodes, WebsocketWriter &writer)
@@ -146,6 +158,27 @@ void PropertyChangeWebsocket::handleGetCommand(const string_list& nodes, Websock
     writer.writeText( JSON::toJsonString( false, n, 0, t ) );
   } // of nodes iteration
 }
+
+void PropertyChangeWebsocket::handleConfigureCommand(cJSON * json)
+{
+  cJSON * j = cJSON_GetObjectItem(json, "min-interval");
+  if ( NULL != j && cJSON_Number == j->type ) {
+    _minInterval = j->valuedouble;
+  }
+
+  j = cJSON_GetObjectItem(json, "deadband");
+  if ( NULL != j && cJSON_Number == j->type ) {
+    _deadband = j->valuedouble;
+  }
+
+  j = cJSON_GetObjectItem(json, "batch");
+  if ( NULL != j && (cJSON_True == j->type || cJSON_False == j->type) ) {
+    _batch = (cJSON_True == j->type);
+  }
+
+  SG_LOG(SG_NETWORK, SG_INFO, "httpd: PropertyChangeWebsocket #" << id << " min-interval " << _minInterval
+         << " deadband " << _deadband << " batch " << _batch);
+}
   
 void PropertyChangeWebsocket::handleRequest(const HTTPRequest & request, WebsocketWriter &writer)
 {
@@ -161,6 +194,13 @@ void PropertyChangeWebsocket::handleRequest(const HTTPRequest & request, Websock
    ],
    node: '/bax/foo'
    }
+   or, for the update rate of this websocket
+   {
+   command : 'configure',
+   'min-interval' : 0.1,
+   deadband : 0.01,
+   batch : true
+   }
    */
   cJSON * json = cJSON_Parse(request.Content.c_str());
   if ( NULL != json) {
@@ -193,10 +233,12 @@ void PropertyChangeWebsocket::handleRequest(const HTTPRequest & request, Websock
       handleSetCommand(nodeNames, json, writer);
     } else if (command == "exec") {
       handleExecCommand(json);
+    } else if (command == "configure") {
+      handleConfigureCommand(json);
     } else {
       string_list::const_iterator it;
       for (it = nodeNames.begin(); it != nodeNames.end(); ++it) {
-        _watchedNodes.handleCommand(command, *it, _propertyChangeObserver);
+        handleListenerCommand(command, *it);
       }
     }
     
@@ -206,39 +248,115 @@ void PropertyChangeWebsocket::handleRequest(const HTTPRequest & request, Websock
 
 void PropertyChangeWebsocket::poll(WebsocketWriter & writer)
 {
-  for (WatchedNodesList::iterator it = _watchedNodes.begin(); it != _watchedNodes.end(); ++it) {
-    SGPropertyNode_ptr node = *it;
+  // collect the changes of this frame, they are sent with the next batch
+  const PropertyChangeObserver::NodeList& changed = _propertyChangeObserver->getChangedNodes();
+  for (PropertyChangeObserver::NodeList::const_iterator it = changed.begin(); it != changed.end(); ++it) {
+    WatchedNodeMap::iterator w = _watchedNodes.find(*it);
+    if (w != _watchedNodes.end() && !w->second._pending) {
+      w->second._pending = true;
+      _pendingNodes.push_back(*it);
+    }
+  }
+
+  // values held back by the deadband which did not change this frame have
+  // settled; send them as they are, or the last small step would be lost
+  for (std::vector<SGPropertyNode*>::iterator it = _heldNodes.begin(); it != _heldNodes.end(); ++it) {
+    WatchedNodeMap::iterator w = _watchedNodes.find(*it);
+    if (w == _watchedNodes.end() || w->second._pending) continue;
+
+    w->second._flush = true;
+    w->second._pending = true;
+    _pendingNodes.push_back(*it);
+  }
+  _heldNodes.clear();
+
+  if (_pendingNodes.empty()) return;
+  if (_minInterval > 0.0 && _lastSent.elapsedMSec() < _minInterval * 1000.0) return;
+
+  double t = fgGetDouble("/sim/time/elapsed-sec");
+  cJSON * batch = _batch ? cJSON_CreateArray() : NULL;
+  for (std::vector<SGPropertyNode*>::iterator it = _pendingNodes.begin(); it != _pendingNodes.end(); ++it) {
+    WatchedNodeMap::iterator w = _watchedNodes.find(*it);
+    if (w == _watchedNodes.end()) continue; // removed meanwhile
 
-    string newValue;
-    if (_propertyChangeObserver->isChangedValue(node)) {
-      string out = JSON::toJsonString( false, node, 0, fgGetDouble("/sim/time/elapsed-sec") );
-      SG_LOG(SG_NETWORK, SG_DEBUG, "PropertyChangeWebsocket::poll() new Value for " << node->getPath(true) << " '" << node->getStringValue() << "' #" << id << ": " << out );
-      writer.writeText( out );
+    w->second._pending = false;
+    if (w->second._flush) {
+      w->second._flush = false;
+      w->second.needsUpdate(0.0);
+    } else if (!w->second.needsUpdate(_deadband)) {
+      _heldNodes.push_back(*it);
+      continue;
     }
+
+    SG_LOG(SG_NETWORK, SG_DEBUG, "PropertyChangeWebsocket::poll() new Value for " << (*it)->getPath(true) << " '" << (*it)->getStringValue() << "' #" << id);
+    if (batch) {
+      cJSON_AddItemToArray(batch, JSON::toJson(w->second._node, 0, t));
+    } else {
+      writer.writeText( JSON::toJsonString( false, w->second._node, 0, t ) );
+    }
+  }
+  _pendingNodes.clear();
+  _lastSent.stamp();
+
+  if (batch) {
+    if (cJSON_GetArraySize(batch) > 0) {
+      char * out = cJSON_PrintUnformatted(batch);
+      writer.writeText(out, strlen(out));
+      free(out);
+    }
+    cJSON_Delete(batch);
+  }
+}
+
+bool PropertyChangeWebsocket::WatchedNode::needsUpdate(double deadband)
+{
+  simgear::props::Type type = _node->getType();
+  if (type != simgear::props::FLOAT && type != simgear::props::DOUBLE) {
+    _sent = false;
+    return true;
   }
+
+  double value = _node->getDoubleValue();
+  if (_sent && deadband > 0.0 && fabs(value - _sentValue) < deadband) return false;
+
+  _sent = true;
+  _sentValue = value;
+  return true;
 }
 
-void PropertyChangeWebsocket::WatchedNodesList::handleCommand(const string & command, const string & node,
-    PropertyChangeObserver * propertyChangeObserver)
+void PropertyChangeWebsocket::handleListenerCommand(const string & command, const string & node)
 {
   if (command == "addListener") {
-    for (iterator it = begin(); it != end(); ++it) {
-      if (node == (*it)->getPath(true)) {
-        SG_LOG(SG_NETWORK, SG_WARN, "httpd: " << command << " '" << node << "' ignored (duplicate)");
-        return; // dupliate
-      }
+    SGPropertyNode_ptr n = _propertyChangeObserver->addObservation(node);
+    if (!n.valid()) return;
+
+    if (_watchedNodes.find(n.get()) != _watchedNodes.end()) {
+      _propertyChangeObserver->removeObservation(n.get());
+      SG_LOG(SG_NETWORK, SG_WARN, "httpd: " << command << " '" << node << "' ignored (duplicate)");
+      return; // dupliate
     }
-    SGPropertyNode_ptr n = propertyChangeObserver->addObservation(node);
-    if (n.valid()) push_back(n);
+
+    // send the current value with the next batch
+    WatchedNode& w = _watchedNodes[n.get()];
+    w._node = n;
+    w._pending = true;
+    _pendingNodes.push_back(n.get());
     SG_LOG(SG_NETWORK, SG_INFO, "httpd: " << command << " '" << node << "' success");
 
   } else if (command == "removeListener") {
-    for (iterator it = begin(); it != end(); ++it) {
-      if (node == (*it)->getPath(true)) {
-        this->erase(it);
-        SG_LOG(SG_NETWORK, SG_INFO, "httpd: " << command << " '" << node << "' success");
-        return;
-      }
+    SGPropertyNode * n = NULL;
+    try {
+      n = fgGetNode(node);
+    }
+    catch( string & s ) {
+    }
+
+    WatchedNodeMap::iterator it = _watchedNodes.find(n);
+    if (n && it != _watchedNodes.end()) {
+      _watchedNodes.erase(it);
+      _propertyChangeObserver->removeObservation(n);
+      SG_LOG(SG_NETWORK, SG_INFO, "httpd: " << command << " '" << node << "' success");
+      return;
     }
     SG_LOG(SG_NETWORK, SG_WARN, "httpd: " << command << " '" << node << "' ignored (not found)");
   }
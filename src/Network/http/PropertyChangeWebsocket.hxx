@@ -23,14 +23,30 @@
 
 #include "Websocket.hxx"
 #include <simgear/props/props.hxx>
+#include <simgear/timing/timestamp.hxx>
 
 #include <vector>
 
+#include <boost/unordered_map.hpp>
+
+struct cJSON;
+
 namespace flightgear {
 namespace http {
 
 class PropertyChangeObserver;
 
+/**
+ * Streams the changes of the watched properties to the client. Changes are
+ * collected from the PropertyChangeObserver each frame and sent at most
+ * every min-interval seconds; floating point values which moved less than
+ * the deadband since they were last sent are held back, until they stop
+ * changing: then their current value is sent anyway. With batching
+ * enabled, all updates of an interval go out as one JSON array frame.
+ *
+ * Defaults come from /sim/http/websocket/{min-interval-sec,deadband,batch},
+ * clients may change them with the 'configure' command.
+ */
 class PropertyChangeWebsocket: public Websocket {
 public:
   PropertyChangeWebsocket(PropertyChangeObserver * propertyChangeObserver);
@@ -44,13 +60,31 @@ private:
   PropertyChangeObserver * _propertyChangeObserver;
 
   void handleGetCommand(const string_list& nodes, WebsocketWriter &writer);
-  
-  class WatchedNodesList: public std::vector<SGPropertyNode_ptr> {
-  public:
-    void handleCommand(const std::string & command, const std::string & node, PropertyChangeObserver * propertyChangeObserver);
+  void handleConfigureCommand(cJSON * json);
+  void handleListenerCommand(const std::string & command, const std::string & node);
+
+  struct WatchedNode {
+    WatchedNode() : _pending(false), _flush(false), _sent(false), _sentValue(0.0) {}
+
+    /// false if a floating point value is still within the deadband
+    bool needsUpdate(double deadband);
+
+    SGPropertyNode_ptr _node;
+    bool _pending;
+    bool _flush;    ///< held back and stopped changing, send regardless
+    bool _sent;
+    double _sentValue;
   };
 
-  WatchedNodesList _watchedNodes;
+  typedef boost::unordered_map<SGPropertyNode*, WatchedNode> WatchedNodeMap;
+  WatchedNodeMap _watchedNodes;
+  std::vector<SGPropertyNode*> _pendingNodes;
+  std::vector<SGPropertyNode*> _heldNodes;  ///< held back by the deadband
+
+  double _minInterval;
+  double _deadband;
+  bool _batch;
+  SGTimeStamp _lastSent;
 };
 
 }
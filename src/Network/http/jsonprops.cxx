@@ -21,6 +21,12 @@
 #include "jsonprops.hxx"
 #include <simgear/misc/strutils.hxx>
 #include <simgear/math/SGMath.hxx>
+
+#include <cfloat>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+
 namespace flightgear {
 namespace http {
 
@@ -108,6 +114,191 @@ cJSON * JSON::toJson(SGPropertyNode_ptr n, int depth, double timestamp )
   return json;
 }
 
+// number and string formatting as cJSON prints them
+static void appendNumber(string & out, double d)
+{
+  char buf[64];
+  if (d <= INT_MAX && d >= INT_MIN && fabs(static_cast<int>(d) - d) <= DBL_EPSILON)
+    sprintf(buf, "%d", static_cast<int>(d));
+  else if (fabs(floor(d) - d) <= DBL_EPSILON && fabs(d) < 1.0e60)
+    sprintf(buf, "%.0f", d);
+  else if (fabs(d) < 1.0e-6 || fabs(d) > 1.0e9)
+    sprintf(buf, "%e", d);
+  else
+    sprintf(buf, "%f", d);
+  out += buf;
+}
+
+static void appendString(string & out, const char * str)
+{
+  out += '"';
+  for (const char * p = str; *p; ++p) {
+    unsigned char c = *p;
+    if (c > 31 && c != '"' && c != '\\') {
+      out += c;
+      continue;
+    }
+
+    out += '\\';
+    switch (c) {
+      case '\\': out += '\\'; break;
+      case '"': out += '"'; break;
+      case '\b': out += 'b'; break;
+      case '\f': out += 'f'; break;
+      case '\n': out += 'n'; break;
+      case '\r': out += 'r'; break;
+      case '\t': out += 't'; break;
+      default: {
+        char buf[8];
+        sprintf(buf, "u%04x", c);
+        out += buf;
+      }
+    }
+  }
+  out += '"';
+}
+
+JSONWriter::JSONWriter(SGPropertyNode_ptr n, int depth, bool indent, double timestamp) :
+  _path(n->getPath(true)),
+  _indent(indent),
+  _timestamp(timestamp)
+{
+  Level level;
+  level.node = n;
+  level.depth = depth;
+  level.nextChild = -1;
+  level.pathLength = _path.size();
+  _stack.push_back(level);
+}
+
+bool JSONWriter::write(string & out, size_t maxBytes)
+{
+  size_t start = out.size();
+  while (!_stack.empty()) {
+    if (out.size() - start >= maxBytes)
+      return false;
+
+    Level & level = _stack.back();
+    if (level.nextChild < 0) {
+      writeNode(out, level);
+      level.nextChild = 0;
+      if (level.depth > 0 && level.node->nChildren() > 0) {
+        key(out, "children", false);
+        out += '[';
+      } else {
+        closeNode(out, level);
+        _stack.pop_back();
+      }
+      continue;
+    }
+
+    if (level.nextChild < level.node->nChildren()) {
+      if (level.nextChild > 0)
+        out += _indent ? ", " : ",";
+      pushChild(level.node->getChild(level.nextChild++), level);
+      continue;
+    }
+
+    out += ']';
+    closeNode(out, level);
+    _stack.pop_back();
+  }
+
+  return true;
+}
+
+void JSONWriter::pushChild(SGPropertyNode * child, const Level & parent)
+{
+  _path.resize(parent.pathLength);
+  _path += '/';
+  _path += child->getName();
+  if (child->getIndex() != 0) {
+    char buf[16];
+    sprintf(buf, "[%d]", child->getIndex());
+    _path += buf;
+  }
+
+  Level level;
+  level.node = child;
+  level.depth = parent.depth - 1;
+  level.nextChild = -1;
+  level.pathLength = _path.size();
+  _stack.push_back(level); // invalidates parent
+}
+
+void JSONWriter::key(string & out, const char * name, bool first)
+{
+  if (!first)
+    out += ',';
+  if (_indent) {
+    if (!first)
+      out += '\n';
+    out.append(2 * _stack.size() - 1, '\t');
+  }
+  out += '"';
+  out += name;
+  out += _indent ? "\":\t" : "\":";
+}
+
+void JSONWriter::writeNode(string & out, const Level & level)
+{
+  SGPropertyNode * n = level.node;
+  out += _indent ? "{\n" : "{";
+  key(out, "path", true);
+  appendString(out, _path.c_str());
+  key(out, "name", false);
+  appendString(out, n->getName());
+  if( n->hasValue() ) {
+    key(out, "value", false);
+    switch( n->getType() ) {
+      case simgear::props::BOOL:
+        out += n->getBoolValue() ? "true" : "false";
+        break;
+      case simgear::props::INT:
+      case simgear::props::LONG:
+      case simgear::props::FLOAT:
+      case simgear::props::DOUBLE: {
+        double val = n->getDoubleValue();
+        if (SGMiscd::isNaN(val))
+          out += "null";
+        else
+          appendNumber(out, val);
+        break;
+      }
+      default:
+        appendString(out, n->getStringValue());
+        break;
+    }
+  }
+  key(out, "type", false);
+  appendString(out, getPropertyTypeString(n->getType()));
+  key(out, "index", false);
+  appendNumber(out, n->getIndex());
+  if( _timestamp >= 0.0 ) {
+    key(out, "ts", false);
+    appendNumber(out, _timestamp);
+  }
+  key(out, "nChildren", false);
+  appendNumber(out, n->nChildren());
+}
+
+void JSONWriter::closeNode(string & out, const Level & level)
+{
+  if (_indent) {
+    out += '\n';
+    out.append(2 * (_stack.size() - 1), '\t');
+  }
+  out += '}';
+}
+
+string JSON::toJsonString(bool indent, SGPropertyNode_ptr n, int depth, double timestamp )
+{
+  string reply;
+  JSONWriter writer(n, depth, indent, timestamp);
+  writer.write(reply, string::npos);
+  return reply;
+}
+
 void JSON::toProp(cJSON * json, SGPropertyNode_ptr base)
 {
   if (NULL == json) return;
@@ -178,15 +369,6 @@ void JSON::addChildrenToProp(cJSON * json, SGPropertyNode_ptr n)
   }
 }
 
-string JSON::toJsonString(bool indent, SGPropertyNode_ptr n, int depth, double timestamp )
-{
-  cJSON * json = toJson( n, depth, timestamp );
-  char * jsonString = indent ? cJSON_Print( json ) : cJSON_PrintUnformatted( json );
-  string reply(jsonString);
-  free( jsonString );
-  cJSON_Delete( json );
-  return reply;
-}
 
 }  // namespace http
 }  // namespace flightgear
@@ -24,9 +24,48 @@
 #include <simgear/props/props.hxx>
 #include <3rdparty/cjson/cJSON.h>
 #include <string>
+#include <vector>
 
 namespace flightgear {
 namespace http {
+
+/**
+ * Writes a property subtree in the format of JSON::toJson straight into a
+ * string, without building a cJSON tree. Paths are extended while
+ * descending instead of calling getPath() for every node.
+ *
+ * Large trees can be written in slices, e.g. one chunk per frame; the
+ * subtree may change between slices.
+ */
+class JSONWriter {
+public:
+  JSONWriter(SGPropertyNode_ptr n, int depth, bool indent, double timestamp = -1.0);
+
+  /**
+   * append output until about maxBytes were added.
+   * @return true when the tree is complete
+   */
+  bool write(std::string & out, size_t maxBytes);
+
+private:
+  struct Level {
+    SGPropertyNode_ptr node;
+    int depth;          ///< remaining child levels
+    int nextChild;      ///< -1 while the node itself is not written
+    size_t pathLength;  ///< length of this node's path in _path
+  };
+
+  void writeNode(std::string & out, const Level & level);
+  void closeNode(std::string & out, const Level & level);
+  void pushChild(SGPropertyNode * child, const Level & parent);
+  void key(std::string & out, const char * name, bool first);
+
+  std::vector<Level> _stack;
+  std::string _path;
+  bool _indent;
+  double _timestamp;
+};
+
 class JSON {
 public:
   static cJSON * toJson(SGPropertyNode_ptr n, int depth, double timestamp = -1.0 );
@@ -35,9 +35,15 @@
 #include <simgear/props/props.hxx>
 #include <simgear/props/props_io.hxx>
 #include <simgear/structure/exception.hxx>
+#include <simgear/misc/stdint.hxx>
+#include <simgear/timing/timestamp.hxx>
 
 #include <sstream>
 #include <iostream>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <limits>
 #include <errno.h>
 
 #include <Main/globals.hxx>
@@ -61,6 +67,186 @@ using std::ends;
 using std::cout;
 using std::endl;
 
+/*
+ * Binary mode, entered with the 'binary' command. Messages in both
+ * directions are a header of
+ *   uint32 payload length, uint16 message type, uint16 reserved (0)
+ * followed by the payload. All values are in network byte order, strings
+ * are a uint16 length followed by the characters.
+ *
+ * client to server:
+ *   REGISTER       uint32 count, count x string path
+ *                  replaces the handle table; handles are the indices of
+ *                  the paths, relative paths start at the current directory
+ *   CONFIGURE      double rate (Hz, 0 for every poll), uint32 flags
+ *                  (FLAG_ON_CHANGE: only send frames when a value changed)
+ *   WRITE          uint32 count, count x (uint32 handle, double value)
+ *   WRITE_STRING   uint32 handle, string value
+ *
+ * server to client:
+ *   HANDLES        uint32 count, count x (uint32 handle, uint8 type)
+ *   FRAME          uint32 sequence, double sim time, uint32 count,
+ *                  count x double value, in handle order. String and
+ *                  invalid handles are NaN.
+ *   STRING         uint32 handle, string value; sent when the value of a
+ *                  string handle changes
+ *   ERROR          string message
+ *
+ * Frames are sent from the protocol's process(), so their rate is limited
+ * by the configured poll frequency of the server.
+ */
+namespace {
+
+enum BinaryMessageType {
+    BIN_REGISTER = 1,
+    BIN_CONFIGURE = 2,
+    BIN_WRITE = 3,
+    BIN_WRITE_STRING = 4,
+    BIN_HANDLES = 0x81,
+    BIN_FRAME = 0x82,
+    BIN_STRING = 0x83,
+    BIN_ERROR = 0xff
+};
+
+enum BinaryValueType {
+    BIN_TYPE_INVALID = 0,
+    BIN_TYPE_BOOL = 1,
+    BIN_TYPE_INT = 2,
+    BIN_TYPE_LONG = 3,
+    BIN_TYPE_FLOAT = 4,
+    BIN_TYPE_DOUBLE = 5,
+    BIN_TYPE_STRING = 6
+};
+
+const uint32_t BIN_FLAG_ON_CHANGE = 1;
+const size_t BIN_HEADER_SIZE = 8;
+const uint32_t BIN_MAX_PAYLOAD = 1024 * 1024;
+
+uint8_t binaryValueType(const SGPropertyNode* node)
+{
+    using namespace simgear;
+
+    if (!node) {
+        return BIN_TYPE_INVALID;
+    }
+
+    switch (node->getType()) {
+    case props::BOOL:   return BIN_TYPE_BOOL;
+    case props::INT:    return BIN_TYPE_INT;
+    case props::LONG:   return BIN_TYPE_LONG;
+    case props::FLOAT:  return BIN_TYPE_FLOAT;
+    case props::DOUBLE: return BIN_TYPE_DOUBLE;
+    default:            return BIN_TYPE_STRING;
+    }
+}
+
+class BinaryWriter
+{
+public:
+    BinaryWriter(uint16_t type) : _data(BIN_HEADER_SIZE, 0)
+    {
+        writeAt(4, type);
+    }
+
+    void u8(uint8_t v) { _data += static_cast<char>(v); }
+    void u16(uint16_t v) { append(v); }
+    void u32(uint32_t v) { append(v); }
+    void f64(double v)
+    {
+        uint64_t bits;
+        memcpy(&bits, &v, sizeof(bits));
+        append(bits);
+    }
+    void str(const std::string& v)
+    {
+        size_t len = std::min(v.size(), size_t(0xffff));
+        u16(len);
+        _data.append(v, 0, len);
+    }
+
+    /// the complete message, with the payload length filled in
+    const std::string& finish()
+    {
+        writeAt(0, uint32_t(_data.size() - BIN_HEADER_SIZE));
+        return _data;
+    }
+private:
+    template <class T>
+    void append(T v)
+    {
+        _data.append(sizeof(T), 0);
+        writeAt(_data.size() - sizeof(T), v);
+    }
+
+    void writeAt(size_t offset, uint16_t v)
+    {
+        if (sgIsLittleEndian()) v = sg_bswap_16(v);
+        memcpy(&_data[offset], &v, sizeof(v));
+    }
+    void writeAt(size_t offset, uint32_t v)
+    {
+        if (sgIsLittleEndian()) v = sg_bswap_32(v);
+        memcpy(&_data[offset], &v, sizeof(v));
+    }
+    void writeAt(size_t offset, uint64_t v)
+    {
+        if (sgIsLittleEndian()) v = sg_bswap_64(v);
+        memcpy(&_data[offset], &v, sizeof(v));
+    }
+
+    std::string _data;
+};
+
+class BinaryReader
+{
+public:
+    BinaryReader(const char* data, size_t len) :
+        _p(data), _end(data + len), _ok(true)
+    { }
+
+    bool ok() const { return _ok; }
+
+    uint16_t u16() { uint16_t v = 0; read(v); return sgIsLittleEndian() ? sg_bswap_16(v) : v; }
+    uint32_t u32() { uint32_t v = 0; read(v); return sgIsLittleEndian() ? sg_bswap_32(v) : v; }
+    double f64()
+    {
+        uint64_t bits = 0;
+        read(bits);
+        if (sgIsLittleEndian()) bits = sg_bswap_64(bits);
+        double v;
+        memcpy(&v, &bits, sizeof(v));
+        return v;
+    }
+    std::string str()
+    {
+        size_t len = u16();
+        if (!_ok || (_end - _p) < static_cast<ptrdiff_t>(len)) {
+            _ok = false;
+            return std::string();
+        }
+        std::string v(_p, len);
+        _p += len;
+        return v;
+    }
+private:
+    template <class T>
+    void read(T& v)
+    {
+        if (!_ok || (_end - _p) < static_cast<ptrdiff_t>(sizeof(T))) {
+            _ok = false;
+            return;
+        }
+        memcpy(&v, _p, sizeof(T));
+        _p += sizeof(T);
+    }
+
+    const char* _p;
+    const char* _end;
+    bool _ok;
+};
+
+} // anonymous namespace
+
 /**
  * Props connection class.
  * This class represents a connection to props client.
@@ -76,17 +262,31 @@ class PropsChannel : public simgear::NetChat, public SGPropertyChangeListener
 
     enum Mode {
         PROMPT,
-        DATA
+        DATA,
+        BINARY
     };
     Mode mode;
 
+    FGProps* server;
+
 public:
     /**
      * Constructor.
      */
-    PropsChannel();
+    PropsChannel( FGProps* server );
     ~PropsChannel();
 
+    /**
+     * Send the binary mode frames which are due, called by the server
+     * on every poll.
+     */
+    void update();
+
+    /**
+     * The server is going away.
+     */
+    void detach() { server = NULL; }
+
     /**
      * Append incoming data to our request buffer.
      *
@@ -131,15 +331,39 @@ private:
     // callback implementations:
     void subscribe(const ParameterList &p);
     void unsubscribe(const ParameterList &p);
+
+    // binary mode
+    void processBinaryInput();
+    void handleBinaryMessage( uint16_t type, BinaryReader& in );
+    void registerHandles( BinaryReader& in );
+    bool sendBinary( BinaryWriter& msg );
+    void binaryError( const std::string& msg );
+
+    std::string binaryInput;
+    std::vector<SGPropertyNode_ptr> handles;
+    std::vector<double> lastValues;       ///< as last sent, per handle
+    std::vector<std::string> lastStrings; ///< as last sent, per string handle
+    std::vector<double> frameValues;      ///< scratch, values of the frame being sent
+    SGPropertyNode_ptr simTimeNode;
+    double frameInterval;
+    bool onChangeOnly;
+    bool valuesSent;
+    uint32_t frameSequence;
+    SGTimeStamp lastFrame;
 };
 
 /**
  *
  */
-PropsChannel::PropsChannel()
+PropsChannel::PropsChannel( FGProps* server )
     : buffer(512),
       path("/"),
-      mode(PROMPT)
+      mode(PROMPT),
+      server(server),
+      frameInterval(0.0),
+      onChangeOnly(false),
+      valuesSent(false),
+      frameSequence(0)
 {
     setTerminator( "\r\n" );
     callback_map["subscribe"] 	= 	&PropsChannel::subscribe;
@@ -151,6 +375,10 @@ PropsChannel::~PropsChannel() {
     BOOST_FOREACH(SGPropertyNode_ptr l, _listeners) {
     l->removeChangeListener( this  );
  }
+
+    if (server) {
+        server->removeBinaryChannel( this );
+    }
 }
 
 void PropsChannel::subscribe(const ParameterList &param) {
@@ -206,9 +434,222 @@ void PropsChannel::unsubscribe(const ParameterList &param) {
 void
 PropsChannel::collectIncomingData( const char* s, int n )
 {
+    if (mode == BINARY) {
+        binaryInput.append( s, n );
+        processBinaryInput();
+        return;
+    }
+
     buffer.append( s, n );
 }
 
+/**
+ * Handle the complete binary messages received so far.
+ */
+void
+PropsChannel::processBinaryInput()
+{
+    size_t pos = 0;
+    while (binaryInput.size() - pos >= BIN_HEADER_SIZE) {
+        BinaryReader header( binaryInput.data() + pos, BIN_HEADER_SIZE );
+        uint32_t length = header.u32();
+        uint16_t type = header.u16();
+        if (length > BIN_MAX_PAYLOAD) {
+            binaryError( "message too long" );
+            binaryInput.clear();
+            close();
+            shouldDelete();
+            return;
+        }
+
+        if (binaryInput.size() - pos < BIN_HEADER_SIZE + length) {
+            break; // incomplete
+        }
+
+        BinaryReader in( binaryInput.data() + pos + BIN_HEADER_SIZE, length );
+        handleBinaryMessage( type, in );
+        pos += BIN_HEADER_SIZE + length;
+    }
+
+    binaryInput.erase( 0, pos );
+}
+
+void
+PropsChannel::handleBinaryMessage( uint16_t type, BinaryReader& in )
+{
+    switch (type) {
+    case BIN_REGISTER:
+        registerHandles( in );
+        break;
+
+    case BIN_CONFIGURE: {
+        double rate = in.f64();
+        uint32_t flags = in.u32();
+        if (!in.ok()) {
+            binaryError( "truncated configure message" );
+            return;
+        }
+        frameInterval = (rate > 0.0) ? 1.0 / rate : 0.0;
+        onChangeOnly = (flags & BIN_FLAG_ON_CHANGE) != 0;
+        break;
+    }
+
+    case BIN_WRITE: {
+        uint32_t count = in.u32();
+        for (uint32_t i = 0; in.ok() && (i < count); ++i) {
+            uint32_t handle = in.u32();
+            double value = in.f64();
+            if (in.ok() && (handle < handles.size()) && handles[handle]) {
+                handles[handle]->setDoubleValue( value );
+            }
+        }
+        if (!in.ok()) {
+            binaryError( "truncated write message" );
+        }
+        break;
+    }
+
+    case BIN_WRITE_STRING: {
+        uint32_t handle = in.u32();
+        std::string value = in.str();
+        if (!in.ok()) {
+            binaryError( "truncated write message" );
+        } else if ((handle < handles.size()) && handles[handle]) {
+            handles[handle]->setStringValue( value.c_str() );
+        }
+        break;
+    }
+
+    default: {
+        std::stringstream msg;
+        msg << "unknown message type " << type;
+        binaryError( msg.str() );
+    }
+    }
+}
+
+void
+PropsChannel::registerHandles( BinaryReader& in )
+{
+    SGPropertyNode* dir = globals->get_props()->getNode( path.c_str() );
+    if (!dir) {
+        dir = globals->get_props();
+    }
+
+    uint32_t count = in.u32();
+    std::vector<SGPropertyNode_ptr> nodes;
+    for (uint32_t i = 0; in.ok() && (i < count); ++i) {
+        std::string p = in.str();
+        if (!in.ok()) {
+            break;
+        }
+
+        SGPropertyNode* node = NULL;
+        try {
+            node = dir->getNode( p.c_str(), true );
+        } catch (const string&) {
+            // invalid path, the handle stays invalid
+        }
+        nodes.push_back( node );
+    }
+
+    if (!in.ok()) {
+        binaryError( "truncated register message" );
+        return;
+    }
+
+    handles.swap( nodes );
+    lastValues.assign( handles.size(), 0.0 );
+    lastStrings.assign( handles.size(), std::string() );
+    valuesSent = false;
+
+    BinaryWriter reply( BIN_HANDLES );
+    reply.u32( handles.size() );
+    for (uint32_t i = 0; i < handles.size(); ++i) {
+        reply.u32( i );
+        reply.u8( binaryValueType( handles[i] ) );
+    }
+    sendBinary( reply );
+}
+
+void
+PropsChannel::update()
+{
+    if (handles.empty()) {
+        return;
+    }
+
+    SGTimeStamp now = SGTimeStamp::now();
+    if (valuesSent && ((now - lastFrame).toSecs() < frameInterval)) {
+        return;
+    }
+
+    BinaryWriter frame( BIN_FRAME );
+    frame.u32( frameSequence );
+    frame.f64( simTimeNode->getDoubleValue() );
+    frame.u32( handles.size() );
+
+    // The last sent values are only updated once a message is accepted, so
+    // dropped changes are sent again with the next frame.
+    bool changed = !valuesSent;
+    frameValues.resize( handles.size() );
+    for (size_t i = 0; i < handles.size(); ++i) {
+        SGPropertyNode* node = handles[i];
+        uint8_t type = binaryValueType( node );
+        double value = std::numeric_limits<double>::quiet_NaN();
+        if (type == BIN_TYPE_STRING) {
+            const char* s = node->getStringValue();
+            if (!valuesSent || (lastStrings[i] != s)) {
+                BinaryWriter msg( BIN_STRING );
+                msg.u32( i );
+                msg.str( s );
+                if (sendBinary( msg )) {
+                    lastStrings[i] = s;
+                }
+            }
+        } else if (type != BIN_TYPE_INVALID) {
+            value = node->getDoubleValue();
+        }
+
+        // bitwise, so NaN compares equal to itself
+        if (memcmp( &value, &lastValues[i], sizeof(double) ) != 0) {
+            changed = true;
+        }
+        frameValues[i] = value;
+        frame.f64( value );
+    }
+
+    lastFrame = now;
+    if (changed || !onChangeOnly) {
+        if (!sendBinary( frame )) {
+            return;
+        }
+        lastValues.swap( frameValues );
+        valuesSent = true;
+        ++frameSequence;
+    }
+}
+
+bool
+PropsChannel::sendBinary( BinaryWriter& msg )
+{
+    const std::string& data = msg.finish();
+    if (!bufferSend( data.data(), data.size() )) {
+        SG_LOG( SG_NETWORK, SG_DEBUG, "props: binary client too slow, message dropped" );
+        return false;
+    }
+    return true;
+}
+
+void
+PropsChannel::binaryError( const std::string& msg )
+{
+    SG_LOG( SG_NETWORK, SG_WARN, "props: binary mode: " << msg );
+    BinaryWriter error( BIN_ERROR );
+    error.str( msg );
+    sendBinary( error );
+}
+
 // return a human readable form of the value "type"
 static string
 getValueTypeString( const SGPropertyNode *node )
@@ -480,6 +921,21 @@ PropsChannel::foundTerminator()
                 mode = DATA;
             } else if ( command == "prompt" ) {
                 mode = PROMPT;
+            } else if ( command == "binary" ) {
+                // the rest of the connection uses binary messages, text
+                // subscriptions would write into that stream
+                BOOST_FOREACH(SGPropertyNode_ptr l, _listeners) {
+                    l->removeChangeListener( this );
+                }
+                _listeners.clear();
+                push( "binary" );
+                push( getTerminator() );
+                mode = BINARY;
+                setTerminator( "" );
+                simTimeNode = globals->get_props()->getNode( "/sim/time/elapsed-sec", true );
+                if (server) {
+                    server->addBinaryChannel( this );
+                }
             } else if (callback_map.find(command) != callback_map.end() ) {
 		   TelnetCallback t = callback_map[ command ];
 		   if (t)
@@ -562,6 +1018,7 @@ PropsChannel::foundTerminator()
                 const char* msg = "\
 Valid commands are:\r\n\
 \r\n\
+binary             switch to the binary subscription protocol\r\n\
 cd <dir>           cd to a directory, '..' to move back\r\n\
 data               switch to raw data mode\r\n\
 dump               dump current state (in xml)\r\n\
@@ -636,6 +1093,9 @@ FGProps::FGProps( const vector<string>& tokens )
  */
 FGProps::~FGProps()
 {
+    BOOST_FOREACH(PropsChannel* channel, binaryChannels) {
+        channel->detach();
+    }
 }
 
 /**
@@ -696,9 +1156,25 @@ bool
 FGProps::process()
 {
     poller.poll();
+
+    BOOST_FOREACH(PropsChannel* channel, binaryChannels) {
+        channel->update();
+    }
     return true;
 }
 
+void
+FGProps::addBinaryChannel( PropsChannel* channel )
+{
+    binaryChannels.insert( channel );
+}
+
+void
+FGProps::removeBinaryChannel( PropsChannel* channel )
+{
+    binaryChannels.erase( channel );
+}
+
 /**
  *
  */
@@ -709,7 +1185,7 @@ FGProps::handleAccept()
     int handle = accept( &addr );
     SG_LOG( SG_IO, SG_INFO, "Props server accepted connection from "
             << addr.getHost() << ":" << addr.getPort() );
-    PropsChannel* channel = new PropsChannel();
+    PropsChannel* channel = new PropsChannel( this );
     channel->setHandle( handle );
     poller.addChannel( channel );
 }
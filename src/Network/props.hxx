@@ -27,6 +27,7 @@
 #define _FG_PROPS_HXX
 
 #include <simgear/compiler.h>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -34,6 +35,8 @@
 
 #include "protocol.hxx"
 
+class PropsChannel;
+
 /**
  * Property server class.
  * This class provides a telnet-like server for remote access to
@@ -50,6 +53,11 @@ private:
      */
     int port;
     simgear::NetChannelPoller poller;
+
+    /**
+     * Connections in binary mode, which send their frames from process().
+     */
+    std::set<PropsChannel*> binaryChannels;
 public:
     /**
      * Create a new TCP server.
@@ -83,6 +91,8 @@ public:
      */
     void handleAccept();
 
+    void addBinaryChannel( PropsChannel* channel );
+    void removeBinaryChannel( PropsChannel* channel );
 };
 
 #endif // _FG_PROPS_HXX
@@ -79,6 +79,14 @@ struct prop_type {
 	double d_Ls;       // d_Lsj[] accumulated
 	double d_L;        // d_Lj[] accumulated
 	double theta_e;    // theta_ej[] accumulated, total bending angle
+	// Working constants of adiff(), A_scat(), A_los() and lrprop(), set up
+	// by their initialising calls. These used to be function statics, which
+	// kept the model from running on more than one thread.
+	double wd1, xd1, A_fo, qk, aht, xht;
+	double ad, rr, etq, h0s;
+	double wls;
+	bool wlos, wscat;
+	double dmin, xae;
 };
 
 
@@ -267,7 +275,7 @@ double  adiff(double s, prop_type &prop)
 	 * distance s. It uses a convex combination of smooth earth
 	 * diffraction and knife-edge diffraction.
 	 */
-	static double wd1, xd1, A_fo, qk, aht, xht;
+	double &wd1 = prop.wd1, &xd1 = prop.xd1, &A_fo = prop.A_fo, &qk = prop.qk, &aht = prop.aht, &xht = prop.xht;
 	const double A = 151.03;      // dimensionles constant from [Alg 4.20]
 	const double D = 50e3;        // 50 km from [Alg 3.9], scale distance for \delta_h(s)
 	const double H = 16;          // 16 m  from [Alg 3.10]
@@ -362,7 +370,7 @@ double  adiff(double s, prop_type &prop)
 static
 double A_scat(double s, prop_type &prop)
 {
-	static double ad, rr, etq, h0s;
+	double &ad = prop.ad, &rr = prop.rr, &etq = prop.etq, &h0s = prop.h0s;
 
 	if (s == 0.0) {
 		// :23: Prepare initial scatter constants, page 10
@@ -450,7 +458,7 @@ double abq_alos(complex<double> r)
 static
 double A_los(double d, prop_type &prop)
 {
-	static double wls;
+	double &wls = prop.wls;
 
 	if (d == 0.0) {
 		// :18: prepare initial line-of-sight constants, page 8
@@ -501,8 +509,8 @@ double A_los(double d, prop_type &prop)
 static
 void lrprop(double d, prop_type &prop)
 {
-	static bool wlos, wscat;
-	static double dmin, xae;
+	bool &wlos = prop.wlos, &wscat = prop.wscat;
+	double &dmin = prop.dmin, &xae = prop.xae;
 	complex<double> prop_zgnd(prop.Z_g_real, prop.Z_g_imag);
 	double a0, a1, a2, a3, a4, a5, a6;
 	double d0, d1, d2, d3, d4, d5, d6;
@@ -747,6 +755,10 @@ struct propv_type {
 	int klim;    // climate indicator
 	// Output
 	double sgc;  // standard deviation of situation variability (confidence)
+	// Working constants of avar(), see prop_type
+	int kdv;
+	double dexa, de, vmd, vs0, sgl, sgtm, sgtp, sgtd, tgtd, gm, gp, cv1, cv2, yv1, yv2, yv3, csm1, csm2, ysm1, ysm2, ysm3, csp1, csp2, ysp1, ysp2, ysp3, csd1, zd, cfm1, cfm2, cfm3, cfp1, cfp2, cfp3;
+	bool no_location_variability, no_situation_variability;
 };
 
 
@@ -909,8 +921,8 @@ double curve(double const &c1, double const &c2, double const &x1, double const
 static
 double avar(double zzt, double zzl, double zzc, prop_type &prop, propv_type &propv)
 {
-	static int kdv;
-	static double dexa, de, vmd, vs0, sgl, sgtm, sgtp, sgtd, tgtd, gm, gp, cv1, cv2, yv1, yv2, yv3, csm1, csm2, ysm1, ysm2, ysm3, csp1, csp2, ysp1, ysp2, ysp3, csd1, zd, cfm1, cfm2, cfm3, cfp1, cfp2, cfp3;
+	int &kdv = propv.kdv;
+	double &dexa = propv.dexa, &de = propv.de, &vmd = propv.vmd, &vs0 = propv.vs0, &sgl = propv.sgl, &sgtm = propv.sgtm, &sgtp = propv.sgtp, &sgtd = propv.sgtd, &tgtd = propv.tgtd, &gm = propv.gm, &gp = propv.gp, &cv1 = propv.cv1, &cv2 = propv.cv2, &yv1 = propv.yv1, &yv2 = propv.yv2, &yv3 = propv.yv3, &csm1 = propv.csm1, &csm2 = propv.csm2, &ysm1 = propv.ysm1, &ysm2 = propv.ysm2, &ysm3 = propv.ysm3, &csp1 = propv.csp1, &csp2 = propv.csp2, &ysp1 = propv.ysp1, &ysp2 = propv.ysp2, &ysp3 = propv.ysp3, &csd1 = propv.csd1, &zd = propv.zd, &cfm1 = propv.cfm1, &cfm2 = propv.cfm2, &cfm3 = propv.cfm3, &cfp1 = propv.cfp1, &cfp2 = propv.cfp2, &cfp3 = propv.cfp3;
 
 	// :29: Climatic constants, page 15
 	// Indexes are:
@@ -948,7 +960,7 @@ double avar(double zzt, double zzl, double zzc, prop_type &prop, propv_type &pro
 	const double bfp2[7] = {    0.0,    0.31,     0.0,    0.19,    0.31,     0.0,    0.0};
 	const double bfp3[7] = {    0.0,    2.00,     0.0,    1.79,    2.00,     0.0,    0.0};
 	const double rt = 7.8, rl = 24.0;
-	static bool no_location_variability, no_situation_variability;
+	bool &no_location_variability = propv.no_location_variability, &no_situation_variability = propv.no_situation_variability;
 	double avarv, q, vs, zt, zl, zc;
 	double sgt, yr;
 	int temp_klim;
@@ -25,16 +25,368 @@
 #include <cmath>
 
 #include <stdlib.h>
+#include <string.h>
+#include <algorithm>
 #include <deque>
+#include <map>
+#include <memory>
+#include <set>
 #include "radio.hxx"
 #include <simgear/scene/material/mat.hxx>
+#include <simgear/sg_inlines.h>
+#include <simgear/threads/SGThread.hxx>
+#include <simgear/threads/SGGuard.hxx>
+#include <simgear/timing/timestamp.hxx>
 #include <Scenery/scenery.hxx>
-#include <boost/scoped_array.hpp>
+#include <Scenery/ElevationService.hxx>
 
 #define WITH_POINT_TO_POINT 1
 #include "itm.cpp"
 
 
+namespace {
+
+// transmitter and receiver positions are quantised to cells of about
+// 110 meters, close to the terrain sampling distance, antenna heights to
+// 10 meter bands and frequencies to 1 kHz
+const double POSITION_CELLS_PER_DEG = 1000.0;
+const double HEIGHT_BAND_M = 10.0;
+const double FREQUENCY_STEPS_PER_MHZ = 1000.0;
+
+// bound on the cached results, the cache is cleared when it is exceeded
+const size_t MAX_CACHED_RESULTS = 4096;
+
+int quantise(double value, double steps)
+{
+	return (int)floor(value * steps + 0.5);
+}
+
+} // anonymous namespace
+
+
+struct FGRadioTransmission::PropagationJob
+{
+	PropagationJob() :
+		transmitter_height(0.0), receiver_height(0.0), frq_mhz(0.0), pol(1),
+		use_clutter(false), reversed(false),
+		dbloss(0.0), clutter_loss(0.0), p_mode(0), errnum(0),
+		first_elevation(0.0), last_elevation(0.0), stamp(0.0) {}
+	
+	/// identifies a link: quantised positions, heights, frequency and mode
+	struct Key
+	{
+		Key() { memset(values, 0, sizeof(values)); }
+		Key(const SGGeod& tx_pos, const SGGeod& rx_pos, double tx_height, double rx_height,
+			double freq, int transmission_type, int pol, bool clutter)
+		{
+			values[0] = quantise(tx_pos.getLatitudeDeg(), POSITION_CELLS_PER_DEG);
+			values[1] = quantise(tx_pos.getLongitudeDeg(), POSITION_CELLS_PER_DEG);
+			values[2] = quantise(freq, FREQUENCY_STEPS_PER_MHZ);
+			values[3] = transmission_type;
+			values[4] = pol;
+			values[5] = clutter;
+			values[6] = quantise(rx_pos.getLatitudeDeg(), POSITION_CELLS_PER_DEG);
+			values[7] = quantise(rx_pos.getLongitudeDeg(), POSITION_CELLS_PER_DEG);
+			values[8] = quantise(tx_height, 1.0 / HEIGHT_BAND_M);
+			values[9] = quantise(rx_height, 1.0 / HEIGHT_BAND_M);
+		}
+		
+		/// the transmitter side of the key, shared by all receiver positions
+		Key transmitter() const
+		{
+			Key k;
+			std::copy(values, values + 6, k.values);
+			return k;
+		}
+		
+		bool operator<(const Key& other) const
+		{ return std::lexicographical_compare(values, values + 10, other.values, other.values + 10); }
+		
+		int values[10];
+	};
+	
+	Key key;
+	
+	// inputs
+	std::vector<double> itm_elev;	// terrain profile, in the layout expected by point_to_point
+	std::vector<string> materials;
+	double transmitter_height;
+	double receiver_height;
+	double frq_mhz;
+	int pol;
+	bool use_clutter;
+	bool reversed;	// sender and receiver roles are switched (pilot transmissions)
+	
+	// results
+	double dbloss;
+	double clutter_loss;
+	string strmode;
+	int p_mode;
+	int errnum;
+	double first_elevation;	// profile end points, the profile itself is not kept
+	double last_elevation;
+	double stamp;	// seconds, when the result was computed
+};
+
+
+/***	Runs the ITM model on worker threads, and caches the results per link.
+*	Callers are served the last result for a link while a fresh one is
+*	computed; only a link which was never seen before is computed
+*	synchronously. Finished jobs are collected on the main thread.
+***/
+class FGRadioTransmission::PropagationCache
+{
+public:
+	typedef PropagationJob::Key Key;
+	enum Lookup { MISS, STALE, FRESH };
+	
+	static PropagationCache* instance()
+	{
+		if (!static_cache) {
+			static_cache = new PropagationCache;
+		}
+		
+		return static_cache;
+	}
+	
+	/// stop and join the workers, pending jobs are dropped
+	static void shutdown()
+	{
+		delete static_cache;
+		static_cache = NULL;
+	}
+	
+	~PropagationCache()
+	{
+		{
+			SGGuard<SGMutex> g(_lock);
+			_stopping = true;
+			_jobAvailable.broadcast();
+		}
+		
+		for (unsigned int i = 0; i < _workers.size(); ++i) {
+			_workers[i]->join();
+			delete _workers[i];
+		}
+		
+		for (unsigned int i = 0; i < _jobs.size(); ++i) {
+			delete _jobs[i];
+		}
+		for (unsigned int i = 0; i < _done.size(); ++i) {
+			delete _done[i];
+		}
+	}
+	
+	/// move finished jobs into the cache and publish the statistics
+	void collect()
+	{
+		std::deque<PropagationJob*> done;
+		{
+			SGGuard<SGMutex> g(_lock);
+			done.swap(_done);
+		}
+		
+		for (unsigned int i = 0; i < done.size(); ++i) {
+			_pending.erase(done[i]->key);
+			store(*done[i]);
+			delete done[i];
+		}
+		
+		publishStats();
+	}
+	
+	Lookup find(const Key& key, PropagationJob& result)
+	{
+		double max_age = _rootNode->getDoubleValue("max-age-sec");
+		ResultMap::const_iterator it = _results.find(key);
+		if (it != _results.end()) {
+			result = it->second;
+			if ((now() - result.stamp) < max_age) {
+				++_freshHits;
+				return FRESH;
+			}
+			
+			++_staleHits;
+			return STALE;
+		}
+		
+		// the receiver (or an antenna) moved; the last result for this
+		// transmitter will do until the new one is ready
+		LatestMap::const_iterator latest = _latest.find(key.transmitter());
+		if (latest != _latest.end()) {
+			it = _results.find(latest->second);
+			if (it != _results.end()) {
+				result = it->second;
+				++_staleHits;
+				return STALE;
+			}
+		}
+		
+		++_misses;
+		return MISS;
+	}
+	
+	bool pending(const Key& key) const
+	{
+		return _pending.find(key) != _pending.end();
+	}
+	
+	/// queue a job for the workers, which take ownership of it
+	void submit(PropagationJob* job)
+	{
+		_pending.insert(job->key);
+		SGGuard<SGMutex> g(_lock);
+		_jobs.push_back(job);
+		_jobAvailable.signal();
+	}
+	
+	void store(PropagationJob& job)
+	{
+		if (_results.size() >= MAX_CACHED_RESULTS) {
+			SG_LOG(SG_GENERAL, SG_DEBUG, "radio propagation cache full, clearing");
+			clear();
+		}
+		
+		job.itm_elev.clear();
+		job.materials.clear();
+		job.stamp = now();
+		_results[job.key] = job;
+		_latest[job.key.transmitter()] = job.key;
+	}
+	
+	void clear()
+	{
+		_results.clear();
+		_latest.clear();
+	}
+	
+	/// wait until all submitted jobs are finished (and collected)
+	void drain()
+	{
+		{
+			SGGuard<SGMutex> g(_lock);
+			while (_busy > 0 || !_jobs.empty()) {
+				_jobFinished.wait(_lock);
+			}
+		}
+		
+		collect();
+	}
+private:
+	class Worker : public SGThread
+	{
+	public:
+		Worker(PropagationCache* cache) : _cache(cache) {}
+	protected:
+		virtual void run()
+		{
+			for (;;) {
+				PropagationJob* job = _cache->nextJob();
+				if (!job) {
+					return;
+				}
+				
+				SGTimeStamp st;
+				st.stamp();
+				run_propagation(*job);
+				_cache->finished(job, st.elapsedMSec());
+			}
+		}
+	private:
+		PropagationCache* _cache;
+	};
+	
+	PropagationCache() :
+		_stopping(false), _busy(0), _workerMSec(0.0), _computed(0),
+		_freshHits(0), _staleHits(0), _misses(0)
+	{
+		_rootNode = fgGetNode("/sim/radio/propagation", true);
+		if (_rootNode->getNode("threads", true)->getType() == simgear::props::NONE) {
+			_rootNode->setIntValue("threads", 2);
+		}
+		if (_rootNode->getNode("max-age-sec", true)->getType() == simgear::props::NONE) {
+			_rootNode->setDoubleValue("max-age-sec", 10.0);
+		}
+		
+		_statsNode = _rootNode->getNode("stats", true);
+		int threads = SG_MAX2(_rootNode->getIntValue("threads"), 1);
+		for (int i = 0; i < threads; ++i) {
+			Worker* w = new Worker(this);
+			w->start();
+			_workers.push_back(w);
+		}
+	}
+	
+	PropagationJob* nextJob()
+	{
+		SGGuard<SGMutex> g(_lock);
+		while (_jobs.empty() && !_stopping) {
+			_jobAvailable.wait(_lock);
+		}
+		
+		if (_stopping) {
+			return NULL;
+		}
+		
+		PropagationJob* job = _jobs.front();
+		_jobs.pop_front();
+		++_busy;
+		return job;
+	}
+	
+	void finished(PropagationJob* job, double msec)
+	{
+		SGGuard<SGMutex> g(_lock);
+		_done.push_back(job);
+		--_busy;
+		++_computed;
+		_workerMSec += msec;
+		_jobFinished.broadcast();
+	}
+	
+	void publishStats()
+	{
+		SGGuard<SGMutex> g(_lock);
+		_statsNode->setIntValue("queued", _jobs.size() + _busy);
+		_statsNode->setIntValue("computed", _computed);
+		_statsNode->setDoubleValue("worker-time-ms", _workerMSec);
+		_statsNode->setIntValue("fresh-hits", _freshHits);
+		_statsNode->setIntValue("stale-hits", _staleHits);
+		_statsNode->setIntValue("misses", _misses);
+		_statsNode->setIntValue("cached", _results.size());
+	}
+	
+	static double now()
+	{
+		return SGTimeStamp::now().toSecs();
+	}
+	
+	static PropagationCache* static_cache;
+	
+	typedef std::map<Key, PropagationJob> ResultMap;
+	typedef std::map<Key, Key> LatestMap;
+	
+	// main thread only
+	ResultMap _results;
+	LatestMap _latest;	// transmitter key to the last computed link
+	std::set<Key> _pending;
+	unsigned int _freshHits, _staleHits, _misses;
+	SGPropertyNode_ptr _rootNode, _statsNode;
+	std::vector<Worker*> _workers;
+	
+	// protected by _lock
+	SGMutex _lock;
+	SGWaitCondition _jobAvailable, _jobFinished;
+	std::deque<PropagationJob*> _jobs, _done;
+	bool _stopping;
+	unsigned int _busy;
+	double _workerMSec;
+	unsigned int _computed;
+};
+
+FGRadioTransmission::PropagationCache* FGRadioTransmission::PropagationCache::static_cache = NULL;
+
+
 FGRadioTransmission::FGRadioTransmission() {
 	
 	
@@ -61,6 +413,10 @@ FGRadioTransmission::FGRadioTransmission() {
 	_rx_line_losses = 2.0;	// to be configured for each station
 	_tx_line_losses = 2.0;
 	
+	// terrain profiles are sampled every 90 meters at most, don't bother
+	// being more precise than that
+	_elevation_caller = flightgear::ElevationService::instance()->registerCaller("radio-propagation", 90.0);
+	
 	_polarization = 1; // default vertical
 	
 	_propagation_model = 2; 
@@ -76,6 +432,11 @@ FGRadioTransmission::~FGRadioTransmission()
 }
 
 
+void FGRadioTransmission::shutdownPropagation() {
+	PropagationCache::shutdown();
+}
+
+
 double FGRadioTransmission::getFrequency(int radio) {
 	double freq = 118.0;
 	switch (radio) {
@@ -213,23 +574,10 @@ double FGRadioTransmission::ITM_calculate_attenuation(SGGeod pos, double freq, i
 	
 	if((freq < 40.0) || (freq > 20000.0))	// frequency out of recommended range 
 		return -1;
-	/** ITM default parameters 
-		TODO: take them from tile materials (especially for sea)?
-	**/
-	double eps_dielect=15.0;
-	double sgm_conductivity = 0.005;
-	double eno = 301.0;
-	double frq_mhz = freq;
 	
-	int radio_climate = 5;		// continental temperate
+	double frq_mhz = freq;
 	int pol= _polarization;	
-	double conf = 0.90;	// 90% of situations and time, take into account speed
-	double rel = 0.90;	
 	double dbloss;
-	char strmode[150];
-	int p_mode = 0; // propgation mode selector: 0 LOS, 1 diffraction dominant, 2 troposcatter
-	double horizons[2];
-	int errnum;
 	
 	double clutter_loss = 0.0; 	// loss due to vegetation and urban
 	double tx_pow = _transmitter_power;
@@ -242,7 +590,7 @@ double FGRadioTransmission::ITM_calculate_attenuation(SGGeod pos, double freq, i
 	double tx_erp = dbm_to_watt(tx_pow + _tx_antenna_gain - _tx_line_losses);
 	
 
-	FGScenery * scenery = globals->get_scenery();
+	flightgear::ElevationService* elevation_service = flightgear::ElevationService::instance();
 	
 	double own_lat = fgGetDouble("/position/latitude-deg");
 	double own_lon = fgGetDouble("/position/longitude-deg");
@@ -292,17 +640,14 @@ double FGRadioTransmission::ITM_calculate_attenuation(SGGeod pos, double freq, i
 	int max_points = (int)floor(distance_m / point_distance);
 	//double delta_last = fmod(distance_m, point_distance);
 	
-	deque<double> elevations;
-	deque<string*> materials;
-	
 
 	double elevation_under_pilot = 0.0;
-	if (scenery->get_elevation_m( max_own_pos, elevation_under_pilot, NULL )) {
+	if (elevation_service->getElevation( _elevation_caller, max_own_pos, elevation_under_pilot )) {
 		receiver_height = own_alt - elevation_under_pilot; 
 	}
 
 	double elevation_under_sender = 0.0;
-	if (scenery->get_elevation_m( max_sender_pos, elevation_under_sender, NULL )) {
+	if (elevation_service->getElevation( _elevation_caller, max_sender_pos, elevation_under_sender )) {
 		transmitter_height = sender_alt - elevation_under_sender;
 	}
 	else {
@@ -318,95 +663,96 @@ double FGRadioTransmission::ITM_calculate_attenuation(SGGeod pos, double freq, i
 	_root_node->setDoubleValue("station[0]/tx-height", transmitter_height);
 	_root_node->setDoubleValue("station[0]/distance", distance_m / 1000);
 	
-	unsigned int e_size = (deque<unsigned>::size_type)max_points;
-	
-	while (elevations.size() <= e_size) {
-		probe_distance += point_distance;
-		SGGeod probe = SGGeod::fromGeoc(center.advanceRadM( course, probe_distance ));
-		const simgear::BVHMaterial *material = 0;
-		double elevation_m = 0.0;
-	
-		if (scenery->get_elevation_m( probe, elevation_m, &material )) {
-                        const SGMaterial *mat;
-                        mat = dynamic_cast<const SGMaterial*>(material);
-			if((transmission_type == 3) || (transmission_type == 4)) {
-				elevations.push_back(elevation_m);
-				if(mat) {
-					const std::vector<string> mat_names = mat->get_names();
-					string* name = new string(mat_names[0]);
-					materials.push_back(name);
-				}
-				else {
-					string* no_material = new string("None"); 
-					materials.push_back(no_material);
+	PropagationCache* cache = PropagationCache::instance();
+	cache->collect();
+	
+	bool use_clutter = _root_node->getBoolValue( "use-clutter-attenuation", false );
+	PropagationCache::Key key(sender_pos, own_pos, transmitter_height, receiver_height,
+		frq_mhz, transmission_type, pol, use_clutter);
+	
+	PropagationJob result;
+	PropagationCache::Lookup lookup = cache->find(key, result);
+	if ((lookup != PropagationCache::FRESH) && !cache->pending(key)) {
+		// sample the terrain here, the scene graph is only available on the main thread
+		std::auto_ptr<PropagationJob> job(new PropagationJob);
+		job->key = key;
+		job->transmitter_height = transmitter_height;
+		job->receiver_height = receiver_height;
+		job->frq_mhz = frq_mhz;
+		job->pol = pol;
+		job->use_clutter = use_clutter;
+		job->reversed = (transmission_type == 3) || (transmission_type == 4);
+		
+		deque<double> elevations;
+		deque<string> materials;
+		
+		unsigned int e_size = (deque<unsigned>::size_type)max_points;
+		
+		// query the whole terrain profile at once
+		flightgear::ElevationService::QueryList profile;
+		profile.reserve(e_size + 1);
+		while (profile.size() <= e_size) {
+			probe_distance += point_distance;
+			SGGeod probe = SGGeod::fromGeoc(center.advanceRadM( course, probe_distance ));
+			profile.push_back(flightgear::ElevationService::Query(probe));
+		}
+		elevation_service->getElevations(_elevation_caller, profile);
+		
+		flightgear::ElevationService::QueryList::const_iterator it;
+		for (it = profile.begin(); it != profile.end(); ++it) {
+			double elevation_m = 0.0;
+			string name = "None";
+			if (it->valid) {
+				elevation_m = it->elevation;
+				const SGMaterial *mat = dynamic_cast<const SGMaterial*>(it->material);
+				if (mat) {
+					name = mat->get_names()[0];
 				}
 			}
+			
+			if (job->reversed) {
+				elevations.push_back(elevation_m);
+				materials.push_back(name);
+			}
 			else {
-				 elevations.push_front(elevation_m);
-				 if(mat) {
-				 	 const std::vector<string> mat_names = mat->get_names();
-				 	 string* name = new string(mat_names[0]);
-				 	 materials.push_front(name);
-				}
-				else {
-					string* no_material = new string("None"); 
-					materials.push_front(no_material);
-				}
+				elevations.push_front(elevation_m);
+				materials.push_front(name);
 			}
 		}
+		if (job->reversed) {
+			elevations.push_front(elevation_under_pilot);
+			//if (delta_last > (point_distance / 2) )			// only add last point if it's farther than half point_distance
+				elevations.push_back(elevation_under_sender);
+		}
 		else {
-			if((transmission_type == 3) || (transmission_type == 4)) {
-				elevations.push_back(0.0);
-				string* no_material = new string("None"); 
-				materials.push_back(no_material);
-			}
-			else {
-				string* no_material = new string("None"); 
-				elevations.push_front(0.0);
-				materials.push_front(no_material);
-			}
+			elevations.push_back(elevation_under_pilot);
+			//if (delta_last > (point_distance / 2) )
+				elevations.push_front(elevation_under_sender);
 		}
-	}
-	if((transmission_type == 3) || (transmission_type == 4)) {
-		elevations.push_front(elevation_under_pilot);
-		//if (delta_last > (point_distance / 2) )			// only add last point if it's farther than half point_distance
-			elevations.push_back(elevation_under_sender);
-	}
-	else {
-		elevations.push_back(elevation_under_pilot);
-		//if (delta_last > (point_distance / 2) )
-			elevations.push_front(elevation_under_sender);
-	}
-	
-	
-	double num_points= (double)elevations.size();
-
-
-	elevations.push_front(point_distance);
-	elevations.push_front(num_points -1);
+		
+		
+		double num_points= (double)elevations.size();
 
-	int size = elevations.size();
-        boost::scoped_array<double> itm_elev( new double[size] );
 
-	for(int i=0;i<size;i++) {
-		itm_elev[i]=elevations[i];
+		elevations.push_front(point_distance);
+		elevations.push_front(num_points -1);
+		
+		job->itm_elev.assign(elevations.begin(), elevations.end());
+		job->materials.assign(materials.begin(), materials.end());
+		
+		if (lookup == PropagationCache::MISS) {
+			// nothing to show for this link yet, don't make the caller wait
+			run_propagation(*job);
+			cache->store(*job);
+			result = *job;
+		}
+		else {
+			cache->submit(job.release());
+		}
 	}
 	
-	if((transmission_type == 3) || (transmission_type == 4)) {
-		// the sender and receiver roles are switched
-		ITM::point_to_point(itm_elev.get(), receiver_height, transmitter_height,
-			eps_dielect, sgm_conductivity, eno, frq_mhz, radio_climate,
-			pol, conf, rel, dbloss, strmode, p_mode, horizons, errnum);
-		if( _root_node->getBoolValue( "use-clutter-attenuation", false ) )
-			calculate_clutter_loss(frq_mhz, itm_elev.get(), materials, receiver_height, transmitter_height, p_mode, horizons, clutter_loss);
-	}
-	else {
-		ITM::point_to_point(itm_elev.get(), transmitter_height, receiver_height,
-			eps_dielect, sgm_conductivity, eno, frq_mhz, radio_climate,
-			pol, conf, rel, dbloss, strmode, p_mode, horizons, errnum);
-		if( _root_node->getBoolValue( "use-clutter-attenuation", false ) )
-			calculate_clutter_loss(frq_mhz, itm_elev.get(), materials, transmitter_height, receiver_height, p_mode, horizons, clutter_loss);
-	}
+	dbloss = result.dbloss;
+	clutter_loss = result.clutter_loss;
 	
 	double pol_loss = 0.0;
 	// TODO: remove this check after we check a bit the axis calculations in this function
@@ -418,7 +764,7 @@ double FGRadioTransmission::ITM_calculate_attenuation(SGGeod pos, double freq, i
 	//cerr << "ITM:: Link budget: " << link_budget << ", Attenuation: " << dbloss << " dBm, " << strmode << ", Error: " << errnum << endl;
 	_root_node->setDoubleValue("station[0]/link-budget", link_budget);
 	_root_node->setDoubleValue("station[0]/terrain-attenuation", dbloss);
-	_root_node->setStringValue("station[0]/prop-mode", strmode);
+	_root_node->setStringValue("station[0]/prop-mode", result.strmode.c_str());
 	_root_node->setDoubleValue("station[0]/clutter-attenuation", clutter_loss);
 	_root_node->setDoubleValue("station[0]/polarization-attenuation", pol_loss);
 	//if (errnum == 4)	// if parameters are outside sane values for lrprop, bail out fast
@@ -430,7 +776,7 @@ double FGRadioTransmission::ITM_calculate_attenuation(SGGeod pos, double freq, i
 	double sender_heading = 270.0; // due West
 	double tx_antenna_bearing = sender_heading - reverse_course * SGD_RADIANS_TO_DEGREES;
 	double rx_antenna_bearing = own_heading - course * SGD_RADIANS_TO_DEGREES;
-	double rx_elev_angle = atan((itm_elev[2] + transmitter_height - itm_elev[(int)itm_elev[0] + 2] + receiver_height) / distance_m) * SGD_RADIANS_TO_DEGREES;
+	double rx_elev_angle = atan((result.first_elevation + transmitter_height - result.last_elevation + receiver_height) / distance_m) * SGD_RADIANS_TO_DEGREES;
 	double tx_elev_angle = 0.0 - rx_elev_angle;
 	if (_root_node->getBoolValue("use-tx-antenna-pattern", false)) {
 		FGRadioAntenna* TX_antenna;
@@ -460,16 +806,126 @@ double FGRadioTransmission::ITM_calculate_attenuation(SGGeod pos, double freq, i
 	//_root_node->setDoubleValue("station[0]/tx-pattern-gain", tx_pattern_gain);
 	//_root_node->setDoubleValue("station[0]/rx-pattern-gain", rx_pattern_gain);
 
-	for (unsigned i =0; i < materials.size(); i++) {
-		delete materials[i];
+	return signal;
+
+}
+
+
+void FGRadioTransmission::run_propagation(PropagationJob &job) {
+	
+	/** ITM default parameters 
+		TODO: take them from tile materials (especially for sea)?
+	**/
+	double eps_dielect=15.0;
+	double sgm_conductivity = 0.005;
+	double eno = 301.0;
+	
+	int radio_climate = 5;		// continental temperate
+	double conf = 0.90;	// 90% of situations and time, take into account speed
+	double rel = 0.90;	
+	char strmode[150];
+	double horizons[2];
+	
+	double* itm_elev = &job.itm_elev[0];
+	job.clutter_loss = 0.0;
+	
+	if(job.reversed) {
+		// the sender and receiver roles are switched
+		ITM::point_to_point(itm_elev, job.receiver_height, job.transmitter_height,
+			eps_dielect, sgm_conductivity, eno, job.frq_mhz, radio_climate,
+			job.pol, conf, rel, job.dbloss, strmode, job.p_mode, horizons, job.errnum);
+		if( job.use_clutter )
+			calculate_clutter_loss(job.frq_mhz, itm_elev, job.materials, job.receiver_height, job.transmitter_height, job.p_mode, horizons, job.clutter_loss);
+	}
+	else {
+		ITM::point_to_point(itm_elev, job.transmitter_height, job.receiver_height,
+			eps_dielect, sgm_conductivity, eno, job.frq_mhz, radio_climate,
+			job.pol, conf, rel, job.dbloss, strmode, job.p_mode, horizons, job.errnum);
+		if( job.use_clutter )
+			calculate_clutter_loss(job.frq_mhz, itm_elev, job.materials, job.transmitter_height, job.receiver_height, job.p_mode, horizons, job.clutter_loss);
 	}
 	
-	return signal;
+	job.strmode = strmode;
+	job.first_elevation = itm_elev[2];
+	job.last_elevation = itm_elev[(int)itm_elev[0] + 2];
+}
+
 
+void FGRadioTransmission::benchmark(unsigned int grid, unsigned int passes) {
+	
+	// transmitters on a grid 10 km apart, receivers on a second grid offset
+	// by 25 km, over rolling synthetic terrain
+	const double GRID_SPACING_M = 10000.0;
+	const double POINT_DISTANCE_M = 90.0;
+	
+	SGGeod origin = SGGeod::fromDeg( -122.0, 37.0 );
+	std::vector<PropagationJob> jobs;
+	for (unsigned int t = 0; t < grid * grid; ++t) {
+		for (unsigned int r = 0; r < grid * grid; ++r) {
+			SGGeod tx_pos = SGGeodesy::direct( origin, 0.0, (t / grid) * GRID_SPACING_M );
+			tx_pos = SGGeodesy::direct( tx_pos, 90.0, (t % grid) * GRID_SPACING_M );
+			SGGeod rx_pos = SGGeodesy::direct( origin, 45.0, 25000.0 + (r / grid) * GRID_SPACING_M );
+			rx_pos = SGGeodesy::direct( rx_pos, 90.0, (r % grid) * GRID_SPACING_M );
+			
+			double distance_m = SGGeodesy::distanceM( tx_pos, rx_pos );
+			int points = (int)floor( distance_m / POINT_DISTANCE_M ) + 2;
+			
+			PropagationJob job;
+			job.key = PropagationJob::Key( tx_pos, rx_pos, 32.0, 1000.0, 121.5, 1, 1, true );
+			job.transmitter_height = 32.0;
+			job.receiver_height = 1000.0;
+			job.frq_mhz = 121.5;
+			job.use_clutter = true;
+			job.itm_elev.push_back( points - 1 );
+			job.itm_elev.push_back( POINT_DISTANCE_M );
+			for (int i = 0; i < points; ++i) {
+				double d = i * POINT_DISTANCE_M;
+				job.itm_elev.push_back( 200.0 + 150.0 * sin( d / 7000.0 + t ) + 40.0 * sin( d / 900.0 + r ) );
+				job.materials.push_back( (i / 40) % 2 ? "DeciduousForest" : "Town" );
+			}
+			jobs.push_back( job );
+		}
+	}
+	
+	SGTimeStamp st;
+	st.stamp();
+	for (unsigned int i = 0; i < jobs.size(); ++i) {
+		PropagationJob job( jobs[i] );
+		run_propagation( job );
+	}
+	double serialMSec = st.elapsedMSec();
+	
+	PropagationCache* cache = PropagationCache::instance();
+	cache->drain();
+	cache->clear();
+	st.stamp();
+	for (unsigned int p = 0; p < passes; ++p) {
+		for (unsigned int i = 0; i < jobs.size(); ++i) {
+			cache->submit( new PropagationJob( jobs[i] ) );
+		}
+		cache->drain();
+	}
+	double poolMSec = st.elapsedMSec();
+	
+	st.stamp();
+	unsigned int found = 0;
+	for (unsigned int i = 0; i < jobs.size(); ++i) {
+		PropagationJob result;
+		if (cache->find( jobs[i].key, result ) != PropagationCache::MISS) {
+			++found;
+		}
+	}
+	double lookupMSec = st.elapsedMSec();
+	cache->clear();
+	
+	SG_LOG( SG_GENERAL, SG_INFO, "radio propagation benchmark: " << jobs.size()
+		<< " links; serial " << serialMSec << "msec, worker pool "
+		<< (passes ? poolMSec / passes : 0.0) << "msec per pass, " << found
+		<< " cached results found in " << lookupMSec << "msec" );
 }
 
 
-void FGRadioTransmission::calculate_clutter_loss(double freq, double itm_elev[], deque<string*> &materials,
+void FGRadioTransmission::calculate_clutter_loss(double freq, double itm_elev[], const std::vector<string> &materials,
 	double transmitter_height, double receiver_height, int p_mode,
 	double horizons[], double &clutter_loss) {
 	
@@ -807,110 +1263,107 @@ void FGRadioTransmission::calculate_clutter_loss(double freq, double itm_elev[],
 }
 
 
-void FGRadioTransmission::get_material_properties(string* mat_name, double &height, double &density) {
-	
-	if(!mat_name)
-		return;
+void FGRadioTransmission::get_material_properties(const string &mat_name, double &height, double &density) {
 	
-	if(*mat_name == "Landmass") {
+	if(mat_name == "Landmass") {
 		height = 15.0;
 		density = 0.2;
 	}
 
-	else if(*mat_name == "SomeSort") {
+	else if(mat_name == "SomeSort") {
 		height = 15.0;
 		density = 0.2;
 	}
 
-	else if(*mat_name == "Island") {
+	else if(mat_name == "Island") {
 		height = 15.0;
 		density = 0.2;
 	}
-	else if(*mat_name == "Default") {
+	else if(mat_name == "Default") {
 		height = 15.0;
 		density = 0.2;
 	}
-	else if(*mat_name == "EvergreenBroadCover") {
+	else if(mat_name == "EvergreenBroadCover") {
 		height = 20.0;
 		density = 0.2;
 	}
-	else if(*mat_name == "EvergreenForest") {
+	else if(mat_name == "EvergreenForest") {
 		height = 20.0;
 		density = 0.2;
 	}
-	else if(*mat_name == "DeciduousBroadCover") {
+	else if(mat_name == "DeciduousBroadCover") {
 		height = 15.0;
 		density = 0.3;
 	}
-	else if(*mat_name == "DeciduousForest") {
+	else if(mat_name == "DeciduousForest") {
 		height = 15.0;
 		density = 0.3;
 	}
-	else if(*mat_name == "MixedForestCover") {
+	else if(mat_name == "MixedForestCover") {
 		height = 20.0;
 		density = 0.25;
 	}
-	else if(*mat_name == "MixedForest") {
+	else if(mat_name == "MixedForest") {
 		height = 15.0;
 		density = 0.25;
 	}
-	else if(*mat_name == "RainForest") {
+	else if(mat_name == "RainForest") {
 		height = 25.0;
 		density = 0.55;
 	}
-	else if(*mat_name == "EvergreenNeedleCover") {
+	else if(mat_name == "EvergreenNeedleCover") {
 		height = 15.0;
 		density = 0.2;
 	}
-	else if(*mat_name == "WoodedTundraCover") {
+	else if(mat_name == "WoodedTundraCover") {
 		height = 5.0;
 		density = 0.15;
 	}
-	else if(*mat_name == "DeciduousNeedleCover") {
+	else if(mat_name == "DeciduousNeedleCover") {
 		height = 5.0;
 		density = 0.2;
 	}
-	else if(*mat_name == "ScrubCover") {
+	else if(mat_name == "ScrubCover") {
 		height = 3.0;
 		density = 0.15;
 	}
-	else if(*mat_name == "BuiltUpCover") {
+	else if(mat_name == "BuiltUpCover") {
 		height = 30.0;
 		density = 0.7;
 	}
-	else if(*mat_name == "Urban") {
+	else if(mat_name == "Urban") {
 		height = 30.0;
 		density = 0.7;
 	}
-	else if(*mat_name == "Construction") {
+	else if(mat_name == "Construction") {
 		height = 30.0;
 		density = 0.7;
 	}
-	else if(*mat_name == "Industrial") {
+	else if(mat_name == "Industrial") {
 		height = 30.0;
 		density = 0.7;
 	}
-	else if(*mat_name == "Port") {
+	else if(mat_name == "Port") {
 		height = 30.0;
 		density = 0.7;
 	}
-	else if(*mat_name == "Town") {
+	else if(mat_name == "Town") {
 		height = 10.0;
 		density = 0.5;
 	}
-	else if(*mat_name == "SubUrban") {
+	else if(mat_name == "SubUrban") {
 		height = 10.0;
 		density = 0.5;
 	}
-	else if(*mat_name == "CropWoodCover") {
+	else if(mat_name == "CropWoodCover") {
 		height = 10.0;
 		density = 0.1;
 	}
-	else if(*mat_name == "CropWood") {
+	else if(mat_name == "CropWood") {
 		height = 10.0;
 		density = 0.1;
 	}
-	else if(*mat_name == "AgroForest") {
+	else if(mat_name == "AgroForest") {
 		height = 10.0;
 		density = 0.1;
 	}
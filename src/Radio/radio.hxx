@@ -24,6 +24,7 @@
 #include <simgear/compiler.h>
 #include <simgear/structure/subsystem_mgr.hxx>
 #include <deque>
+#include <vector>
 #include <Main/fg_props.hxx>
 
 #include <simgear/math/sg_geodesy.hxx>
@@ -37,6 +38,14 @@ class FGRadioTransmission
 {
 private:
 	
+/***	Terrain profile and parameters for the ITM model, and its results.
+*	The model itself only depends on these, so it can run on the
+*	propagation worker threads.
+***/
+	struct PropagationJob;
+	class PropagationCache;
+	friend class PropagationCache;
+	
 	double _receiver_sensitivity;
 	double _transmitter_power;
 	double _tx_antenna_height;
@@ -51,6 +60,7 @@ private:
 	std::map<string, double[2]> _mat_database;
 	SGPropertyNode *_root_node;
 	int _propagation_model; /// 0 none, 1 round Earth, 2 ITM
+	unsigned int _elevation_caller; /// ElevationService registration
 	double polarization_loss();
 	
 	
@@ -74,15 +84,22 @@ private:
 *	@param: frequency, elevation data, terrain type, horizon distances, calculated loss
 *	@return: none
 ***/
-	void calculate_clutter_loss(double freq, double itm_elev[], std::deque<string*> &materials,
+	static void calculate_clutter_loss(double freq, double itm_elev[], const std::vector<string> &materials,
 			double transmitter_height, double receiver_height, int p_mode,
 			double horizons[], double &clutter_loss);
 	
+/*** Run the ITM model and clutter loss for a sampled terrain profile,
+*	 safe to call from any thread
+*	@param: the profile and parameters, results are stored in it
+*	@return: none
+***/
+	static void run_propagation(PropagationJob &job);
+	
 /*** 	Temporary material properties database
 *		@param: terrain type, median clutter height, radiowave attenuation factor
 *		@return: none
 ***/
-	void get_material_properties(string* mat_name, double &height, double &density);
+	static void get_material_properties(const string &mat_name, double &height, double &density);
 	
 	
 public:
@@ -111,6 +128,21 @@ public:
     static double dbm_to_watt(double dbm);
     static double dbm_to_microvolt(double dbm);
     
+/*** Compute the attenuation for a fixed grid of transmitter/receiver pairs
+*	over synthetic terrain, on the calling thread, through the worker
+*	pool and from the result cache, and log the timings
+*	@param: grid size, number of worker passes
+*	@return: none
+***/
+    static void benchmark(unsigned int grid, unsigned int passes);
+    
+/*** Stop and join the propagation worker threads, they are started
+*	again on the next transmission
+*	@param: none
+*	@return: none
+***/
+    static void shutdownPropagation();
+    
     
 /*** Receive ATC radio communication as text
 *	transmission_type: 0 for air to ground 1 for ground to air, 2 for air to air, 3 for pilot to ground, 4 for pilot to air
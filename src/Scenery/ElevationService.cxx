@@ -0,0 +1,272 @@
+// ElevationService.cxx - shared, cached terrain elevation queries
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "ElevationService.hxx"
+
+#include <cmath>
+
+#include <simgear/constants.h>
+#include <simgear/bucket/newbucket.hxx>
+#include <simgear/debug/logstream.hxx>
+
+#include <Main/globals.hxx>
+#include <Main/fg_props.hxx>
+
+#include "scenery.hxx"
+
+namespace {
+
+// cells per tile side are a power of two, at most 2^MAX_CELL_LEVEL
+const unsigned int MAX_CELL_LEVEL = 20;
+// bound on the cached samples, the cache is cleared when it is exceeded
+const size_t MAX_CACHED_SAMPLES = 256 * 1024;
+
+unsigned int cellLevel(double tileSizeM, double resolutionM)
+{
+  unsigned int level = 0;
+  while ((level < MAX_CELL_LEVEL) && (tileSizeM > resolutionM)) {
+    tileSizeM *= 0.5;
+    ++level;
+  }
+
+  return level;
+}
+
+} // anonymous namespace
+
+namespace flightgear
+{
+
+static ElevationService* static_elevationService = NULL;
+
+ElevationService* ElevationService::instance()
+{
+  if (!static_elevationService) {
+    static_elevationService = new ElevationService;
+  }
+
+  return static_elevationService;
+}
+
+ElevationService::ElevationService() :
+  _sampleCount(0)
+{
+}
+
+ElevationService::CallerId
+ElevationService::registerCaller(const std::string& name, double resolutionM)
+{
+  for (CallerId i = 0; i < _callers.size(); ++i) {
+    if (_callers[i].name == name) {
+      return i;
+    }
+  }
+
+  Caller c;
+  c.name = name;
+  c.resolutionM = resolutionM;
+  c.queries = c.hits = c.failures = 0;
+  _callers.push_back(c);
+  return _callers.size() - 1;
+}
+
+bool ElevationService::exactElevation(const SGGeod& pos, double& elevation,
+                                      const simgear::BVHMaterial** material,
+                                      const osg::Node* butNotFrom)
+{
+  FGScenery* scenery = globals->get_scenery();
+  if (!scenery) {
+    return false;
+  }
+
+  return scenery->get_elevation_m(pos, elevation, material, butNotFrom);
+}
+
+bool ElevationService::getElevation(CallerId id, const SGGeod& pos,
+                                    double& elevation,
+                                    const simgear::BVHMaterial** material,
+                                    const osg::Node* butNotFrom)
+{
+  Caller& caller(_callers[id]);
+  ++caller.queries;
+
+  bool ok;
+  if ((caller.resolutionM <= 0.0) || butNotFrom) {
+    ok = exactElevation(pos, elevation, material, butNotFrom);
+  } else {
+    ok = cachedElevation(caller, pos, elevation, material);
+  }
+
+  if (!ok) {
+    ++caller.failures;
+  }
+
+  return ok;
+}
+
+bool ElevationService::cachedElevation(Caller& caller, const SGGeod& pos,
+                                       double& elevation,
+                                       const simgear::BVHMaterial** material)
+{
+  SGBucket bucket(pos);
+  if (!bucket.isValid()) {
+    return false;
+  }
+
+  double width = bucket.get_width();
+  double height = bucket.get_height();
+  unsigned int level = cellLevel(SGMiscd::max(bucket.get_width_m(),
+                                              bucket.get_height_m()),
+                                 caller.resolutionM);
+  unsigned int cells = 1u << level;
+
+  double fx = (pos.getLongitudeDeg() - bucket.get_center_lon()) / width + 0.5;
+  double fy = (pos.getLatitudeDeg() - bucket.get_center_lat()) / height + 0.5;
+  unsigned int cx = static_cast<unsigned int>(SGMiscd::clip(floor(fx * cells), 0.0, cells - 1.0));
+  unsigned int cy = static_cast<unsigned int>(SGMiscd::clip(floor(fy * cells), 0.0, cells - 1.0));
+  uint64_t key = (uint64_t(level) << 48) | (uint64_t(cx) << 24) | cy;
+
+  long tileIndex = bucket.gen_index();
+  const Sample* sample = 0;
+  TileSampleMap::const_iterator tile = _tiles.find(tileIndex);
+  if (tile != _tiles.end()) {
+    SampleMap::const_iterator it = tile->second.find(key);
+    if (it != tile->second.end()) {
+      sample = &it->second;
+    }
+  }
+
+  bool cached = (sample != 0);
+  if (!cached) {
+    // sample the cell centre, from above the highest terrain
+    SGGeod centre = SGGeod::fromDegM(
+      bucket.get_center_lon() + ((cx + 0.5) / cells - 0.5) * width,
+      bucket.get_center_lat() + ((cy + 0.5) / cells - 0.5) * height,
+      SG_MAX_ELEVATION_M);
+
+    Sample s;
+    double sampleElevation;
+    if (!exactElevation(centre, sampleElevation, &s.material, 0)) {
+      // no scenery (yet), don't cache that
+      return false;
+    }
+
+    if (_sampleCount >= MAX_CACHED_SAMPLES) {
+      SG_LOG(SG_TERRAIN, SG_DEBUG, "elevation cache full, clearing");
+      clear();
+    }
+
+    s.elevation = sampleElevation;
+    sample = &_tiles[tileIndex].insert(std::make_pair(key, s)).first->second;
+    ++_sampleCount;
+  }
+
+  if (pos.getElevationM() < sample->elevation) {
+    // query starts below the terrain surface (a tunnel, or under a
+    // bridge); the sample does not apply
+    return exactElevation(pos, elevation, material, 0);
+  }
+
+  if (cached) {
+    ++caller.hits;
+  }
+
+  elevation = sample->elevation;
+  if (material) {
+    *material = sample->material;
+  }
+
+  return true;
+}
+
+size_t ElevationService::getElevations(CallerId caller, QueryList& queries)
+{
+  size_t valid = 0;
+  QueryList::iterator it;
+  for (it = queries.begin(); it != queries.end(); ++it) {
+    it->valid = getElevation(caller, it->position, it->elevation,
+                             &it->material);
+    if (it->valid) {
+      ++valid;
+    }
+  }
+
+  return valid;
+}
+
+bool ElevationService::getGroundIntersection(CallerId id, const SGVec3d& start,
+                                             const SGVec3d& dir,
+                                             SGVec3d& nearestHit)
+{
+  Caller& caller(_callers[id]);
+  ++caller.queries;
+
+  FGScenery* scenery = globals->get_scenery();
+  if (!scenery || !scenery->get_cart_ground_intersection(start, dir, nearestHit)) {
+    ++caller.failures;
+    return false;
+  }
+
+  return true;
+}
+
+void ElevationService::invalidateTile(long tileIndex)
+{
+  TileSampleMap::iterator it = _tiles.find(tileIndex);
+  if (it == _tiles.end()) {
+    return;
+  }
+
+  _sampleCount -= it->second.size();
+  _tiles.erase(it);
+}
+
+void ElevationService::clear()
+{
+  _tiles.clear();
+  _sampleCount = 0;
+}
+
+void ElevationService::publishStats()
+{
+  if (!_rootNode) {
+    _rootNode = fgGetNode("/sim/scenery/elevation-service", true);
+  }
+
+  _rootNode->setIntValue("cached-samples", _sampleCount);
+  _rootNode->setIntValue("cached-tiles", _tiles.size());
+
+  std::vector<Caller>::iterator it;
+  for (it = _callers.begin(); it != _callers.end(); ++it) {
+    if (!it->node) {
+      it->node = _rootNode->getChild("caller", it - _callers.begin(), true);
+      it->node->setStringValue("name", it->name);
+      it->node->setDoubleValue("resolution-m", it->resolutionM);
+    }
+
+    it->node->setIntValue("queries", it->queries);
+    it->node->setIntValue("cache-hits", it->hits);
+    it->node->setIntValue("failures", it->failures);
+    it->node->setDoubleValue("hit-rate",
+      it->queries ? double(it->hits) / it->queries : 0.0);
+  }
+}
+
+} // of namespace flightgear
@@ -0,0 +1,146 @@
+/**
+ * ElevationService.hxx - shared, cached terrain elevation queries
+ */
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifndef FG_ELEVATION_SERVICE_HXX
+#define FG_ELEVATION_SERVICE_HXX
+
+#include <map>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include <simgear/math/SGMath.hxx>
+#include <simgear/props/props.hxx>
+
+namespace osg {
+class Node;
+}
+
+namespace simgear {
+class BVHMaterial;
+}
+
+namespace flightgear
+{
+
+/**
+ * Terrain elevation queries on behalf of the various subsystems which
+ * probe the scenery (radio propagation, ridge lift, AI vehicles, ...).
+ *
+ * Each caller registers with the resolution it needs; results are then
+ * served from a per-tile heightfield cache, with samples taken at the
+ * centre of cells no larger than that resolution. Callers registered with
+ * resolution 0 always get an exact scene graph intersection, but are still
+ * included in the statistics. Cached samples are dropped when their tile is
+ * unloaded.
+ *
+ * Query counts and cache hit rates are published per caller below
+ * /sim/scenery/elevation-service. Only for use from the main thread.
+ */
+class ElevationService
+{
+public:
+  typedef unsigned int CallerId;
+
+  struct Query
+  {
+    Query() : elevation(0.0), material(0), valid(false) {}
+    explicit Query(const SGGeod& pos) :
+      position(pos), elevation(0.0), material(0), valid(false) {}
+
+    SGGeod position; ///< the altitude is the highest point of interest
+    double elevation;
+    const simgear::BVHMaterial* material;
+    bool valid;      ///< false if there is no scenery at the position
+  };
+  typedef std::vector<Query> QueryList;
+
+  static ElevationService* instance();
+
+  /**
+   * Register a caller (or look up an existing registration by name).
+   * resolutionM is the largest acceptable horizontal error, in meters.
+   */
+  CallerId registerCaller(const std::string& name, double resolutionM);
+
+  /**
+   * Elevation of the scenery below pos, as FGScenery::get_elevation_m.
+   * Queries which exclude a node (butNotFrom) are never cached.
+   */
+  bool getElevation(CallerId caller, const SGGeod& pos, double& elevation,
+                    const simgear::BVHMaterial** material = 0,
+                    const osg::Node* butNotFrom = 0);
+
+  /**
+   * Batched form of getElevation, fills in the results of all queries and
+   * returns the number of valid ones.
+   */
+  size_t getElevations(CallerId caller, QueryList& queries);
+
+  /**
+   * Uncached line intersection, as
+   * FGScenery::get_cart_ground_intersection; routed through here for the
+   * statistics.
+   */
+  bool getGroundIntersection(CallerId caller, const SGVec3d& start,
+                             const SGVec3d& dir, SGVec3d& nearestHit);
+
+  /// drop the cached samples of an unloaded tile
+  void invalidateTile(long tileIndex);
+
+  /// drop all cached samples
+  void clear();
+
+  /// update the statistics properties, called once per frame
+  void publishStats();
+private:
+  ElevationService();
+
+  struct Caller
+  {
+    std::string name;
+    double resolutionM;
+    unsigned int queries, hits, failures;
+    SGPropertyNode_ptr node;
+  };
+
+  /// a cell of the heightfield
+  struct Sample
+  {
+    float elevation;
+    const simgear::BVHMaterial* material;
+  };
+
+  typedef std::map<uint64_t, Sample> SampleMap;
+  typedef std::map<long, SampleMap> TileSampleMap;
+
+  bool exactElevation(const SGGeod& pos, double& elevation,
+                      const simgear::BVHMaterial** material,
+                      const osg::Node* butNotFrom);
+  bool cachedElevation(Caller& caller, const SGGeod& pos, double& elevation,
+                       const simgear::BVHMaterial** material);
+
+  std::vector<Caller> _callers;
+  TileSampleMap _tiles;
+  size_t _sampleCount;
+  SGPropertyNode_ptr _rootNode;
+};
+
+} // of namespace flightgear
+
+#endif // of FG_ELEVATION_SERVICE_HXX
@@ -24,9 +24,13 @@
 #  include <config.h>
 #endif
 
+#include <osg/Group>
+
 #include <simgear/bucket/newbucket.hxx>
 #include <simgear/debug/logstream.hxx>
+#include <simgear/math/SGGeodesy.hxx>
 #include <simgear/misc/sg_path.hxx>
+#include <simgear/timing/timestamp.hxx>
 
 #include "tileentry.hxx"
 #include "tilecache.hxx"
@@ -54,11 +58,50 @@ void TileCache::entry_free( long tile_index ) {
     SG_LOG( SG_TERRAIN, SG_DEBUG, "FREEING CACHE ENTRY = " << tile_index );
     TileEntry *tile = tile_cache[tile_index];
     tile->removeFromSceneGraph();
+    index_remove( tile_index, tile );
     tile_cache.erase( tile_index );
     delete tile;
 }
 
 
+bool TileCache::DropKey::operator<(const DropKey& other) const
+{
+    if (time_expired != other.time_expired)
+        return time_expired < other.time_expired;
+    if (priority != other.priority)
+        return priority < other.priority;
+    return index < other.index;
+}
+
+
+void TileCache::index_add( long tile_index, TileEntry* e )
+{
+    if (e->is_current_view()) {
+        current_view_tiles.insert( tile_index );
+        return;
+    }
+
+    DropKey key = { e->get_time_expired(), e->get_priority(), tile_index };
+    drop_queue.insert( key );
+    if (!e->is_loaded()) {
+        unloaded_queue.insert( key );
+    }
+}
+
+
+void TileCache::index_remove( long tile_index, TileEntry* e )
+{
+    if (e->is_current_view()) {
+        current_view_tiles.erase( tile_index );
+        return;
+    }
+
+    DropKey key = { e->get_time_expired(), e->get_priority(), tile_index };
+    drop_queue.erase( key );
+    unloaded_queue.erase( key );
+}
+
+
 // Initialize the tile cache subsystem
 void TileCache::init( void ) {
     SG_LOG( SG_TERRAIN, SG_INFO, "Initializing the tile cache." );
@@ -86,60 +129,41 @@ bool TileCache::exists( const SGBucket& b ) const {
 // Return the index of a tile to be dropped from the cache, return -1 if
 // nothing available to be removed.
 long TileCache::get_drop_tile() {
-    long min_index = -1;
-    double min_time = DBL_MAX;
-    float priority = FLT_MAX;
-
-    tile_map_iterator current = tile_cache.begin();
-    tile_map_iterator end = tile_cache.end();
-
-    for ( ; current != end; ++current ) {
-        long index = current->first;
-        TileEntry *e = current->second;
-        if (( !e->is_current_view() )&&
-            ( e->is_expired(current_time) ))
-        {
-            if (e->is_expired(current_time - 1.0)&&
-                !e->is_loaded())
-            {
-                /* Immediately drop "empty" tiles which are no longer used/requested, and were last requested > 1 second ago...
-                 * Allow a 1 second timeout since an empty tiles may just be loaded...
-                 */
-                SG_LOG( SG_TERRAIN, SG_DEBUG, "    dropping an unused and empty tile");
-                min_index = index;
-                break;
-            }
-            if (( e->get_time_expired() < min_time )||
-                (( e->get_time_expired() == min_time)&&
-                 ( priority > e->get_priority())))
-            {
-                // drop oldest tile with lowest priority
-                min_time = e->get_time_expired();
-                priority = e->get_priority();
-                min_index = index;
-            }
+    /* Immediately drop "empty" tiles which are no longer used/requested, and were last requested > 1 second ago...
+     * Allow a 1 second timeout since an empty tiles may just be loaded...
+     */
+    drop_index::iterator it = unloaded_queue.begin();
+    while (( it != unloaded_queue.end() )&&
+           ( it->time_expired < current_time - 1.0 ))
+    {
+        TileEntry *e = get_tile( it->index );
+        if (!e->is_loaded()) {
+            SG_LOG( SG_TERRAIN, SG_DEBUG, "    dropping an unused and empty tile");
+            return it->index;
         }
+
+        // loaded meanwhile, it stays in drop_queue only
+        unloaded_queue.erase( it++ );
     }
 
+    // drop oldest tile with lowest priority
+    long min_index = get_first_expired_tile();
     SG_LOG( SG_TERRAIN, SG_DEBUG, "    index = " << min_index );
-    SG_LOG( SG_TERRAIN, SG_DEBUG, "    min_time = " << min_time );
 
     return min_index;
 }
 
 long TileCache::get_first_expired_tile() const
 {
-  const_tile_map_iterator current = tile_cache.begin();
-  const_tile_map_iterator end = tile_cache.end();
-  
-  for ( ; current != end; ++current ) {
-    TileEntry *e = current->second;
-    if (!e->is_current_view() && e->is_expired(current_time))
-    {
-      return current->first;
-    }
+  if (drop_queue.empty()) {
+    return -1;
+  }
+
+  const DropKey& oldest = *drop_queue.begin();
+  if (oldest.time_expired < current_time) {
+    return oldest.index;
   }
-  
+
   return -1; // no expired tile found
 }
 
@@ -147,24 +171,29 @@ long TileCache::get_first_expired_tile() const
 // Clear all flags indicating tiles belonging to the current view
 void TileCache::clear_current_view()
 {
-    tile_map_iterator current = tile_cache.begin();
-    tile_map_iterator end = tile_cache.end();
-
-    for ( ; current != end; ++current ) {
-        TileEntry *e = current->second;
-        if (e->is_current_view())
-        {
-            // update expiry time for tiles belonging to most recent position
-            e->update_time_expired( current_time );
-            e->set_current_view( false );
-        }
+    std::set<long> previous_view;
+    previous_view.swap( current_view_tiles );
+
+    std::set<long>::const_iterator it = previous_view.begin();
+    for ( ; it != previous_view.end(); ++it ) {
+        TileEntry *e = get_tile( *it );
+        // update expiry time for tiles belonging to most recent position
+        e->update_time_expired( current_time );
+        e->set_current_view( false );
+        index_add( *it, e );
     }
 }
 
 // Clear a cache entry, note that the cache only holds pointers
 // and this does not free the object which is pointed to.
 void TileCache::clear_entry( long tile_index ) {
-    tile_cache.erase( tile_index );
+    tile_map_iterator it = tile_cache.find( tile_index );
+    if ( it == tile_cache.end() ) {
+        return;
+    }
+
+    index_remove( tile_index, it->second );
+    tile_cache.erase( it );
 }
 
 
@@ -194,8 +223,10 @@ void TileCache::clear_cache() {
 bool TileCache::insert_tile( TileEntry *e ) {
     // register tile in the cache
     long tile_index = e->get_tile_bucket().gen_index();
+    clear_entry( tile_index );
     tile_cache[tile_index] = e;
     e->update_time_expired(current_time);
+    index_add( tile_index, e );
 
     return true;
 }
@@ -206,6 +237,9 @@ void TileCache::request_tile(TileEntry* t,float priority,bool current_view,doubl
     if ((!current_view)&&(request_time<=0.0))
         return;
 
+    long tile_index = t->get_tile_bucket().gen_index();
+    index_remove( tile_index, t );
+
     // update priority when higher - or old request has expired
     if ((t->is_expired(current_time))||
          (priority > t->get_priority()))
@@ -222,4 +256,81 @@ void TileCache::request_tile(TileEntry* t,float priority,bool current_view,doubl
     {
         t->update_time_expired( current_time+request_time );
     }
+
+    index_add( tile_index, t );
+}
+
+void TileCache::benchmark( unsigned int steps, int range )
+{
+    // roughly the size of a tile at mid latitudes
+    const double STEP_DISTANCE_M = 12000.0;
+
+    TileCache cache;
+    cache.set_max_cache_size( (2*range + 2) * (2*range + 2) * 2 );
+
+    SGGeod pos = SGGeod::fromDeg( -122.0, 37.0 );
+    double course = 75.0;
+    unsigned int created = 0, dropped = 0;
+    double requestMSec = 0.0, dropMSec = 0.0;
+
+    for (unsigned int i = 0; i < steps; ++i) {
+        SGTimeStamp st;
+        st.stamp();
+
+        cache.set_current_time( i * 0.5 );
+        cache.clear_current_view();
+
+        SGBucket center( pos );
+        for ( int x = -range; x <= range; ++x ) {
+            for ( int y = -range; y <= range; ++y ) {
+                SGBucket b = center.sibling( x, y );
+                if (!b.isValid()) {
+                    continue;
+                }
+
+                TileEntry *t = cache.get_tile( b );
+                if (!t) {
+                    t = new TileEntry( b );
+                    // every other tile pretends to have been loaded by the
+                    // pager, so both drop paths are exercised
+                    if (created++ % 2) {
+                        t->getNode()->addChild( new osg::Group );
+                    }
+                    cache.insert_tile( t );
+                }
+
+                cache.request_tile( t, (-1.0) * (x*x + y*y), true, 0.0 );
+            }
+        }
+
+        requestMSec += st.elapsedMSec();
+        st.stamp();
+
+        int drop_count = cache.get_size() - cache.get_max_cache_size();
+        while ( drop_count-- > 0 ) {
+            long drop_index = cache.get_drop_tile();
+            if ( drop_index < 0 ) {
+                break;
+            }
+
+            TileEntry *old = cache.get_tile( drop_index );
+            cache.clear_entry( drop_index );
+            delete old;
+            ++dropped;
+        }
+
+        dropMSec += st.elapsedMSec();
+
+        SGGeod next;
+        double az2;
+        SGGeodesy::direct( pos, course, STEP_DISTANCE_M, next, az2 );
+        pos = next;
+        course = SGMiscd::normalizePeriodic( 0.0, 360.0, az2 + 180.0 );
+    }
+
+    SG_LOG( SG_TERRAIN, SG_INFO, "tile cache benchmark: " << steps
+            << " steps, range " << range << ", " << created << " tiles created, "
+            << dropped << " dropped, cache size " << cache.get_size()
+            << "; requests took " << requestMSec << "msec, drops took "
+            << dropMSec << "msec" );
 }
@@ -25,6 +25,7 @@
 #define _TILECACHE_HXX
 
 #include <map>
+#include <set>
 
 #include <simgear/bucket/newbucket.hxx>
 #include "tileentry.hxx"
@@ -49,9 +50,33 @@ private:
 
     double current_time;
 
+    // Key of the drop index: tiles are dropped oldest first, and with the
+    // lowest priority first among tiles expiring at the same time.
+    struct DropKey {
+        double time_expired;
+        float priority;
+        long index;
+
+        bool operator<(const DropKey& other) const;
+    };
+    typedef std::set<DropKey> drop_index;
+
+    // tiles not belonging to the current view, ordered for dropping
+    drop_index drop_queue;
+    // the subset of drop_queue which was not yet loaded when last checked;
+    // tiles never unload, so entries are pruned as they are found loaded
+    drop_index unloaded_queue;
+    // tiles belonging to the current view, which are never dropped
+    std::set<long> current_view_tiles;
+
     // Free a tile cache entry
     void entry_free( long cache_index );
 
+    // Keep the indices above in sync. A tile must be removed before its
+    // priority, expiry time or view flag are changed, and added back after.
+    void index_add( long tile_index, TileEntry* e );
+    void index_remove( long tile_index, TileEntry* e );
+
 public:
     tile_map_iterator begin() { return tile_cache.begin(); }
     tile_map_iterator end() { return tile_cache.end(); }
@@ -128,6 +153,14 @@ public:
 
     // update tile's priority and expiry time according to current request
     void request_tile(TileEntry* t,float priority,bool current_view,double requesttime);
+
+    /**
+     * Measure the cache bookkeeping for a long flight: the view moves
+     * across the given number of steps (of roughly one tile each), with
+     * the tiles within range requested and the excess dropped each step,
+     * the way FGTileMgr does it. Timings are logged.
+     */
+    static void benchmark( unsigned int steps, int range );
 };
 
 #endif // _TILECACHE_HXX
@@ -51,9 +51,32 @@
 
 #include "scenery.hxx"
 #include "SceneryPager.hxx"
+#include "ElevationService.hxx"
 #include "tilemgr.hxx"
 
 using flightgear::SceneryPager;
+using flightgear::ElevationService;
+
+namespace {
+
+// predictive scheduling only pays off for fast movement; below this ground
+// speed (m/s) tiles are scheduled by distance alone
+const double PREDICTIVE_MIN_SPEED_MPS = 50.0;
+// unloaded tiles further behind than this (in tiles, along the track) are
+// not handed to the pager
+const double PREDICTIVE_KEEP_TILES = 1.5;
+// weight of the distance along the track, relative to the distance off the
+// track, in the priority of tiles ahead: tiles reached sooner load first,
+// but a tile on the track still beats a neighbour beside it
+const double PREDICTIVE_ALONG_WEIGHT = 0.25;
+// reschedule when the track turned by more than ~30 degrees
+const double TRACK_CHANGE_COS = 0.866;
+// time constant (s) for smoothing the view velocity
+const double VELOCITY_TIME_CONSTANT = 2.0;
+// faster view movement is a view change or relocation
+const double MAX_VIEW_SPEED_MPS = 2000.0;
+
+} // anonymous namespace
 
 class FGTileMgr::TileManagerListener : public SGPropertyChangeListener
 {
@@ -121,8 +144,26 @@ FGTileMgr::FGTileMgr():
     _scenery_loaded(fgGetNode("/sim/sceneryloaded", true)),
     _scenery_override(fgGetNode("/sim/sceneryloaded-override", true)),
     _pager(FGScenery::getPagerSingleton()),
-    _enableCache(true)
+    _enableCache(true),
+    _predictive(fgGetNode("/sim/tile-manager/predictive", true)),
+    _lookaheadSec(fgGetNode("/sim/tile-manager/lookahead-sec", true)),
+    _statsPagerQueue(fgGetNode("/sim/tile-manager/stats/pager-queue-depth", true)),
+    _statsQueued(fgGetNode("/sim/tile-manager/stats/queued-requests", true)),
+    _statsDeferred(fgGetNode("/sim/tile-manager/stats/deferred-tiles", true)),
+    _statsLookaheadMargin(fgGetNode("/sim/tile-manager/stats/lookahead-margin-sec", true)),
+    _viewCart(SGVec3d::zeros()),
+    _viewTime(-1.0),
+    _viewVelocity(SGVec3d::zeros()),
+    _scheduledVelocity(SGVec3d::zeros()),
+    _scheduledTime(0.0)
 {
+    if (_predictive->getType() == simgear::props::NONE) {
+        _predictive->setBoolValue(false);
+    }
+
+    if (_lookaheadSec->getType() == simgear::props::NONE) {
+        _lookaheadSec->setDoubleValue(120.0);
+    }
 }
 
 
@@ -201,6 +242,7 @@ void FGTileMgr::reinit()
     osg::Group* group = globals->get_scenery()->get_terrain_branch();
     group->removeChildren(0, group->getNumChildren());
     tile_cache.init();
+    ElevationService::instance()->clear();
     
     // clear OSG cache, except on initial start-up
     if (state != Start)
@@ -213,6 +255,10 @@ void FGTileMgr::reinit()
     previous_bucket.make_bad();
     current_bucket.make_bad();
     scheduled_visibility = 100.0;
+    _viewTime = -1.0;
+    _viewVelocity = _scheduledVelocity = SGVec3d::zeros();
+    _deferredTiles.clear();
+    _aheadTiles.clear();
 
     // force an update now
     update(0.0);
@@ -302,12 +348,31 @@ void FGTileMgr::schedule_needed(const SGBucket& curr_bucket, double vis)
             = globals->get_renderer()->getViewer()->getFrameStamp();
     tile_cache.set_current_time(framestamp->getReferenceTime());
 
+    // ground track of the view, in the local horizontal frame
+    _scheduledVelocity = _viewVelocity;
+    _scheduledTime = framestamp->getReferenceTime();
+    _deferredTiles.clear();
+    _aheadTiles.clear();
+
+    SGVec3d viewCart = (_viewTime < 0.0) ? SGVec3d::fromGeod(curr_bucket.get_center()) : _viewCart;
+    SGQuatd hlOr = SGQuatd::fromLonLat(SGGeod::fromCart(viewCart));
+    SGVec3d track = hlOr.transform(_viewVelocity);
+    track[2] = 0.0;
+    double speed = norm(track);
+    double lookahead = _lookaheadSec->getDoubleValue();
+    double tile_size = sqrt(tile_width * tile_height);
+    bool predict = _predictive->getBoolValue() && (speed > PREDICTIVE_MIN_SPEED_MPS);
+
     SGBucket b;
 
     int x, y;
 
     /* schedule all tiles, use distance-based loading priority,
-     * so tiles are loaded in innermost-to-outermost sequence. */
+     * so tiles are loaded in innermost-to-outermost sequence.
+     * In predictive mode tiles ahead are ranked by their distance off the
+     * projected track and, with less weight, the distance along it, so
+     * they are loaded before those behind and in the order they will be
+     * reached. */
     for ( x = -xrange; x <= xrange; ++x )
     {
         for ( y = -yrange; y <= yrange; ++y )
@@ -318,6 +383,26 @@ void FGTileMgr::schedule_needed(const SGBucket& curr_bucket, double vis)
             }
             
             float priority = (-1.0) * (x*x+y*y);
+            if (predict) {
+                SGVec3d offset = hlOr.transform(SGVec3d::fromGeod(b.get_center()) - viewCart);
+                offset[2] = 0.0;
+                double eta = dot(offset, track) / (speed * speed);
+                if (eta >= 0.0) {
+                    double t = std::min(eta, lookahead);
+                    double miss = norm(offset - t * track) / tile_size;
+                    double along = t * speed / tile_size;
+                    priority = (-1.0) * (miss * miss + PREDICTIVE_ALONG_WEIGHT * along * along);
+                    if ((eta <= lookahead) && (miss < 1.0)) {
+                        _aheadTiles.push_back(std::make_pair(eta, b.gen_index()));
+                    }
+                } else {
+                    priority *= 2.0;
+                    if ((-eta * speed) / tile_size > PREDICTIVE_KEEP_TILES) {
+                        _deferredTiles.insert(b.gen_index());
+                    }
+                }
+            }
+
             sched_tile( b, priority, true, 0.0 );
             
             if (_terra_sync) {
@@ -325,6 +410,70 @@ void FGTileMgr::schedule_needed(const SGBucket& curr_bucket, double vis)
             }
         }
     }
+
+    std::sort(_aheadTiles.begin(), _aheadTiles.end());
+}
+
+void FGTileMgr::update_view_velocity(const SGGeod& location, double time)
+{
+    SGVec3d cart = SGVec3d::fromGeod(location);
+    double dt = time - _viewTime;
+    if ((_viewTime >= 0.0) && (dt > 0.0)) {
+        SGVec3d velocity = (cart - _viewCart) / dt;
+        if (norm(velocity) > MAX_VIEW_SPEED_MPS) {
+            // view change or relocation, not movement
+            _viewVelocity = SGVec3d::zeros();
+        } else {
+            double alpha = std::min(dt / VELOCITY_TIME_CONSTANT, 1.0);
+            _viewVelocity += alpha * (velocity - _viewVelocity);
+        }
+    }
+
+    _viewCart = cart;
+    _viewTime = time;
+}
+
+bool FGTileMgr::track_changed() const
+{
+    if (!_predictive->getBoolValue()) {
+        // reschedule once after switching off, to release deferred tiles
+        return !_deferredTiles.empty() || !_aheadTiles.empty();
+    }
+
+    double speed = norm(_viewVelocity);
+    double scheduledSpeed = norm(_scheduledVelocity);
+    bool moving = speed > PREDICTIVE_MIN_SPEED_MPS;
+    if (moving != (scheduledSpeed > PREDICTIVE_MIN_SPEED_MPS)) {
+        return true;
+    }
+
+    if (!moving) {
+        return false;
+    }
+
+    return dot(_viewVelocity, _scheduledVelocity) < TRACK_CHANGE_COS * speed * scheduledSpeed;
+}
+
+void FGTileMgr::update_stats(double current_time, int queued)
+{
+    _statsQueued->setIntValue(queued);
+    _statsPagerQueue->setIntValue(_pager->getFileRequestListSize());
+    _statsDeferred->setIntValue(_deferredTiles.size());
+
+    // time left until the view reaches the first tile on the projected
+    // track which is not loaded yet
+    double margin = _lookaheadSec->getDoubleValue();
+    double elapsed = current_time - _scheduledTime;
+    AheadTileList::const_iterator it;
+    for (it = _aheadTiles.begin(); it != _aheadTiles.end(); ++it) {
+        TileEntry* e = tile_cache.get_tile(it->second);
+        if (e && !e->is_loaded()) {
+            margin = it->first - elapsed;
+            break;
+        }
+    }
+
+    _statsLookaheadMargin->setDoubleValue(margin);
 }
 
 /**
@@ -358,7 +507,11 @@ void FGTileMgr::update_queues(bool& isDownloadingScenery)
                 bool nonExpiredOrCurrent = !e->is_expired(current_time) || e->is_current_view();
                 bool downloading = isTileDirSyncing(e->tileFileName);
                 isDownloadingScenery |= downloading;
-                if ( !downloading && nonExpiredOrCurrent) {
+                // deferred tiles are left out, the pager discards their
+                // earlier requests since they are not renewed
+                bool deferred = !_deferredTiles.empty() &&
+                    (_deferredTiles.count(e->get_tile_bucket().gen_index()) > 0);
+                if ( !downloading && nonExpiredOrCurrent && !deferred) {
                     // schedule tile for loading with osg pager
                     _pager->queueRequest(e->tileFileName,
                                          e->getNode(),
@@ -396,6 +549,7 @@ void FGTileMgr::update_queues(bool& isDownloadingScenery)
             SG_LOG(SG_TERRAIN, SG_DEBUG, "Dropping:" << old->get_tile_bucket());
 
             tile_cache.clear_entry(drop_index);
+            ElevationService::instance()->invalidateTile(drop_index);
             
             osg::ref_ptr<osg::Object> subgraph = old->getNode();
             old->removeFromSceneGraph();
@@ -413,6 +567,9 @@ void FGTileMgr::update_queues(bool& isDownloadingScenery)
                drop_index = -1;
         }
     } // of dropping tiles loop
+
+    update_stats(current_time, loading);
+    ElevationService::instance()->publishStats();
 }
 
 // given the current lon/lat (in degrees), fill in the array of local
@@ -421,6 +578,9 @@ void FGTileMgr::update_queues(bool& isDownloadingScenery)
 void FGTileMgr::update(double)
 {
     double vis = _visibilityMeters->getDoubleValue();
+    osg::FrameStamp* framestamp
+        = globals->get_renderer()->getViewer()->getFrameStamp();
+    update_view_velocity(globals->get_view_position(), framestamp->getReferenceTime());
     schedule_tiles_at(globals->get_view_position(), vis);
 
     bool waitingOnTerrasync = false;
@@ -482,7 +642,7 @@ void FGTileMgr::schedule_tiles_at(const SGGeod& location, double range_m)
         {
             SG_LOG( SG_TERRAIN, SG_DEBUG, "State == Running" );
         }
-        if (current_bucket != previous_bucket) {
+        if ((current_bucket != previous_bucket) || track_changed()) {
             // We've moved to a new bucket, we need to schedule any
             // needed tiles for loading.
             SG_LOG( SG_TERRAIN, SG_INFO, "FGTileMgr: at " << location << ", scheduling needed for:" << current_bucket
@@ -26,6 +26,10 @@
 
 #include <simgear/compiler.h>
 
+#include <set>
+#include <vector>
+
+#include <simgear/math/SGMath.hxx>
 #include <simgear/structure/subsystem_mgr.hxx>
 #include <simgear/bucket/newbucket.hxx>
 #include "SceneryPager.hxx"
@@ -86,6 +90,16 @@ private:
     // schedule tiles for the viewer bucket
     void schedule_tiles_at(const SGGeod& location, double rangeM);
 
+    // track the (smoothed) velocity of the view position
+    void update_view_velocity(const SGGeod& location, double time);
+
+    // true if the ground track changed enough to make the current
+    // predictive schedule stale
+    bool track_changed() const;
+
+    // publish the pager queue and look-ahead statistics
+    void update_stats(double current_time, int queued);
+
     SGPropertyNode_ptr _visibilityMeters;
     SGPropertyNode_ptr _maxTileRangeM, _disableNasalHooks;
     SGPropertyNode_ptr _scenery_loaded, _scenery_override;
@@ -94,6 +108,28 @@ private:
 
     /// is caching of expired tiles enabled or not?
     bool _enableCache;
+
+    /**
+     * Predictive scheduling: tiles along the projected ground track are
+     * loaded first, and unloaded tiles well behind a fast moving view are
+     * not passed to the pager at all.
+     */
+    SGPropertyNode_ptr _predictive, _lookaheadSec;
+    SGPropertyNode_ptr _statsPagerQueue, _statsQueued, _statsDeferred,
+      _statsLookaheadMargin;
+
+    SGVec3d _viewCart;          ///< view position at the last update
+    double _viewTime;           ///< frame time of _viewCart, negative if unset
+    SGVec3d _viewVelocity;      ///< smoothed view velocity, earth centered, m/s
+    SGVec3d _scheduledVelocity; ///< _viewVelocity when tiles were last scheduled
+    double _scheduledTime;
+
+    /// unloaded tiles which are behind the view, and not sent to the pager
+    std::set<long> _deferredTiles;
+
+    /// tiles on the projected track, with the time until they are reached
+    typedef std::vector<std::pair<double, long> > AheadTileList;
+    AheadTileList _aheadTiles;
 public:
     FGTileMgr();
     ~FGTileMgr();
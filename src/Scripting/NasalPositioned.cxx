@@ -46,6 +46,7 @@
 #include <Main/globals.hxx>
 #include <Main/fg_props.hxx>
 #include <Scenery/scenery.hxx>
+#include <Scenery/ElevationService.hxx>
 #include <ATC/CommStation.hxx>
 #include <Navaids/FlightPlan.hxx>
 #include <Navaids/waypoint.hxx>
@@ -988,7 +989,11 @@ static naRef f_geodinfo(naContext c, naRef me, int argc, naRef* args)
   double elev = argc == 3 ? naNumValue(args[2]).num : 10000;
   const simgear::BVHMaterial *material;
   SGGeod geod = SGGeod::fromDegM(lon, lat, elev);
-  if(!globals->get_scenery()->get_elevation_m(geod, elev, &material))
+  // scripts expect the exact elevation, this is only routed through the
+  // service for the statistics
+  static ElevationService::CallerId caller =
+    ElevationService::instance()->registerCaller("nasal-geodinfo", 0.0);
+  if(!ElevationService::instance()->getElevation(caller, geod, elev, &material))
     return naNil();
   const SGMaterial *mat = dynamic_cast<const SGMaterial *>(material);
   naRef vec = naNewVector(c);
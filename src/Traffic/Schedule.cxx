@@ -58,6 +58,13 @@
 
 using std::string;
 
+// how often (in seconds) a schedule handed to the AIManager is checked, to
+// notice when its aircraft is removed again
+static const time_t AI_AIRCRAFT_POLL_INTERVAL = 10;
+// retry interval for schedules which can't be positioned, and the longest
+// a distant schedule sleeps between position updates
+static const time_t MAX_SLEEP_INTERVAL = 600;
+
 /******************************************************************************
  * the FGAISchedule class contains data members and code to maintain a
  * schedule of Flights for an artificially controlled aircraft.
@@ -75,7 +82,8 @@ FGAISchedule::FGAISchedule()
     courseToDest(0),
     initialized(false),
     valid(false),
-    scheduleComplete(false)
+    scheduleComplete(false),
+    nextUpdate(0)
 {
 }
 
@@ -104,7 +112,8 @@ FGAISchedule::FGAISchedule(const string& model,
       courseToDest(0),
       initialized(false),
       valid(true),
-      scheduleComplete(false)
+      scheduleComplete(false),
+      nextUpdate(0)
 {
   modelPath        = model; 
   livery           = lvry; 
@@ -149,6 +158,7 @@ FGAISchedule::FGAISchedule(const FGAISchedule &other)
   initialized        = other.initialized;
   valid              = other.valid;
   scheduleComplete   = other.scheduleComplete;
+  nextUpdate         = other.nextUpdate;
 }
 
 
@@ -216,6 +226,7 @@ bool FGAISchedule::update(time_t now, const SGVec3d& userCart)
   }
 
   if (!scheduleComplete) {
+      nextUpdate = now;
       return false; // not ready yet, continue processing in next iteration
   }
 
@@ -248,6 +259,7 @@ bool FGAISchedule::update(time_t now, const SGVec3d& userCart)
     if (aiAircraft->getDie()) {
       aiAircraft = NULL;
     } else {
+      nextUpdate = now + AI_AIRCRAFT_POLL_INTERVAL;
       return true; // in visual range, let the AIManager handle it
     }
   }
@@ -261,12 +273,14 @@ bool FGAISchedule::update(time_t now, const SGVec3d& userCart)
     // and detach it from the current list of aircraft. 
     flight->update();
     flights.erase(flights.begin()); // pop_front(), effectively
+    nextUpdate = now; // position the next leg straight away
     return true; // processing complete
   }
   
   FGAirport* dep = flight->getDepartureAirport();
   FGAirport* arr = flight->getArrivalAirport();
   if (!dep || !arr) {
+    nextUpdate = now + MAX_SLEEP_INTERVAL;
     return true; // processing complete
   }
     
@@ -317,6 +331,15 @@ bool FGAISchedule::update(time_t now, const SGVec3d& userCart)
 	     << dep->getId() << " to " << arr->getId() << ". Current distance to user: " 
              << distanceToUser);
   if (distanceToUser >= TRAFFICTOAIDISTTOSTART) {
+    // sleep until the user could have closed the gap, the flight departs
+    // or the leg is over, whichever comes first
+    double gapSec = (distanceToUser - TRAFFICTOAIDISTTOSTART) * 3600.0 / TRAFFICMAXCLOSINGSPEED;
+    time_t sleep = SG_MIN2(static_cast<time_t>(gapSec), MAX_SLEEP_INTERVAL);
+    nextUpdate = now + SG_MAX2(sleep, static_cast<time_t>(1));
+    if (flight->getDepartureTime() > now) {
+      nextUpdate = SG_MIN2(nextUpdate, flight->getDepartureTime());
+    }
+    nextUpdate = SG_MIN2(nextUpdate, flight->getArrivalTime());
     return true; // out of visual range, for the moment.
   }
 
@@ -324,6 +347,8 @@ bool FGAISchedule::update(time_t now, const SGVec3d& userCart)
       valid = false;
   }
 
+  nextUpdate = now + AI_AIRCRAFT_POLL_INTERVAL;
+
 
     return true; // processing complete
 }
@@ -32,6 +32,11 @@
 #define TRAFFICTOAIDISTTOSTART 150.0
 #define TRAFFICTOAIDISTTODIE   200.0
 
+// upper bound for the speed (in knots) at which the user and a distant
+// schedule can approach each other, used to work out how long a schedule
+// can sleep before it might come within TRAFFICTOAIDISTTOSTART
+#define TRAFFICMAXCLOSINGSPEED 1500.0
+
 // forward decls
 class FGAIAircraft;
 class FGScheduledFlight;
@@ -66,6 +71,7 @@ class FGAISchedule
   bool initialized;
   bool valid;
   bool scheduleComplete;
+  time_t nextUpdate;
 
   bool scheduleFlights(time_t now);
   int groundTimeFromRadius();
@@ -104,6 +110,15 @@ class FGAISchedule
   bool update(time_t now, const SGVec3d& userCart);
   bool init();
 
+  /**
+   * Earliest time at which update() has any work to do, based on the
+   * pending departure / arrival and the distance to the user at the last
+   * update. Only meaningful while isValid() returns true.
+   */
+  time_t getNextUpdate        () const { return nextUpdate; };
+  bool   isValid              () const { return valid; };
+  double getDistanceToUser    () const { return distanceToUser; };
+
   double getSpeed         ();
   //void setClosestDistanceToUser();
   bool next();   // forces the schedule to move on to the next flight.
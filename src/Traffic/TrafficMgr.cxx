@@ -53,6 +53,7 @@
 #include <boost/foreach.hpp>
 
 #include <simgear/compiler.h>
+#include <simgear/sg_inlines.h>
 #include <simgear/misc/sg_path.hxx>
 #include <simgear/misc/sgstream.hxx>
 #include <simgear/misc/sg_dir.hxx>
@@ -60,6 +61,7 @@
 #include <simgear/structure/subsystem_mgr.hxx>
 #include <simgear/structure/exception.hxx>
 #include <simgear/timing/sg_time.hxx>
+#include <simgear/timing/timestamp.hxx>
 
 #include <simgear/xml/easyxml.hxx>
 #include <simgear/threads/SGThread.hxx>
@@ -84,6 +86,13 @@ using std::endl;
 using std::string;
 using std::vector;
 
+// distance band (in nm) used to order schedules which are due at the same
+// time, so the ones closest to the user are processed first
+static const double DISTANCE_BUCKET_NM = 50.0;
+// user movement between two updates beyond which the update queue is
+// rebuilt, since the wake times of all schedules are then meaningless
+static const double USER_RELOCATION_DISTANCE_NM = 20.0;
+
 /**
  * Thread encapsulating parsing the traffic schedules.
  */
@@ -94,6 +103,7 @@ public:
     _trafficManager(traffic),
     _isFinished(false),
     _cancelThread(false),
+    _parseTimeMSec(0.0),
     cruiseAlt(0),
     score(0),
     acCounter(0),
@@ -128,8 +138,18 @@ public:
     return _isFinished;
   }
 
+  /// total time spent parsing, valid once isFinished() returns true
+  double parseTimeMSec() const
+  {
+    SGGuard<SGMutex> g(_lock);
+    return _parseTimeMSec;
+  }
+
   virtual void run()
   {
+      SGTimeStamp st;
+      st.stamp();
+
       BOOST_FOREACH(SGPath p, _trafficDirPaths) {
           parseTrafficDir(p);
           if (_cancelThread) {
@@ -138,6 +158,7 @@ public:
       }
 
     SGGuard<SGMutex> g(_lock);
+    _parseTimeMSec = st.elapsedMSec();
     _isFinished = true;
   }
 
@@ -399,6 +420,7 @@ private:
   mutable SGMutex _lock;
   bool _isFinished;
   bool _cancelThread;
+  double _parseTimeMSec;
   simgear::PathList _trafficDirPaths;
 
 // parser state
@@ -426,6 +448,9 @@ FGTrafficManager::FGTrafficManager() :
   doingInit(false),
   trafficSyncRequested(false),
   waitingMetarTime(0.0),
+  queueOrder(0),
+  lastUpdateTime(0),
+  parseTimeMSec(0.0),
   enabled("/sim/traffic-manager/enabled"),
   aiEnabled("/sim/ai/enabled"),
   realWxEnabled("/environment/realwx/enabled"),
@@ -493,9 +518,9 @@ void FGTrafficManager::shutdown()
         cachefile.close();
     }
     scheduledAircraft.clear();
+    updateQueue.clear();
     flights.clear();
 
-    currAircraft = scheduledAircraft.begin();
     doingInit = false;
     inited = false;
     trafficSyncRequested = false;
@@ -556,6 +581,9 @@ void FGTrafficManager::init()
         scheduleParser->setTrafficDirs(dirs);
         scheduleParser->start();
     } else {
+        SGTimeStamp st;
+        st.stamp();
+
         fgSetBool("/sim/traffic-manager/heuristics", false);
         SGPath path = string(fgGetString("/sim/traffic-manager/datafile"));
         string ext = path.extension();
@@ -576,6 +604,7 @@ void FGTrafficManager::init()
                                 << " for traffic");
         }
         //exit(1);
+        parseTimeMSec = st.elapsedMSec();
     }
 }
 
@@ -601,8 +630,23 @@ void FGTrafficManager::finishInit()
 
     sort(scheduledAircraft.begin(), scheduledAircraft.end(),
          compareSchedules);
-    currAircraft = scheduledAircraft.begin();
-    currAircraftClosest = scheduledAircraft.begin();
+
+    if (scheduleParser.get()) {
+        parseTimeMSec = scheduleParser->parseTimeMSec();
+    }
+
+    budgetNode = fgGetNode("/sim/traffic-manager/update-budget-ms", true);
+    if (!budgetNode->hasValue()) {
+        budgetNode->setDoubleValue(2.0);
+    }
+
+    statsNode = fgGetNode("/sim/traffic-manager/stats", true);
+    statsNode->setDoubleValue("parse-time-ms", parseTimeMSec);
+    statsNode->setIntValue("schedules", scheduledAircraft.size());
+    SG_LOG(SG_AI, SG_INFO, "AI-Traffic: " << scheduledAircraft.size()
+           << " schedules, parsing took " << parseTimeMSec << "msec");
+
+    rebuildQueue(globals->get_time_params()->get_cur_time());
 
     doingInit = false;
     inited = true;
@@ -653,13 +697,13 @@ void FGTrafficManager::loadHeuristics()
       }
     }
 
-  for(currAircraft = scheduledAircraft.begin(); currAircraft != scheduledAircraft.end(); ++currAircraft) {
-        const string& registration = (*currAircraft)->getRegistration();
+  for(ScheduleVectorIterator it = scheduledAircraft.begin(); it != scheduledAircraft.end(); ++it) {
+        const string& registration = (*it)->getRegistration();
         HeuristicMapIterator itr = heurMap.find(registration);
         if (itr != heurMap.end()) {
-            (*currAircraft)->setrunCount(itr->second.runCount);
-            (*currAircraft)->setHits(itr->second.hits);
-            (*currAircraft)->setLastUsed(itr->second.lastRun);
+            (*it)->setrunCount(itr->second.runCount);
+            (*it)->setHits(itr->second.hits);
+            (*it)->setLastUsed(itr->second.lastRun);
         }
     }
 }
@@ -729,18 +773,105 @@ void FGTrafficManager::update(double dt)
     }
 
     SGVec3d userCart = globals->get_aircraft_position_cart();
+    time_t now = globals->get_time_params()->get_cur_time();
 
-    if (currAircraft == scheduledAircraft.end()) {
-        currAircraft = scheduledAircraft.begin();
+    // the wake times assume the user moves continuously forward in time;
+    // after a relocation or a jump back in time, everything is due again
+    if ((now < lastUpdateTime) ||
+        (dist(userCart, lastUserCart) * SG_METER_TO_NM > USER_RELOCATION_DISTANCE_NM))
+    {
+        SG_LOG(SG_AI, SG_DEBUG, "AI-Traffic: user relocated, rescheduling all aircraft");
+        rebuildQueue(now);
     }
+    lastUserCart = userCart;
+    lastUpdateTime = now;
+
+    // process every due schedule until the budget is spent. Schedules are
+    // re-queued afterwards, so each is processed at most once per frame.
+    SGTimeStamp st;
+    st.stamp();
+    double budget = budgetNode->getDoubleValue();
+    unsigned int processed = 0;
+    ScheduleVector requeue;
+
+    while (!updateQueue.empty() && (updateQueue.front().wakeTime <= now)) {
+        if ((processed > 0) && (st.elapsedMSec() >= budget)) {
+            break;
+        }
 
-    time_t now = globals->get_time_params()->get_cur_time();
+        FGAISchedule* schedule = updateQueue.front().schedule;
+        std::pop_heap(updateQueue.begin(), updateQueue.end());
+        updateQueue.pop_back();
+
+        schedule->update(now, userCart);
+        ++processed;
+        if (schedule->isValid()) {
+            requeue.push_back(schedule);
+        }
+    }
 
-    //cerr << "Processing << " << (*currAircraft)->getRegistration() << " with score " << (*currAircraft)->getScore() << endl;
-    if ((*currAircraft)->update(now, userCart)) {
-        // schedule is done - process another aircraft in next iteration
-        currAircraft++;
+    BOOST_FOREACH(FGAISchedule* schedule, requeue) {
+        pushSchedule(schedule, SG_MAX2(schedule->getNextUpdate(), now));
     }
+
+    publishStats(processed, st.elapsedMSec());
+}
+
+bool FGTrafficManager::QueueEntry::operator<(const QueueEntry& other) const
+{
+    // reversed, so the standard heap functions give a min-heap
+    if (wakeTime != other.wakeTime) {
+        return wakeTime > other.wakeTime;
+    }
+
+    if (distanceBucket != other.distanceBucket) {
+        return distanceBucket > other.distanceBucket;
+    }
+
+    return order > other.order;
+}
+
+void FGTrafficManager::pushSchedule(FGAISchedule* schedule, time_t wakeTime)
+{
+    QueueEntry e;
+    e.wakeTime = wakeTime;
+    e.distanceBucket = static_cast<int>(schedule->getDistanceToUser() / DISTANCE_BUCKET_NM);
+    e.order = queueOrder++;
+    e.schedule = schedule;
+    updateQueue.push_back(e);
+    std::push_heap(updateQueue.begin(), updateQueue.end());
+}
+
+void FGTrafficManager::rebuildQueue(time_t now)
+{
+    // everything becomes due now, in score order, which is the order of
+    // scheduledAircraft
+    updateQueue.clear();
+    updateQueue.reserve(scheduledAircraft.size());
+    queueOrder = 0;
+    BOOST_FOREACH(FGAISchedule* schedule, scheduledAircraft) {
+        if (!schedule->isValid()) {
+            continue;
+        }
+
+        QueueEntry e;
+        e.wakeTime = now;
+        e.distanceBucket = 0;
+        e.order = queueOrder++;
+        e.schedule = schedule;
+        updateQueue.push_back(e);
+    }
+
+    std::make_heap(updateQueue.begin(), updateQueue.end());
+    lastUpdateTime = now;
+    lastUserCart = globals->get_aircraft_position_cart();
+}
+
+void FGTrafficManager::publishStats(unsigned int processed, double usedMSec)
+{
+    statsNode->setIntValue("queue-depth", updateQueue.size());
+    statsNode->setIntValue("processed", processed);
+    statsNode->setDoubleValue("budget-used-ms", usedMSec);
 }
 
 void FGTrafficManager::readTimeTableFromFile(SGPath infileName)
@@ -48,7 +48,9 @@
 
 #include <set>
 #include <memory>
+#include <vector>
 
+#include <simgear/math/SGMath.hxx>
 #include <simgear/structure/subsystem_mgr.hxx>
 #include <simgear/props/propertyObject.hxx>
 #include <simgear/misc/sg_path.hxx>
@@ -86,7 +88,32 @@ private:
   std::string waitingMetarStation;
   
   ScheduleVector scheduledAircraft;
-  ScheduleVectorIterator currAircraft, currAircraftClosest;
+
+  /**
+   * Entry of the update queue: schedules are kept in a min-heap on the
+   * time they next need an update, ties broken by distance to the user
+   * and then by score order.
+   */
+  struct QueueEntry
+  {
+    time_t wakeTime;
+    int distanceBucket;
+    unsigned int order;
+    FGAISchedule* schedule;
+
+    bool operator<(const QueueEntry& other) const;
+  };
+  typedef std::vector<QueueEntry> UpdateQueue;
+
+  UpdateQueue updateQueue;
+  unsigned int queueOrder;
+  SGVec3d lastUserCart;
+  time_t lastUpdateTime;
+  double parseTimeMSec;
+
+  void pushSchedule(FGAISchedule* schedule, time_t wakeTime);
+  void rebuildQueue(time_t now);
+  void publishStats(unsigned int processed, double usedMSec);
     
   FGScheduledFlightMap flights;
 
@@ -94,6 +121,7 @@ private:
     void Tokenize(const std::string& str, std::vector<std::string>& tokens, const std::string& delimiters = " ");
 
   simgear::PropertyObject<bool> enabled, aiEnabled, realWxEnabled, metarValid;
+  SGPropertyNode_ptr budgetNode, statsNode;
   
   void loadHeuristics();
   
@@ -0,0 +1,393 @@
+// jsbbatch.cxx -- run JSBSim scripts headless, many cases in parallel
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <simgear/threads/SGThread.hxx>
+#include <simgear/threads/SGGuard.hxx>
+#include <simgear/timing/timestamp.hxx>
+
+#include <FGFDMExec.h>
+#include <FGJSBBase.h>
+#include <input_output/FGPropertyManager.h>
+#include <input_output/FGXMLFileRead.h>
+
+using namespace std;
+
+namespace {
+
+struct Options
+{
+  Options() : runs(1), seed(1), jobs(1), interval(0.0), endTime(0.0),
+    documentCache(true) {}
+
+  string root;
+  vector<string> scripts;
+  vector<string> properties;
+  int runs;
+  int seed;
+  int jobs;
+  double interval;
+  double endTime;
+  string output;
+  bool documentCache;
+};
+
+/// one script run; the samples are rows of the simulation time followed by
+/// the requested properties
+struct Case
+{
+  Case() : seed(0), done(false), ok(false), frames(0) {}
+
+  string script;
+  int seed;
+  bool done;
+  bool ok;
+  unsigned long frames;
+  vector<double> samples;
+};
+
+/**
+ * Runs the cases on a pool of worker threads. Each case gets its own
+ * FGFDMExec; loading and destroying them is serialized (see FGFDMExec), the
+ * simulation itself runs concurrently. Results are written in case order, as
+ * soon as all the preceding cases are finished.
+ */
+class Batch
+{
+public:
+  Batch(const Options& opts, ostream& out) :
+    _opts(opts), _out(out), _nextCase(0), _nextOutput(0)
+  {
+    for (size_t i = 0; i < opts.scripts.size(); ++i) {
+      for (int run = 0; run < opts.runs; ++run) {
+        Case c;
+        c.script = opts.scripts[i];
+        c.seed = opts.seed + run;
+        _cases.push_back(c);
+      }
+    }
+  }
+
+  size_t numCases() const { return _cases.size(); }
+
+  /// run cases until there are none left, called from each worker
+  void work()
+  {
+    size_t index;
+    while (nextCase(index)) {
+      runCase(_cases[index]);
+      finishCase(index);
+    }
+  }
+
+  void writeHeader()
+  {
+    _out << "case,script,seed,time";
+    for (size_t i = 0; i < _opts.properties.size(); ++i) {
+      _out << "," << _opts.properties[i];
+    }
+    _out << endl;
+  }
+
+  unsigned int numFailed() const
+  {
+    unsigned int failed = 0;
+    for (size_t i = 0; i < _cases.size(); ++i) {
+      if (!_cases[i].ok) ++failed;
+    }
+    return failed;
+  }
+
+  unsigned long numFrames() const
+  {
+    unsigned long frames = 0;
+    for (size_t i = 0; i < _cases.size(); ++i) {
+      frames += _cases[i].frames;
+    }
+    return frames;
+  }
+private:
+  bool nextCase(size_t& index)
+  {
+    SGGuard<SGMutex> lock(_queueMutex);
+    if (_nextCase >= _cases.size()) {
+      return false;
+    }
+
+    index = _nextCase++;
+    return true;
+  }
+
+  JSBSim::FGFDMExec* load(Case& c, vector<JSBSim::FGPropertyNode*>& nodes)
+  {
+    JSBSim::FGFDMExec* fdm = new JSBSim::FGFDMExec;
+    // the ground callback is shared with the cases running in the other
+    // threads, keep our time out of it
+    fdm->SetGroundCallbackTime(false);
+    fdm->SetRootDir(_opts.root);
+    fdm->SetAircraftPath("aircraft");
+    fdm->SetEnginePath("engine");
+    fdm->SetSystemsPath("systems");
+    // reseeds the random number generator, for the dispersions
+    fdm->SetPropertyValue("simulation/randomseed", c.seed);
+
+    if (!fdm->LoadScript(c.script)) {
+      cerr << c.script << ": could not load the script" << endl;
+      return fdm;
+    }
+
+    // the script's own output directives would write the same files from
+    // all the cases
+    fdm->DisableOutput();
+
+    JSBSim::FGPropertyManager* pm = fdm->GetPropertyManager();
+    for (size_t i = 0; i < _opts.properties.size(); ++i) {
+      JSBSim::FGPropertyNode* node = pm->GetNode(_opts.properties[i]);
+      if (!node) {
+        cerr << c.script << ": no property " << _opts.properties[i] << endl;
+        return fdm;
+      }
+      nodes.push_back(node);
+    }
+
+    c.ok = fdm->RunIC();
+    return fdm;
+  }
+
+  void sample(Case& c, JSBSim::FGFDMExec* fdm,
+              const vector<JSBSim::FGPropertyNode*>& nodes)
+  {
+    c.samples.push_back(fdm->GetSimTime());
+    for (size_t i = 0; i < nodes.size(); ++i) {
+      c.samples.push_back(nodes[i]->getDoubleValue());
+    }
+  }
+
+  void runCase(Case& c)
+  {
+    JSBSim::FGFDMExec* fdm = 0;
+    vector<JSBSim::FGPropertyNode*> nodes;
+
+    try {
+      {
+        SGGuard<SGMutex> lock(_setupMutex);
+        fdm = load(c, nodes);
+      }
+
+      if (c.ok) {
+        sample(c, fdm, nodes);
+        double nextSample = _opts.interval;
+        while (fdm->Run()) {
+          ++c.frames;
+          // sample the frame nearest to each multiple of the interval
+          double t = fdm->GetSimTime();
+          double halfFrame = 0.5 * fdm->GetDeltaT();
+          if ((_opts.interval <= 0.0) || (t + halfFrame >= nextSample)) {
+            sample(c, fdm, nodes);
+            while ((_opts.interval > 0.0) && (t + halfFrame >= nextSample)) {
+              nextSample += _opts.interval;
+            }
+          }
+          if ((_opts.endTime > 0.0) && (t >= _opts.endTime)) {
+            break;
+          }
+        }
+      }
+    } catch (const string& msg) {
+      cerr << c.script << ": " << msg << endl;
+      c.ok = false;
+    } catch (...) {
+      cerr << c.script << ": unexpected exception" << endl;
+      c.ok = false;
+    }
+
+    SGGuard<SGMutex> lock(_setupMutex);
+    if (fdm) {
+      // nobody reads the gear contact messages, don't let them pile up
+      while (fdm->ProcessNextMessage()) {}
+      delete fdm;
+    }
+  }
+
+  void finishCase(size_t index)
+  {
+    SGGuard<SGMutex> lock(_outputMutex);
+    _cases[index].done = true;
+
+    size_t columns = _opts.properties.size() + 1;
+    for (; (_nextOutput < _cases.size()) && _cases[_nextOutput].done; ++_nextOutput) {
+      Case& c(_cases[_nextOutput]);
+      for (size_t row = 0; row < c.samples.size(); row += columns) {
+        _out << _nextOutput << "," << c.script << "," << c.seed;
+        for (size_t col = 0; col < columns; ++col) {
+          _out << "," << c.samples[row + col];
+        }
+        _out << "\n";
+      }
+      _out.flush();
+      vector<double>().swap(c.samples);
+    }
+  }
+
+  const Options& _opts;
+  ostream& _out;
+  vector<Case> _cases;
+  size_t _nextCase;
+  size_t _nextOutput;
+
+  SGMutex _queueMutex;
+  SGMutex _setupMutex;
+  SGMutex _outputMutex;
+};
+
+class Worker : public SGThread
+{
+public:
+  Worker(Batch& batch) : _batch(batch) {}
+protected:
+  virtual void run() { _batch.work(); }
+private:
+  Batch& _batch;
+};
+
+bool parseOption(const string& arg, const string& name, string& value)
+{
+  string prefix = "--" + name + "=";
+  if (arg.compare(0, prefix.size(), prefix) != 0) {
+    return false;
+  }
+
+  value = arg.substr(prefix.size());
+  return true;
+}
+
+void usage()
+{
+  cerr << "Usage: jsbbatch [options] <script> ..." << endl
+       << "  --root=<dir>        JSBSim root, containing aircraft/, engine/ and systems/" << endl
+       << "  --script=<file>     script to run, relative to the root (repeatable)" << endl
+       << "  --runs=<n>          runs of each script, with consecutive random seeds" << endl
+       << "  --seed=<n>          random seed of the first run (default 1)" << endl
+       << "  --jobs=<n>          number of worker threads (default 1)" << endl
+       << "  --property=<name>   property to record (repeatable)" << endl
+       << "  --interval=<sec>    sampling interval, 0 records every frame (default)" << endl
+       << "  --end=<sec>         stop the runs at this simulation time" << endl
+       << "  --output=<file>     CSV output file (default stdout)" << endl
+       << "  --no-cache          parse the XML files again for each run" << endl
+       << "Set JSBSIM_DISPERSE=1 to apply the dispersions of the aircraft model." << endl;
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+  Options opts;
+
+  for (int i = 1; i < argc; ++i) {
+    string arg = argv[i];
+    string value;
+    if ((arg == "-h") || (arg == "--help")) {
+      usage();
+      return 0;
+    } else if (parseOption(arg, "root", value)) {
+      opts.root = value;
+    } else if (parseOption(arg, "script", value)) {
+      opts.scripts.push_back(value);
+    } else if (parseOption(arg, "runs", value)) {
+      opts.runs = atoi(value.c_str());
+    } else if (parseOption(arg, "seed", value)) {
+      opts.seed = atoi(value.c_str());
+    } else if (parseOption(arg, "jobs", value)) {
+      opts.jobs = atoi(value.c_str());
+    } else if (parseOption(arg, "property", value)) {
+      opts.properties.push_back(value);
+    } else if (parseOption(arg, "interval", value)) {
+      opts.interval = atof(value.c_str());
+    } else if (parseOption(arg, "end", value)) {
+      opts.endTime = atof(value.c_str());
+    } else if (parseOption(arg, "output", value)) {
+      opts.output = value;
+    } else if (arg == "--no-cache") {
+      opts.documentCache = false;
+    } else if (arg.compare(0, 2, "--") == 0) {
+      cerr << "Unknown option " << arg << endl;
+      usage();
+      return 1;
+    } else {
+      opts.scripts.push_back(arg);
+    }
+  }
+
+  if (opts.scripts.empty() || (opts.runs < 1) || (opts.jobs < 1)) {
+    usage();
+    return 1;
+  }
+
+  if (!opts.root.empty() && (opts.root[opts.root.size() - 1] != '/')) {
+    opts.root += "/";
+  }
+
+  ofstream file;
+  if (!opts.output.empty()) {
+    file.open(opts.output.c_str());
+    if (!file.is_open()) {
+      cerr << "Could not open " << opts.output << endl;
+      return 1;
+    }
+  }
+  ostream& out = opts.output.empty() ? cout : file;
+  out.precision(10);
+
+  JSBSim::FGJSBBase::debug_lvl = 0; // JSBSIM_DEBUG still applies
+  JSBSim::FGXMLFileRead::UseDocumentCache(opts.documentCache);
+
+  Batch batch(opts, out);
+  batch.writeHeader();
+
+  SGTimeStamp start = SGTimeStamp::now();
+
+  vector<Worker*> workers;
+  int jobs = min(opts.jobs, int(batch.numCases()));
+  for (int i = 0; i < jobs; ++i) {
+    workers.push_back(new Worker(batch));
+    workers.back()->start();
+  }
+
+  for (size_t i = 0; i < workers.size(); ++i) {
+    workers[i]->join();
+    delete workers[i];
+  }
+
+  double elapsed = (SGTimeStamp::now() - start).toSecs();
+  unsigned int failed = batch.numFailed();
+  cerr << batch.numCases() << " cases (" << failed << " failed) on "
+       << jobs << " threads in " << elapsed << " s, "
+       << batch.numFrames() / elapsed << " frames/s" << endl;
+
+  JSBSim::FGXMLFileRead::UseDocumentCache(false);
+
+  return failed ? 2 : 0;
+}